@@ -2,6 +2,7 @@
 #include "util/str8.h"
 #include "util/bit.h"
 #include "util/allocator.h"
+#include "util/job_system.h"
 #include "renderer/simple_renderer.h"
 
 #include "systems/resource_system.h"
@@ -24,16 +25,30 @@ int main(int ArgumentCount, char* ArgumentList[])
 
 	PlatformLogSystemInit();
 
+	log_file_config LogFileConfig = {};
+	LogFileConfig.Path = "chibi-tech.log";
+
 	log_flags_bitset LogFlags = log_flags_bitset()
 		.Set(log_flags::console)
 		.Set(log_flags::debug_console);
+	if (PlatformLogSystemOpenFile(LogFileConfig))
+	{
+		LogFlags.Set(log_flags::file);
+	}
 	PlatformLogSystemSetFlags(LogFlags);
 
 	//
 	// Resource System
 	// 
 
-	resource_system ResourceSystem = resource_system(ContentPath);
+	resource_system  ResourceSystem  = resource_system(ContentPath);
+	resource_watcher ResourceWatcher = resource_watcher(HeapAllocator, &ResourceSystem);
+
+	//
+	// Job System
+	//
+
+	job_system JobSystem = job_system(HeapAllocator);
 
 	//
 	// Client Window
@@ -50,6 +65,7 @@ int main(int ArgumentCount, char* ArgumentList[])
 		.HeapAllocator  = &HeapAllocator,
 		.ClientWindow   = ClientWindow,
 		.ResourceSystem = ResourceSystem,
+		.JobSystem      = &JobSystem,
 	};
 
 	SimpleRendererInit(RenderInfo);
@@ -58,13 +74,14 @@ int main(int ArgumentCount, char* ArgumentList[])
 	// Run the App
 	//
 
-	platform_timer FrameTimer    = {};
-	platform_timer PerFrameTimer = {};
+	// Pace to the monitor's refresh rate so we don't melt the CPU/GPU. A rate of 0 runs uncapped.
+	platform_frame_limiter FrameLimiter = {};
+	FrameLimiter.SetTargetFrameRate(ClientWindow.GetMonitorRefreshRate());
 
-	FrameTimer.Start();
+	u32 FrameIndex = 0;
 	while (ClientWindow.IsRunning())
 	{
-		PerFrameTimer.Start();
+		FrameLimiter.BeginFrame();
 
 		platform_pump_message_result PumpResult = ClientWindow.PumpMessages();
 		if (PumpResult.Close || PumpResult.Error)
@@ -80,27 +97,26 @@ int main(int ArgumentCount, char* ArgumentList[])
 		{
 		}
 
+		ResourceWatcher.Update();
+
 		SimpleRendererRender();
 
 		// End of the frame
-		FrameTimer.Update();
-		PerFrameTimer.Update(); 
-
-		// Meet the target frame rate so we don't melt the CPU/GPU
-		f64 TargetRefreshRate      = ClientWindow.GetMonitorRefreshRate();
-		f64 WorkSecondsElapsed     = PerFrameTimer.GetSecondsElapsed();
-		f64 SecondsElapsedForFrame = WorkSecondsElapsed;
-		if (SecondsElapsedForFrame < TargetRefreshRate)
+		FrameLimiter.EndFrame();
+
+		FrameIndex += 1;
+		if (FrameIndex % platform_frame_limiter::cHistorySize == 0)
 		{
-			s64 SleepMS = (s64)(1000.0 * (TargetRefreshRate - SecondsElapsedForFrame));
-			if (SleepMS > 0)
-			{
-				PlatformSleepMainThread((u32)SleepMS);
-			}
+			frame_time_stats Stats = FrameLimiter.GetStats();
+			LogDebug("Frame (ms) p50 %.3f, p99 %.3f, max %.3f | Work (ms) p50 %.3f, p99 %.3f, max %.3f",
+				Stats.FrameP50Ns / 1e6, Stats.FrameP99Ns / 1e6, Stats.FrameMaxNs / 1e6,
+				Stats.WorkP50Ns  / 1e6, Stats.WorkP99Ns  / 1e6, Stats.WorkMaxNs  / 1e6);
 		}
 	}
 
 	SimpleRendererDeinit();
+	JobSystem.Deinit();
+	ResourceWatcher.Deinit();
 	ClientWindow.Deinit();
 	PlatformDeinit();
 	PlatformLogSystemDeinit();
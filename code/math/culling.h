@@ -0,0 +1,234 @@
+//
+// Header-Only Frustum Culling
+//
+// frustum FrustumFromMatrix(f32x44 ViewProjection)
+// bool    FrustumTestSphere(const frustum& Frustum, f32x3 Center, f32 Radius)
+// bool    FrustumTestAabb(const frustum& Frustum, f32x3 Center, f32x3 Extent)
+//
+// aabb    TransformAabb(const f32x44& Matrix, aabb Box)
+//
+// Batched tests over SoA bounds, 8 (AVX) or 4 (SSE) objects at a time. The indices of the visible
+// objects are written to VisibleIndices in order and the number of visible objects is returned.
+// VisibleIndices must have room for Count indices.
+//
+// u32 FrustumCullSpheres(const frustum& Frustum, sphere_soa Spheres, u32 Count, u32* VisibleIndices)
+// u32 FrustumCullAabbs(const frustum& Frustum, aabb_soa Boxes, u32 Count, u32* VisibleIndices)
+//
+// The tests are conservative: an object straddling a plane, or outside the frustum near a corner,
+// is reported as visible.
+//
+#pragma once
+
+#include "math.h"
+
+enum class frustum_plane : u8
+{
+    left,
+    right,
+    bottom,
+    top,
+    z_near, // "near" and "far" are macros in the Windows headers
+    z_far,
+    count,
+};
+
+// Each plane is (Normal.X, Normal.Y, Normal.Z, Distance) with the normal pointing into the frustum,
+// so a point is inside when Dot(Normal, Point) + Distance >= 0.
+struct frustum
+{
+    f32x4 Planes[u32(frustum_plane::count)];
+};
+
+struct sphere_soa
+{
+    f32* CenterX;
+    f32* CenterY;
+    f32* CenterZ;
+    f32* Radius;
+};
+
+// Min/max form, which is the cheapest form to merge and to store in a BVH.
+struct aabb
+{
+    f32x3 Min;
+    f32x3 Max;
+};
+
+// Center + half-extent form, which is the cheapest form for plane tests.
+struct aabb_soa
+{
+    f32* CenterX;
+    f32* CenterY;
+    f32* CenterZ;
+    f32* ExtentX;
+    f32* ExtentY;
+    f32* ExtentZ;
+};
+
+// Extracts the planes from a combined projection * view matrix (Gribb/Hartmann). Clip space depth is
+// [-W, W] to match PerspectiveMatrixRH. Passing a projection * view * model matrix gives model space planes.
+inline frustum FrustumFromMatrix(f32x44 ViewProjection)
+{
+    f32x44 Rows = TransposeMatrix(ViewProjection);
+
+    frustum Result;
+    Result.Planes[u32(frustum_plane::left)]   = Rows.C3 + Rows.C0;
+    Result.Planes[u32(frustum_plane::right)]  = Rows.C3 - Rows.C0;
+    Result.Planes[u32(frustum_plane::bottom)] = Rows.C3 + Rows.C1;
+    Result.Planes[u32(frustum_plane::top)]    = Rows.C3 - Rows.C1;
+    Result.Planes[u32(frustum_plane::z_near)] = Rows.C3 + Rows.C2;
+    Result.Planes[u32(frustum_plane::z_far)]  = Rows.C3 - Rows.C2;
+
+    // Normalize so the plane distance is in world units, which the sphere radius test relies on.
+    for (f32x4& Plane : Result.Planes)
+    {
+        f32 Length = Plane.XYZ.Length();
+        Plane /= Length;
+    }
+
+    return Result;
+}
+
+inline bool FrustumTestSphere(const frustum& Frustum, f32x3 Center, f32 Radius)
+{
+    for (const f32x4& Plane : Frustum.Planes)
+    {
+        if (Dot(Plane.XYZ, Center) + Plane.W < -Radius) return false;
+    }
+    return true;
+}
+
+inline bool FrustumTestAabb(const frustum& Frustum, f32x3 Center, f32x3 Extent)
+{
+    for (const f32x4& Plane : Frustum.Planes)
+    {
+        // Projected radius of the box onto the plane normal
+        f32 Radius = fabsf(Plane.X) * Extent.X + fabsf(Plane.Y) * Extent.Y + fabsf(Plane.Z) * Extent.Z;
+        if (Dot(Plane.XYZ, Center) + Plane.W < -Radius) return false;
+    }
+    return true;
+}
+
+// Bounds of the transformed box (Arvo). Each world axis extent is the sum of the absolute
+// contributions of the local extents, so rotated boxes grow to fit.
+inline aabb TransformAabb(const f32x44& Matrix, aabb Box)
+{
+    f32x3 Center = (Box.Min + Box.Max) * 0.5f;
+    f32x3 Extent = (Box.Max - Box.Min) * 0.5f;
+
+    f32x3 AxisX = Matrix.C0.XYZ;
+    f32x3 AxisY = Matrix.C1.XYZ;
+    f32x3 AxisZ = Matrix.C2.XYZ;
+
+    f32x3 WorldCenter = Matrix.C3.XYZ + AxisX * Center.X + AxisY * Center.Y + AxisZ * Center.Z;
+    f32x3 WorldExtent = f32x3{ fabsf(AxisX.X), fabsf(AxisX.Y), fabsf(AxisX.Z) } * Extent.X
+                      + f32x3{ fabsf(AxisY.X), fabsf(AxisY.Y), fabsf(AxisY.Z) } * Extent.Y
+                      + f32x3{ fabsf(AxisZ.X), fabsf(AxisZ.Y), fabsf(AxisZ.Z) } * Extent.Z;
+
+    return { WorldCenter - WorldExtent, WorldCenter + WorldExtent };
+}
+
+namespace math_internal
+{
+    // Appends Base + i for each set bit i of VisibleMask without branching on the mask.
+    // VisibleIndices[Count] is always within the caller's buffer since Count <= Base + i.
+    inline u32 AppendVisible(u32* VisibleIndices, u32 Count, u32 Base, u32 VisibleMask, u32 Width)
+    {
+        for (u32 Lane = 0; Lane < Width; ++Lane)
+        {
+            VisibleIndices[Count] = Base + Lane;
+            Count += (VisibleMask >> Lane) & 1;
+        }
+        return Count;
+    }
+
+    // For each object, tracks the minimum over all planes of (distance to plane + radius).
+    // The object is visible when that minimum is not negative.
+    template<typename lanes>
+    inline u32 FrustumCullSpheres(const frustum& Frustum, sphere_soa Spheres, u32 Begin, u32 Count, u32* VisibleIndices, u32* VisibleCount)
+    {
+        using reg = typename lanes::reg;
+
+        u32 i = Begin;
+        for (; i + lanes::cWidth <= Count; i += lanes::cWidth)
+        {
+            reg X = lanes::Load(Spheres.CenterX + i);
+            reg Y = lanes::Load(Spheres.CenterY + i);
+            reg Z = lanes::Load(Spheres.CenterZ + i);
+            reg R = lanes::Load(Spheres.Radius  + i);
+
+            reg MinDistance = lanes::Set1(F32_MAX);
+            for (const f32x4& Plane : Frustum.Planes)
+            {
+                reg Distance = lanes::MulAdd(lanes::Set1(Plane.X), X, lanes::Add(lanes::Set1(Plane.W), R));
+                Distance     = lanes::MulAdd(lanes::Set1(Plane.Y), Y, Distance);
+                Distance     = lanes::MulAdd(lanes::Set1(Plane.Z), Z, Distance);
+                MinDistance  = lanes::Min(MinDistance, Distance);
+            }
+
+            *VisibleCount = AppendVisible(VisibleIndices, *VisibleCount, i, lanes::NonNegativeMask(MinDistance), lanes::cWidth);
+        }
+        return i;
+    }
+
+    template<typename lanes>
+    inline u32 FrustumCullAabbs(const frustum& Frustum, aabb_soa Boxes, u32 Begin, u32 Count, u32* VisibleIndices, u32* VisibleCount)
+    {
+        using reg = typename lanes::reg;
+
+        u32 i = Begin;
+        for (; i + lanes::cWidth <= Count; i += lanes::cWidth)
+        {
+            reg X  = lanes::Load(Boxes.CenterX + i);
+            reg Y  = lanes::Load(Boxes.CenterY + i);
+            reg Z  = lanes::Load(Boxes.CenterZ + i);
+            reg EX = lanes::Load(Boxes.ExtentX + i);
+            reg EY = lanes::Load(Boxes.ExtentY + i);
+            reg EZ = lanes::Load(Boxes.ExtentZ + i);
+
+            reg MinDistance = lanes::Set1(F32_MAX);
+            for (const f32x4& Plane : Frustum.Planes)
+            {
+                reg Radius   = lanes::Mul(lanes::Set1(fabsf(Plane.X)), EX);
+                Radius       = lanes::MulAdd(lanes::Set1(fabsf(Plane.Y)), EY, Radius);
+                Radius       = lanes::MulAdd(lanes::Set1(fabsf(Plane.Z)), EZ, Radius);
+
+                reg Distance = lanes::MulAdd(lanes::Set1(Plane.X), X, lanes::Add(lanes::Set1(Plane.W), Radius));
+                Distance     = lanes::MulAdd(lanes::Set1(Plane.Y), Y, Distance);
+                Distance     = lanes::MulAdd(lanes::Set1(Plane.Z), Z, Distance);
+                MinDistance  = lanes::Min(MinDistance, Distance);
+            }
+
+            *VisibleCount = AppendVisible(VisibleIndices, *VisibleCount, i, lanes::NonNegativeMask(MinDistance), lanes::cWidth);
+        }
+        return i;
+    }
+}
+
+inline u32 FrustumCullSpheres(const frustum& Frustum, sphere_soa Spheres, u32 Count, u32* VisibleIndices)
+{
+    u32 VisibleCount = 0;
+    u32 i            = 0;
+#if SIMD_AVX
+    i = math_internal::FrustumCullSpheres<math_internal::lanes_x8>(Frustum, Spheres, i, Count, VisibleIndices, &VisibleCount);
+#endif
+#if SIMD_SSE2
+    i = math_internal::FrustumCullSpheres<math_internal::lanes_x4>(Frustum, Spheres, i, Count, VisibleIndices, &VisibleCount);
+#endif
+    math_internal::FrustumCullSpheres<math_internal::lanes_x1>(Frustum, Spheres, i, Count, VisibleIndices, &VisibleCount);
+    return VisibleCount;
+}
+
+inline u32 FrustumCullAabbs(const frustum& Frustum, aabb_soa Boxes, u32 Count, u32* VisibleIndices)
+{
+    u32 VisibleCount = 0;
+    u32 i            = 0;
+#if SIMD_AVX
+    i = math_internal::FrustumCullAabbs<math_internal::lanes_x8>(Frustum, Boxes, i, Count, VisibleIndices, &VisibleCount);
+#endif
+#if SIMD_SSE2
+    i = math_internal::FrustumCullAabbs<math_internal::lanes_x4>(Frustum, Boxes, i, Count, VisibleIndices, &VisibleCount);
+#endif
+    math_internal::FrustumCullAabbs<math_internal::lanes_x1>(Frustum, Boxes, i, Count, VisibleIndices, &VisibleCount);
+    return VisibleCount;
+}
@@ -0,0 +1,566 @@
+//
+// Header-Only Fast Transcendental Approximations
+//
+// Cephes-style polynomial approximations for f32. The F32x4Fast* functions evaluate four lanes with
+// SSE2 (FMA when enabled). The scalar F32Fast* functions run the same code on one lane, so scalar and
+// SIMD callers get bit-identical results. With SIMD_FORCE_SCALAR they use a plain C version of the
+// same polynomials.
+//
+// f32  F32FastSin(f32 X)                    __m128 F32x4FastSin(__m128 X)
+// f32  F32FastCos(f32 X)                    __m128 F32x4FastCos(__m128 X)
+// void F32FastSinCos(f32 X, f32* Sin, f32* Cos)
+//                                           void   F32x4FastSinCos(__m128 X, __m128* Sin, __m128* Cos)
+// f32  F32FastAtan2(f32 Y, f32 X)           __m128 F32x4FastAtan2(__m128 Y, __m128 X)
+// f32  F32FastAcos(f32 X)                   __m128 F32x4FastAcos(__m128 X)
+// f32  F32FastExp(f32 X)                    __m128 F32x4FastExp(__m128 X)
+// f32  F32FastLog(f32 X)                    __m128 F32x4FastLog(__m128 X)
+// f32  F32FastRsqrt(f32 X)                  __m128 F32x4FastRsqrt(__m128 X)
+//
+// void F32FastSinCosArray(const f32* In, f32* Sin, f32* Cos, u64 Count)
+//
+// Angles are in radians. Maximum error against a correctly rounded result, measured over the given
+// domain on x64 (SSE2 and AVX2+FMA builds):
+//
+//   Function  Domain                     Max ULP   Notes
+//   --------  -------------------------  -------   -----
+//   Sin/Cos   |X| <= pi                      1.6
+//   Sin/Cos   |X| <= 8192                      -   absolute error < 1e-7, relative error grows near the roots
+//   Sin/Cos   |X| > 8192                       -   lanes fall back to sinf/cosf, Inf gives NaN
+//   Atan2     all finite                     3.2   Atan2(0, 0) = 0, Atan2(Inf, Inf) is NaN
+//   Acos      [-1, 1]                        1.3   NaN outside [-1, 1]
+//   Exp       [-87.3, 88.7]                  1.3   overflows to +Inf, underflows through denormals to 0
+//   Log       (0, +Inf]                      0.9   Log(0) = -Inf, negative input gives NaN
+//   Rsqrt     [FLT_MIN, FLT_MAX]             4.4   hardware estimate + one Newton-Raphson step
+//                                                  (1.5 with SIMD_FORCE_SCALAR, which uses 1 / sqrtf)
+//
+// NaN inputs return NaN.
+//
+#pragma once
+
+#include <types.h>
+#include <util/simd.h>
+
+#include <cmath>
+#include <string.h>
+
+namespace fast_math_internal
+{
+    constexpr f32 cFourOverPi    = 1.27323954473516f;
+    constexpr f32 cPi            = 3.14159265358979f;
+    constexpr f32 cHalfPi        = 1.57079632679490f;
+    constexpr f32 cQuarterPi     = 0.78539816339745f;
+    constexpr f32 cTanEighthPi   = 0.41421356237310f;
+
+    // pi/4 split in three parts so X - J * pi/4 stays exact for |X| <= cReduceMax
+    constexpr f32 cReduce1       = 0.78515625f;
+    constexpr f32 cReduce2       = 2.4187564849853515625e-4f;
+    constexpr f32 cReduce3       = 3.77489497744594108e-8f;
+    constexpr f32 cReduceMax     = 8192.0f;
+
+    constexpr f32 cSin0          = -1.9515295891e-4f;
+    constexpr f32 cSin1          =  8.3321608736e-3f;
+    constexpr f32 cSin2          = -1.6666654611e-1f;
+    constexpr f32 cCos0          =  2.443315711809948e-5f;
+    constexpr f32 cCos1          = -1.388731625493765e-3f;
+    constexpr f32 cCos2          =  4.166664568298827e-2f;
+
+    constexpr f32 cAtan0         =  8.05374449538e-2f;
+    constexpr f32 cAtan1         = -1.38776856032e-1f;
+    constexpr f32 cAtan2         =  1.99777106478e-1f;
+    constexpr f32 cAtan3         = -3.33329491539e-1f;
+
+    constexpr f32 cAsin0         =  4.2163199048e-2f;
+    constexpr f32 cAsin1         =  2.4181311049e-2f;
+    constexpr f32 cAsin2         =  4.5470025998e-2f;
+    constexpr f32 cAsin3         =  7.4953002686e-2f;
+    constexpr f32 cAsin4         =  1.6666752422e-1f;
+
+    // ln(2) split in two parts, shared by Exp and Log
+    constexpr f32 cLn2High       =  0.693359375f;
+    constexpr f32 cLn2Low        = -2.12194440e-4f;
+    constexpr f32 cLog2e         =  1.44269504088896341f;
+    constexpr f32 cExpMin        = -104.0f; // below 2^-150, rounds to 0
+    constexpr f32 cExpMax        =  89.0f;  // above 2^128, rounds to +Inf
+
+    constexpr f32 cExp0          =  1.9875691500e-4f;
+    constexpr f32 cExp1          =  1.3981999507e-3f;
+    constexpr f32 cExp2          =  8.3334519073e-3f;
+    constexpr f32 cExp3          =  4.1665795894e-2f;
+    constexpr f32 cExp4          =  1.6666665459e-1f;
+    constexpr f32 cExp5          =  5.0000001201e-1f;
+
+    constexpr f32 cSqrtHalf      =  0.707106781186547524f;
+    constexpr f32 cLog0          =  7.0376836292e-2f;
+    constexpr f32 cLog1          = -1.1514610310e-1f;
+    constexpr f32 cLog2          =  1.1676998740e-1f;
+    constexpr f32 cLog3          = -1.2420140846e-1f;
+    constexpr f32 cLog4          =  1.4249322787e-1f;
+    constexpr f32 cLog5          = -1.6668057665e-1f;
+    constexpr f32 cLog6          =  2.0000714765e-1f;
+    constexpr f32 cLog7          = -2.4999993993e-1f;
+    constexpr f32 cLog8          =  3.3333331174e-1f;
+
+#if SIMD_SSE2
+    inline __m128 MulAdd(__m128 A, __m128 B, __m128 C)
+    { // A * B + C
+#if SIMD_FMA
+        return _mm_fmadd_ps(A, B, C);
+#else
+        return _mm_add_ps(_mm_mul_ps(A, B), C);
+#endif
+    }
+
+    inline __m128 Select(__m128 Mask, __m128 IfTrue, __m128 IfFalse)
+    {
+        return _mm_or_ps(_mm_and_ps(Mask, IfTrue), _mm_andnot_ps(Mask, IfFalse));
+    }
+
+    // Replaces the lanes set in LaneMask with libm's result, which does the full argument reduction.
+    inline void SinCosLarge(__m128 X, s32 LaneMask, __m128* Sin, __m128* Cos)
+    {
+        alignas(16) f32 In[4], SinOut[4], CosOut[4];
+        _mm_store_ps(In, X);
+        _mm_store_ps(SinOut, *Sin);
+        _mm_store_ps(CosOut, *Cos);
+
+        for (u32 Lane = 0; Lane < 4; ++Lane)
+        {
+            if (LaneMask & (1 << Lane))
+            {
+                SinOut[Lane] = sinf(In[Lane]);
+                CosOut[Lane] = cosf(In[Lane]);
+            }
+        }
+
+        *Sin = _mm_load_ps(SinOut);
+        *Cos = _mm_load_ps(CosOut);
+    }
+
+    inline __m128 SignBit() { return _mm_castsi128_ps(_mm_set1_epi32(s32(0x80000000u))); }
+
+    // Reduces |X| to R in [-pi/4, pi/4] with |X| = J * pi/4 + R, J even. Only valid for |X| <= cReduceMax.
+    inline __m128 ReduceQuarterPi(__m128 AbsX, __m128i* J)
+    {
+        __m128i Octant = _mm_cvttps_epi32(_mm_mul_ps(AbsX, _mm_set1_ps(cFourOverPi)));
+        Octant         = _mm_and_si128(_mm_add_epi32(Octant, _mm_set1_epi32(1)), _mm_set1_epi32(~1));
+        *J             = Octant;
+
+        __m128 Y = _mm_cvtepi32_ps(Octant);
+        __m128 R = MulAdd(Y, _mm_set1_ps(-cReduce1), AbsX);
+        R        = MulAdd(Y, _mm_set1_ps(-cReduce2), R);
+        R        = MulAdd(Y, _mm_set1_ps(-cReduce3), R);
+        return R;
+    }
+
+    inline __m128 SinPoly(__m128 R, __m128 R2)
+    {
+        __m128 P = MulAdd(_mm_set1_ps(cSin0), R2, _mm_set1_ps(cSin1));
+        P        = MulAdd(P, R2, _mm_set1_ps(cSin2));
+        return MulAdd(_mm_mul_ps(P, R2), R, R);
+    }
+
+    inline __m128 CosPoly(__m128 R2)
+    {
+        __m128 P = MulAdd(_mm_set1_ps(cCos0), R2, _mm_set1_ps(cCos1));
+        P        = MulAdd(P, R2, _mm_set1_ps(cCos2));
+        P        = _mm_mul_ps(_mm_mul_ps(P, R2), R2);
+        return _mm_add_ps(MulAdd(R2, _mm_set1_ps(-0.5f), _mm_set1_ps(1.0f)), P);
+    }
+
+    // asin(S) for S in [0, 0.5] where Z = S * S
+    inline __m128 AsinPoly(__m128 S, __m128 Z)
+    {
+        __m128 P = MulAdd(_mm_set1_ps(cAsin0), Z, _mm_set1_ps(cAsin1));
+        P        = MulAdd(P, Z, _mm_set1_ps(cAsin2));
+        P        = MulAdd(P, Z, _mm_set1_ps(cAsin3));
+        P        = MulAdd(P, Z, _mm_set1_ps(cAsin4));
+        return MulAdd(_mm_mul_ps(P, Z), S, S);
+    }
+
+    // 2^N for integer N in [-126, 127]
+    inline __m128 Pow2(__m128i N)
+    {
+        return _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(N, _mm_set1_epi32(127)), 23));
+    }
+#else
+    inline u32 F32Bits(f32 Value) { u32 Bits; memcpy(&Bits, &Value, sizeof(Bits)); return Bits; }
+    inline f32 F32FromBits(u32 Bits) { f32 Value; memcpy(&Value, &Bits, sizeof(Value)); return Value; }
+
+    // Only valid for AbsX <= cReduceMax
+    inline f32 ReduceQuarterPi(f32 AbsX, s32* J)
+    {
+        s32 Octant = s32(AbsX * cFourOverPi);
+        Octant     = (Octant + 1) & ~1;
+        *J         = Octant;
+
+        f32 Y = f32(Octant);
+        return ((AbsX - Y * cReduce1) - Y * cReduce2) - Y * cReduce3;
+    }
+
+    inline f32 SinPoly(f32 R, f32 R2) { return ((cSin0 * R2 + cSin1) * R2 + cSin2) * R2 * R + R; }
+    inline f32 CosPoly(f32 R2)        { return (1.0f - 0.5f * R2) + ((cCos0 * R2 + cCos1) * R2 + cCos2) * R2 * R2; }
+
+    inline f32 AsinPoly(f32 S, f32 Z)
+    {
+        return ((((cAsin0 * Z + cAsin1) * Z + cAsin2) * Z + cAsin3) * Z + cAsin4) * Z * S + S;
+    }
+#endif
+}
+
+#if SIMD_SSE2
+inline void F32x4FastSinCos(__m128 X, __m128* Sin, __m128* Cos)
+{
+    using namespace fast_math_internal;
+
+    __m128  SignX = _mm_and_ps(X, SignBit());
+    __m128  AbsX  = _mm_xor_ps(X, SignX);
+    __m128i J;
+    __m128  R  = ReduceQuarterPi(AbsX, &J);
+    __m128  R2 = _mm_mul_ps(R, R);
+
+    __m128 SinR = SinPoly(R, R2);
+    __m128 CosR = CosPoly(R2);
+
+    // With |X| = k * pi/2 + R (k = J / 2), odd quadrants swap sin and cos. Sin is negative in
+    // quadrants 2 and 3, cos in quadrants 1 and 2.
+    __m128 Swap    = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(J, _mm_set1_epi32(2)), _mm_set1_epi32(2)));
+    __m128 SinSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(J, _mm_set1_epi32(4)), 29));
+    __m128 CosSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(J, _mm_set1_epi32(2)), _mm_set1_epi32(4)), 29));
+
+    *Sin = _mm_xor_ps(Select(Swap, CosR, SinR), _mm_xor_ps(SinSign, SignX));
+    *Cos = _mm_xor_ps(Select(Swap, SinR, CosR), CosSign);
+
+    // Past cReduceMax the octant no longer fits the reduction (and overflows s32 past 2^31), so those
+    // lanes take the slow path. Angles that grow without bound should be wrapped by the caller instead.
+    s32 Large = _mm_movemask_ps(_mm_cmpgt_ps(AbsX, _mm_set1_ps(cReduceMax)));
+    if (Large)
+    {
+        SinCosLarge(X, Large, Sin, Cos);
+    }
+}
+
+inline __m128 F32x4FastSin(__m128 X)
+{
+    __m128 Sin, Cos;
+    F32x4FastSinCos(X, &Sin, &Cos);
+    return Sin;
+}
+
+inline __m128 F32x4FastCos(__m128 X)
+{
+    __m128 Sin, Cos;
+    F32x4FastSinCos(X, &Sin, &Cos);
+    return Cos;
+}
+
+inline __m128 F32x4FastAtan2(__m128 Y, __m128 X)
+{
+    using namespace fast_math_internal;
+
+    __m128 AbsX = _mm_andnot_ps(SignBit(), X);
+    __m128 AbsY = _mm_andnot_ps(SignBit(), Y);
+
+    // atan of the ratio in [0, 1], so the reduction below only needs one step
+    __m128 Max   = _mm_max_ps(AbsX, AbsY);
+    __m128 Min   = _mm_min_ps(AbsX, AbsY);
+    __m128 Ratio = _mm_and_ps(_mm_div_ps(Min, Max), _mm_cmpneq_ps(Max, _mm_setzero_ps()));
+
+    // Above tan(pi/8), use atan(A) = pi/4 + atan((A - 1) / (A + 1))
+    __m128 One     = _mm_set1_ps(1.0f);
+    __m128 Reduce  = _mm_cmpgt_ps(Ratio, _mm_set1_ps(cTanEighthPi));
+    __m128 A       = Select(Reduce, _mm_div_ps(_mm_sub_ps(Ratio, One), _mm_add_ps(Ratio, One)), Ratio);
+    __m128 Offset  = _mm_and_ps(Reduce, _mm_set1_ps(cQuarterPi));
+
+    __m128 Z = _mm_mul_ps(A, A);
+    __m128 P = MulAdd(_mm_set1_ps(cAtan0), Z, _mm_set1_ps(cAtan1));
+    P        = MulAdd(P, Z, _mm_set1_ps(cAtan2));
+    P        = MulAdd(P, Z, _mm_set1_ps(cAtan3));
+    __m128 Result = _mm_add_ps(MulAdd(_mm_mul_ps(P, Z), A, A), Offset);
+
+    // Undo the octant folding
+    Result = Select(_mm_cmpgt_ps(AbsY, AbsX), _mm_sub_ps(_mm_set1_ps(cHalfPi), Result), Result);
+    Result = Select(_mm_castsi128_ps(_mm_srai_epi32(_mm_castps_si128(X), 31)), _mm_sub_ps(_mm_set1_ps(cPi), Result), Result);
+    return _mm_or_ps(Result, _mm_and_ps(Y, SignBit()));
+}
+
+inline __m128 F32x4FastAcos(__m128 X)
+{
+    using namespace fast_math_internal;
+
+    __m128 SignX = _mm_and_ps(X, SignBit());
+    __m128 AbsX  = _mm_xor_ps(X, SignX);
+
+    // Above 0.5, use acos(|X|) = 2 * asin(sqrt((1 - |X|) / 2)) to keep precision near |X| = 1
+    __m128 Large = _mm_cmpgt_ps(AbsX, _mm_set1_ps(0.5f));
+    __m128 Z     = Select(Large, _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(1.0f), AbsX), _mm_set1_ps(0.5f)), _mm_mul_ps(X, X));
+    __m128 S     = Select(Large, _mm_sqrt_ps(Z), AbsX);
+    __m128 Asin  = AsinPoly(S, Z);
+
+    __m128 LargeResult = _mm_add_ps(Asin, Asin);
+    LargeResult        = Select(_mm_castsi128_ps(_mm_srai_epi32(_mm_castps_si128(X), 31)), _mm_sub_ps(_mm_set1_ps(cPi), LargeResult), LargeResult);
+    __m128 SmallResult = _mm_sub_ps(_mm_set1_ps(cHalfPi), _mm_xor_ps(Asin, SignX));
+    return Select(Large, LargeResult, SmallResult);
+}
+
+inline __m128 F32x4FastExp(__m128 X)
+{
+    using namespace fast_math_internal;
+
+    // max/min return the second operand when either is NaN, which keeps NaN flowing through
+    X = _mm_min_ps(_mm_set1_ps(cExpMax), _mm_max_ps(_mm_set1_ps(cExpMin), X));
+
+    // X = N * ln(2) + R, |R| <= ln(2) / 2
+    __m128i N  = _mm_cvtps_epi32(_mm_mul_ps(X, _mm_set1_ps(cLog2e)));
+    __m128  FN = _mm_cvtepi32_ps(N);
+    __m128  R  = MulAdd(FN, _mm_set1_ps(-cLn2High), X);
+    R          = MulAdd(FN, _mm_set1_ps(-cLn2Low), R);
+
+    __m128 P = MulAdd(_mm_set1_ps(cExp0), R, _mm_set1_ps(cExp1));
+    P        = MulAdd(P, R, _mm_set1_ps(cExp2));
+    P        = MulAdd(P, R, _mm_set1_ps(cExp3));
+    P        = MulAdd(P, R, _mm_set1_ps(cExp4));
+    P        = MulAdd(P, R, _mm_set1_ps(cExp5));
+    P        = MulAdd(P, _mm_mul_ps(R, R), _mm_add_ps(R, _mm_set1_ps(1.0f)));
+
+    // N is in [-150, 128], so scale in two halves to reach the denormal and overflow ends
+    __m128i NHalf = _mm_srai_epi32(N, 1);
+    return _mm_mul_ps(_mm_mul_ps(P, Pow2(NHalf)), Pow2(_mm_sub_epi32(N, NHalf)));
+}
+
+inline __m128 F32x4FastLog(__m128 X)
+{
+    using namespace fast_math_internal;
+
+    __m128 Zero = _mm_setzero_ps();
+    __m128 One  = _mm_set1_ps(1.0f);
+
+    // Denormals: scale into the normal range and take it back out of the exponent
+    __m128  Denormal = _mm_cmplt_ps(X, _mm_set1_ps(1.17549435e-38f));
+    __m128  Scaled   = Select(Denormal, _mm_mul_ps(X, _mm_set1_ps(8388608.0f)), X);
+    __m128i Bits     = _mm_castps_si128(Scaled);
+
+    // X = M * 2^E with M in [sqrt(1/2), sqrt(2))
+    __m128i E = _mm_sub_epi32(_mm_srli_epi32(Bits, 23), _mm_set1_epi32(126));
+    E         = _mm_sub_epi32(E, _mm_and_si128(_mm_castps_si128(Denormal), _mm_set1_epi32(23)));
+    __m128  M = _mm_or_ps(_mm_and_ps(_mm_castsi128_ps(Bits), _mm_castsi128_ps(_mm_set1_epi32(0x007FFFFF))), _mm_set1_ps(0.5f));
+
+    __m128 Small = _mm_cmplt_ps(M, _mm_set1_ps(cSqrtHalf));
+    E            = _mm_add_epi32(E, _mm_castps_si128(Small)); // mask is -1
+    M            = _mm_add_ps(_mm_sub_ps(M, One), _mm_and_ps(Small, M));
+    __m128 FE    = _mm_cvtepi32_ps(E);
+
+    __m128 Z = _mm_mul_ps(M, M);
+    __m128 P = MulAdd(_mm_set1_ps(cLog0), M, _mm_set1_ps(cLog1));
+    P        = MulAdd(P, M, _mm_set1_ps(cLog2));
+    P        = MulAdd(P, M, _mm_set1_ps(cLog3));
+    P        = MulAdd(P, M, _mm_set1_ps(cLog4));
+    P        = MulAdd(P, M, _mm_set1_ps(cLog5));
+    P        = MulAdd(P, M, _mm_set1_ps(cLog6));
+    P        = MulAdd(P, M, _mm_set1_ps(cLog7));
+    P        = MulAdd(P, M, _mm_set1_ps(cLog8));
+    P        = _mm_mul_ps(_mm_mul_ps(P, Z), M);
+
+    P = MulAdd(FE, _mm_set1_ps(cLn2Low), P);
+    P = MulAdd(Z, _mm_set1_ps(-0.5f), P);
+    __m128 Result = MulAdd(FE, _mm_set1_ps(cLn2High), _mm_add_ps(M, P));
+
+    // Special cases: +Inf, 0, negative and NaN
+    __m128 Infinity = _mm_castsi128_ps(_mm_set1_epi32(0x7F800000));
+    Result = Select(_mm_cmpeq_ps(X, Infinity), Infinity, Result);
+    Result = Select(_mm_cmpeq_ps(X, Zero), _mm_or_ps(Infinity, SignBit()), Result);
+    Result = _mm_or_ps(Result, _mm_cmpnge_ps(X, Zero)); // all bits set is a NaN
+    return Result;
+}
+
+inline __m128 F32x4FastRsqrt(__m128 X)
+{
+    // Y' = Y * (1.5 - 0.5 * X * Y * Y). The step turns 0 and Inf into NaN, keep the estimate there.
+    __m128 Estimate = _mm_rsqrt_ps(X);
+    __m128 HalfXY   = _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), X), Estimate);
+    __m128 Result   = _mm_mul_ps(Estimate, fast_math_internal::MulAdd(_mm_mul_ps(HalfXY, Estimate), _mm_set1_ps(-1.0f), _mm_set1_ps(1.5f)));
+    __m128 Valid    = _mm_cmpord_ps(Result, Result);
+    return fast_math_internal::Select(_mm_or_ps(Valid, _mm_cmpunord_ps(X, X)), Result, Estimate);
+}
+#endif
+
+inline void F32FastSinCos(f32 X, f32* Sin, f32* Cos)
+{
+#if SIMD_SSE2
+    __m128 SinSimd, CosSimd;
+    F32x4FastSinCos(_mm_set_ss(X), &SinSimd, &CosSimd);
+    *Sin = _mm_cvtss_f32(SinSimd);
+    *Cos = _mm_cvtss_f32(CosSimd);
+#else
+    using namespace fast_math_internal;
+
+    if (fabsf(X) > cReduceMax)
+    {
+        *Sin = sinf(X);
+        *Cos = cosf(X);
+        return;
+    }
+
+    s32 J;
+    f32 R    = ReduceQuarterPi(fabsf(X), &J);
+    f32 R2   = R * R;
+    f32 SinR = SinPoly(R, R2);
+    f32 CosR = CosPoly(R2);
+
+    bool Swap = (J & 2) != 0;
+    f32  S    = Swap ? CosR : SinR;
+    f32  C    = Swap ? SinR : CosR;
+
+    *Sin = ((J & 4) != 0) != (X < 0.0f) ? -S : S;
+    *Cos = (((J + 2) & 4) != 0) ? -C : C;
+#endif
+}
+
+inline f32 F32FastSin(f32 X)
+{
+    f32 Sin, Cos;
+    F32FastSinCos(X, &Sin, &Cos);
+    return Sin;
+}
+
+inline f32 F32FastCos(f32 X)
+{
+    f32 Sin, Cos;
+    F32FastSinCos(X, &Sin, &Cos);
+    return Cos;
+}
+
+inline f32 F32FastAtan2(f32 Y, f32 X)
+{
+#if SIMD_SSE2
+    return _mm_cvtss_f32(F32x4FastAtan2(_mm_set_ss(Y), _mm_set_ss(X)));
+#else
+    using namespace fast_math_internal;
+
+    f32 AbsX  = fabsf(X);
+    f32 AbsY  = fabsf(Y);
+    f32 Max   = fmaxf(AbsX, AbsY);
+    f32 Ratio = (Max != 0.0f) ? fminf(AbsX, AbsY) / Max : 0.0f;
+
+    bool Reduce = Ratio > cTanEighthPi;
+    f32  A      = Reduce ? (Ratio - 1.0f) / (Ratio + 1.0f) : Ratio;
+    f32  Z      = A * A;
+
+    f32 Result = ((cAtan0 * Z + cAtan1) * Z + cAtan2) * Z + cAtan3;
+    Result     = Result * Z * A + A + (Reduce ? cQuarterPi : 0.0f);
+
+    if (AbsY > AbsX)     Result = cHalfPi - Result;
+    if (std::signbit(X)) Result = cPi - Result;
+    return copysignf(Result, Y);
+#endif
+}
+
+inline f32 F32FastAcos(f32 X)
+{
+#if SIMD_SSE2
+    return _mm_cvtss_f32(F32x4FastAcos(_mm_set_ss(X)));
+#else
+    using namespace fast_math_internal;
+
+    f32 AbsX = fabsf(X);
+    if (AbsX > 0.5f)
+    {
+        f32 Z      = (1.0f - AbsX) * 0.5f;
+        f32 Result = 2.0f * AsinPoly(sqrtf(Z), Z);
+        return (X < 0.0f) ? cPi - Result : Result;
+    }
+
+    f32 Asin = AsinPoly(AbsX, X * X);
+    return cHalfPi - ((X < 0.0f) ? -Asin : Asin);
+#endif
+}
+
+inline f32 F32FastExp(f32 X)
+{
+#if SIMD_SSE2
+    return _mm_cvtss_f32(F32x4FastExp(_mm_set_ss(X)));
+#else
+    using namespace fast_math_internal;
+
+    if (X != X) return X;
+    X = fminf(fmaxf(X, cExpMin), cExpMax);
+
+    s32 N  = s32(lrintf(X * cLog2e));
+    f32 FN = f32(N);
+    f32 R  = (X - FN * cLn2High) - FN * cLn2Low;
+
+    f32 P = ((((cExp0 * R + cExp1) * R + cExp2) * R + cExp3) * R + cExp4) * R + cExp5;
+    P     = P * R * R + R + 1.0f;
+
+    s32 NHalf = N >> 1;
+    return P * F32FromBits(u32(NHalf + 127) << 23) * F32FromBits(u32(N - NHalf + 127) << 23);
+#endif
+}
+
+inline f32 F32FastLog(f32 X)
+{
+#if SIMD_SSE2
+    return _mm_cvtss_f32(F32x4FastLog(_mm_set_ss(X)));
+#else
+    using namespace fast_math_internal;
+
+    if (!(X >= 0.0f))  return NAN;
+    if (X == 0.0f)     return -INFINITY;
+    if (X == INFINITY) return INFINITY;
+
+    s32 E = 0;
+    if (X < 1.17549435e-38f)
+    {
+        X *= 8388608.0f;
+        E -= 23;
+    }
+
+    u32 Bits = F32Bits(X);
+    E       += s32(Bits >> 23) - 126;
+    f32 M    = F32FromBits((Bits & 0x007FFFFF) | 0x3F000000);
+
+    if (M < cSqrtHalf)
+    {
+        E -= 1;
+        M  = M + M - 1.0f;
+    }
+    else
+    {
+        M  = M - 1.0f;
+    }
+
+    f32 FE = f32(E);
+    f32 Z  = M * M;
+    f32 P  = ((((((((cLog0 * M + cLog1) * M + cLog2) * M + cLog3) * M + cLog4) * M + cLog5) * M + cLog6) * M + cLog7) * M + cLog8);
+    P      = P * Z * M;
+    P     += FE * cLn2Low;
+    P     -= 0.5f * Z;
+    return (M + P) + FE * cLn2High;
+#endif
+}
+
+inline f32 F32FastRsqrt(f32 X)
+{
+#if SIMD_SSE2
+    return _mm_cvtss_f32(F32x4FastRsqrt(_mm_set_ss(X)));
+#else
+    return 1.0f / sqrtf(X);
+#endif
+}
+
+inline void F32FastSinCosArray(const f32* In, f32* Sin, f32* Cos, u64 Count)
+{
+    u64 i = 0;
+#if SIMD_SSE2
+    for (; i + 4 <= Count; i += 4)
+    {
+        __m128 SinSimd, CosSimd;
+        F32x4FastSinCos(_mm_loadu_ps(In + i), &SinSimd, &CosSimd);
+        _mm_storeu_ps(Sin + i, SinSimd);
+        _mm_storeu_ps(Cos + i, CosSimd);
+    }
+#endif
+    for (; i < Count; ++i)
+    {
+        F32FastSinCos(In[i], &Sin[i], &Cos[i]);
+    }
+}
@@ -18,6 +18,10 @@
 // Matrices do not implement the math operator overloads since, I want it to be explicit
 // if the operation is a Left or Right Hand.
 //
+// f32x4 and f32x44 are 16 byte aligned. When SSE2 is available (see util/simd.h) the full-width f32x4
+// operators and the f32x44 functions below use SSE, with FMA and AVX used when the build enables them.
+// Define SIMD_FORCE_SCALAR to use the scalar reference paths.
+//
 // f32x44 F32x44MulRH(f32x44 Left, f32x44 Right);
 // f32x44 InvertMatrix(f32x44 Matrix);
 // f32x44 ScaleMatrix(f32 ScaleX, f32 ScaleY, f32 ScaleZ);
@@ -31,10 +35,35 @@
 // f32x44 RotateZMatrix(f32 Theta);
 // f32x44 RotateMatrix(f32 Theta, f32x3 RotationAxis);
 //
+// Batched versions of the above for many objects are listed under "Batch Functions".
+//
+// The rotation, projection and normalize functions use the approximations in fast_math.h
+// (sin/cos within 1.6 ULP, rsqrt within 4.4 ULP) instead of libm.
+//
 //------------------------------------------
 // Quaternion Math
 //
-// f32x44 QuaternionToRotationMatrix(quaternion Quaternion)
+// Angles are in degrees, like the matrix functions. Multiplication composes right to left: (A * B)
+// rotates by B, then by A. The SIMD paths keep the quaternion in one register.
+//
+// quaternion QuaternionFromAxisAngle(f32x3 Axis, f32 Theta)
+// quaternion EulerToQuaternion(f32 Roll, f32 Pitch, f32 Yaw)
+// quaternion QuaternionMul(quaternion Left, quaternion Right)   (also operator*)
+// quaternion QuaternionConjugate(quaternion Quaternion)
+// quaternion QuaternionInverse(quaternion Quaternion)
+// f32        Dot(quaternion Left, quaternion Right)
+// quaternion QuaternionNLerp(quaternion From, quaternion To, f32 Factor)
+// quaternion QuaternionSlerp(quaternion From, quaternion To, f32 Factor)
+// f32x3      QuaternionRotateVector(quaternion Quaternion, f32x3 Vector)
+// f32x44     QuaternionToRotationMatrix(quaternion Quaternion)
+//
+// dual_quaternion DualQuaternionFromRotationTranslation(quaternion Rotation, f32x3 Translation)
+// dual_quaternion DualQuaternionMul(dual_quaternion Left, dual_quaternion Right)   (also operator*)
+// dual_quaternion DualQuaternionNorm(dual_quaternion Value)
+// dual_quaternion DualQuaternionBlend(const dual_quaternion* Values, const f32* Weights, u32 Count)
+// f32x3           DualQuaternionGetTranslation(dual_quaternion Value)
+// f32x3           DualQuaternionTransformPoint(dual_quaternion Value, f32x3 Point)
+// f32x44          DualQuaternionToMatrix(dual_quaternion Value)
 //
 //------------------------------------------
 // More Misc. / Geometric Functions
@@ -52,6 +81,9 @@
 // f32x3 F32x3RandomInHemisphere(f32x3 Normal)
 // f32x3 F32x3RandomUnitVector()
 // f32x3 F32x3RandomInUnitDisc()
+// f32x3 F32x3RandomFillClamped/F32x3RandomFillUnitVector/F32x3RandomFillInUnitSphere(xoshiro128x4& Rng, f32x3* Out, u64 Count)
+//
+// The random functions also take an explicit generator as their first argument, see random.h.
 // f32x3 ReflectVector(f32x3 Vector, f32x3 Normal)
 // f32x3 RefractVector(f32x3 IncidentVector, f32x3 Normal, f32 IndicesOfRefraction)
 //
@@ -67,6 +99,11 @@
 #include <limits>
 #include <numbers> // requires c++ 20
 
+#include <util/simd.h>
+
+#include "random.h"
+#include "fast_math.h"
+
 constexpr f32 F32_EPSILON = std::numeric_limits<float>::epsilon() * 0.5f;
 constexpr f32 F32_PI      = std::numbers::pi_v<float>;
 
@@ -126,7 +163,7 @@ struct f32x3
     inline f32x3& operator/=(f32   Other);
 };
 
-struct f32x4
+struct alignas(16) f32x4
 {
     union
     {
@@ -135,6 +172,9 @@ struct f32x4
         struct { f32x3 XYZ;  f32   Pad0; };
         struct { f32   Pad1; f32x3 YZW;  };
         f32 Ptr[4];
+#if SIMD_SSE2
+        __m128 Simd;
+#endif
     };
 
     inline f32    Length();
@@ -172,27 +212,37 @@ struct f32x4
     inline f32x4& operator/=(f32 Other);
 };
 
-struct quaternion
+// Rotation quaternion: XYZ is the vector part, W the scalar part. Default constructs to the identity.
+// Use QuaternionFromAxisAngle to build one from an axis and angle.
+struct alignas(16) quaternion
 {
     union
     {
-        struct { f32 X, Y, Z, Theta; };
+        struct { f32 X, Y, Z, W; };
         struct { f32x3 XYZ; f32 Pad0; };
-        f32x4 Ptr;
+        f32x4 Vector;
     };
 
-    quaternion(f32 AxisX, f32 AxisY, f32 AxisZ, f32 Angle)
-        : X(AxisX), Y(AxisY), Z(AxisZ), Theta(Angle) {}
+    quaternion(f32 InX, f32 InY, f32 InZ, f32 InW)
+        : X(InX), Y(InY), Z(InZ), W(InW) {}
 
-    quaternion(f32x3 Axis, f32 Angle) : quaternion(Axis.X, Axis.Y, Axis.Z, Angle)                {}
-    quaternion(f32 Array[4])          : quaternion(Array[0], Array[1], Array[2], Array[3]) {}
+    quaternion(f32 Array[4]) : quaternion(Array[0], Array[1], Array[2], Array[3]) {}
+    quaternion(f32x4 Value)  : Vector(Value) {}
 
-    quaternion() : quaternion(0.0f, 0.0f, 0.0f, 0.0f) {}
+    quaternion() : quaternion(0.0f, 0.0f, 0.0f, 1.0f) {}
 
     inline quaternion& Norm();
 };
 
-struct f32x44
+// Rigid transform (rotation then translation) as a dual quaternion: Real holds the rotation,
+// Dual holds 0.5 * Translation * Real.
+struct dual_quaternion
+{
+    quaternion Real = quaternion(0.0f, 0.0f, 0.0f, 1.0f);
+    quaternion Dual = quaternion(0.0f, 0.0f, 0.0f, 0.0f);
+};
+
+struct alignas(16) f32x44
 {
     union
     {
@@ -680,14 +730,16 @@ inline f32x3 operator/(f32x3 Left, f32 Right)
 inline f32 f32x3::Length()   { return sqrt(X * X + Y * Y + Z * Z); }
 inline f32 f32x3::LengthSq() { return X * X + Y * Y + Z * Z;          }
 
+// Vectors shorter than ~1e-19 (squared length below FLT_MIN) are left unchanged.
 inline f32x3& f32x3::Norm()
 {
-    f32 Len = Length();
-    if (!F32IsZero(Len))
+    f32 LenSq = LengthSq();
+    if (LenSq >= std::numeric_limits<f32>::min())
     {
-        X /= Len;
-        Y /= Len;
-        Z /= Len;
+        f32 InvLen = F32FastRsqrt(LenSq);
+        X *= InvLen;
+        Y *= InvLen;
+        Z *= InvLen;
     }
     return *this;
 }
@@ -713,6 +765,57 @@ inline f32x3 Cross(f32x3 Left, f32x3 Right)
     return Result;
 }
 
+//
+// SIMD Helpers
+//
+
+#if SIMD_SSE2
+// Broadcast a single lane to all four lanes
+#define F32x4Splat(Vector, Lane) _mm_shuffle_ps((Vector), (Vector), _MM_SHUFFLE(Lane, Lane, Lane, Lane))
+
+inline __m128 F32x4MulAdd(__m128 A, __m128 B, __m128 C)
+{ // A * B + C
+#if SIMD_FMA
+    return _mm_fmadd_ps(A, B, C);
+#else
+    return _mm_add_ps(_mm_mul_ps(A, B), C);
+#endif
+}
+
+// Sum of all four lanes, broadcast to every lane
+inline __m128 F32x4HorizontalSum(__m128 Vector)
+{
+    __m128 Sum = _mm_add_ps(Vector, _mm_shuffle_ps(Vector, Vector, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_add_ps(Sum, _mm_shuffle_ps(Sum, Sum, _MM_SHUFFLE(1, 0, 3, 2)));
+}
+
+// Lanes with a zero divisor are 0, same as the scalar divide operators
+inline __m128 F32x4SafeDiv(__m128 Numerator, __m128 Denominator)
+{
+    __m128 NonZero = _mm_cmpneq_ps(Denominator, _mm_setzero_ps());
+    return _mm_and_ps(_mm_div_ps(Numerator, Denominator), NonZero);
+}
+
+// Cross product of the XYZ lanes, the W lane of the result is 0
+inline __m128 F32x4Cross3(__m128 Left, __m128 Right)
+{
+    __m128 LeftYZX  = _mm_shuffle_ps(Left, Left, _MM_SHUFFLE(3, 0, 2, 1));
+    __m128 RightYZX = _mm_shuffle_ps(Right, Right, _MM_SHUFFLE(3, 0, 2, 1));
+    __m128 Result   = _mm_sub_ps(_mm_mul_ps(Left, RightYZX), _mm_mul_ps(LeftYZX, Right));
+    return _mm_shuffle_ps(Result, Result, _MM_SHUFFLE(3, 0, 2, 1));
+}
+
+// Left * Column for a column-major matrix: the columns of Left scaled by each component of Column
+inline __m128 F32x44MulColumn(const f32x44& Left, __m128 Column)
+{
+    __m128 Result = _mm_mul_ps(Left.C0.Simd, F32x4Splat(Column, 0));
+    Result        = F32x4MulAdd(Left.C1.Simd, F32x4Splat(Column, 1), Result);
+    Result        = F32x4MulAdd(Left.C2.Simd, F32x4Splat(Column, 2), Result);
+    Result        = F32x4MulAdd(Left.C3.Simd, F32x4Splat(Column, 3), Result);
+    return Result;
+}
+#endif
+
 //
 // Boilerplate Math Operator Overloads: f32x4
 //
@@ -720,10 +823,14 @@ inline f32x3 Cross(f32x3 Left, f32x3 Right)
 // Per component add-equals
 inline f32x4& f32x4::operator+=(f32x4 Other)
 {
+#if SIMD_SSE2
+    Simd = _mm_add_ps(Simd, Other.Simd);
+#else
     X += Other.X;
     Y += Other.Y;
     Z += Other.Z;
     W += Other.W;
+#endif
     return *this;
 }
 
@@ -745,10 +852,14 @@ inline f32x4& f32x4::operator+=(f32x2 Other)
 // Per Component Subtract-equals
 inline f32x4& f32x4::operator-=(f32x4 Other)
 {
+#if SIMD_SSE2
+    Simd = _mm_sub_ps(Simd, Other.Simd);
+#else
     X -= Other.X;
     Y -= Other.Y;
     Z -= Other.Z;
     W -= Other.W;
+#endif
     return *this;
 }
 
@@ -770,10 +881,14 @@ inline f32x4& f32x4::operator-=(f32x2 Other)
 // Per Component Multiply-equals
 inline f32x4& f32x4::operator*=(f32x4 Other)
 {
+#if SIMD_SSE2
+    Simd = _mm_mul_ps(Simd, Other.Simd);
+#else
     X *= Other.X;
     Y *= Other.Y;
     Z *= Other.Z;
     W *= Other.W;
+#endif
     return *this;
 }
 
@@ -795,10 +910,15 @@ inline f32x4& f32x4::operator*=(f32x2 Other)
 // Per Component Multiply-equals
 inline f32x4& f32x4::operator/=(f32x4 Other)
 {
+#if SIMD_SSE2
+    Simd = F32x4SafeDiv(Simd, Other.Simd);
+#else
     X = (F32IsZero(Other.X)) ? 0.0f : X / Other.X;
     Y = (F32IsZero(Other.Y)) ? 0.0f : Y / Other.Y;
     Z = (F32IsZero(Other.Z)) ? 0.0f : Z / Other.Z;
     W = (F32IsZero(Other.W)) ? 0.0f : W / Other.W;
+#endif
+    return *this;
 }
 
 inline f32x4& f32x4::operator/=(f32x3 Other)
@@ -806,50 +926,77 @@ inline f32x4& f32x4::operator/=(f32x3 Other)
     X = (F32IsZero(Other.X)) ? 0.0f : X / Other.X;
     Y = (F32IsZero(Other.Y)) ? 0.0f : Y / Other.Y;
     Z = (F32IsZero(Other.Z)) ? 0.0f : Z / Other.Z;
+    return *this;
 }
 
 inline f32x4& f32x4::operator/=(f32x2 Other)
 {
     X = (F32IsZero(Other.X)) ? 0.0f : X / Other.X;
     Y = (F32IsZero(Other.Y)) ? 0.0f : Y / Other.Y;
+    return *this;
 }
 
 // The following operators apply to the entire vector.
 inline f32x4& f32x4::operator+=(f32 Other)
 {
+#if SIMD_SSE2
+    Simd = _mm_add_ps(Simd, _mm_set1_ps(Other));
+#else
     X += Other;
     Y += Other;
     Z += Other;
     W += Other;
+#endif
+    return *this;
 }
 
 inline f32x4& f32x4::operator-=(f32 Other)
 {
+#if SIMD_SSE2
+    Simd = _mm_sub_ps(Simd, _mm_set1_ps(Other));
+#else
     X -= Other;
     Y -= Other;
     Z -= Other;
     W -= Other;
+#endif
+    return *this;
 }
 
 inline f32x4& f32x4::operator*=(f32 Other)
 {
+#if SIMD_SSE2
+    Simd = _mm_mul_ps(Simd, _mm_set1_ps(Other));
+#else
     X *= Other;
     Y *= Other;
     Z *= Other;
     W *= Other;
+#endif
+    return *this;
 }
 
 inline f32x4& f32x4::operator/=(f32 Other)
 {
+#if SIMD_SSE2
+    Simd = F32x4SafeDiv(Simd, _mm_set1_ps(Other));
+#else
     X = (F32IsZero(Other)) ? 0.0f : X / Other;
     Y = (F32IsZero(Other)) ? 0.0f : Y / Other;
     Z = (F32IsZero(Other)) ? 0.0f : Z / Other;
     W = (F32IsZero(Other)) ? 0.0f : W / Other;
+#endif
+    return *this;
 }
 
 // Add Operator
 inline f32x4 operator+(f32x4 Left, f32x4 Right)
 {
+#if SIMD_SSE2
+    f32x4 Result;
+    Result.Simd = _mm_add_ps(Left.Simd, Right.Simd);
+    return Result;
+#else
     f32x4 Result = f32x4_zero;
 
     Result.X = Left.X + Right.X;
@@ -858,6 +1005,7 @@ inline f32x4 operator+(f32x4 Left, f32x4 Right)
     Result.W = Left.W + Right.W;
 
     return Result;
+#endif
 }
 
 inline f32x4 operator+(f32x4 Left, f32x3 Right)
@@ -904,6 +1052,11 @@ inline f32x4 operator+(f32x2 Left, f32x4 Right)
 
 inline f32x4 operator+(f32x4 Left, f32 Right)
 {
+#if SIMD_SSE2
+    f32x4 Result;
+    Result.Simd = _mm_add_ps(Left.Simd, _mm_set1_ps(Right));
+    return Result;
+#else
     f32x4 Result = f32x4_zero;
 
     Result.X = Left.X + Right;
@@ -912,11 +1065,17 @@ inline f32x4 operator+(f32x4 Left, f32 Right)
     Result.W = Left.W + Right;
 
     return Result;
+#endif
 }
 
 // Sub Operator
 inline f32x4 operator-(f32x4 Left, f32x4 Right)
 {
+#if SIMD_SSE2
+    f32x4 Result;
+    Result.Simd = _mm_sub_ps(Left.Simd, Right.Simd);
+    return Result;
+#else
     f32x4 Result = f32x4_zero;
 
     Result.X = Left.X - Right.X;
@@ -925,6 +1084,7 @@ inline f32x4 operator-(f32x4 Left, f32x4 Right)
     Result.W = Left.W - Right.W;
 
     return Result;
+#endif
 }
 
 inline f32x4 operator-(f32x4 Left, f32x3 Right)
@@ -970,6 +1130,11 @@ inline f32x4 operator-(f32x2 Left, f32x4 Right)
 
 inline f32x4 operator-(f32x4 Left, f32 Right)
 {
+#if SIMD_SSE2
+    f32x4 Result;
+    Result.Simd = _mm_sub_ps(Left.Simd, _mm_set1_ps(Right));
+    return Result;
+#else
     f32x4 Result = f32x4_zero;
 
     Result.X = Left.X - Right;
@@ -978,11 +1143,17 @@ inline f32x4 operator-(f32x4 Left, f32 Right)
     Result.W = Left.W - Right;
 
     return Result;
+#endif
 }
 
 // Multiplication Operator
 inline f32x4 operator*(f32x4 Left, f32x4 Right)
 {
+#if SIMD_SSE2
+    f32x4 Result;
+    Result.Simd = _mm_mul_ps(Left.Simd, Right.Simd);
+    return Result;
+#else
     f32x4 Result = f32x4_zero;
 
     Result.X = Left.X * Right.X;
@@ -991,6 +1162,7 @@ inline f32x4 operator*(f32x4 Left, f32x4 Right)
     Result.W = Left.W * Right.W;
 
     return Result;
+#endif
 }
 
 inline f32x4 operator*(f32x4 Left, f32x3 Right)
@@ -1037,6 +1209,11 @@ inline f32x4 operator*(f32x2 Left, f32x4 Right)
 
 inline f32x4 operator*(f32x4 Left, f32 Right)
 {
+#if SIMD_SSE2
+    f32x4 Result;
+    Result.Simd = _mm_mul_ps(Left.Simd, _mm_set1_ps(Right));
+    return Result;
+#else
     f32x4 Result = f32x4_zero;
 
     Result.X = Left.X * Right;
@@ -1045,11 +1222,17 @@ inline f32x4 operator*(f32x4 Left, f32 Right)
     Result.W = Left.W * Right;
 
     return Result;
+#endif
 }
 
 // Division Operator
 inline f32x4 operator/(f32x4 Left, f32x4 Right)
 {
+#if SIMD_SSE2
+    f32x4 Result;
+    Result.Simd = F32x4SafeDiv(Left.Simd, Right.Simd);
+    return Result;
+#else
     f32x4 Result = f32x4_zero;
 
     Result.X = F32IsZero(Right.X) ? 0.0f : Left.X / Right.X;
@@ -1058,6 +1241,7 @@ inline f32x4 operator/(f32x4 Left, f32x4 Right)
     Result.W = F32IsZero(Right.W) ? 0.0f : Left.W / Right.W;
 
     return Result;
+#endif
 }
 
 inline f32x4 operator/(f32x4 Left, f32x3 Right)
@@ -1104,6 +1288,11 @@ inline f32x4 operator/(f32x2 Left, f32x4 Right)
 
 inline f32x4 operator/(f32x4 Left, f32 Right)
 {
+#if SIMD_SSE2
+    f32x4 Result;
+    Result.Simd = F32x4SafeDiv(Left.Simd, _mm_set1_ps(Right));
+    return Result;
+#else
     f32x4 Result = f32x4_zero;
 
     Result.X = F32IsZero(Right) ? 0.0f : Left.X / Right;
@@ -1112,6 +1301,7 @@ inline f32x4 operator/(f32x4 Left, f32 Right)
     Result.W = F32IsZero(Right) ? 0.0f : Left.W / Right;
 
     return Result;
+#endif
 }
 
 // f32    f32x4::LengthSq()
@@ -1120,11 +1310,24 @@ inline f32x4 operator/(f32x4 Left, f32 Right)
 // f32    Dot(f32x4 Left, f32x4 Right)
 // f32x4  Cross(f32x4 Left, f32x4 Right)
 
-inline f32 f32x4::Length()   { return sqrt(X * X + Y * Y + Z * Z + W * W); }
-inline f32 f32x4::LengthSq() { return X * X + Y * Y + Z * Z + W * W;          }
+inline f32 Dot(f32x4 Left, f32x4 Right)
+{
+#if SIMD_SSE2
+    return _mm_cvtss_f32(F32x4HorizontalSum(_mm_mul_ps(Left.Simd, Right.Simd)));
+#else
+    return Left.X * Right.X + Left.Y * Right.Y + Left.Z * Right.Z + Left.W * Right.W;
+#endif
+}
+
+inline f32 f32x4::Length()   { return sqrt(LengthSq()); }
+inline f32 f32x4::LengthSq() { return Dot(*this, *this); }
 
 inline f32x4& f32x4::Norm()
 {
+#if SIMD_SSE2
+    __m128 Len = _mm_sqrt_ps(F32x4HorizontalSum(_mm_mul_ps(Simd, Simd)));
+    Simd       = F32x4SafeDiv(Simd, Len);
+#else
     f32 Len = Length();
     if (!F32IsZero(Len))
     {
@@ -1133,14 +1336,10 @@ inline f32x4& f32x4::Norm()
         Z /= Len;
         W /= Len;
     }
+#endif
     return *this;
 }
 
-inline f32 Dot(f32x4 Left, f32x4 Right)
-{
-    return Left.X * Right.X + Left.Y * Right.Y + Left.Z * Right.Z + Left.W * Right.W;
-}
-
 inline f32x4 Cross(f32x4 Left, f32x4 Right)
 {
     f32x4 Result;
@@ -1155,6 +1354,43 @@ inline f32x4 Cross(f32x4 Left, f32x4 Right)
 
 inline f32x44 F32x44MulRH(f32x44 Left, f32x44 Right)
 {
+#if SIMD_AVX
+    // Two result columns per iteration: each 128-bit half of Pair holds one column of Right,
+    // and _mm256_permute_ps broadcasts the same component within each half.
+    f32x44 Result;
+
+    __m256 L0 = _mm256_broadcast_ps(&Left.C0.Simd);
+    __m256 L1 = _mm256_broadcast_ps(&Left.C1.Simd);
+    __m256 L2 = _mm256_broadcast_ps(&Left.C2.Simd);
+    __m256 L3 = _mm256_broadcast_ps(&Left.C3.Simd);
+
+    for (u32 Column = 0; Column < 4; Column += 2)
+    {
+        __m256 Pair = _mm256_loadu_ps(Right.Ptr[Column]);
+
+        __m256 Sum = _mm256_mul_ps(L0, _mm256_permute_ps(Pair, _MM_SHUFFLE(0, 0, 0, 0)));
+#if SIMD_FMA
+        Sum = _mm256_fmadd_ps(L1, _mm256_permute_ps(Pair, _MM_SHUFFLE(1, 1, 1, 1)), Sum);
+        Sum = _mm256_fmadd_ps(L2, _mm256_permute_ps(Pair, _MM_SHUFFLE(2, 2, 2, 2)), Sum);
+        Sum = _mm256_fmadd_ps(L3, _mm256_permute_ps(Pair, _MM_SHUFFLE(3, 3, 3, 3)), Sum);
+#else
+        Sum = _mm256_add_ps(Sum, _mm256_mul_ps(L1, _mm256_permute_ps(Pair, _MM_SHUFFLE(1, 1, 1, 1))));
+        Sum = _mm256_add_ps(Sum, _mm256_mul_ps(L2, _mm256_permute_ps(Pair, _MM_SHUFFLE(2, 2, 2, 2))));
+        Sum = _mm256_add_ps(Sum, _mm256_mul_ps(L3, _mm256_permute_ps(Pair, _MM_SHUFFLE(3, 3, 3, 3))));
+#endif
+        _mm256_storeu_ps(Result.Ptr[Column], Sum);
+    }
+
+    return Result;
+#elif SIMD_SSE2
+    // Column j of the result is Left * Right.Cj, no transpose required.
+    f32x44 Result;
+    Result.C0.Simd = F32x44MulColumn(Left, Right.C0.Simd);
+    Result.C1.Simd = F32x44MulColumn(Left, Right.C1.Simd);
+    Result.C2.Simd = F32x44MulColumn(Left, Right.C2.Simd);
+    Result.C3.Simd = F32x44MulColumn(Left, Right.C3.Simd);
+    return Result;
+#else
     f32x44 Result;
 
     f32x4 lr0 = { Left.Ptr[0][0], Left.Ptr[1][0], Left.Ptr[2][0], Left.Ptr[3][0] };
@@ -1183,11 +1419,75 @@ inline f32x44 F32x44MulRH(f32x44 Left, f32x44 Right)
     Result.Ptr[3][3] = Dot(lr3, Right.C3);
 
     return Result;
+#endif
 }
 
 // https://gist.github.com/mattatz/86fff4b32d198d0928d0fa4ff32cf6fa
 inline f32x44 InvertMatrix(f32x44 Matrix)
 {
+#if SIMD_SSE2
+    // 2x2 block inverse. Each __m128 holds a 2x2 sub-matrix; the method is the same for row and
+    // column major storage since inverse(transpose(M)) == transpose(inverse(M)).
+    // Source: https://lxjk.github.io/2017/09/03/Fast-4x4-Matrix-Inverse-with-SSE-SIMD-Explained.html
+    const __m128 M0 = Matrix.C0.Simd;
+    const __m128 M1 = Matrix.C1.Simd;
+    const __m128 M2 = Matrix.C2.Simd;
+    const __m128 M3 = Matrix.C3.Simd;
+
+    __m128 A = _mm_movelh_ps(M0, M1);
+    __m128 B = _mm_movehl_ps(M1, M0);
+    __m128 C = _mm_movelh_ps(M2, M3);
+    __m128 D = _mm_movehl_ps(M3, M2);
+
+    // Determinants of the sub-matrices as (|A| |B| |C| |D|)
+    __m128 DetSub = _mm_sub_ps(
+        _mm_mul_ps(_mm_shuffle_ps(M0, M2, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_ps(M1, M3, _MM_SHUFFLE(3, 1, 3, 1))),
+        _mm_mul_ps(_mm_shuffle_ps(M0, M2, _MM_SHUFFLE(3, 1, 3, 1)), _mm_shuffle_ps(M1, M3, _MM_SHUFFLE(2, 0, 2, 0))));
+
+    __m128 DetA = F32x4Splat(DetSub, 0);
+    __m128 DetB = F32x4Splat(DetSub, 1);
+    __m128 DetC = F32x4Splat(DetSub, 2);
+    __m128 DetD = F32x4Splat(DetSub, 3);
+
+    // 2x2 products: Mul = L*R, AdjMul = adj(L)*R, MulAdj = L*adj(R)
+    auto Mat2Mul = [](__m128 L, __m128 R) {
+        return _mm_add_ps(_mm_mul_ps(L, _mm_shuffle_ps(R, R, _MM_SHUFFLE(3, 0, 3, 0))),
+                          _mm_mul_ps(_mm_shuffle_ps(L, L, _MM_SHUFFLE(2, 3, 0, 1)), _mm_shuffle_ps(R, R, _MM_SHUFFLE(1, 2, 1, 2))));
+    };
+    auto Mat2AdjMul = [](__m128 L, __m128 R) {
+        return _mm_sub_ps(_mm_mul_ps(_mm_shuffle_ps(L, L, _MM_SHUFFLE(0, 0, 3, 3)), R),
+                          _mm_mul_ps(_mm_shuffle_ps(L, L, _MM_SHUFFLE(2, 2, 1, 1)), _mm_shuffle_ps(R, R, _MM_SHUFFLE(1, 0, 3, 2))));
+    };
+    auto Mat2MulAdj = [](__m128 L, __m128 R) {
+        return _mm_sub_ps(_mm_mul_ps(L, _mm_shuffle_ps(R, R, _MM_SHUFFLE(0, 3, 0, 3))),
+                          _mm_mul_ps(_mm_shuffle_ps(L, L, _MM_SHUFFLE(2, 3, 0, 1)), _mm_shuffle_ps(R, R, _MM_SHUFFLE(1, 2, 1, 2))));
+    };
+
+    __m128 DC = Mat2AdjMul(D, C);
+    __m128 AB = Mat2AdjMul(A, B);
+
+    __m128 X = _mm_sub_ps(_mm_mul_ps(DetD, A), Mat2Mul(B, DC));
+    __m128 W = _mm_sub_ps(_mm_mul_ps(DetA, D), Mat2Mul(C, AB));
+    __m128 Y = _mm_sub_ps(_mm_mul_ps(DetB, C), Mat2MulAdj(D, AB));
+    __m128 Z = _mm_sub_ps(_mm_mul_ps(DetC, B), Mat2MulAdj(A, DC));
+
+    // |M| = |A||D| + |B||C| - tr(adj(A)B * adj(D)C)
+    __m128 Trace = F32x4HorizontalSum(_mm_mul_ps(AB, _mm_shuffle_ps(DC, DC, _MM_SHUFFLE(3, 1, 2, 0))));
+    __m128 DetM  = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(DetA, DetD), _mm_mul_ps(DetB, DetC)), Trace);
+
+    __m128 InvDetM = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), DetM);
+    X = _mm_mul_ps(X, InvDetM);
+    Y = _mm_mul_ps(Y, InvDetM);
+    Z = _mm_mul_ps(Z, InvDetM);
+    W = _mm_mul_ps(W, InvDetM);
+
+    f32x44 Result;
+    Result.C0.Simd = _mm_shuffle_ps(X, Y, _MM_SHUFFLE(1, 3, 1, 3));
+    Result.C1.Simd = _mm_shuffle_ps(X, Y, _MM_SHUFFLE(0, 2, 0, 2));
+    Result.C2.Simd = _mm_shuffle_ps(Z, W, _MM_SHUFFLE(1, 3, 1, 3));
+    Result.C3.Simd = _mm_shuffle_ps(Z, W, _MM_SHUFFLE(0, 2, 0, 2));
+    return Result;
+#else
     float n11 = Matrix.Ptr[0][0], n12 = Matrix.Ptr[1][0], n13 = Matrix.Ptr[2][0], n14 = Matrix.Ptr[3][0];
     float n21 = Matrix.Ptr[0][1], n22 = Matrix.Ptr[1][1], n23 = Matrix.Ptr[2][1], n24 = Matrix.Ptr[3][1];
     float n31 = Matrix.Ptr[0][2], n32 = Matrix.Ptr[1][2], n33 = Matrix.Ptr[2][2], n34 = Matrix.Ptr[3][2];
@@ -1224,6 +1524,7 @@ inline f32x44 InvertMatrix(f32x44 Matrix)
     Result.Ptr[3][3] = (n12 * n23 * n31 - n13 * n22 * n31 + n13 * n21 * n32 - n11 * n23 * n32 - n12 * n21 * n33 + n11 * n22 * n33) * idet;
 
     return Result;
+#endif
 }
 
 // Creates a scaling matrix
@@ -1240,6 +1541,11 @@ inline f32x44 ScaleMatrix(f32 ScaleX, f32 ScaleY, f32 ScaleZ)
 
 inline f32x44 TransposeMatrix(f32x44 InMatrix)
 {
+#if SIMD_SSE2
+    f32x44 Result = InMatrix;
+    _MM_TRANSPOSE4_PS(Result.C0.Simd, Result.C1.Simd, Result.C2.Simd, Result.C3.Simd);
+    return Result;
+#else
     f32x44 Result = f32x44();
 
     Result.Ptr[0][0] = InMatrix.Ptr[0][0];
@@ -1263,10 +1569,16 @@ inline f32x44 TransposeMatrix(f32x44 InMatrix)
     Result.Ptr[3][3] = InMatrix.Ptr[3][3];
 
     return Result;
+#endif
 }
 
 inline f32x4 MatrixTranslatePoint(f32x44 Matrix, f32x4 Point)
 {
+#if SIMD_SSE2
+    f32x4 Result;
+    Result.Simd = F32x44MulColumn(Matrix, Point.Simd);
+    return Result;
+#else
     f32x4 r0 = { Matrix.Ptr[0][0], Matrix.Ptr[1][0], Matrix.Ptr[2][0], Matrix.Ptr[3][0] };
     f32x4 r1 = { Matrix.Ptr[0][1], Matrix.Ptr[1][1], Matrix.Ptr[2][1], Matrix.Ptr[3][1] };
     f32x4 r2 = { Matrix.Ptr[0][2], Matrix.Ptr[1][2], Matrix.Ptr[2][2], Matrix.Ptr[3][2] };
@@ -1278,6 +1590,7 @@ inline f32x4 MatrixTranslatePoint(f32x44 Matrix, f32x4 Point)
     Result.Z = Dot(Point, r2);
     Result.W = Dot(Point, r3);
     return Result;
+#endif
 }
 
 // Creates a translation matrix
@@ -1334,7 +1647,9 @@ inline f32x44 PerspectiveMatrixRH(f32 FieldOfView, f32 AspectRatio, f32 NearPlan
     f32x44 Result = f32x44(0.0f);
 
     f32 Radians = DegreesToRadians(FieldOfView);
-    f32 Cotangent = 1.0f / tanf(Radians * 0.5f);
+    f32 Sine, Cosine;
+    F32FastSinCos(Radians * 0.5f, &Sine, &Cosine);
+    f32 Cotangent = Cosine / Sine;
 
     Result.Ptr[0][0] = Cotangent / AspectRatio;
     Result.Ptr[1][1] = Cotangent;
@@ -1350,8 +1665,8 @@ inline f32x44 RotateXMatrix(f32 Theta)
 {
     Theta = DegreesToRadians(Theta);
 
-    f32 c = cosf(Theta);
-    f32 s = sinf(Theta);
+    f32 s, c;
+    F32FastSinCos(Theta, &s, &c);
 
     f32x44 Result;
 
@@ -1382,8 +1697,8 @@ inline f32x44 RotateYMatrix(f32 Theta)
 {
     Theta = DegreesToRadians(Theta);
 
-    f32 c = cosf(Theta);
-    f32 s = sinf(Theta);
+    f32 s, c;
+    F32FastSinCos(Theta, &s, &c);
 
     f32x44 Result;
 
@@ -1414,8 +1729,8 @@ inline f32x44 RotateZMatrix(f32 Theta)
 {
     Theta = DegreesToRadians(Theta);
 
-    f32 c = cosf(Theta);
-    f32 s = sinf(Theta);
+    f32 s, c;
+    F32FastSinCos(Theta, &s, &c);
 
     f32x44 Result;
 
@@ -1447,8 +1762,8 @@ inline f32x44 RotateMatrix(f32 Theta, f32x3 RotationAxis)
     Theta = DegreesToRadians(Theta);
     RotationAxis.Norm();
 
-    f32 c = cosf(Theta);
-    f32 s = sinf(Theta);
+    f32 s, c;
+    F32FastSinCos(Theta, &s, &c);
     f32 d = 1.0f - c;
 
     f32 x = RotationAxis.X * d;
@@ -1483,20 +1798,358 @@ inline f32x44 RotateMatrix(f32 Theta, f32x3 RotationAxis)
     return Result;
 }
 
+//
+// Batch Functions
+//
+// Kernels for transforming many objects at once. SoA inputs keep one component of 4 (SSE) or
+// 8 (AVX) objects in a register; the remainder that does not fill a register uses scalar code.
+// The matrix batches work on whole f32x44s instead, one column (SSE) or two columns (AVX) per register.
+//
+// void F32x44MulBatchRH(const f32x44* Left, const f32x44* Right, f32x44* Out, u64 Count) Out[i] = Left[i] * Right[i]
+// void F32x44MulBatchRH(f32x44 Left, const f32x44* Right, f32x44* Out, u64 Count)        Out[i] = Left * Right[i]
+// void TransformPointsSoA(f32x44 Matrix, f32x3_soa In, f32x3_soa Out, u64 Count)        W = 1, no perspective divide
+// void TransformNormalsSoA(f32x44 Matrix, f32x3_soa In, f32x3_soa Out, u64 Count)       Upper 3x3 only, not renormalized
+// void ComposeTransformsSoA(trs_soa In, void* Out, u64 OutStride, u64 Count)             Out[i] = T * R * S
+//
+// In and Out of the SoA point/normal transforms may be the same arrays. ComposeTransformsSoA writes
+// each f32x44 at a byte stride so it can fill a field of a mapped GPU buffer, for example
+//     ComposeTransformsSoA(Transforms, &MeshData[0].Transforms, sizeof(per_mesh_data), Count);
+// The writes are sequential and cover the whole matrix, which is what write-combined memory wants.
+//
+
+struct f32x3_soa
+{
+    f32* X;
+    f32* Y;
+    f32* Z;
+};
+
+// Translation, unit quaternion rotation (X, Y, Z, W), and scale for Count objects
+struct trs_soa
+{
+    f32* PositionX;
+    f32* PositionY;
+    f32* PositionZ;
+    f32* RotationX;
+    f32* RotationY;
+    f32* RotationZ;
+    f32* RotationW;
+    f32* ScaleX;
+    f32* ScaleY;
+    f32* ScaleZ;
+};
+
+namespace math_internal
+{
+    // Register width abstraction so each batch kernel is written once for SSE and AVX.
+#if SIMD_SSE2
+    struct lanes_x4
+    {
+        using reg = __m128;
+        static constexpr u64 cWidth = 4;
+
+        static reg  Load(const f32* Ptr)        { return _mm_loadu_ps(Ptr);     }
+        static void Store(f32* Ptr, reg Value)  { _mm_storeu_ps(Ptr, Value);    }
+        static reg  Set1(f32 Value)             { return _mm_set1_ps(Value);    }
+        static reg  Add(reg A, reg B)           { return _mm_add_ps(A, B);      }
+        static reg  Sub(reg A, reg B)           { return _mm_sub_ps(A, B);      }
+        static reg  Mul(reg A, reg B)           { return _mm_mul_ps(A, B);      }
+        static reg  MulAdd(reg A, reg B, reg C) { return F32x4MulAdd(A, B, C);  }
+        static reg  Min(reg A, reg B)           { return _mm_min_ps(A, B);      }
+        static reg  Max(reg A, reg B)           { return _mm_max_ps(A, B);      }
+
+        // Matrix columns: a register holds cWidth / 4 consecutive columns of one f32x44.
+        static reg  BroadcastColumn(const f32* Column) { return _mm_loadu_ps(Column); }
+        template<u32 Lane>
+        static reg  SplatComponent(reg Columns)        { return F32x4Splat(Columns, Lane); }
+
+        // Bit i is set when lane i is >= 0
+        static u32  NonNegativeMask(reg Value)  { return u32(_mm_movemask_ps(_mm_cmpge_ps(Value, _mm_setzero_ps()))); }
+
+        // Transposes one matrix column from SoA (4 objects) to AoS and stores it in each object.
+        static void StoreColumn(u8* Out, u64 Stride, u64 ColumnOffset, reg X, reg Y, reg Z, reg W)
+        {
+            _MM_TRANSPOSE4_PS(X, Y, Z, W);
+            _mm_storeu_ps((f32*)(Out + 0 * Stride + ColumnOffset), X);
+            _mm_storeu_ps((f32*)(Out + 1 * Stride + ColumnOffset), Y);
+            _mm_storeu_ps((f32*)(Out + 2 * Stride + ColumnOffset), Z);
+            _mm_storeu_ps((f32*)(Out + 3 * Stride + ColumnOffset), W);
+        }
+    };
+#endif
+
+#if SIMD_AVX
+    struct lanes_x8
+    {
+        using reg = __m256;
+        static constexpr u64 cWidth = 8;
+
+        static reg  Load(const f32* Ptr)        { return _mm256_loadu_ps(Ptr);     }
+        static void Store(f32* Ptr, reg Value)  { _mm256_storeu_ps(Ptr, Value);    }
+        static reg  Set1(f32 Value)             { return _mm256_set1_ps(Value);    }
+        static reg  Add(reg A, reg B)           { return _mm256_add_ps(A, B);      }
+        static reg  Sub(reg A, reg B)           { return _mm256_sub_ps(A, B);      }
+        static reg  Mul(reg A, reg B)           { return _mm256_mul_ps(A, B);      }
+        static reg  Min(reg A, reg B)           { return _mm256_min_ps(A, B);      }
+        static reg  Max(reg A, reg B)           { return _mm256_max_ps(A, B);      }
+        static u32  NonNegativeMask(reg Value)  { return u32(_mm256_movemask_ps(_mm256_cmp_ps(Value, _mm256_setzero_ps(), _CMP_GE_OQ))); }
+
+        // Each 128-bit half holds one column, so components are splat within each half.
+        static reg  BroadcastColumn(const f32* Column) { return _mm256_broadcast_ps((const __m128*)Column); }
+        template<u32 Lane>
+        static reg  SplatComponent(reg Columns)        { return _mm256_permute_ps(Columns, _MM_SHUFFLE(Lane, Lane, Lane, Lane)); }
+
+        static reg  MulAdd(reg A, reg B, reg C)
+        {
+#if SIMD_FMA
+            return _mm256_fmadd_ps(A, B, C);
+#else
+            return _mm256_add_ps(_mm256_mul_ps(A, B), C);
+#endif
+        }
+
+        static void StoreColumn(u8* Out, u64 Stride, u64 ColumnOffset, reg X, reg Y, reg Z, reg W)
+        {
+            lanes_x4::StoreColumn(Out, Stride, ColumnOffset,
+                _mm256_castps256_ps128(X), _mm256_castps256_ps128(Y), _mm256_castps256_ps128(Z), _mm256_castps256_ps128(W));
+            lanes_x4::StoreColumn(Out + 4 * Stride, Stride, ColumnOffset,
+                _mm256_extractf128_ps(X, 1), _mm256_extractf128_ps(Y, 1), _mm256_extractf128_ps(Z, 1), _mm256_extractf128_ps(W, 1));
+        }
+    };
+#endif
+
+    // Scalar lanes, used for the remainder and when SIMD is unavailable.
+    struct lanes_x1
+    {
+        using reg = f32;
+        static constexpr u64 cWidth = 1;
+
+        static reg  Load(const f32* Ptr)        { return *Ptr;            }
+        static void Store(f32* Ptr, reg Value)  { *Ptr = Value;           }
+        static reg  Set1(f32 Value)             { return Value;           }
+        static reg  Add(reg A, reg B)           { return A + B;           }
+        static reg  Sub(reg A, reg B)           { return A - B;           }
+        static reg  Mul(reg A, reg B)           { return A * B;           }
+        static reg  MulAdd(reg A, reg B, reg C) { return A * B + C;       }
+        static reg  Min(reg A, reg B)           { return (A < B) ? A : B; }
+        static reg  Max(reg A, reg B)           { return (A > B) ? A : B; }
+        static u32  NonNegativeMask(reg Value)  { return Value >= 0.0f;   }
+
+        static void StoreColumn(u8* Out, u64, u64 ColumnOffset, reg X, reg Y, reg Z, reg W)
+        {
+            f32* Column = (f32*)(Out + ColumnOffset);
+            Column[0] = X;
+            Column[1] = Y;
+            Column[2] = Z;
+            Column[3] = W;
+        }
+    };
+
+    // Processes [Begin, Count) in steps of lanes::cWidth and returns the first index that was not processed.
+    template<typename lanes>
+    inline u64 TransformSoA(const f32x44& Matrix, f32x3_soa In, f32x3_soa Out, u64 Begin, u64 Count, bool IsPoint)
+    {
+        using reg = typename lanes::reg;
+
+        const reg M00 = lanes::Set1(Matrix.Ptr[0][0]), M01 = lanes::Set1(Matrix.Ptr[0][1]), M02 = lanes::Set1(Matrix.Ptr[0][2]);
+        const reg M10 = lanes::Set1(Matrix.Ptr[1][0]), M11 = lanes::Set1(Matrix.Ptr[1][1]), M12 = lanes::Set1(Matrix.Ptr[1][2]);
+        const reg M20 = lanes::Set1(Matrix.Ptr[2][0]), M21 = lanes::Set1(Matrix.Ptr[2][1]), M22 = lanes::Set1(Matrix.Ptr[2][2]);
+        const reg M30 = lanes::Set1(IsPoint ? Matrix.Ptr[3][0] : 0.0f);
+        const reg M31 = lanes::Set1(IsPoint ? Matrix.Ptr[3][1] : 0.0f);
+        const reg M32 = lanes::Set1(IsPoint ? Matrix.Ptr[3][2] : 0.0f);
+
+        u64 i = Begin;
+        for (; i + lanes::cWidth <= Count; i += lanes::cWidth)
+        {
+            reg X = lanes::Load(In.X + i);
+            reg Y = lanes::Load(In.Y + i);
+            reg Z = lanes::Load(In.Z + i);
+
+            lanes::Store(Out.X + i, lanes::MulAdd(M20, Z, lanes::MulAdd(M10, Y, lanes::MulAdd(M00, X, M30))));
+            lanes::Store(Out.Y + i, lanes::MulAdd(M21, Z, lanes::MulAdd(M11, Y, lanes::MulAdd(M01, X, M31))));
+            lanes::Store(Out.Z + i, lanes::MulAdd(M22, Z, lanes::MulAdd(M12, Y, lanes::MulAdd(M02, X, M32))));
+        }
+        return i;
+    }
+
+    template<typename lanes>
+    inline u64 ComposeTransformsSoA(const trs_soa& In, u8* Out, u64 OutStride, u64 Begin, u64 Count)
+    {
+        using reg = typename lanes::reg;
+
+        const reg One  = lanes::Set1(1.0f);
+        const reg Two  = lanes::Set1(2.0f);
+        const reg Zero = lanes::Set1(0.0f);
+
+        u64 i = Begin;
+        for (; i + lanes::cWidth <= Count; i += lanes::cWidth)
+        {
+            reg QX = lanes::Load(In.RotationX + i);
+            reg QY = lanes::Load(In.RotationY + i);
+            reg QZ = lanes::Load(In.RotationZ + i);
+            reg QW = lanes::Load(In.RotationW + i);
+
+            reg X2 = lanes::Mul(QX, Two), Y2 = lanes::Mul(QY, Two), Z2 = lanes::Mul(QZ, Two);
+            reg XX = lanes::Mul(QX, X2),  YY = lanes::Mul(QY, Y2),  ZZ = lanes::Mul(QZ, Z2);
+            reg XY = lanes::Mul(QX, Y2),  XZ = lanes::Mul(QX, Z2),  YZ = lanes::Mul(QY, Z2);
+            reg WX = lanes::Mul(QW, X2),  WY = lanes::Mul(QW, Y2),  WZ = lanes::Mul(QW, Z2);
+
+            reg SX = lanes::Load(In.ScaleX + i);
+            reg SY = lanes::Load(In.ScaleY + i);
+            reg SZ = lanes::Load(In.ScaleZ + i);
+
+            u8* Dst = Out + i * OutStride;
+            lanes::StoreColumn(Dst, OutStride, 0 * sizeof(f32x4),
+                lanes::Mul(lanes::Sub(One, lanes::Add(YY, ZZ)), SX),
+                lanes::Mul(lanes::Add(XY, WZ), SX),
+                lanes::Mul(lanes::Sub(XZ, WY), SX),
+                Zero);
+            lanes::StoreColumn(Dst, OutStride, 1 * sizeof(f32x4),
+                lanes::Mul(lanes::Sub(XY, WZ), SY),
+                lanes::Mul(lanes::Sub(One, lanes::Add(XX, ZZ)), SY),
+                lanes::Mul(lanes::Add(YZ, WX), SY),
+                Zero);
+            lanes::StoreColumn(Dst, OutStride, 2 * sizeof(f32x4),
+                lanes::Mul(lanes::Add(XZ, WY), SZ),
+                lanes::Mul(lanes::Sub(YZ, WX), SZ),
+                lanes::Mul(lanes::Sub(One, lanes::Add(XX, YY)), SZ),
+                Zero);
+            lanes::StoreColumn(Dst, OutStride, 3 * sizeof(f32x4),
+                lanes::Load(In.PositionX + i),
+                lanes::Load(In.PositionY + i),
+                lanes::Load(In.PositionZ + i),
+                One);
+        }
+        return i;
+    }
+
+    // Out = Left * Right, where L0..L3 are the columns of Left from lanes::BroadcastColumn.
+    // Columns of Right are read before the same columns of Out are written, so Out may alias either input.
+    template<typename lanes>
+    inline void F32x44MulColumnsRH(typename lanes::reg L0, typename lanes::reg L1, typename lanes::reg L2, typename lanes::reg L3,
+                                   const f32x44& Right, f32x44& Out)
+    {
+        using reg = typename lanes::reg;
+
+        for (u64 Column = 0; Column < 4; Column += lanes::cWidth / 4)
+        {
+            reg R   = lanes::Load(Right.Ptr[Column]);
+            reg Sum = lanes::Mul(L0, lanes::template SplatComponent<0>(R));
+            Sum     = lanes::MulAdd(L1, lanes::template SplatComponent<1>(R), Sum);
+            Sum     = lanes::MulAdd(L2, lanes::template SplatComponent<2>(R), Sum);
+            Sum     = lanes::MulAdd(L3, lanes::template SplatComponent<3>(R), Sum);
+            lanes::Store(Out.Ptr[Column], Sum);
+        }
+    }
+
+    template<typename lanes>
+    inline void F32x44MulBatchRH(const f32x44* Left, const f32x44* Right, f32x44* Out, u64 Count)
+    {
+        for (u64 i = 0; i < Count; ++i)
+        {
+            F32x44MulColumnsRH<lanes>(lanes::BroadcastColumn(Left[i].Ptr[0]), lanes::BroadcastColumn(Left[i].Ptr[1]),
+                                      lanes::BroadcastColumn(Left[i].Ptr[2]), lanes::BroadcastColumn(Left[i].Ptr[3]),
+                                      Right[i], Out[i]);
+        }
+    }
+
+    template<typename lanes>
+    inline void F32x44MulBatchRH(const f32x44& Left, const f32x44* Right, f32x44* Out, u64 Count)
+    {
+        // Left stays in registers for the whole batch.
+        const typename lanes::reg L0 = lanes::BroadcastColumn(Left.Ptr[0]);
+        const typename lanes::reg L1 = lanes::BroadcastColumn(Left.Ptr[1]);
+        const typename lanes::reg L2 = lanes::BroadcastColumn(Left.Ptr[2]);
+        const typename lanes::reg L3 = lanes::BroadcastColumn(Left.Ptr[3]);
+
+        for (u64 i = 0; i < Count; ++i)
+        {
+            F32x44MulColumnsRH<lanes>(L0, L1, L2, L3, Right[i], Out[i]);
+        }
+    }
+
+    inline void TransformSoA(const f32x44& Matrix, f32x3_soa In, f32x3_soa Out, u64 Count, bool IsPoint)
+    {
+        u64 i = 0;
+#if SIMD_AVX
+        i = TransformSoA<lanes_x8>(Matrix, In, Out, i, Count, IsPoint);
+#endif
+#if SIMD_SSE2
+        i = TransformSoA<lanes_x4>(Matrix, In, Out, i, Count, IsPoint);
+#endif
+        TransformSoA<lanes_x1>(Matrix, In, Out, i, Count, IsPoint);
+    }
+}
+
+inline void F32x44MulBatchRH(const f32x44* Left, const f32x44* Right, f32x44* Out, u64 Count)
+{
+#if SIMD_AVX
+    math_internal::F32x44MulBatchRH<math_internal::lanes_x8>(Left, Right, Out, Count);
+#elif SIMD_SSE2
+    math_internal::F32x44MulBatchRH<math_internal::lanes_x4>(Left, Right, Out, Count);
+#else
+    for (u64 i = 0; i < Count; ++i)
+    {
+        Out[i] = F32x44MulRH(Left[i], Right[i]);
+    }
+#endif
+}
+
+inline void F32x44MulBatchRH(f32x44 Left, const f32x44* Right, f32x44* Out, u64 Count)
+{
+#if SIMD_AVX
+    math_internal::F32x44MulBatchRH<math_internal::lanes_x8>(Left, Right, Out, Count);
+#elif SIMD_SSE2
+    math_internal::F32x44MulBatchRH<math_internal::lanes_x4>(Left, Right, Out, Count);
+#else
+    for (u64 i = 0; i < Count; ++i)
+    {
+        Out[i] = F32x44MulRH(Left, Right[i]);
+    }
+#endif
+}
+
+inline void TransformPointsSoA(f32x44 Matrix, f32x3_soa In, f32x3_soa Out, u64 Count)
+{
+    math_internal::TransformSoA(Matrix, In, Out, Count, true);
+}
+
+inline void TransformNormalsSoA(f32x44 Matrix, f32x3_soa In, f32x3_soa Out, u64 Count)
+{
+    math_internal::TransformSoA(Matrix, In, Out, Count, false);
+}
+
+inline void ComposeTransformsSoA(trs_soa In, void* Out, u64 OutStride, u64 Count)
+{
+    u8* Dst = (u8*)Out;
+    u64 i   = 0;
+#if SIMD_AVX
+    i = math_internal::ComposeTransformsSoA<math_internal::lanes_x8>(In, Dst, OutStride, i, Count);
+#endif
+#if SIMD_SSE2
+    i = math_internal::ComposeTransformsSoA<math_internal::lanes_x4>(In, Dst, OutStride, i, Count);
+#endif
+    math_internal::ComposeTransformsSoA<math_internal::lanes_x1>(In, Dst, OutStride, i, Count);
+}
+
 //
 // quaternion Functions
 //
 
 inline quaternion& quaternion::Norm()
 {
-    f32 d = 1.0f / sqrtf(X * X + Y * Y + Z * Z + Theta * Theta);
+    Vector.Norm();
+    return *this;
+}
+
+inline quaternion QuaternionFromAxisAngle(f32x3 Axis, f32 Theta)
+{
+    Axis.Norm();
 
-    Theta = Theta * d;
-    X     = X * d;
-    Y     = Y * d;
-    Z     = Z * d;
+    f32 Sine, Cosine;
+    F32FastSinCos(DegreesToRadians(Theta) * 0.5f, &Sine, &Cosine);
 
-    return *this;
+    return quaternion(Axis.X * Sine, Axis.Y * Sine, Axis.Z * Sine, Cosine);
 }
 
 inline quaternion EulerToQuaternion(f32 Roll, f32 Pitch, f32 Yaw)
@@ -1505,16 +2158,14 @@ inline quaternion EulerToQuaternion(f32 Roll, f32 Pitch, f32 Yaw)
     Pitch = DegreesToRadians(Pitch);
     Yaw   = DegreesToRadians(Yaw);
 
-    f32 cy = cosf(Yaw * 0.5f);
-    f32 sy = sinf(Yaw * 0.5f);
-    f32 cp = cosf(Pitch * 0.5f);
-    f32 sp = sinf(Pitch * 0.5f);
-    f32 cr = cosf(Roll * 0.5f);
-    f32 sr = sinf(Roll * 0.5f);
+    f32 sy, cy, sp, cp, sr, cr;
+    F32FastSinCos(Yaw   * 0.5f, &sy, &cy);
+    F32FastSinCos(Pitch * 0.5f, &sp, &cp);
+    F32FastSinCos(Roll  * 0.5f, &sr, &cr);
 
     quaternion Result = {};
 
-    Result.Theta = cr * cp * cy + sr * sp * sy;
+    Result.W = cr * cp * cy + sr * sp * sy;
     Result.X = sr * cp * cy - cr * sp * sy;
     Result.Y = cr * sp * cy + sr * cp * sy;
     Result.Z = cr * cp * sy - sr * sp * cy;
@@ -1527,29 +2178,220 @@ inline quaternion EulerToQuaternion(f32 Axis[3])
     return EulerToQuaternion(Axis[0], Axis[1], Axis[2]);
 }
 
+// Hamilton product, Left * Right rotates by Right then by Left.
+inline quaternion QuaternionMul(quaternion Left, quaternion Right)
+{
+#if SIMD_SSE2
+    // Each component of Left scales a shuffled, sign-flipped copy of Right:
+    //   Result = Lw * (Rx,  Ry,  Rz,  Rw)
+    //          + Lx * (Rw, -Rz,  Ry, -Rx)
+    //          + Ly * (Rz,  Rw, -Rx, -Ry)
+    //          + Lz * (-Ry, Rx,  Rw, -Rz)
+    const __m128 L = Left.Vector.Simd;
+    const __m128 R = Right.Vector.Simd;
+
+    __m128 Result = _mm_mul_ps(F32x4Splat(L, 3), R);
+    Result = F32x4MulAdd(F32x4Splat(L, 0), _mm_xor_ps(_mm_shuffle_ps(R, R, _MM_SHUFFLE(0, 1, 2, 3)), _mm_setr_ps( 0.0f, -0.0f,  0.0f, -0.0f)), Result);
+    Result = F32x4MulAdd(F32x4Splat(L, 1), _mm_xor_ps(_mm_shuffle_ps(R, R, _MM_SHUFFLE(1, 0, 3, 2)), _mm_setr_ps( 0.0f,  0.0f, -0.0f, -0.0f)), Result);
+    Result = F32x4MulAdd(F32x4Splat(L, 2), _mm_xor_ps(_mm_shuffle_ps(R, R, _MM_SHUFFLE(2, 3, 0, 1)), _mm_setr_ps(-0.0f,  0.0f,  0.0f, -0.0f)), Result);
+
+    quaternion Quaternion;
+    Quaternion.Vector.Simd = Result;
+    return Quaternion;
+#else
+    quaternion Result;
+    Result.X = Left.W * Right.X + Left.X * Right.W + Left.Y * Right.Z - Left.Z * Right.Y;
+    Result.Y = Left.W * Right.Y - Left.X * Right.Z + Left.Y * Right.W + Left.Z * Right.X;
+    Result.Z = Left.W * Right.Z + Left.X * Right.Y - Left.Y * Right.X + Left.Z * Right.W;
+    Result.W = Left.W * Right.W - Left.X * Right.X - Left.Y * Right.Y - Left.Z * Right.Z;
+    return Result;
+#endif
+}
+
+inline quaternion operator*(quaternion Left, quaternion Right)
+{
+    return QuaternionMul(Left, Right);
+}
+
+inline quaternion QuaternionConjugate(quaternion Quaternion)
+{
+#if SIMD_SSE2
+    Quaternion.Vector.Simd = _mm_xor_ps(Quaternion.Vector.Simd, _mm_setr_ps(-0.0f, -0.0f, -0.0f, 0.0f));
+#else
+    Quaternion.X = -Quaternion.X;
+    Quaternion.Y = -Quaternion.Y;
+    Quaternion.Z = -Quaternion.Z;
+#endif
+    return Quaternion;
+}
+
+inline f32 Dot(quaternion Left, quaternion Right)
+{
+    return Dot(Left.Vector, Right.Vector);
+}
+
+// For unit quaternions this is the same as the conjugate.
+inline quaternion QuaternionInverse(quaternion Quaternion)
+{
+    quaternion Result = QuaternionConjugate(Quaternion);
+    Result.Vector /= Dot(Quaternion, Quaternion);
+    return Result;
+}
+
+// Normalized linear interpolation along the shortest arc. Cheaper than Slerp, but the angular
+// speed is not constant across the interpolation.
+inline quaternion QuaternionNLerp(quaternion From, quaternion To, f32 Factor)
+{
+    f32x4 Target = (Dot(From, To) < 0.0f) ? To.Vector * -1.0f : To.Vector;
+
+    quaternion Result = From.Vector + (Target - From.Vector) * Factor;
+    return Result.Norm();
+}
+
+inline quaternion QuaternionSlerp(quaternion From, quaternion To, f32 Factor)
+{
+    f32   CosTheta = Dot(From, To);
+    f32x4 Target   = To.Vector;
+    if (CosTheta < 0.0f)
+    {
+        Target   = Target * -1.0f;
+        CosTheta = -CosTheta;
+    }
+
+    // Nearly parallel, sin(Theta) approaches zero so fall back to NLerp.
+    if (CosTheta > 0.9995f)
+    {
+        return QuaternionNLerp(From, quaternion(Target), Factor);
+    }
+
+    f32 Theta    = F32FastAcos(CosTheta);
+    f32 InvSine  = 1.0f / F32FastSin(Theta);
+    f32 FromPart = F32FastSin((1.0f - Factor) * Theta) * InvSine;
+    f32 ToPart   = F32FastSin(Factor * Theta) * InvSine;
+
+    return quaternion(From.Vector * FromPart + Target * ToPart);
+}
+
+// Rotates Vector without building a matrix: V + 2W(Q x V) + Q x (2(Q x V))
+inline f32x3 QuaternionRotateVector(quaternion Quaternion, f32x3 Vector)
+{
+#if SIMD_SSE2
+    const __m128 Q = Quaternion.Vector.Simd;
+    const __m128 V = _mm_setr_ps(Vector.X, Vector.Y, Vector.Z, 0.0f);
+
+    __m128 T      = F32x4Cross3(Q, V);
+    T             = _mm_add_ps(T, T);
+    __m128 Result = F32x4MulAdd(F32x4Splat(Q, 3), T, _mm_add_ps(V, F32x4Cross3(Q, T)));
+
+    f32x4 Out;
+    Out.Simd = Result;
+    return Out.XYZ;
+#else
+    f32x3 T = Cross(Quaternion.XYZ, Vector) * 2.0f;
+    return Vector + T * Quaternion.W + Cross(Quaternion.XYZ, T);
+#endif
+}
+
 inline f32x44 QuaternionToRotationMatrix(quaternion Quaternion)
 {
-    f32 X2 = Quaternion.X     * Quaternion.X;
-    f32 Y2 = Quaternion.Y     * Quaternion.Y;
-    f32 Z2 = Quaternion.Z     * Quaternion.Z;
-    f32 XY = Quaternion.X     * Quaternion.Y;
-    f32 XZ = Quaternion.X     * Quaternion.Z;
-    f32 YZ = Quaternion.Y     * Quaternion.Z;
-    f32 WX = Quaternion.Theta * Quaternion.X;
-    f32 WY = Quaternion.Theta * Quaternion.Y;
-    f32 WZ = Quaternion.Theta * Quaternion.Z;
+    f32 X2 = Quaternion.X * Quaternion.X;
+    f32 Y2 = Quaternion.Y * Quaternion.Y;
+    f32 Z2 = Quaternion.Z * Quaternion.Z;
+    f32 XY = Quaternion.X * Quaternion.Y;
+    f32 XZ = Quaternion.X * Quaternion.Z;
+    f32 YZ = Quaternion.Y * Quaternion.Z;
+    f32 WX = Quaternion.W * Quaternion.X;
+    f32 WY = Quaternion.W * Quaternion.Y;
+    f32 WZ = Quaternion.W * Quaternion.Z;
 
     f32x44 Result = {};
 
     // 3x3 Rotation Matrix
     Result.C0 = { 1 - 2.0f * (Y2 + Z2),        2.0f * (XY + WZ),        2.0f * (XZ - WY), 0.0f };
-    Result.C1 = {     2.0f * (XY - WZ), 1.0f - 2.0f * (X2 + Z2),        2.0f * (YZ - WX), 0.0f };
+    Result.C1 = {     2.0f * (XY - WZ), 1.0f - 2.0f * (X2 + Z2),        2.0f * (YZ + WX), 0.0f };
     Result.C2 = {        2.0f * (XZ + WY),     2.0f * (YZ - WX), 1.0f - 2.0f * (X2 + Y2), 0.0f };
     Result.C3 = {                       0,                    0,                       0,    1 };
 
     return Result;
 }
 
+//
+// dual_quaternion Functions
+//
+
+inline dual_quaternion DualQuaternionFromRotationTranslation(quaternion Rotation, f32x3 Translation)
+{
+    dual_quaternion Result;
+    Result.Real = Rotation;
+    Result.Dual = QuaternionMul(quaternion(Translation.X, Translation.Y, Translation.Z, 0.0f), Rotation).Vector * 0.5f;
+    return Result;
+}
+
+// Left * Right applies Right, then Left
+inline dual_quaternion DualQuaternionMul(dual_quaternion Left, dual_quaternion Right)
+{
+    dual_quaternion Result;
+    Result.Real = QuaternionMul(Left.Real, Right.Real);
+    Result.Dual = QuaternionMul(Left.Real, Right.Dual).Vector + QuaternionMul(Left.Dual, Right.Real).Vector;
+    return Result;
+}
+
+inline dual_quaternion operator*(dual_quaternion Left, dual_quaternion Right)
+{
+    return DualQuaternionMul(Left, Right);
+}
+
+// Normalizes the rotation and removes the part of Dual that is not orthogonal to it.
+inline dual_quaternion DualQuaternionNorm(dual_quaternion Value)
+{
+    f32 InvLength = 1.0f / Value.Real.Vector.Length();
+
+    dual_quaternion Result;
+    Result.Real = Value.Real.Vector * InvLength;
+    Result.Dual = Value.Dual.Vector * InvLength;
+    Result.Dual = Result.Dual.Vector - Result.Real.Vector * Dot(Result.Real, Result.Dual);
+    return Result;
+}
+
+// Dual quaternion linear blending, as used for skinning. Weights do not need to sum to one.
+inline dual_quaternion DualQuaternionBlend(const dual_quaternion* Values, const f32* Weights, u32 Count)
+{
+    assert(Count > 0);
+
+    f32x4 Real = f32x4_zero;
+    f32x4 Dual = f32x4_zero;
+    ForRange(u32, i, Count)
+    {
+        // Keep every rotation in the same hemisphere as the first so they do not cancel out
+        f32 Weight = (Dot(Values[i].Real, Values[0].Real) < 0.0f) ? -Weights[i] : Weights[i];
+        Real += Values[i].Real.Vector * Weight;
+        Dual += Values[i].Dual.Vector * Weight;
+    }
+
+    dual_quaternion Result;
+    Result.Real = Real;
+    Result.Dual = Dual;
+    return DualQuaternionNorm(Result);
+}
+
+inline f32x3 DualQuaternionGetTranslation(dual_quaternion Value)
+{
+    quaternion Translation = QuaternionMul(Value.Dual, QuaternionConjugate(Value.Real));
+    return Translation.XYZ * 2.0f;
+}
+
+inline f32x3 DualQuaternionTransformPoint(dual_quaternion Value, f32x3 Point)
+{
+    return QuaternionRotateVector(Value.Real, Point) + DualQuaternionGetTranslation(Value);
+}
+
+inline f32x44 DualQuaternionToMatrix(dual_quaternion Value)
+{
+    f32x44 Result = QuaternionToRotationMatrix(Value.Real);
+    Result.C3.XYZ = DualQuaternionGetTranslation(Value);
+    return Result;
+}
+
 //
 // More Misc. / Geometric Functions
 //
@@ -1579,58 +2421,87 @@ inline f32x3 F32x3ComputeNormal(f32x3 Point0, f32x3 Point1, f32x3 Point2)
     return NormalVector.Norm();
 }
 
-inline f32 F32Random()
+// Each random function takes the generator to draw from (pcg32, xoshiro256 or xoshiro128x4, see random.h).
+// The overloads without a generator use the calling thread's RandomThreadGenerator().
+
+template<typename rng>
+inline f32 F32Random(rng& Rng)
 {
-    return f32(rand()) / (RAND_MAX + 1.0f);
+    return Rng.NextF32();
 }
 
-inline f32 F32RandomClamped(f32 Min, f32 Max)
+template<typename rng>
+inline f32 F32RandomClamped(rng& Rng, f32 Min, f32 Max)
 {
-    return Min + (Max - Min) * F32Random();
+    return Min + (Max - Min) * Rng.NextF32();
 }
 
-inline s32 S32RandomClamped(s32 Min, s32 Max)
+// Returns a value in [Min, Max)
+template<typename rng>
+inline s32 S32RandomClamped(rng& Rng, s32 Min, s32 Max)
 {
-    s32 Rand = rand();
-    return Min + Rand % (Max - Min);
+    return Min + s32(Rng.NextBounded(u32(Max - Min)));
 }
 
-
-inline f32x3 F32x3Random()
+template<typename rng>
+inline f32x3 F32x3Random(rng& Rng)
 {
     f32x3 Result;
 
-    Result.X = F32Random();
-    Result.Y = F32Random();
-    Result.Z = F32Random();
+    Result.X = Rng.NextF32();
+    Result.Y = Rng.NextF32();
+    Result.Z = Rng.NextF32();
 
     return Result;
 }
 
-inline f32x3 F32x3RandomClamped(f32 Min, f32 Max)
+template<typename rng>
+inline f32x3 F32x3RandomClamped(rng& Rng, f32 Min, f32 Max)
 {
     f32x3 Result;
 
-    Result.X = F32RandomClamped(Min, Max);
-    Result.Y = F32RandomClamped(Min, Max);
-    Result.Z = F32RandomClamped(Min, Max);
+    Result.X = F32RandomClamped(Rng, Min, Max);
+    Result.Y = F32RandomClamped(Rng, Min, Max);
+    Result.Z = F32RandomClamped(Rng, Min, Max);
 
     return Result;
 }
 
-inline f32x3 F32x3RandomInUnitSphere()
+// The samplers below map uniform values directly onto the shape (no rejection loops), so each
+// sample costs a fixed number of generator calls.
+
+// Maps two uniform values in [0, 1) to a uniformly distributed direction
+inline f32x3 F32x3UnitVectorFromUniform(f32 U, f32 V)
+{
+    f32 Z = 1.0f - 2.0f * U;
+    f32 A = 2.0f * F32_PI * V;
+    f32 R = sqrtf(fmaxf(0.0f, 1.0f - Z * Z));
+
+    f32 Sine, Cosine;
+    F32FastSinCos(A, &Sine, &Cosine);
+    return { R * Cosine, R * Sine, Z };
+}
+
+template<typename rng>
+inline f32x3 F32x3RandomUnitVector(rng& Rng)
 {
-    while (true)
-    {
-        f32x3 Ran = F32x3RandomClamped(-1.0f, 1.0f);
-        if (Ran.LengthSq() >= 1.0f) continue;
-        return Ran;
-    }
+    f32 U = Rng.NextF32();
+    f32 V = Rng.NextF32();
+    return F32x3UnitVectorFromUniform(U, V);
+}
+
+// The cube root of the radius keeps the points uniform over the volume.
+template<typename rng>
+inline f32x3 F32x3RandomInUnitSphere(rng& Rng)
+{
+    f32x3 Direction = F32x3RandomUnitVector(Rng);
+    return Direction * cbrtf(Rng.NextF32());
 }
 
-inline f32x3 F32x3RandomInHemisphere(f32x3 Normal)
+template<typename rng>
+inline f32x3 F32x3RandomInHemisphere(rng& Rng, f32x3 Normal)
 {
-    f32x3 RandomInSphere = F32x3RandomInUnitSphere();
+    f32x3 RandomInSphere = F32x3RandomInUnitSphere(Rng);
     if (Dot(RandomInSphere, Normal) > 0.0f)
     {
         return RandomInSphere;
@@ -1641,21 +2512,66 @@ inline f32x3 F32x3RandomInHemisphere(f32x3 Normal)
     }
 }
 
-inline f32x3 F32x3RandomUnitVector()
+// The square root of the radius keeps the points uniform over the area.
+template<typename rng>
+inline f32x3 F32x3RandomInUnitDisc(rng& Rng)
+{
+    f32 R = sqrtf(Rng.NextF32());
+    f32 A = 2.0f * F32_PI * Rng.NextF32();
+
+    f32 Sine, Cosine;
+    F32FastSinCos(A, &Sine, &Cosine);
+    return { R * Cosine, R * Sine, 0.0f };
+}
+
+inline f32   F32Random()                              { return F32Random(RandomThreadGenerator());                    }
+inline f32   F32RandomClamped(f32 Min, f32 Max)       { return F32RandomClamped(RandomThreadGenerator(), Min, Max);   }
+inline s32   S32RandomClamped(s32 Min, s32 Max)       { return S32RandomClamped(RandomThreadGenerator(), Min, Max);   }
+inline f32x3 F32x3Random()                            { return F32x3Random(RandomThreadGenerator());                  }
+inline f32x3 F32x3RandomClamped(f32 Min, f32 Max)     { return F32x3RandomClamped(RandomThreadGenerator(), Min, Max); }
+inline f32x3 F32x3RandomUnitVector()                  { return F32x3RandomUnitVector(RandomThreadGenerator());        }
+inline f32x3 F32x3RandomInUnitSphere()                { return F32x3RandomInUnitSphere(RandomThreadGenerator());      }
+inline f32x3 F32x3RandomInHemisphere(f32x3 Normal)    { return F32x3RandomInHemisphere(RandomThreadGenerator(), Normal); }
+inline f32x3 F32x3RandomInUnitDisc()                  { return F32x3RandomInUnitDisc(RandomThreadGenerator());        }
+
+// Bulk fills. The uniform values are generated 4 at a time with SSE2, then shaped.
+inline void F32x3RandomFillClamped(xoshiro128x4& Rng, f32x3* Out, u64 Count, f32 Min, f32 Max)
+{
+    static_assert(sizeof(f32x3) == 3 * sizeof(f32));
+    Rng.FillF32(Out->Ptr, Count * 3, Min, Max);
+}
+
+inline void F32x3RandomFillUnitVector(xoshiro128x4& Rng, f32x3* Out, u64 Count)
 {
-    f32 A = F32RandomClamped(0, 2 * F32_PI);
-    f32 Z = F32RandomClamped(-1, 1);
-    f32 R = sqrtf(1 - Z * Z);
-    return { R * cosf(A), R * sinf(A), Z };
+    constexpr u64 cBatch = 256;
+    f32 Uniform[2 * cBatch];
+
+    for (u64 Base = 0; Base < Count; Base += cBatch)
+    {
+        u64 BatchCount = (Count - Base < cBatch) ? Count - Base : cBatch;
+        Rng.FillF32(Uniform, 2 * BatchCount);
+
+        for (u64 i = 0; i < BatchCount; ++i)
+        {
+            Out[Base + i] = F32x3UnitVectorFromUniform(Uniform[2 * i], Uniform[2 * i + 1]);
+        }
+    }
 }
 
-inline f32x3  F32x3RandomInUnitDisc()
+inline void F32x3RandomFillInUnitSphere(xoshiro128x4& Rng, f32x3* Out, u64 Count)
 {
-    while (true)
+    constexpr u64 cBatch = 256;
+    f32 Uniform[3 * cBatch];
+
+    for (u64 Base = 0; Base < Count; Base += cBatch)
     {
-        f32x3 Ran = { F32RandomClamped(-1, 1), F32RandomClamped(-1, 1), 0};
-        if (Ran.LengthSq() >= 1.0f) continue;
-        return Ran;
+        u64 BatchCount = (Count - Base < cBatch) ? Count - Base : cBatch;
+        Rng.FillF32(Uniform, 3 * BatchCount);
+
+        for (u64 i = 0; i < BatchCount; ++i)
+        {
+            Out[Base + i] = F32x3UnitVectorFromUniform(Uniform[3 * i], Uniform[3 * i + 1]) * cbrtf(Uniform[3 * i + 2]);
+        }
     }
 }
 
@@ -1665,6 +2581,7 @@ inline f32x3 ReflectVector(f32x3 Vector, f32x3 Normal)
     // ReflectedVector = Vector - 2 * (Vector dot Normal) * Normal
     f32 CosTheta = Dot(Vector, Normal);
     f32x3 Result = Vector - 2.0f * CosTheta * Normal;
+    return Result;
 }
 
 inline f32x3 RefractVector(f32x3 IncidentVector, f32x3 Normal, f32 IndicesOfRefraction)
@@ -0,0 +1,527 @@
+//
+// Header-Only Packed Numeric Types
+//
+// Storage formats for vertex and GPU buffer data. These are conversion targets, not math types:
+// unpack to f32 before doing arithmetic.
+//
+// f16        - IEEE 754 binary16, round to nearest even. Converted with F16C when the build enables
+//              it (/arch:AVX2 or -mf16c), otherwise with SSE2 integer math, otherwise scalar.
+// snorm16    - [-1, 1] in a s16, matches DXGI_FORMAT_R16_SNORM
+// unorm8     - [0, 1] in a u8, matches DXGI_FORMAT_R8_UNORM
+// oct_normal - Unit vector folded onto an octahedron, stored as two snorm16 (4 bytes instead of 12).
+//              Decode with the same math in HLSL.
+//
+// f16  F32ToF16(f32 Value)                  f32  F16ToF32(f16 Value)
+// void F32ToF16Array(const f32* In, f16* Out, u64 Count)
+// void F16ToF32Array(const f16* In, f32* Out, u64 Count)
+//
+// snorm16 PackSnorm16(f32 Value)            f32  UnpackSnorm16(snorm16 Value)
+// unorm8  PackUnorm8(f32 Value)             f32  UnpackUnorm8(unorm8 Value)
+// void    PackSnorm16Array(const f32* In, snorm16* Out, u64 Count)
+// void    UnpackSnorm16Array(const snorm16* In, f32* Out, u64 Count)
+// void    PackUnorm8Array(const f32* In, unorm8* Out, u64 Count)
+// void    UnpackUnorm8Array(const unorm8* In, f32* Out, u64 Count)
+//
+// oct_normal OctNormalEncode(f32x3 Normal)  f32x3 OctNormalDecode(oct_normal Value)
+// void       OctNormalEncodeArray(const f32x3* In, oct_normal* Out, u64 Count)
+// void       OctNormalDecodeArray(const oct_normal* In, f32x3* Out, u64 Count)
+//
+// The float -> integer packers round to nearest and clamp out of range input (NaN becomes 0).
+// The array versions give the same bits as calling the scalar function on each element: NaN f16 is
+// always 0x7E00 (with the input sign), and a zero or NaN normal encodes to (0, 0), which decodes to +Z.
+//
+#pragma once
+
+#include "math.h"
+
+#include <string.h>
+
+struct f16     { u16 Bits;  };
+struct snorm16 { s16 Value; };
+struct unorm8  { u8  Value; };
+
+struct oct_normal
+{
+    snorm16 X;
+    snorm16 Y;
+};
+
+static_assert(sizeof(f16) == 2 && sizeof(snorm16) == 2 && sizeof(unorm8) == 1 && sizeof(oct_normal) == 4);
+
+namespace math_internal
+{
+    inline u32 F32AsU32(f32 Value) { u32 Result; memcpy(&Result, &Value, sizeof(Result)); return Result; }
+    inline f32 U32AsF32(u32 Value) { f32 Result; memcpy(&Result, &Value, sizeof(Result)); return Result; }
+
+#if SIMD_SSE2
+    // SSE2 versions of the scalar conversions below, both branches are computed and selected with masks.
+    // The f16 results are in the low 16 bits of each 32-bit lane.
+    inline __m128i F32ToF16SSE2(__m128 Value)
+    {
+        const __m128i SignMask    = _mm_set1_epi32(s32(0x80000000u));
+        const __m128i F16Max      = _mm_set1_epi32((127 + 16) << 23);
+        const __m128i F32Infinity = _mm_set1_epi32(255 << 23);
+        const __m128i DenormMagic = _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23);
+        const __m128i MinNormal   = _mm_set1_epi32(113 << 23);
+
+        __m128i Bits = _mm_castps_si128(Value);
+        __m128i Sign = _mm_and_si128(Bits, SignMask);
+        __m128i Abs  = _mm_xor_si128(Bits, Sign);
+
+        // Inf or NaN (NaN becomes a quiet NaN)
+        __m128i IsNaN    = _mm_cmpgt_epi32(Abs, F32Infinity);
+        __m128i Special  = _mm_or_si128(_mm_set1_epi32(0x7C00), _mm_and_si128(IsNaN, _mm_set1_epi32(0x0200)));
+
+        // Subnormal or zero: let the float adder do the rounding
+        __m128  Denorm   = _mm_add_ps(_mm_castsi128_ps(Abs), _mm_castsi128_ps(DenormMagic));
+        __m128i Small    = _mm_sub_epi32(_mm_castps_si128(Denorm), DenormMagic);
+
+        // Normal: rebias the exponent and round to nearest even
+        __m128i MantOdd  = _mm_and_si128(_mm_srli_epi32(Abs, 13), _mm_set1_epi32(1));
+        __m128i Normal   = _mm_add_epi32(Abs, _mm_set1_epi32(((15 - 127) << 23) + 0xFFF));
+        Normal           = _mm_srli_epi32(_mm_add_epi32(Normal, MantOdd), 13);
+
+        __m128i IsSpecial = _mm_cmpgt_epi32(F16Max, Abs);  // inverted: true when not special
+        __m128i IsSmall   = _mm_cmpgt_epi32(MinNormal, Abs);
+
+        __m128i Result = _mm_or_si128(_mm_and_si128(IsSmall, Small), _mm_andnot_si128(IsSmall, Normal));
+        Result         = _mm_or_si128(_mm_and_si128(IsSpecial, Result), _mm_andnot_si128(IsSpecial, Special));
+        return _mm_or_si128(Result, _mm_srli_epi32(Sign, 16));
+    }
+
+    // Input is one f16 in the low 16 bits of each 32-bit lane
+    inline __m128 F16ToF32SSE2(__m128i Value)
+    {
+        const __m128i ShiftedExp = _mm_set1_epi32(0x7C00 << 13);
+        const __m128  Magic      = _mm_castsi128_ps(_mm_set1_epi32(113 << 23));
+
+        __m128i Bits     = _mm_slli_epi32(_mm_and_si128(Value, _mm_set1_epi32(0x7FFF)), 13);
+        __m128i Exponent = _mm_and_si128(Bits, ShiftedExp);
+        Bits             = _mm_add_epi32(Bits, _mm_set1_epi32((127 - 15) << 23));
+
+        __m128i IsSpecial = _mm_cmpeq_epi32(Exponent, ShiftedExp);
+        __m128i IsSmall   = _mm_cmpeq_epi32(Exponent, _mm_setzero_si128());
+
+        // Inf/NaN: extra exponent adjust. Zero/subnormal: adjust, then renormalize through the FPU.
+        __m128i Special = _mm_add_epi32(Bits, _mm_set1_epi32((128 - 16) << 23));
+        __m128  Small   = _mm_sub_ps(_mm_castsi128_ps(_mm_add_epi32(Bits, _mm_set1_epi32(1 << 23))), Magic);
+
+        __m128i Result = _mm_or_si128(_mm_and_si128(IsSpecial, Special), _mm_andnot_si128(IsSpecial, Bits));
+        Result         = _mm_or_si128(_mm_and_si128(IsSmall, _mm_castps_si128(Small)), _mm_andnot_si128(IsSmall, Result));
+
+        __m128i Sign = _mm_slli_epi32(_mm_and_si128(Value, _mm_set1_epi32(0x8000)), 16);
+        return _mm_castsi128_ps(_mm_or_si128(Result, Sign));
+    }
+
+    // OctNormalDecode for 4 normals, X and Y are the unpacked snorm16 values. The scalar OctNormalDecode
+    // runs this on one lane, so both give the same bits however the compiler contracts scalar math.
+    inline void OctNormalDecodeSSE2(__m128* X, __m128* Y, __m128* Z)
+    {
+        const __m128 SignMask = _mm_castsi128_ps(_mm_set1_epi32(s32(0x80000000u)));
+        const __m128 One      = _mm_set1_ps(1.0f);
+        const __m128 MinLenSq = _mm_set1_ps(std::numeric_limits<f32>::min());
+
+        __m128 ResultX = *X;
+        __m128 ResultY = *Y;
+        __m128 ResultZ = _mm_sub_ps(_mm_sub_ps(One, _mm_andnot_ps(SignMask, ResultX)), _mm_andnot_ps(SignMask, ResultY));
+
+        // Unfold the lower hemisphere: subtract Fold from positive components, add it to negative ones
+        __m128 Fold = _mm_max_ps(_mm_xor_ps(ResultZ, SignMask), _mm_setzero_ps());
+        ResultX     = _mm_add_ps(ResultX, _mm_xor_ps(Fold, _mm_and_ps(_mm_cmpge_ps(ResultX, _mm_setzero_ps()), SignMask)));
+        ResultY     = _mm_add_ps(ResultY, _mm_xor_ps(Fold, _mm_and_ps(_mm_cmpge_ps(ResultY, _mm_setzero_ps()), SignMask)));
+
+        // f32x3::Norm
+        __m128 LenSq  = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ResultX, ResultX), _mm_mul_ps(ResultY, ResultY)), _mm_mul_ps(ResultZ, ResultZ));
+        __m128 Valid  = _mm_cmpge_ps(LenSq, MinLenSq);
+        __m128 InvLen = _mm_or_ps(_mm_and_ps(Valid, F32x4FastRsqrt(LenSq)), _mm_andnot_ps(Valid, One));
+
+        *X = _mm_mul_ps(ResultX, InvLen);
+        *Y = _mm_mul_ps(ResultY, InvLen);
+        *Z = _mm_mul_ps(ResultZ, InvLen);
+    }
+
+    // Packs the low 16 bits of each lane of two registers into 8 u16 (no saturation)
+    inline __m128i PackLow16(__m128i Low, __m128i High)
+    {
+        // Sign extend the low 16 bits so the signed saturating pack passes them through unchanged
+        Low  = _mm_srai_epi32(_mm_slli_epi32(Low,  16), 16);
+        High = _mm_srai_epi32(_mm_slli_epi32(High, 16), 16);
+        return _mm_packs_epi32(Low, High);
+    }
+#endif
+}
+
+//
+// f16
+//
+
+inline f16 F32ToF16(f32 Value)
+{
+    u32 Bits = math_internal::F32AsU32(Value);
+    u32 Sign = Bits & 0x80000000u;
+    Bits ^= Sign;
+
+    u32 Result;
+    if (Bits >= ((127 + 16) << 23))
+    { // Inf or NaN
+        Result = (Bits > (255u << 23)) ? 0x7E00 : 0x7C00;
+    }
+    else if (Bits < (113 << 23))
+    { // Subnormal or zero, the float add rounds to nearest even
+        constexpr u32 DenormMagic = ((127 - 15) + (23 - 10) + 1) << 23;
+        f32 Denorm = math_internal::U32AsF32(Bits) + math_internal::U32AsF32(DenormMagic);
+        Result     = math_internal::F32AsU32(Denorm) - DenormMagic;
+    }
+    else
+    { // Normal, rebias the exponent and round to nearest even
+        u32 MantissaOdd = (Bits >> 13) & 1;
+        Bits  += ((15 - 127) << 23) + 0xFFF;
+        Bits  += MantissaOdd;
+        Result = Bits >> 13;
+    }
+
+    return { u16(Result | (Sign >> 16)) };
+}
+
+inline f32 F16ToF32(f16 Value)
+{
+    constexpr u32 ShiftedExp = 0x7C00 << 13;
+
+    u32 Bits     = u32(Value.Bits & 0x7FFF) << 13;
+    u32 Exponent = Bits & ShiftedExp;
+    Bits += (127 - 15) << 23;
+
+    if (Exponent == ShiftedExp)
+    { // Inf/NaN
+        Bits += (128 - 16) << 23;
+    }
+    else if (Exponent == 0)
+    { // Zero/Subnormal
+        Bits += 1 << 23;
+        Bits  = math_internal::F32AsU32(math_internal::U32AsF32(Bits) - math_internal::U32AsF32(113 << 23));
+    }
+
+    Bits |= u32(Value.Bits & 0x8000) << 16;
+    return math_internal::U32AsF32(Bits);
+}
+
+inline void F32ToF16Array(const f32* In, f16* Out, u64 Count)
+{
+    u64 i = 0;
+#if SIMD_F16C
+    // F16C keeps the top of the NaN payload, the scalar path returns the canonical quiet NaN.
+    // Replace NaN lanes with the f32 quiet NaN (keeping the sign), which converts to 0x7E00.
+    const __m128 SignMask = _mm_castsi128_ps(_mm_set1_epi32(s32(0x80000000u)));
+    const __m128 QuietNaN = _mm_castsi128_ps(_mm_set1_epi32(0x7FC00000));
+    auto CanonicalNaN = [&](__m128 Value) {
+        __m128 IsNaN = _mm_cmpunord_ps(Value, Value);
+        __m128 NaN   = _mm_or_ps(_mm_and_ps(Value, SignMask), QuietNaN);
+        return _mm_or_ps(_mm_and_ps(IsNaN, NaN), _mm_andnot_ps(IsNaN, Value));
+    };
+
+    for (; i + 8 <= Count; i += 8)
+    {
+        __m128i Low  = _mm_cvtps_ph(CanonicalNaN(_mm_loadu_ps(In + i)),     _MM_FROUND_TO_NEAREST_INT);
+        __m128i High = _mm_cvtps_ph(CanonicalNaN(_mm_loadu_ps(In + i + 4)), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128((__m128i*)(Out + i), _mm_unpacklo_epi64(Low, High));
+    }
+#elif SIMD_SSE2
+    for (; i + 8 <= Count; i += 8)
+    {
+        __m128i Low  = math_internal::F32ToF16SSE2(_mm_loadu_ps(In + i));
+        __m128i High = math_internal::F32ToF16SSE2(_mm_loadu_ps(In + i + 4));
+        _mm_storeu_si128((__m128i*)(Out + i), math_internal::PackLow16(Low, High));
+    }
+#endif
+    for (; i < Count; ++i)
+    {
+        Out[i] = F32ToF16(In[i]);
+    }
+}
+
+inline void F16ToF32Array(const f16* In, f32* Out, u64 Count)
+{
+    u64 i = 0;
+#if SIMD_F16C
+    for (; i + 8 <= Count; i += 8)
+    {
+        __m128i Halves = _mm_loadu_si128((const __m128i*)(In + i));
+        _mm_storeu_ps(Out + i,     _mm_cvtph_ps(Halves));
+        _mm_storeu_ps(Out + i + 4, _mm_cvtph_ps(_mm_unpackhi_epi64(Halves, Halves)));
+    }
+#elif SIMD_SSE2
+    for (; i + 8 <= Count; i += 8)
+    {
+        __m128i Halves = _mm_loadu_si128((const __m128i*)(In + i));
+        _mm_storeu_ps(Out + i,     math_internal::F16ToF32SSE2(_mm_unpacklo_epi16(Halves, _mm_setzero_si128())));
+        _mm_storeu_ps(Out + i + 4, math_internal::F16ToF32SSE2(_mm_unpackhi_epi16(Halves, _mm_setzero_si128())));
+    }
+#endif
+    for (; i < Count; ++i)
+    {
+        Out[i] = F16ToF32(In[i]);
+    }
+}
+
+//
+// snorm16 / unorm8
+//
+
+inline snorm16 PackSnorm16(f32 Value)
+{
+    Value = (Value == Value) ? F32Clamp(-1.0f, 1.0f, Value) : 0.0f;
+    return { s16(lrintf(Value * 32767.0f)) };
+}
+
+inline f32 UnpackSnorm16(snorm16 Value)
+{
+    // -32768 and -32767 both map to -1, as on the GPU
+    f32 Result = f32(Value.Value) * (1.0f / 32767.0f);
+    return (Result < -1.0f) ? -1.0f : Result;
+}
+
+inline unorm8 PackUnorm8(f32 Value)
+{
+    Value = (Value == Value) ? F32Clamp(0.0f, 1.0f, Value) : 0.0f;
+    return { u8(lrintf(Value * 255.0f)) };
+}
+
+inline f32 UnpackUnorm8(unorm8 Value)
+{
+    return f32(Value.Value) * (1.0f / 255.0f);
+}
+
+inline void PackSnorm16Array(const f32* In, snorm16* Out, u64 Count)
+{
+    u64 i = 0;
+#if SIMD_SSE2
+    const __m128 Min   = _mm_set1_ps(-1.0f);
+    const __m128 Max   = _mm_set1_ps( 1.0f);
+    const __m128 Scale = _mm_set1_ps(32767.0f);
+    for (; i + 8 <= Count; i += 8)
+    {
+        // max/min return the second operand for NaN, so NaN clamps to -1 here; zero it first.
+        __m128 Low  = _mm_loadu_ps(In + i);
+        __m128 High = _mm_loadu_ps(In + i + 4);
+        Low  = _mm_and_ps(Low,  _mm_cmpord_ps(Low,  Low));
+        High = _mm_and_ps(High, _mm_cmpord_ps(High, High));
+
+        __m128i LowInt  = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(Low,  Min), Max), Scale));
+        __m128i HighInt = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(High, Min), Max), Scale));
+        _mm_storeu_si128((__m128i*)(Out + i), _mm_packs_epi32(LowInt, HighInt));
+    }
+#endif
+    for (; i < Count; ++i)
+    {
+        Out[i] = PackSnorm16(In[i]);
+    }
+}
+
+inline void UnpackSnorm16Array(const snorm16* In, f32* Out, u64 Count)
+{
+    u64 i = 0;
+#if SIMD_SSE2
+    const __m128 Scale = _mm_set1_ps(1.0f / 32767.0f);
+    const __m128 Min   = _mm_set1_ps(-1.0f);
+    for (; i + 8 <= Count; i += 8)
+    {
+        __m128i Values = _mm_loadu_si128((const __m128i*)(In + i));
+        __m128i Low    = _mm_srai_epi32(_mm_unpacklo_epi16(Values, Values), 16);
+        __m128i High   = _mm_srai_epi32(_mm_unpackhi_epi16(Values, Values), 16);
+        _mm_storeu_ps(Out + i,     _mm_max_ps(_mm_mul_ps(_mm_cvtepi32_ps(Low),  Scale), Min));
+        _mm_storeu_ps(Out + i + 4, _mm_max_ps(_mm_mul_ps(_mm_cvtepi32_ps(High), Scale), Min));
+    }
+#endif
+    for (; i < Count; ++i)
+    {
+        Out[i] = UnpackSnorm16(In[i]);
+    }
+}
+
+inline void PackUnorm8Array(const f32* In, unorm8* Out, u64 Count)
+{
+    u64 i = 0;
+#if SIMD_SSE2
+    const __m128 One   = _mm_set1_ps(1.0f);
+    const __m128 Scale = _mm_set1_ps(255.0f);
+
+    // max returns the second operand for NaN, so NaN clamps to 0
+    auto Convert = [&](const f32* Values) {
+        __m128 Value = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(Values), _mm_setzero_ps()), One);
+        return _mm_cvtps_epi32(_mm_mul_ps(Value, Scale));
+    };
+
+    for (; i + 16 <= Count; i += 16)
+    {
+        __m128i A = Convert(In + i +  0);
+        __m128i B = Convert(In + i +  4);
+        __m128i C = Convert(In + i +  8);
+        __m128i D = Convert(In + i + 12);
+        _mm_storeu_si128((__m128i*)(Out + i), _mm_packus_epi16(_mm_packs_epi32(A, B), _mm_packs_epi32(C, D)));
+    }
+#endif
+    for (; i < Count; ++i)
+    {
+        Out[i] = PackUnorm8(In[i]);
+    }
+}
+
+inline void UnpackUnorm8Array(const unorm8* In, f32* Out, u64 Count)
+{
+    u64 i = 0;
+#if SIMD_SSE2
+    const __m128 Scale = _mm_set1_ps(1.0f / 255.0f);
+    for (; i + 16 <= Count; i += 16)
+    {
+        __m128i Bytes = _mm_loadu_si128((const __m128i*)(In + i));
+        __m128i Low   = _mm_unpacklo_epi8(Bytes, _mm_setzero_si128());
+        __m128i High  = _mm_unpackhi_epi8(Bytes, _mm_setzero_si128());
+        _mm_storeu_ps(Out + i +  0, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(Low,  _mm_setzero_si128())), Scale));
+        _mm_storeu_ps(Out + i +  4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(Low,  _mm_setzero_si128())), Scale));
+        _mm_storeu_ps(Out + i +  8, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(High, _mm_setzero_si128())), Scale));
+        _mm_storeu_ps(Out + i + 12, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(High, _mm_setzero_si128())), Scale));
+    }
+#endif
+    for (; i < Count; ++i)
+    {
+        Out[i] = UnpackUnorm8(In[i]);
+    }
+}
+
+//
+// Octahedral Normals
+//
+// Project the unit vector onto the octahedron |x| + |y| + |z| = 1, then fold the lower half over the
+// upper half so the whole sphere maps onto the [-1, 1] square.
+//
+
+inline oct_normal OctNormalEncode(f32x3 Normal)
+{
+    f32 L1 = fabsf(Normal.X) + fabsf(Normal.Y) + fabsf(Normal.Z);
+    f32 X  = Normal.X / L1;
+    f32 Y  = Normal.Y / L1;
+
+    if (Normal.Z < 0.0f)
+    {
+        f32 FoldedX = (1.0f - fabsf(Y)) * ((X >= 0.0f) ? 1.0f : -1.0f);
+        f32 FoldedY = (1.0f - fabsf(X)) * ((Y >= 0.0f) ? 1.0f : -1.0f);
+        X = FoldedX;
+        Y = FoldedY;
+    }
+
+    return { PackSnorm16(X), PackSnorm16(Y) };
+}
+
+inline f32x3 OctNormalDecode(oct_normal Value)
+{
+#if SIMD_SSE2
+    __m128 X = _mm_set_ss(UnpackSnorm16(Value.X));
+    __m128 Y = _mm_set_ss(UnpackSnorm16(Value.Y));
+    __m128 Z;
+    math_internal::OctNormalDecodeSSE2(&X, &Y, &Z);
+    return { _mm_cvtss_f32(X), _mm_cvtss_f32(Y), _mm_cvtss_f32(Z) };
+#else
+    f32x3 Result;
+    Result.X = UnpackSnorm16(Value.X);
+    Result.Y = UnpackSnorm16(Value.Y);
+    Result.Z = 1.0f - fabsf(Result.X) - fabsf(Result.Y);
+
+    // Unfold the lower hemisphere
+    f32 Fold  = fmaxf(-Result.Z, 0.0f);
+    Result.X += (Result.X >= 0.0f) ? -Fold : Fold;
+    Result.Y += (Result.Y >= 0.0f) ? -Fold : Fold;
+
+    return Result.Norm();
+#endif
+}
+
+inline void OctNormalEncodeArray(const f32x3* In, oct_normal* Out, u64 Count)
+{
+    u64 i = 0;
+#if SIMD_SSE2
+    const __m128 AbsMask  = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+    const __m128 SignMask = _mm_castsi128_ps(_mm_set1_epi32(s32(0x80000000u)));
+    const __m128 One      = _mm_set1_ps(1.0f);
+    const __m128 MinusOne = _mm_set1_ps(-1.0f);
+    const __m128 Scale    = _mm_set1_ps(32767.0f);
+
+    for (; i + 4 <= Count; i += 4)
+    {
+        // AoS -> SoA for 4 normals
+        __m128 X = _mm_setr_ps(In[i].X, In[i + 1].X, In[i + 2].X, In[i + 3].X);
+        __m128 Y = _mm_setr_ps(In[i].Y, In[i + 1].Y, In[i + 2].Y, In[i + 3].Y);
+        __m128 Z = _mm_setr_ps(In[i].Z, In[i + 1].Z, In[i + 2].Z, In[i + 3].Z);
+
+        __m128 L1 = _mm_add_ps(_mm_add_ps(_mm_and_ps(X, AbsMask), _mm_and_ps(Y, AbsMask)), _mm_and_ps(Z, AbsMask));
+        X = _mm_div_ps(X, L1);
+        Y = _mm_div_ps(Y, L1);
+
+        // Folded = (1 - |other|) with the sign of this component (+1 for zero, like the scalar path)
+        __m128 SignX   = _mm_andnot_ps(_mm_cmpge_ps(X, _mm_setzero_ps()), SignMask);
+        __m128 SignY   = _mm_andnot_ps(_mm_cmpge_ps(Y, _mm_setzero_ps()), SignMask);
+        __m128 FoldedX = _mm_or_ps(_mm_sub_ps(One, _mm_and_ps(Y, AbsMask)), SignX);
+        __m128 FoldedY = _mm_or_ps(_mm_sub_ps(One, _mm_and_ps(X, AbsMask)), SignY);
+
+        __m128 Lower = _mm_cmplt_ps(Z, _mm_setzero_ps());
+        X = _mm_or_ps(_mm_and_ps(Lower, FoldedX), _mm_andnot_ps(Lower, X));
+        Y = _mm_or_ps(_mm_and_ps(Lower, FoldedY), _mm_andnot_ps(Lower, Y));
+
+        // Same as PackSnorm16: a zero length or NaN normal gives NaN here, which packs to 0
+        X = _mm_and_ps(X, _mm_cmpord_ps(X, X));
+        Y = _mm_and_ps(Y, _mm_cmpord_ps(Y, Y));
+        X = _mm_min_ps(_mm_max_ps(X, MinusOne), One);
+        Y = _mm_min_ps(_mm_max_ps(Y, MinusOne), One);
+
+        // Interleave X/Y and convert both to snorm16 in one pack
+        __m128i XInt = _mm_cvtps_epi32(_mm_mul_ps(X, Scale));
+        __m128i YInt = _mm_cvtps_epi32(_mm_mul_ps(Y, Scale));
+        __m128i XY   = _mm_packs_epi32(_mm_unpacklo_epi32(XInt, YInt), _mm_unpackhi_epi32(XInt, YInt));
+        _mm_storeu_si128((__m128i*)(Out + i), XY);
+    }
+#endif
+    for (; i < Count; ++i)
+    {
+        Out[i] = OctNormalEncode(In[i]);
+    }
+}
+
+inline void OctNormalDecodeArray(const oct_normal* In, f32x3* Out, u64 Count)
+{
+    u64 i = 0;
+#if SIMD_SSE2
+    static_assert(sizeof(f32x3) == 3 * sizeof(f32));
+
+    const __m128 MinusOne = _mm_set1_ps(-1.0f);
+    const __m128 Scale    = _mm_set1_ps(1.0f / 32767.0f);
+
+    for (; i + 4 <= Count; i += 4)
+    {
+        // X0 Y0 X1 Y1 and X2 Y2 X3 Y3, unpacked like UnpackSnorm16, then split into X and Y
+        __m128i Values = _mm_loadu_si128((const __m128i*)(In + i));
+        __m128  Low    = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(Values, Values), 16));
+        __m128  High   = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(Values, Values), 16));
+        Low            = _mm_max_ps(_mm_mul_ps(Low,  Scale), MinusOne);
+        High           = _mm_max_ps(_mm_mul_ps(High, Scale), MinusOne);
+
+        __m128 X = _mm_shuffle_ps(Low, High, _MM_SHUFFLE(2, 0, 2, 0));
+        __m128 Y = _mm_shuffle_ps(Low, High, _MM_SHUFFLE(3, 1, 3, 1));
+        __m128 Z;
+        math_internal::OctNormalDecodeSSE2(&X, &Y, &Z);
+
+        // SoA -> AoS: X0 Y0 Z0 X1 | Y1 Z1 X2 Y2 | Z2 X3 Y3 Z3
+        __m128 ZZXX01 = _mm_shuffle_ps(Z, X, _MM_SHUFFLE(1, 1, 0, 0));
+        __m128 YYZZ1  = _mm_shuffle_ps(Y, Z, _MM_SHUFFLE(1, 1, 1, 1));
+        __m128 ZZXX23 = _mm_shuffle_ps(Z, X, _MM_SHUFFLE(3, 3, 2, 2));
+        __m128 YYZZ3  = _mm_shuffle_ps(Y, Z, _MM_SHUFFLE(3, 3, 3, 3));
+
+        f32* Dst = &Out[i].X;
+        _mm_storeu_ps(Dst + 0, _mm_shuffle_ps(_mm_unpacklo_ps(X, Y), ZZXX01, _MM_SHUFFLE(2, 0, 1, 0)));
+        _mm_storeu_ps(Dst + 4, _mm_shuffle_ps(YYZZ1, _mm_unpackhi_ps(X, Y), _MM_SHUFFLE(1, 0, 2, 0)));
+        _mm_storeu_ps(Dst + 8, _mm_shuffle_ps(ZZXX23, YYZZ3, _MM_SHUFFLE(2, 0, 2, 0)));
+    }
+#endif
+    for (; i < Count; ++i)
+    {
+        Out[i] = OctNormalDecode(In[i]);
+    }
+}
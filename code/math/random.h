@@ -0,0 +1,263 @@
+//
+// Header-Only Pseudo Random Number Generators
+//
+// None of the generators use global state. Give each thread (or each job) its own generator; the
+// F32Random family in math.h falls back to a thread_local xoshiro256 when no generator is passed.
+//
+// pcg32        - 64-bit state, 32-bit output. Tiny and fast, with selectable streams.
+// xoshiro256   - 256-bit state, 64-bit output (xoshiro256**). Jump() advances 2^128 steps to split
+//                one seed into non-overlapping per-thread sequences.
+// xoshiro128x4 - four interleaved xoshiro128+ generators for bulk float fills, one SSE2 register
+//                per state word. The scalar fallback produces the exact same sequence.
+//
+// Every generator provides NextU32(), NextF32() in [0, 1) and NextBounded(Bound) in [0, Bound).
+//
+#pragma once
+
+#include <types.h>
+#include <util/simd.h>
+
+namespace random_internal
+{
+    // Used to expand a 64-bit seed into generator state.
+    inline u64 SplitMix64(u64* State)
+    {
+        u64 Result = (*State += 0x9E3779B97F4A7C15ull);
+        Result = (Result ^ (Result >> 30)) * 0xBF58476D1CE4E5B9ull;
+        Result = (Result ^ (Result >> 27)) * 0x94D049BB133111EBull;
+        return Result ^ (Result >> 31);
+    }
+
+    constexpr u64 RotateLeft64(u64 Value, u32 Shift) { return (Value << Shift) | (Value >> (64 - Shift)); }
+    constexpr u32 RotateLeft32(u32 Value, u32 Shift) { return (Value << Shift) | (Value >> (32 - Shift)); }
+    constexpr u32 RotateRight32(u32 Value, u32 Shift) { return (Value >> Shift) | (Value << ((32 - Shift) & 31)); }
+
+    // The top 24 bits fill a float mantissa exactly, giving a uniform value in [0, 1)
+    constexpr f32 U32ToUnitF32(u32 Value) { return f32(Value >> 8) * (1.0f / 16777216.0f); }
+
+    // Lemire's nearly divisionless bounded integer in [0, Bound)
+    template<typename rng>
+    inline u32 NextBounded(rng& Rng, u32 Bound)
+    {
+        u64 Product = u64(Rng.NextU32()) * u64(Bound);
+        u32 Low     = u32(Product);
+        if (Low < Bound)
+        {
+            u32 Threshold = (0u - Bound) % Bound;
+            while (Low < Threshold)
+            {
+                Product = u64(Rng.NextU32()) * u64(Bound);
+                Low     = u32(Product);
+            }
+        }
+        return u32(Product >> 32);
+    }
+}
+
+class pcg32
+{
+public:
+    pcg32() : pcg32(0x853C49E6748FEA9Bull) {}
+
+    explicit pcg32(u64 Seed, u64 Stream = 0xDA3E39CB94B95BDBull)
+    {
+        mIncrement = (Stream << 1) | 1;
+        mState     = 0;
+        NextU32();
+        mState    += Seed;
+        NextU32();
+    }
+
+    u32 NextU32()
+    {
+        u64 OldState = mState;
+        mState = OldState * 6364136223846793005ull + mIncrement;
+
+        u32 XorShifted = u32(((OldState >> 18) ^ OldState) >> 27);
+        u32 Rotation   = u32(OldState >> 59);
+        return random_internal::RotateRight32(XorShifted, Rotation);
+    }
+
+    f32 NextF32()                { return random_internal::U32ToUnitF32(NextU32());   }
+    u32 NextBounded(u32 Bound)   { return random_internal::NextBounded(*this, Bound); }
+
+private:
+    u64 mState     = 0;
+    u64 mIncrement = 0;
+};
+
+class xoshiro256
+{
+public:
+    xoshiro256() : xoshiro256(0x2545F4914F6CDD1Dull) {}
+
+    explicit xoshiro256(u64 Seed)
+    {
+        ForRange(u32, i, 4)
+        {
+            mState[i] = random_internal::SplitMix64(&Seed);
+        }
+    }
+
+    u64 NextU64()
+    {
+        u64 Result = random_internal::RotateLeft64(mState[1] * 5, 7) * 9;
+        u64 Temp   = mState[1] << 17;
+
+        mState[2] ^= mState[0];
+        mState[3] ^= mState[1];
+        mState[1] ^= mState[2];
+        mState[0] ^= mState[3];
+        mState[2] ^= Temp;
+        mState[3]  = random_internal::RotateLeft64(mState[3], 45);
+
+        return Result;
+    }
+
+    u32 NextU32()                { return u32(NextU64() >> 32);                        }
+    f32 NextF32()                { return random_internal::U32ToUnitF32(NextU32());    }
+    f64 NextF64()                { return f64(NextU64() >> 11) * (1.0 / 9007199254740992.0); }
+    u32 NextBounded(u32 Bound)   { return random_internal::NextBounded(*this, Bound);  }
+
+    // Equivalent to 2^128 calls to NextU64(). Seed one generator, then Jump() once per additional thread.
+    void Jump()
+    {
+        constexpr u64 cJump[] = { 0x180EC6D33CFD0ABAull, 0xD5A61266F0C9392Cull, 0xA9582618E03FC9AAull, 0x39ABDC4529B1661Cull };
+
+        u64 Result[4] = {};
+        for (u64 JumpWord : cJump)
+        {
+            ForRange(u32, Bit, 64)
+            {
+                if (JumpWord & (u64(1) << Bit))
+                {
+                    ForRange(u32, i, 4) Result[i] ^= mState[i];
+                }
+                NextU64();
+            }
+        }
+
+        ForRange(u32, i, 4) mState[i] = Result[i];
+    }
+
+private:
+    u64 mState[4] = {};
+};
+
+class xoshiro128x4
+{
+public:
+    xoshiro128x4() : xoshiro128x4(0x9E3779B97F4A7C15ull) {}
+
+    explicit xoshiro128x4(u64 Seed)
+    {
+        ForRange(u32, Lane, 4)
+        {
+            u64 Low  = random_internal::SplitMix64(&Seed);
+            u64 High = random_internal::SplitMix64(&Seed);
+            mState[0][Lane] = u32(Low);
+            mState[1][Lane] = u32(Low >> 32);
+            mState[2][Lane] = u32(High);
+            mState[3][Lane] = u32(High >> 32);
+        }
+    }
+
+    // Writes four outputs, one from each lane.
+    void Next4U32(u32 Out[4])
+    {
+#if SIMD_SSE2
+        __m128i S0 = _mm_load_si128((const __m128i*)mState[0]);
+        __m128i S1 = _mm_load_si128((const __m128i*)mState[1]);
+        __m128i S2 = _mm_load_si128((const __m128i*)mState[2]);
+        __m128i S3 = _mm_load_si128((const __m128i*)mState[3]);
+
+        _mm_storeu_si128((__m128i*)Out, _mm_add_epi32(S0, S3));
+
+        __m128i Temp = _mm_slli_epi32(S1, 9);
+        S2 = _mm_xor_si128(S2, S0);
+        S3 = _mm_xor_si128(S3, S1);
+        S1 = _mm_xor_si128(S1, S2);
+        S0 = _mm_xor_si128(S0, S3);
+        S2 = _mm_xor_si128(S2, Temp);
+        S3 = _mm_or_si128(_mm_slli_epi32(S3, 11), _mm_srli_epi32(S3, 21));
+
+        _mm_store_si128((__m128i*)mState[0], S0);
+        _mm_store_si128((__m128i*)mState[1], S1);
+        _mm_store_si128((__m128i*)mState[2], S2);
+        _mm_store_si128((__m128i*)mState[3], S3);
+#else
+        ForRange(u32, Lane, 4)
+        {
+            u32& S0 = mState[0][Lane];
+            u32& S1 = mState[1][Lane];
+            u32& S2 = mState[2][Lane];
+            u32& S3 = mState[3][Lane];
+
+            Out[Lane] = S0 + S3;
+
+            u32 Temp = S1 << 9;
+            S2 ^= S0;
+            S3 ^= S1;
+            S1 ^= S2;
+            S0 ^= S3;
+            S2 ^= Temp;
+            S3  = random_internal::RotateLeft32(S3, 11);
+        }
+#endif
+    }
+
+    // Uniform floats in [Min, Max)
+    void FillF32(f32* Out, u64 Count, f32 Min = 0.0f, f32 Max = 1.0f)
+    {
+        u64 i = 0;
+#if SIMD_SSE2
+        const __m128 Scale = _mm_set1_ps((Max - Min) * (1.0f / 16777216.0f));
+        const __m128 Bias  = _mm_set1_ps(Min);
+        for (; i + 4 <= Count; i += 4)
+        {
+            alignas(16) u32 Bits[4];
+            Next4U32(Bits);
+
+            __m128i Mantissa = _mm_srli_epi32(_mm_load_si128((const __m128i*)Bits), 8);
+            __m128  Value    = _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(Mantissa), Scale), Bias);
+            _mm_storeu_ps(Out + i, Value);
+        }
+#endif
+        while (i < Count)
+        {
+            u32 Bits[4];
+            Next4U32(Bits);
+            for (u32 Lane = 0; Lane < 4 && i < Count; ++Lane, ++i)
+            {
+                Out[i] = Min + (Max - Min) * random_internal::U32ToUnitF32(Bits[Lane]);
+            }
+        }
+    }
+
+    u32 NextU32()
+    {
+        if (mBufferedCount == 0)
+        {
+            Next4U32(mBuffered);
+            mBufferedCount = 4;
+        }
+        return mBuffered[--mBufferedCount];
+    }
+
+    f32 NextF32()                { return random_internal::U32ToUnitF32(NextU32());   }
+    u32 NextBounded(u32 Bound)   { return random_internal::NextBounded(*this, Bound); }
+
+private:
+    alignas(16) u32 mState[4][4] = {}; // [StateWord][Lane]
+    u32             mBuffered[4] = {};
+    u32             mBufferedCount = 0;
+};
+
+// Per-thread generator used by the F32Random family when no generator is given. Each thread is
+// seeded from the address of its own thread-local storage, so threads get different sequences.
+inline xoshiro256& RandomThreadGenerator()
+{
+    thread_local u8         Marker = 0;
+    thread_local xoshiro256 Generator(0x5851F42D4C957F2Dull ^ u64(&Marker));
+    return Generator;
+}
@@ -3,6 +3,17 @@
 
 #include <types.h>
 #include <util/bit.h>
+#include <util/str8.h>
+
+#include <atomic>
+#include <type_traits>
+#include <string.h>
+
+#if defined(_MSC_VER)
+# include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+# include <x86intrin.h>
+#endif
 
 //
 // Common Platform Functions
@@ -12,6 +23,9 @@ void PlatformInit();
 void PlatformDeinit();
 
 void PlatformSleepMainThread(u32 TimeMS);
+// Sleeps the calling thread for at least Nanoseconds. The OS rounds up to its scheduler granularity
+// (~1ms on Windows after PlatformInit, tens of microseconds on Linux), spin for anything more precise.
+void PlatformSleepNanoseconds(u64 Nanoseconds);
 
 //
 // Platform Window
@@ -79,6 +93,63 @@ private:
 	void*                 mInternalState      = nullptr;
 };
 
+//
+// Platform Clock
+//
+
+// The high resolution clock: QueryPerformanceCounter on Windows, CLOCK_MONOTONIC on Linux. Ticks never
+// go backwards and are comparable across threads. Keep time as integer ticks or nanoseconds and only
+// convert differences to floating point, an f64 of seconds since boot loses precision over long uptimes.
+u64 PlatformQueryTicks();
+u64 PlatformGetTickFrequency(); // ticks per second
+
+// Monotonic time in nanoseconds, from the same clock as PlatformQueryTicks.
+u64 PlatformQueryNanoseconds();
+
+fn_inline u64
+PlatformTicksToNanoseconds(u64 Ticks, u64 Frequency = PlatformGetTickFrequency())
+{ // Split so Ticks * 1e9 can't overflow
+	return (Ticks / Frequency) * 1'000'000'000 + ((Ticks % Frequency) * 1'000'000'000) / Frequency;
+}
+
+// CPU cycle counter (rdtsc on x64, the virtual counter on ARM64), for timing zones too short for the
+// high resolution clock. A read costs a few nanoseconds and doesn't enter the kernel. On x64 the counter
+// runs at a constant rate on any CPU made in the last decade (invariant TSC), but it is not the core
+// clock and it is only comparable across cores if the OS synchronized them, which Windows and Linux do.
+fn_inline u64
+PlatformReadCycleCounter()
+{
+#if defined(_M_X64) || defined(__x86_64__) || defined(_M_IX86) || defined(__i386__)
+	return __rdtsc();
+#elif defined(_M_ARM64)
+	return _ReadStatusReg(0x5F02); // CNTVCT_EL0
+#elif defined(__aarch64__)
+	u64 Value;
+	__asm__ volatile("mrs %0, cntvct_el0" : "=r"(Value));
+	return Value;
+#else
+	return PlatformQueryTicks();
+#endif
+}
+
+// Like PlatformReadCycleCounter, but waits for the instructions before it to finish (rdtscp), so the
+// end of a zone is not read early.
+fn_inline u64
+PlatformReadCycleCounterSerialized()
+{
+#if defined(_M_X64) || defined(__x86_64__) || defined(_M_IX86) || defined(__i386__)
+	u32 Aux;
+	return __rdtscp(&Aux);
+#else
+	return PlatformReadCycleCounter();
+#endif
+}
+
+// Cycle counter ticks per second, measured against the high resolution clock the first time it is
+// called (which takes ~10ms).
+u64 PlatformGetCycleCounterFrequency();
+fn_inline u64 PlatformCyclesToNanoseconds(u64 Cycles) { return PlatformTicksToNanoseconds(Cycles, PlatformGetCycleCounterFrequency()); }
+
 //
 // Platform Timer
 //
@@ -91,15 +162,255 @@ public:
 	void Start();
 	void Update();
 
+	u64 GetTicksElapsed()       const { return mElapsedTicks - mStartTicks;                                 }
+	u64 GetNanosecondsElapsed() const { return PlatformTicksToNanoseconds(GetTicksElapsed(), mFrequency); }
 	f64 GetSecondsElapsed()     const;
 	f64 GetMiliSecondsElapsed() const { return 1000.0 * GetSecondsElapsed(); }
 
 private:
-	f64 mFrequency   = 0.0;
-	f64 mStartTime   = 0.0;
-	f64 mElapsedTime = 0.0;
+	u64 mFrequency    = 0; // ticks per second
+	u64 mStartTicks   = 0;
+	u64 mElapsedTicks = 0;
 };
 
+//
+// Platform Frame Limiter
+//
+
+struct frame_time_stats
+{
+	u32 SampleCount;
+	// Full frame times, waiting included
+	u64 FrameP50Ns;
+	u64 FrameP99Ns;
+	u64 FrameMaxNs;
+	// Time between BeginFrame/EndFrame, i.e. how much of the frame was actual work
+	u64 WorkP50Ns;
+	u64 WorkP99Ns;
+	u64 WorkMaxNs;
+};
+
+// Paces the main loop to a fixed frame period. The remaining time of a frame is slept in one coarse
+// sleep that stops short of the deadline by the sleep overshoot seen so far, the rest is spun. Deadlines
+// are kept on a fixed grid so a late wake up is made up on the next frame instead of drifting, unless a
+// frame runs more than a whole period over, which starts a new grid.
+//
+// Usage:
+//     platform_frame_limiter Limiter = {};
+//     Limiter.SetTargetFrameRate(ClientWindow.GetMonitorRefreshRate());
+//     while (Running)
+//     {
+//         Limiter.BeginFrame();
+//         // ... frame ...
+//         Limiter.EndFrame();
+//     }
+class platform_frame_limiter
+{
+public:
+	static constexpr u32 cHistorySize = 256; // power of 2
+
+	// 0 disables the limiter, frames are only measured
+	void SetTargetFrameRate(f64 FramesPerSecond);
+	void SetTargetFramePeriod(u64 Nanoseconds) { mTargetPeriodNs = Nanoseconds; }
+	u64  GetTargetFramePeriod() const          { return mTargetPeriodNs;        }
+	bool IsUncapped()           const          { return mTargetPeriodNs == 0;   }
+
+	void BeginFrame();
+	// Waits until the end of the frame period and records the frame
+	void EndFrame();
+
+	// Percentiles over the last cHistorySize frames
+	frame_time_stats GetStats() const;
+
+private:
+	void WaitUntil(u64 DeadlineNs);
+
+	u64 mTargetPeriodNs      = 0;
+	u64 mDeadlineNs          = 0; // end of the current frame's period, 0 until the first frame
+	u64 mFrameStartNs        = 0;
+	u64 mSleepOvershootNs    = 0; // running estimate of how late the OS wakes us up
+
+	u64 mFrameTimesNs[cHistorySize] = {};
+	u64 mWorkTimesNs[cHistorySize]  = {};
+	u32 mFrameCount                 = 0;
+};
+
+//
+// Threads
+//
+
+using platform_thread_pfn = void (*)(void* UserData);
+
+// Logical processors the process can run on. Affinity masks cover the first 64 of them.
+u32  PlatformGetLogicalProcessorCount();
+u32  PlatformGetCurrentThreadId();
+void PlatformYieldThread();
+
+// Names the calling thread for debuggers and profilers. Linux keeps the first 15 characters.
+void PlatformSetThreadName(istr8 Name);
+// Restricts the calling thread to the logical processors set in AffinityMask.
+bool PlatformSetThreadAffinity(u64 AffinityMask);
+
+class platform_thread
+{
+public:
+	// An AffinityMask of 0 lets the thread run on any logical processor. Returns false (and logs) if
+	// the thread could not be created.
+	bool Start(platform_thread_pfn Function, void* UserData, istr8 Name = "", u64 AffinityMask = 0);
+	// Waits for the thread function to return.
+	void Join();
+
+	bool IsStarted() const { return mHandle != 0; }
+	bool SetAffinity(u64 AffinityMask);
+
+private:
+	u64 mHandle = 0; // pthread_t or HANDLE
+};
+
+// Dynamic thread local storage, for state owned by an object rather than a translation unit (where
+// thread_local is simpler). Every thread sees nullptr in a new slot.
+using platform_tls_slot = u32;
+
+// Returns false (and logs) when the process is out of slots.
+bool              PlatformAllocTlsSlot(platform_tls_slot* Slot);
+void              PlatformFreeTlsSlot(platform_tls_slot Slot);
+void*             PlatformGetTlsValue(platform_tls_slot Slot);
+void              PlatformSetTlsValue(platform_tls_slot Slot, void* Value);
+
+//
+// Synchronization
+//
+// Everything here is built on waiting on an address (futex on Linux, WaitOnAddress on Windows). The
+// state is a 32-bit word in user memory, so the uncontended paths are a single atomic instruction and
+// only a thread that has to block enters the kernel. The primitives are not copyable and need no
+// Init/Deinit, they can live in globals and in allocator memory.
+//
+
+constexpr u64 cPlatformWaitForever = U64_MAX;
+
+// Blocks while *Address == Expected, until woken or TimeoutNs passes. Wake ups can be spurious, so
+// check the condition again in a loop. Returns false on timeout.
+bool PlatformWaitOnAddress(const std::atomic<u32>* Address, u32 Expected, u64 TimeoutNs = cPlatformWaitForever);
+void PlatformWakeOne(const std::atomic<u32>* Address);
+void PlatformWakeAll(const std::atomic<u32>* Address);
+
+// Spin loop hint (pause on x64), lets the other hyperthread run and saves power while spinning.
+fn_inline void
+PlatformCpuRelax()
+{
+#if defined(_M_X64) || defined(__x86_64__) || defined(_M_IX86) || defined(__i386__)
+	_mm_pause();
+#elif defined(_M_ARM64)
+	__yield();
+#elif defined(__aarch64__)
+	__asm__ volatile("yield");
+#endif
+}
+
+// Process wide counts of the slow paths, to see how much time goes into blocking. Parks are the waits
+// that entered the kernel, wakes the wake calls that had to (a waiter was, or may have been, parked).
+struct platform_sync_stats
+{
+	u64 Parks;
+	u64 Wakes;
+};
+
+platform_sync_stats PlatformGetSyncStats();
+
+// Spins briefly before parking: most critical sections are shorter than a sleep/wake round trip.
+class platform_mutex
+{
+public:
+	static constexpr u32 cDefaultSpinCount = 128;
+
+	platform_mutex() = default;
+	explicit platform_mutex(u32 SpinCount) : mSpinCount(SpinCount) {}
+	platform_mutex(const platform_mutex&) = delete;
+	platform_mutex& operator=(const platform_mutex&) = delete;
+
+	void Lock();
+	bool TryLock();
+	void Unlock();
+
+private:
+	friend class platform_condition_variable;
+
+	// 0 unlocked, 1 locked, 2 locked and a thread may be parked (Drepper, "Futexes Are Tricky")
+	std::atomic<u32> mState     = 0;
+	u32              mSpinCount = cDefaultSpinCount;
+};
+
+// Locks a mutex for the lifetime of a scope.
+class platform_scoped_lock
+{
+public:
+	explicit platform_scoped_lock(platform_mutex& Mutex) : mMutex(Mutex) { mMutex.Lock(); }
+	~platform_scoped_lock() { mMutex.Unlock(); }
+
+	platform_scoped_lock(const platform_scoped_lock&) = delete;
+	platform_scoped_lock& operator=(const platform_scoped_lock&) = delete;
+
+private:
+	platform_mutex& mMutex;
+};
+
+class platform_condition_variable
+{
+public:
+	platform_condition_variable() = default;
+	platform_condition_variable(const platform_condition_variable&) = delete;
+	platform_condition_variable& operator=(const platform_condition_variable&) = delete;
+
+	// Unlocks Mutex while waiting and locks it again before returning. Can wake spuriously, wait in a
+	// loop on the condition. Returns false on timeout.
+	bool Wait(platform_mutex& Mutex, u64 TimeoutNs = cPlatformWaitForever);
+	void NotifyOne();
+	void NotifyAll();
+
+private:
+	std::atomic<u32> mSequence = 0; // bumped by every notify
+	std::atomic<u32> mWaiters  = 0;
+};
+
+// A flag threads can wait on. Manual reset events stay signaled and release every waiter until Reset,
+// auto reset events release one waiter and reset themselves.
+class platform_event
+{
+public:
+	platform_event() = default;
+	explicit platform_event(bool AutoReset) : mAutoReset(AutoReset) {}
+	platform_event(const platform_event&) = delete;
+	platform_event& operator=(const platform_event&) = delete;
+
+	void Signal();
+	void Reset();
+	bool IsSignaled() const { return mState.load(std::memory_order_acquire) != 0; }
+	// Returns false on timeout.
+	bool Wait(u64 TimeoutNs = cPlatformWaitForever);
+
+private:
+	std::atomic<u32> mState     = 0;
+	std::atomic<u32> mWaiters   = 0;
+	bool             mAutoReset = false;
+};
+
+class platform_semaphore
+{
+public:
+	platform_semaphore() = default;
+	explicit platform_semaphore(u32 InitialCount) : mCount(InitialCount) {}
+	platform_semaphore(const platform_semaphore&) = delete;
+	platform_semaphore& operator=(const platform_semaphore&) = delete;
+
+	void Signal(u32 Count = 1);
+	bool TryWait();
+	// Returns false on timeout.
+	bool Wait(u64 TimeoutNs = cPlatformWaitForever);
+
+private:
+	std::atomic<u32> mCount   = 0;
+	std::atomic<u32> mWaiters = 0;
+};
 
 //
 // Platform Logger
@@ -128,6 +439,15 @@ enum class log_level : u8
 	count,
 };
 
+// What a log call does when the queue to the log thread is full. Errors and fatals always block, they
+// are never dropped.
+enum class log_backpressure : u8
+{
+	block,     // wait for the log thread to make room
+	drop,      // discard the new message
+	overwrite, // discard the oldest queued message
+};
+
 enum class log_color : u8
 {
 	black,
@@ -149,29 +469,354 @@ enum class log_color : u8
 	max,
 };
 
-#define LogTrace(Fmt, ...) PlatformLogSystemLog(log_level::trace, __FILE__, __LINE__, Fmt, ##__VA_ARGS__)
-#define LogDebug(Fmt, ...) PlatformLogSystemLog(log_level::debug, __FILE__, __LINE__, Fmt, ##__VA_ARGS__)
-#define LogInfo(Fmt,  ...) PlatformLogSystemLog(log_level::info,  __FILE__, __LINE__, Fmt, ##__VA_ARGS__)
-#define LogWarn(Fmt,  ...) PlatformLogSystemLog(log_level::warn,  __FILE__, __LINE__, Fmt, ##__VA_ARGS__)
+// Log calls below this level compile to nothing, arguments are not evaluated. Values match log_level
+// (0 trace, 1 debug, 2 info, 3 warn). Debug builds keep every level, other builds drop Trace and Debug.
+// Errors and fatals are always kept. Define LOG_COMPILE_MIN_LEVEL to override.
+#ifndef LOG_COMPILE_MIN_LEVEL
+# if DEBUG_BUILD
+#  define LOG_COMPILE_MIN_LEVEL 0
+# else
+#  define LOG_COMPILE_MIN_LEVEL 2
+# endif
+#endif
+
+static_assert(u32(log_level::trace) == 0 && u32(log_level::warn) == 3, "LOG_COMPILE_MIN_LEVEL values follow log_level");
+
+// Keeps the arguments type checked (and variables only used by the log "used") without generating code.
+#define LogStripped(Fmt, ...) do { if constexpr (false) PlatformLogSystemLog(log_level::trace, nullptr, 0, Fmt, ##__VA_ARGS__); } while (0)
+
+// Trace and Debug are deferred: the call records its call site and copies the raw arguments, the log
+// thread does the formatting. See "Deferred Logging" below.
+#if LOG_COMPILE_MIN_LEVEL <= 0
+# define LogTrace(Fmt, ...) LogDeferred(log_level::trace, Fmt, ##__VA_ARGS__)
+#else
+# define LogTrace(Fmt, ...) LogStripped(Fmt, ##__VA_ARGS__)
+#endif
+
+#if LOG_COMPILE_MIN_LEVEL <= 1
+# define LogDebug(Fmt, ...) LogDeferred(log_level::debug, Fmt, ##__VA_ARGS__)
+#else
+# define LogDebug(Fmt, ...) LogStripped(Fmt, ##__VA_ARGS__)
+#endif
+
+#if LOG_COMPILE_MIN_LEVEL <= 2
+# define LogInfo(Fmt,  ...) PlatformLogSystemLog(log_level::info,  __FILE__, __LINE__, Fmt, ##__VA_ARGS__)
+#else
+# define LogInfo(Fmt,  ...) LogStripped(Fmt, ##__VA_ARGS__)
+#endif
+
+#if LOG_COMPILE_MIN_LEVEL <= 3
+# define LogWarn(Fmt,  ...) PlatformLogSystemLog(log_level::warn,  __FILE__, __LINE__, Fmt, ##__VA_ARGS__)
+#else
+# define LogWarn(Fmt,  ...) LogStripped(Fmt, ##__VA_ARGS__)
+#endif
+
 #define LogError(Fmt, ...) PlatformLogSystemLog(log_level::error, __FILE__, __LINE__, Fmt, ##__VA_ARGS__)
 #define LogFatal(Fmt, ...) PlatformLogSystemLog(log_level::fatal, __FILE__, __LINE__, Fmt, ##__VA_ARGS__)
 
+// Rate limited logging for messages that can repeat every frame. The state is a static per call site.
+// Level is a log_level value (log_level::warn), stripped at compile time like the macros above.
+//
+// LogOnce:        only the first call logs.
+// LogEvery:       the 1st, N+1th, 2N+1th, ... calls log.
+// LogRateLimited: at most one message per IntervalNs, the next one says how many were skipped.
+#define LogAtLevel(Level, Fmt, ...) PlatformLogSystemLog(Level, __FILE__, __LINE__, Fmt, ##__VA_ARGS__)
+
+constexpr bool
+LogIsCompiledIn(log_level Level)
+{
+	return s32(Level) >= s32(LOG_COMPILE_MIN_LEVEL) || Level >= log_level::error;
+}
+
+#define LogOnce(Level, Fmt, ...)                                                                     \
+	do {                                                                                             \
+		if constexpr (LogIsCompiledIn(Level))                                                        \
+		{                                                                                            \
+			static std::atomic<bool> LogHasLogged_ = false;                                          \
+			if (!LogHasLogged_.load(std::memory_order_relaxed) && !LogHasLogged_.exchange(true))     \
+				LogAtLevel(Level, Fmt, ##__VA_ARGS__);                                               \
+		}                                                                                            \
+	} while (0)
+
+#define LogEvery(N, Level, Fmt, ...)                                                                 \
+	do {                                                                                             \
+		if constexpr (LogIsCompiledIn(Level))                                                        \
+		{                                                                                            \
+			static std::atomic<u32> LogCallCount_ = 0;                                               \
+			if (LogCallCount_.fetch_add(1, std::memory_order_relaxed) % u32(N) == 0)                 \
+				LogAtLevel(Level, Fmt, ##__VA_ARGS__);                                               \
+		}                                                                                            \
+	} while (0)
+
+#define LogRateLimited(IntervalNs, Level, Fmt, ...)                                                  \
+	do {                                                                                             \
+		if constexpr (LogIsCompiledIn(Level))                                                        \
+		{                                                                                            \
+			static std::atomic<u64> LogNextNs_     = 0;                                              \
+			static std::atomic<u32> LogSuppressed_ = 0;                                              \
+			u64 LogNowNs_  = PlatformQueryNanoseconds();                                             \
+			u64 LogDueNs_  = LogNextNs_.load(std::memory_order_relaxed);                             \
+			if (LogNowNs_ >= LogDueNs_ &&                                                            \
+			    LogNextNs_.compare_exchange_strong(LogDueNs_, LogNowNs_ + u64(IntervalNs)))          \
+			{                                                                                        \
+				u32 LogSkipped_ = LogSuppressed_.exchange(0, std::memory_order_relaxed);             \
+				if (LogSkipped_ > 0) LogAtLevel(Level, Fmt " (%u similar messages suppressed)", ##__VA_ARGS__, LogSkipped_); \
+				else                 LogAtLevel(Level, Fmt, ##__VA_ARGS__);                          \
+			}                                                                                        \
+			else                                                                                     \
+			{                                                                                        \
+				LogSuppressed_.fetch_add(1, std::memory_order_relaxed);                              \
+			}                                                                                        \
+		}                                                                                            \
+	} while (0)
+
 // Platform Independent Log Implementation.
-void PlatformLogSystemInit(int InMemoryLogCount = 50);
+//
+// After Init, log calls format their message into a lock-free queue and return; a log thread adds the
+// prefix and writes to the sinks. Before Init and after Deinit messages are written on the calling thread.
+// Deinit writes out everything that is still queued, other threads should have stopped logging by then.
+void PlatformLogSystemInit(int InMemoryLogCount = 50, log_backpressure Backpressure = log_backpressure::block);
 void PlatformLogSystemDeinit();
+// Blocks until every message logged before the call has been written, log file included. LogFatal
+// flushes before exiting.
+void PlatformLogSystemFlush();
+// Messages discarded by log_backpressure::drop or log_backpressure::overwrite.
+u64  PlatformLogSystemGetDroppedCount();
+
+struct log_file_config
+{
+	istr8 Path            = {};
+	u64   MaxFileSize     = 16 * 1024 * 1024; // rotates once the file grows past this, 0 never rotates
+	u32   MaxRotatedFiles = 3;                // older files are kept as Path.1 (newest) to Path.N
+	u64   FlushIntervalNs = 1'000'000'000;    // longest a line sits in the buffer once the log thread runs, errors are written right away
+};
+
+// Log file sink, used when log_flags::file is set. Lines are buffered and appended to Config.Path.
+// Returns false (and logs) if the file can't be opened.
+bool PlatformLogSystemOpenFile(const log_file_config& Config);
+void PlatformLogSystemCloseFile();
+
+// The last InMemoryLogCount lines, kept when log_flags::editor is set. Lines are at most 256 bytes.
+using log_history_pfn = void (*)(void* UserData, log_level Level, istr8 Line);
+// Calls Callback for each line, oldest first. Holds the history lock, so Callback must not log.
+void PlatformLogSystemVisitHistory(log_history_pfn Callback, void* UserData);
 void PlatformLogSystemMinLogLevel(log_level MinLogLevel = log_level::trace);
 void PlatformLogSystemSetFlags(const log_flags_bitset& Flags);
 void PlatformLogSystemSetLogColor(log_level Level, log_color Foreground, log_color Background);
 void PlatformLogSystemLog(log_level LogLevel, const char* File, int Line, const char* Format, ...);
 
+//
+// Deferred Logging
+//
+
+// Everything about a log call that is known at compile time. One static descriptor per call site, the
+// address identifies the call site in the queue.
+struct log_call_site
+{
+	log_level   Level;
+	int         Line;
+	const char* File;
+	const char* Format;
+};
+
+// Arguments are stored as a tag byte followed by the value. Integers are widened the same way printf
+// varargs would be, strings are copied (u32 length, then the bytes) since the pointer may not outlive the
+// call. A null string is stored with cLogNullStringLength.
+enum class log_arg_type : u8
+{
+	s32,
+	u32,
+	s64,
+	u64,
+	f64,
+	pointer,
+	string,
+};
+
+constexpr u32 cLogNullStringLength = U32_MAX;
+
+fn_inline u32
+LogStringLength(const char* String)
+{
+	return String ? u32(strlen(String)) : cLogNullStringLength;
+}
+
+#define LogDeferred(Level, Fmt, ...)                                                           \
+	do {                                                                                       \
+		static constexpr log_call_site LogCallSite_ = { Level, __LINE__, __FILE__, Fmt };      \
+		PlatformLogSystemLogDeferred(&LogCallSite_, ##__VA_ARGS__);                            \
+	} while (0)
+
+// A queue slot reserved for the arguments of a deferred call.
+struct log_deferred_slot
+{
+	void* Record;
+	u64   Position;
+};
+
+// Returns where to write ArgsSize bytes of encoded arguments, or nullptr when the call is filtered out,
+// dropped, or has to be formatted right away (no log thread, or the arguments do not fit in a slot).
+// *FormatNow says which of the latter it is.
+u8*  PlatformLogSystemBeginDeferred(const log_call_site* Site, u64 ArgsSize, log_deferred_slot* Slot, bool* FormatNow);
+void PlatformLogSystemEndDeferred(const log_deferred_slot& Slot);
+
+template<typename T>
+constexpr log_arg_type
+LogArgType()
+{
+	using type = std::decay_t<T>;
+	if constexpr (std::is_same_v<type, char*> || std::is_same_v<type, const char*>) return log_arg_type::string;
+	else if constexpr (std::is_pointer_v<type> || std::is_null_pointer_v<type>)     return log_arg_type::pointer;
+	else if constexpr (std::is_floating_point_v<type>)                              return log_arg_type::f64;
+	else if constexpr (std::is_enum_v<type>)                                        return LogArgType<std::underlying_type_t<type>>();
+	else
+	{
+		static_assert(std::is_integral_v<type>, "Deferred log arguments must be integers, floats, pointers or C strings");
+		if constexpr (sizeof(type) < sizeof(int))       return log_arg_type::s32; // promoted to int
+		else if constexpr (sizeof(type) == sizeof(int)) return std::is_signed_v<type> ? log_arg_type::s32 : log_arg_type::u32;
+		else                                            return std::is_signed_v<type> ? log_arg_type::s64 : log_arg_type::u64;
+	}
+}
+
+template<typename T>
+fn_inline u64
+LogArgSize(const T& Value)
+{
+	constexpr log_arg_type Type = LogArgType<T>();
+	if constexpr (Type == log_arg_type::string)
+	{
+		u32 Length = LogStringLength(Value);
+		return 1 + sizeof(u32) + (Length != cLogNullStringLength ? Length : 0);
+	}
+	else if constexpr (Type == log_arg_type::s32 || Type == log_arg_type::u32)
+	{
+		return 1 + sizeof(u32);
+	}
+	else
+	{
+		return 1 + sizeof(u64);
+	}
+}
+
+template<typename T>
+fn_inline u8*
+LogEncodeArg(u8* Cursor, const T& Value)
+{
+	constexpr log_arg_type Type = LogArgType<T>();
+	*Cursor++ = u8(Type);
+
+	if constexpr (Type == log_arg_type::string)
+	{
+		u32 Length = LogStringLength(Value);
+		memcpy(Cursor, &Length, sizeof(Length));
+		if (Length == cLogNullStringLength) return Cursor + sizeof(Length);
+
+		memcpy(Cursor + sizeof(Length), Value, Length);
+		return Cursor + sizeof(Length) + Length;
+	}
+	else
+	{
+		if constexpr      (Type == log_arg_type::s32) { s32 Bits = s32(Value);       memcpy(Cursor, &Bits, sizeof(Bits)); }
+		else if constexpr (Type == log_arg_type::u32) { u32 Bits = u32(Value);       memcpy(Cursor, &Bits, sizeof(Bits)); }
+		else if constexpr (Type == log_arg_type::s64) { s64 Bits = s64(Value);       memcpy(Cursor, &Bits, sizeof(Bits)); }
+		else if constexpr (Type == log_arg_type::u64) { u64 Bits = u64(Value);       memcpy(Cursor, &Bits, sizeof(Bits)); }
+		else if constexpr (Type == log_arg_type::f64) { f64 Bits = f64(Value);       memcpy(Cursor, &Bits, sizeof(Bits)); }
+		else                                          { u64 Bits = u64(uptr(Value)); memcpy(Cursor, &Bits, sizeof(Bits)); }
+
+		return Cursor + (Type == log_arg_type::s32 || Type == log_arg_type::u32 ? sizeof(u32) : sizeof(u64));
+	}
+}
+
+template<typename... Args>
+void
+PlatformLogSystemLogDeferred(const log_call_site* Site, const Args&... Arguments)
+{
+	u64 ArgsSize = (u64(0) + ... + LogArgSize(Arguments));
+
+	log_deferred_slot Slot;
+	bool              FormatNow = false;
+	if (u8* Cursor = PlatformLogSystemBeginDeferred(Site, ArgsSize, &Slot, &FormatNow))
+	{
+		((Cursor = LogEncodeArg(Cursor, Arguments)), ...);
+		PlatformLogSystemEndDeferred(Slot);
+	}
+	else if (FormatNow)
+	{
+		PlatformLogSystemLog(Site->Level, Site->File, Site->Line, Site->Format, Arguments...);
+	}
+}
+
+// Formats encoded arguments with the call site's format string. Returns the length written, or the
+// length that would have been written if it does not fit. Usable by offline tools that read raw records.
+u64 PlatformLogSystemDecodeDeferred(char* Buffer, u64 BufferSize, const char* Format, const u8* Args, u64 ArgsSize);
+
 // Platform Dependent Log Implementation
 void PlatformLogToConsole(bool IsError, log_color Foreground, log_color Background, const struct istr8& Message);
 void PlatformLogToDebugConsole(const struct istr8& Message);
+// Log file handles, 0 is never a valid handle. Open appends to the file, creating it if needed. None of
+// these log, they run inside the logger.
+u64  PlatformLogFileOpen(istr8 Path, u64* FileSize);
+bool PlatformLogFileWrite(u64 File, const void* Data, u64 Size);
+void PlatformLogFileClose(u64 File);
+// Replaces To if it exists.
+bool PlatformLogFileRename(istr8 From, istr8 To);
+bool PlatformLogFileDelete(istr8 Path);
 
 // Exit the current application. This is the equivalent of an app crash. Useful for error states
-// that aren't detected with assert. LogFatal is an example of this usage.
+// that aren't detected with assert. LogFatal is an example of this usage. The process exits with
+// EXIT_FAILURE, so scripts and CI see the failure.
 void PlatformExitProcess();
 
+//
+// Virtual Memory
+//
+
+enum class page_hint : u8
+{
+	normal,
+	// Asks the OS to back the range with huge pages (2MB on x64) when it can, e.g. for large buffers
+	// touched every frame, to cut TLB misses. Linux only (madvise), normal pages elsewhere.
+	transparent_huge,
+	// Explicit huge pages: hugetlbfs pages on Linux, large pages on Windows (which needs the "Lock pages
+	// in memory" privilege). They are locked in memory, so the whole reservation is committed up front
+	// and stays committed until it is released. Falls back to transparent_huge, then normal.
+	huge,
+};
+
+enum class page_protection : u8
+{
+	none,       // any access faults, e.g. guard pages
+	read,
+	read_write,
+};
+
+// Reserved address space. Only committed pages can be accessed.
+struct platform_reservation
+{
+	u8*       Base     = nullptr;
+	u64       Size     = 0;                 // rounded up to PageSize
+	u64       PageSize = 0;                 // granularity of Commit, Decommit and Protect
+	page_hint Pages    = page_hint::normal; // the kind of pages that were actually used
+};
+
+u64  PlatformGetPageSize();
+// 0 if the platform has no huge pages
+u64  PlatformGetHugePageSize();
+
+// Reserves Size bytes of address space without using any memory, so a buffer can grow in place up to
+// Size with stable addresses. Returns false (and logs) if the address space could not be reserved.
+bool PlatformReserve(u64 Size, platform_reservation* Reservation, page_hint Hint = page_hint::normal);
+void PlatformRelease(platform_reservation* Reservation);
+
+// Offset and Size are rounded out to whole pages. Committed memory is zeroed and read_write, the OS
+// only backs it with physical pages once it is touched.
+bool PlatformCommit(const platform_reservation& Reservation, u64 Offset, u64 Size);
+// Returns the pages to the OS and makes the range inaccessible. Commit them again to reuse them, they
+// come back zeroed. Does nothing for huge pages.
+void PlatformDecommit(const platform_reservation& Reservation, u64 Offset, u64 Size);
+// Changes the access of committed pages, e.g. none for guard pages or read once data is baked.
+bool PlatformProtect(const platform_reservation& Reservation, u64 Offset, u64 Size, page_protection Protection);
+
 //
 // File I/O
 // 
@@ -179,4 +824,136 @@ void PlatformExitProcess();
 // AbsolutePath - utf8 filepath. On windows this will be converted to utf16 - this is a requirement for File I/O on Windows.
 bool PlatformLoadFileIntoBuffer(class allocator& Allocator, istr8 AbsolutePath, u8** Buffer, u64* BufferSize);
 
+// How a mapped file is going to be read. Lets the OS pick the read-ahead (and what to evict) when paging it in.
+enum class file_access_hint : u8
+{
+	normal,     // default read-ahead
+	sequential, // read front to back once, aggressive read-ahead and pages can be dropped after use
+	random,     // scattered reads (e.g. lookups in an asset pack), no read-ahead
+	will_need,  // the whole range is about to be read, start paging it in now
+};
+
+// Read-only view of a whole file. Pages are read in on first access and are backed by the OS file
+// cache, so there is no copy and no second buffer the size of the file.
+struct platform_mapped_file
+{
+	const u8* Data = nullptr; // nullptr for empty files
+	u64       Size = 0;
+};
+
+// Files of any size can be mapped on 64-bit targets. Returns false (and logs) if the file could not be
+// opened or mapped. The view stays valid until PlatformUnmapFile, even if the file is deleted.
+bool PlatformMapFile(istr8 AbsolutePath, platform_mapped_file* File, file_access_hint Hint = file_access_hint::normal);
+void PlatformUnmapFile(platform_mapped_file* File);
+// Changes the hint for part of a mapped file, e.g. will_need for the next chunk of a streamed pack.
+void PlatformAdviseMappedFile(const platform_mapped_file& File, u64 Offset, u64 Size, file_access_hint Hint);
+
+// Size of the file in bytes. Returns false if the file does not exist or can't be queried.
+bool PlatformGetFileSize(istr8 AbsolutePath, u64* Size);
+
+//
+// Async File I/O
+//
+
+struct platform_read_request
+{
+	istr8 AbsolutePath = {};      // utf8, only needs to live until Submit() returns
+	u64   Offset       = 0;
+	u64   Size         = 0;
+	void* Destination  = nullptr; // must stay valid until the read completes
+	void* UserData     = nullptr; // handed back in the completion
+};
+
+struct platform_read_completion
+{
+	void* UserData  = nullptr;
+	u64   BytesRead = 0;          // less than the requested Size if the file ended first
+	bool  Succeeded = false;      // false if the file could not be opened or a read failed
+};
+
+// Batched asynchronous file reads. Submit many reads at once, then Poll() or Wait() for completions,
+// doing other work in between. Files are read straight into the caller's buffers.
+//
+// Linux uses io_uring, so a batch is handed to the kernel in one syscall and the disk queue stays full.
+// If io_uring is not available (old kernels, seccomp) the reads run on a small pool of threads. Windows
+// uses overlapped reads on an I/O completion port.
+//
+// Not thread safe: submit and poll from one thread.
+//
+// Usage:
+//     platform_async_reader Reader = {};
+//     Reader.Init(Allocator);
+//     Reader.Submit(Requests, RequestCount);
+//
+//     platform_read_completion Completions[16];
+//     while (Reader.InFlight() > 0)
+//     {
+//         u32 Count = Reader.Wait(Completions, ArrayCount(Completions));
+//         // parse the files that finished while the rest are read...
+//     }
+//     Reader.Deinit();
+//
+class platform_async_reader
+{
+public:
+	static constexpr u32 cDefaultMaxInFlight = 64;
+
+	// MaxInFlight bounds the number of reads queued at once, Submit() takes fewer requests when full.
+	void Init(const allocator& Allocator, u32 MaxInFlight = cDefaultMaxInFlight);
+	// Waits for the reads still in flight, their completions are dropped.
+	void Deinit();
+
+	// Queues the requests and returns how many were taken, the rest must be submitted again later.
+	u32  Submit(const platform_read_request* Requests, u32 Count);
+	// Returns the reads that finished, without blocking.
+	u32  Poll(platform_read_completion* Completions, u32 MaxCompletions);
+	// Like Poll(), but blocks until at least one read finishes. Returns 0 only when nothing is in flight.
+	u32  Wait(platform_read_completion* Completions, u32 MaxCompletions);
+
+	// Reads submitted and not yet returned by Poll() or Wait().
+	u32  InFlight() const { return mInFlight; }
+
+private:
+	u32   mInFlight      = 0;
+	void* mInternalState = nullptr;
+};
+
+//
+// File Watcher
+//
+
+enum class file_change_type : u8
+{
+	modified,
+	created,  // also the new name of a renamed file, editors often save through a rename
+	removed,  // also the old name of a renamed file
+	overflow, // the OS dropped changes, RelativePath is empty and anything may have changed
+};
+
+using platform_file_change_pfn = void (*)(void* UserData, istr8 RelativePath, file_change_type Type);
+
+// Reports changes to the files in a directory and all of its subdirectories. Paths are relative to the
+// watched directory and use '/' separators.
+//
+// Linux uses inotify, with one watch per directory that follows directories as they are added and
+// removed. The files of a directory moved into the tree are reported as created. Windows uses
+// ReadDirectoryChangesW on the root, which is recursive, but also reports directories (a moved in
+// directory is one change), so callers should match the paths against the files they know about.
+//
+// Not thread safe: poll from one thread.
+class platform_file_watcher
+{
+public:
+	// Returns false (and logs) if the directory can't be watched.
+	bool Init(const allocator& Allocator, istr8 Directory);
+	void Deinit();
+
+	// Calls Callback for every change since the last Poll, without blocking. A burst of writes to one
+	// file is usually reported as several changes, callers are expected to coalesce them.
+	void Poll(platform_file_change_pfn Callback, void* UserData);
+
+private:
+	void* mInternalState = nullptr;
+};
+
 #endif //_PLATFORM_H_
\ No newline at end of file
@@ -1,14 +1,103 @@
 #include "platform.h"
 #include <util/str8.h>
 #include <util/bit.h>
+#include <util/allocator.h>
 
 #include <stdarg.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
-struct log_message
+// Messages are formatted straight into a queue slot. The rare message that does not fit is copied to
+// the heap and the slot points at it.
+var_global constexpr u32 cLogRecordSize      = 256;
+var_global constexpr u32 cLogQueueCapacity   = 4096; // must be a power of 2
+var_global constexpr u32 cLogWriteBufferSize = 64 * 1024;
+var_global constexpr u32 cLogDecodeBufferSize = 4096;
+var_global constexpr u32 cLogFileBufferSize   = 64 * 1024;
+var_global constexpr u32 cLogHistoryLineSize  = 256; // longer lines are cut in the history
+
+// Slot of a bounded MPMC queue (Vyukov). Sequence == the enqueue position when the slot is free,
+// position + 1 once it holds a message, and position + capacity after it has been read.
+//
+// A deferred record has a Site, and Message holds the encoded arguments instead of text.
+struct log_record
+{
+	std::atomic<u64>     Sequence;
+	log_level            Level;
+	u32                  ThreadId;
+	const char*          File;
+	int                  Line;
+	u32                  Length;
+	char*                Overflow;
+	const log_call_site* Site;
+
+	static constexpr u64 cHeaderSize = sizeof(std::atomic<u64>) + 2 * sizeof(u32) + sizeof(const char*) + 2 * sizeof(u32) + sizeof(char*) + sizeof(log_call_site*);
+	char                 Message[cLogRecordSize - cHeaderSize];
+
+	const char* Text() const { return Overflow ? Overflow : Message; }
+};
+static_assert(sizeof(log_record) == cLogRecordSize);
+
+struct alignas(64) log_queue
+{
+	log_record*           Records   = nullptr;
+	u64                   Mask      = 0;
+
+	alignas(64) std::atomic<u64> EnqueuePos = 0;
+	alignas(64) std::atomic<u64> DequeuePos = 0;
+
+	alignas(64) std::atomic<u64> DroppedCount = 0;
+
+	// The log thread parks on WakeEpoch when the queue is empty. Producers only touch it when
+	// WriterSleeping is set, so a busy log thread costs them nothing.
+	alignas(64) std::atomic<u32> WakeEpoch      = 0;
+	std::atomic<u32>             WriterSleeping = 0;
+
+	// Bumped after every batch the log thread writes, blocked producers and flushes park on it.
+	alignas(64) std::atomic<u32> DrainEpoch   = 0;
+	std::atomic<u32>             DrainWaiters = 0;
+
+	// A flush raises FlushTarget to the EnqueuePos it saw, then takes a ticket. The log thread serves
+	// the tickets once DequeuePos has passed the target and the file is written, the queue does not
+	// have to be empty, so a flush finishes while other threads keep logging.
+	std::atomic<u64>             FlushTarget    = 0;
+	std::atomic<u32>             FlushRequested = 0;
+	std::atomic<u32>             FlushServed    = 0;
+};
+
+// Lines are gathered in Buffer and written when it fills up, when FlushIntervalNs has passed, or on an
+// error. The file rotates on the flush that takes it past MaxFileSize.
+struct log_file_sink
+{
+	platform_mutex Lock;
+	u64            File            = 0;
+	mstr8          Path            = {};
+	u64            Size            = 0;
+	u64            MaxFileSize     = 0;
+	u32            MaxRotatedFiles = 0;
+	u64            FlushIntervalNs = 0;
+	u64            LastFlushNs     = 0;
+	char*          Buffer          = nullptr;
+	u64            BufferLength    = 0;
+};
+
+struct log_history_line
 {
 	log_level Level;
-	mstr8     Message;
+	u32       Length;
+	char*     Text; // cLogHistoryLineSize bytes of the slab
+};
+
+// Ring of the most recent lines, the text lives in one slab allocated up front.
+struct log_history
+{
+	platform_mutex    Lock;
+	log_history_line* Lines    = nullptr;
+	char*             Slab     = nullptr;
+	u32               Capacity = 0;
+	u32               First    = 0;
+	u32               Count    = 0;
 };
 
 struct platform_logger
@@ -32,37 +121,755 @@ struct platform_logger
 		log_color::dark_red, // fatal
 	};
 
-	// TODO: File I/O and Scrolling. 
-	// Instead of storing logs "In Memory" we can just keep an offset into
-	// a file. If the editor wants to display logs, we just read from the File.
-
-	// TODO:
-	// In Memory Logs if there is an editor to display them, this will be the "log history"
-	// or just a hueristic for reading from the Log File
-#if 0
-	log_message* InMemoryLogs;
-	u32          InMemoryLogMax;
-	u32          InMemoryLogFirst;
-	u32          InMemoryLogLast;
-#endif
+	log_file_sink                            FileSink                                = {};
+	log_history                              History                                 = {};
 
-	// TODO: Threading
-	// Proper synchronization for logs
+	log_backpressure                         Backpressure                            = log_backpressure::block;
+	log_queue                                Queue                                   = {};
+	platform_thread                          Writer                                  = {};
+	std::atomic<bool>                        IsAsync                                 = false;
+	std::atomic<bool>                        IsStopping                              = false;
+	char*                                    WriteBuffer                             = nullptr;
+	char*                                    DecodeBuffer                            = nullptr;
 };
 
 var_global platform_logger gLogger = {};
 
+// Set on the log thread, which must never wait on its own queue.
+var_global thread_local bool tIsLogWriter = false;
+// Cached, getting the id is a syscall on Linux.
+var_global thread_local u32  tLogThreadId = 0;
+
+var_global const char* cLogLevelNames[u32(log_level::count)] = {
+	"Trace",
+	"Debug",
+	"Info",
+	"Warn",
+	"Error",
+	"Fatal"
+};
+
+//
+// Formatting and Sinks
+//
+
+// [Trace] [Thread] File:Line Message
+// --- TODO: write out the Stack Trace
+// [Debug] [Thread] File:Line Message
+// [Info] Message
+// [Warn] Message
+// [Error] [Thread] File:Line Message
+// [Fatal] [Thread] File:Line Message
+//
+// Returns the length written, or the length that would have been written if it does not fit.
+fn_internal u64
+LogFormatLine(char* Buffer, u64 BufferSize, log_level Level, u32 ThreadId, const char* File, int Line, const char* Message, u64 MessageLength)
+{
+	int PrefixLength = 0;
+	if (Level != log_level::info && Level != log_level::warn)
+	{
+		PrefixLength = snprintf(Buffer, size_t(BufferSize), "[%s] [%u] %s:%d ", cLogLevelNames[u32(Level)], ThreadId, File, Line);
+	}
+	else
+	{
+		PrefixLength = snprintf(Buffer, size_t(BufferSize), "[%s] ", cLogLevelNames[u32(Level)]);
+	}
+
+	u64 Length = u64(PrefixLength) + MessageLength + 1;
+	if (Length < BufferSize)
+	{
+		memcpy(Buffer + PrefixLength, Message, MessageLength);
+		Buffer[Length - 1] = '\n';
+		Buffer[Length]     = 0;
+	}
+
+	return Length;
+}
+
+//
+// File Sink
+//
+
+// Path, Path.1, ... Path.MaxRotatedFiles, Index 0 is the live file.
+fn_internal istr8
+LogRotatedFilePath(char* Buffer, u64 BufferSize, const mstr8& Path, u32 Index)
+{
+	int Length = Index == 0 ? snprintf(Buffer, size_t(BufferSize), "%s", Path.Ptr()) : snprintf(Buffer, size_t(BufferSize), "%s.%u", Path.Ptr(), Index);
+	return istr8(Buffer, u64(Length) < BufferSize ? u64(Length) : BufferSize - 1);
+}
+
+// Sink lock must be held.
+fn_internal void
+LogFileRotate(log_file_sink& Sink)
+{
+	PlatformLogFileClose(Sink.File);
+	Sink.File = 0;
+
+	char FromPath[1024];
+	char ToPath[1024];
+	for (u32 Index = Sink.MaxRotatedFiles; Index > 0; --Index)
+	{ // Renaming over the oldest drops it
+		PlatformLogFileRename(LogRotatedFilePath(FromPath, sizeof(FromPath), Sink.Path, Index - 1),
+		                      LogRotatedFilePath(ToPath,   sizeof(ToPath),   Sink.Path, Index));
+	}
+
+	if (Sink.MaxRotatedFiles == 0)
+	{ // Nothing to keep, start over
+		PlatformLogFileDelete(Sink.Path);
+	}
+
+	Sink.File = PlatformLogFileOpen(Sink.Path, &Sink.Size);
+}
+
+// Sink lock must be held.
+fn_internal void
+LogFileFlush(log_file_sink& Sink)
+{
+	if (Sink.BufferLength > 0 && Sink.File)
+	{
+		PlatformLogFileWrite(Sink.File, Sink.Buffer, Sink.BufferLength);
+		Sink.Size += Sink.BufferLength;
+
+		if (Sink.MaxFileSize > 0 && Sink.Size >= Sink.MaxFileSize)
+		{
+			LogFileRotate(Sink);
+		}
+	}
+
+	Sink.BufferLength = 0;
+	Sink.LastFlushNs  = PlatformQueryNanoseconds();
+}
+
+fn_internal void
+LogFileAppend(log_level Level, istr8 Text)
+{
+	log_file_sink& Sink = gLogger.FileSink;
+	platform_scoped_lock Lock(Sink.Lock);
+	if (!Sink.File) return;
+
+	if (Sink.BufferLength + Text.Length() > cLogFileBufferSize)
+	{
+		LogFileFlush(Sink);
+	}
+
+	if (Text.Length() > cLogFileBufferSize)
+	{ // Larger than the whole buffer, write it as is
+		PlatformLogFileWrite(Sink.File, Text.Ptr(), Text.Length());
+		Sink.Size += Text.Length();
+	}
+	else
+	{
+		memcpy(Sink.Buffer + Sink.BufferLength, Text.Ptr(), Text.Length());
+		Sink.BufferLength += Text.Length();
+	}
+
+	// Errors go out right away, they are what is needed when the process dies before the next flush.
+	if (Level >= log_level::error || PlatformQueryNanoseconds() - Sink.LastFlushNs >= Sink.FlushIntervalNs)
+	{
+		LogFileFlush(Sink);
+	}
+}
+
+// Writes the buffer if it has been held for FlushIntervalNs. Returns how long until the next timed
+// flush is due, cPlatformWaitForever if there is nothing buffered.
+fn_internal u64
+LogFileFlushIfDue()
+{
+	log_file_sink& Sink = gLogger.FileSink;
+	platform_scoped_lock Lock(Sink.Lock);
+	if (Sink.BufferLength == 0) return cPlatformWaitForever;
+
+	u64 HeldNs = PlatformQueryNanoseconds() - Sink.LastFlushNs;
+	if (HeldNs >= Sink.FlushIntervalNs)
+	{
+		LogFileFlush(Sink);
+		return cPlatformWaitForever;
+	}
+
+	return Sink.FlushIntervalNs - HeldNs;
+}
+
+//
+// History
+//
+
+fn_internal void
+LogHistoryAppend(log_level Level, istr8 Text)
+{
+	log_history& History = gLogger.History;
+	if (History.Capacity == 0) return;
+
+	platform_scoped_lock Lock(History.Lock);
+
+	// Text can hold several lines of the same level, each one gets its own entry.
+	const char* LineBegin = Text.Ptr();
+	const char* TextEnd   = Text.Ptr() + Text.Length();
+	while (LineBegin < TextEnd)
+	{
+		const char* LineEnd = (const char*)memchr(LineBegin, '\n', size_t(TextEnd - LineBegin));
+		if (!LineEnd) LineEnd = TextEnd;
+
+		u32 Index = History.Count < History.Capacity ? (History.First + History.Count) % History.Capacity : History.First;
+		if (History.Count < History.Capacity) History.Count += 1;
+		else                                  History.First  = (History.First + 1) % History.Capacity;
+
+		log_history_line& Line = History.Lines[Index];
+		u64 Length = u64(LineEnd - LineBegin);
+		Line.Level  = Level;
+		Line.Length = u32(Length < cLogHistoryLineSize ? Length : cLogHistoryLineSize);
+		memcpy(Line.Text, LineBegin, Line.Length);
+
+		LineBegin = LineEnd + 1;
+	}
+}
+
+fn_internal void
+LogWriteToSinks(log_level Level, istr8 Text)
+{
+	if (gLogger.Flags.IsSet(log_flags::file))
+	{
+		LogFileAppend(Level, Text);
+	}
+
+	if (gLogger.Flags.IsSet(log_flags::editor))
+	{
+		LogHistoryAppend(Level, Text);
+	}
+
+	if (gLogger.Flags.IsSet(log_flags::console))
+	{
+		PlatformLogToConsole(Level > log_level::warn,
+			gLogger.ForegroundColors[u32(Level)],
+			gLogger.BackgroundColors[u32(Level)],
+			Text);
+	}
+
+#if _DEBUG
+	if (gLogger.Flags.IsSet(log_flags::debug_console))
+	{
+		PlatformLogToDebugConsole(Text);
+	}
+#endif
+}
+
+fn_internal u32
+LogCurrentThreadId()
+{
+	if (tLogThreadId == 0)
+	{
+		tLogThreadId = PlatformGetCurrentThreadId();
+	}
+	return tLogThreadId;
+}
+
+// Formats and writes a line right away, used when there is no log thread and for lines too long to batch.
+fn_internal void
+LogWriteLineNow(log_level Level, u32 ThreadId, const char* File, int Line, const char* Message, u64 MessageLength)
+{
+	constexpr u64 cStackLineSize = 2048;
+	char  StackLine[cStackLineSize];
+	char* LineBuffer = StackLine;
+
+	u64 Length   = LogFormatLine(StackLine, cStackLineSize, Level, ThreadId, File, Line, Message, MessageLength);
+	if (Length >= cStackLineSize)
+	{
+		LineBuffer = (char*)allocator::Default().AllocChunk(Length + 1);
+		LogFormatLine(LineBuffer, Length + 1, Level, ThreadId, File, Line, Message, MessageLength);
+	}
+
+	LogWriteToSinks(Level, istr8(LineBuffer, Length));
+
+	if (LineBuffer != StackLine)
+	{
+		allocator::Default().Free((void*)LineBuffer);
+	}
+}
+
+//
+// Log Queue
+//
+
+// Claims the next free slot, or returns nullptr when the queue is full.
+fn_internal log_record*
+LogQueueClaim(log_queue& Queue, u64* Position)
+{
+	u64 Pos = Queue.EnqueuePos.load(std::memory_order_relaxed);
+	while (true)
+	{
+		log_record* Record   = &Queue.Records[Pos & Queue.Mask];
+		u64         Sequence = Record->Sequence.load(std::memory_order_acquire);
+		s64         Diff     = s64(Sequence) - s64(Pos);
+
+		if (Diff == 0)
+		{
+			if (Queue.EnqueuePos.compare_exchange_weak(Pos, Pos + 1, std::memory_order_relaxed))
+			{
+				*Position = Pos;
+				return Record;
+			}
+		}
+		else if (Diff < 0)
+		{
+			return nullptr;
+		}
+		else
+		{
+			Pos = Queue.EnqueuePos.load(std::memory_order_relaxed);
+		}
+	}
+}
+
+fn_internal void
+LogQueuePublish(log_queue& Queue, log_record* Record, u64 Position)
+{
+	Record->Sequence.store(Position + 1, std::memory_order_release);
+
+	// Pairs with the fence in LogWriterMain: either the writer sees this record before it sleeps, or
+	// this sees the writer asleep and wakes it.
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (Queue.WriterSleeping.load(std::memory_order_relaxed))
+	{
+		Queue.WakeEpoch.fetch_add(1, std::memory_order_relaxed);
+		PlatformWakeOne(&Queue.WakeEpoch);
+	}
+}
+
+// Takes the oldest message, or returns nullptr when the queue is empty. LogQueueRelease hands the slot back.
+fn_internal log_record*
+LogQueueTake(log_queue& Queue, u64* Position)
+{
+	u64 Pos = Queue.DequeuePos.load(std::memory_order_relaxed);
+	while (true)
+	{
+		log_record* Record   = &Queue.Records[Pos & Queue.Mask];
+		u64         Sequence = Record->Sequence.load(std::memory_order_acquire);
+		s64         Diff     = s64(Sequence) - s64(Pos + 1);
+
+		if (Diff == 0)
+		{
+			if (Queue.DequeuePos.compare_exchange_weak(Pos, Pos + 1, std::memory_order_relaxed))
+			{
+				*Position = Pos;
+				return Record;
+			}
+		}
+		else if (Diff < 0)
+		{
+			return nullptr;
+		}
+		else
+		{
+			Pos = Queue.DequeuePos.load(std::memory_order_relaxed);
+		}
+	}
+}
+
+fn_internal void
+LogQueueRelease(log_queue& Queue, log_record* Record, u64 Position)
+{
+	if (Record->Overflow)
+	{
+		allocator::Default().Free((void*)Record->Overflow);
+		Record->Overflow = nullptr;
+	}
+
+	Record->Sequence.store(Position + Queue.Mask + 1, std::memory_order_release);
+}
+
+fn_internal bool
+LogQueueIsEmpty(const log_queue& Queue)
+{
+	u64 Pos = Queue.DequeuePos.load(std::memory_order_relaxed);
+	return Queue.Records[Pos & Queue.Mask].Sequence.load(std::memory_order_acquire) != Pos + 1;
+}
+
+// Parks until the log thread has written its next batch, or a short timeout passes.
+fn_internal void
+LogQueueWaitForDrain(log_queue& Queue)
+{
+	u32 Epoch = Queue.DrainEpoch.load(std::memory_order_acquire);
+	Queue.DrainWaiters.fetch_add(1, std::memory_order_seq_cst);
+
+	Queue.WakeEpoch.fetch_add(1, std::memory_order_relaxed);
+	PlatformWakeOne(&Queue.WakeEpoch);
+
+	PlatformWaitOnAddress(&Queue.DrainEpoch, Epoch, 1'000'000);
+	Queue.DrainWaiters.fetch_sub(1, std::memory_order_relaxed);
+}
+
+// Claims a slot, applying the backpressure policy when the queue is full. Returns nullptr if the
+// message should be dropped.
+fn_internal log_record*
+LogQueueClaimWithBackpressure(log_queue& Queue, log_level Level, u64* Position)
+{
+	log_backpressure Backpressure = Level >= log_level::error ? log_backpressure::block : gLogger.Backpressure;
+	while (true)
+	{
+		log_record* Record = LogQueueClaim(Queue, Position);
+		if (Record) return Record;
+
+		switch (Backpressure)
+		{
+			case log_backpressure::block:
+			{
+				LogQueueWaitForDrain(Queue);
+			} break;
+
+			case log_backpressure::drop:
+			{
+				Queue.DroppedCount.fetch_add(1, std::memory_order_relaxed);
+				return nullptr;
+			}
+
+			case log_backpressure::overwrite:
+			{
+				u64         OldestPosition;
+				log_record* Oldest = LogQueueTake(Queue, &OldestPosition);
+				if (Oldest)
+				{
+					Queue.DroppedCount.fetch_add(1, std::memory_order_relaxed);
+					LogQueueRelease(Queue, Oldest, OldestPosition);
+				}
+			} break;
+		}
+	}
+}
+
+//
+// Log Thread
+//
+
+// Appends a record to the write buffer, writing the buffer out first when the level changes (the
+// sinks color per level) or when it is full.
+fn_internal void
+LogWriterAppend(u64* BufferLength, log_level* BufferLevel, const log_record& Record, const char* Text, u64 TextLength)
+{
+	if (*BufferLength > 0 && *BufferLevel != Record.Level)
+	{
+		LogWriteToSinks(*BufferLevel, istr8(gLogger.WriteBuffer, *BufferLength));
+		*BufferLength = 0;
+	}
+
+	u64 Available = cLogWriteBufferSize - *BufferLength;
+	u64 Length    = LogFormatLine(gLogger.WriteBuffer + *BufferLength, Available, Record.Level, Record.ThreadId, Record.File, Record.Line, Text, TextLength);
+	if (Length >= Available)
+	{
+		if (*BufferLength > 0)
+		{
+			LogWriteToSinks(*BufferLevel, istr8(gLogger.WriteBuffer, *BufferLength));
+			*BufferLength = 0;
+			Available     = cLogWriteBufferSize;
+			Length        = LogFormatLine(gLogger.WriteBuffer, Available, Record.Level, Record.ThreadId, Record.File, Record.Line, Text, TextLength);
+		}
+
+		if (Length >= Available)
+		{ // Larger than the whole buffer
+			LogWriteLineNow(Record.Level, Record.ThreadId, Record.File, Record.Line, Text, TextLength);
+			return;
+		}
+	}
+
+	*BufferLength += Length;
+	*BufferLevel   = Record.Level;
+}
+
+// Writes everything that is queued, returns the number of messages written.
+fn_internal u32
+LogWriterDrain(log_queue& Queue)
+{
+	u32       Count        = 0;
+	u64       BufferLength = 0;
+	log_level BufferLevel  = log_level::trace;
+
+	u64         Position;
+	log_record* Record;
+	while ((Record = LogQueueTake(Queue, &Position)) != nullptr)
+	{
+		if (Record->Site)
+		{
+			char* Text   = gLogger.DecodeBuffer;
+			u64   Length = PlatformLogSystemDecodeDeferred(Text, cLogDecodeBufferSize, Record->Site->Format, (const u8*)Record->Message, Record->Length);
+			if (Length >= cLogDecodeBufferSize)
+			{
+				Text = (char*)allocator::Default().AllocChunk(Length + 1);
+				PlatformLogSystemDecodeDeferred(Text, Length + 1, Record->Site->Format, (const u8*)Record->Message, Record->Length);
+			}
+
+			LogWriterAppend(&BufferLength, &BufferLevel, *Record, Text, Length);
+
+			if (Text != gLogger.DecodeBuffer)
+			{
+				allocator::Default().Free((void*)Text);
+			}
+		}
+		else
+		{
+			LogWriterAppend(&BufferLength, &BufferLevel, *Record, Record->Text(), Record->Length);
+		}
+		LogQueueRelease(Queue, Record, Position);
+		Count += 1;
+
+		// Write out regularly so blocked producers are not waiting on a full buffer's worth of I/O.
+		if (Count % (cLogQueueCapacity / 4) == 0)
+		{
+			break;
+		}
+	}
+
+	if (BufferLength > 0)
+	{
+		LogWriteToSinks(BufferLevel, istr8(gLogger.WriteBuffer, BufferLength));
+	}
+
+	return Count;
+}
+
+fn_internal void
+LogWriterWakeDrainWaiters(log_queue& Queue)
+{
+	Queue.DrainEpoch.fetch_add(1, std::memory_order_seq_cst);
+	if (Queue.DrainWaiters.load(std::memory_order_seq_cst) > 0)
+	{
+		PlatformWakeAll(&Queue.DrainEpoch);
+	}
+}
+
+fn_internal void
+LogWriterMain([[maybe_unused]] void* UserData)
+{
+	tIsLogWriter = true;
+
+	log_queue& Queue = gLogger.Queue;
+	while (true)
+	{
+		bool IsStopping     = gLogger.IsStopping.load(std::memory_order_acquire);
+		u32  FlushRequested = Queue.FlushRequested.load(std::memory_order_acquire);
+		u64  FlushTarget    = Queue.FlushTarget.load(std::memory_order_acquire); // covers every ticket up to FlushRequested
+
+		u32 Drained = LogWriterDrain(Queue);
+
+		// Everything queued before the tickets were taken has been written (or dropped by an overwrite)
+		bool ServedFlush = false;
+		if (FlushRequested != Queue.FlushServed.load(std::memory_order_relaxed) &&
+		    Queue.DequeuePos.load(std::memory_order_acquire) >= FlushTarget)
+		{
+			{
+				platform_scoped_lock Lock(gLogger.FileSink.Lock);
+				LogFileFlush(gLogger.FileSink);
+			}
+
+			Queue.FlushServed.store(FlushRequested, std::memory_order_release);
+			ServedFlush = true;
+		}
+
+		if (Drained > 0 || ServedFlush)
+		{
+			LogWriterWakeDrainWaiters(Queue);
+		}
+
+		if (Drained > 0) continue;
+
+		if (IsStopping) break;
+
+		// Sleep until there is work, or until buffered file output is due.
+		u64 TimeoutNs = LogFileFlushIfDue();
+
+		u32 Epoch = Queue.WakeEpoch.load(std::memory_order_acquire);
+		Queue.WriterSleeping.store(1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		if (LogQueueIsEmpty(Queue) && !gLogger.IsStopping.load(std::memory_order_acquire))
+		{
+			PlatformWaitOnAddress(&Queue.WakeEpoch, Epoch, TimeoutNs);
+		}
+
+		Queue.WriterSleeping.store(0, std::memory_order_relaxed);
+	}
+}
+
 void 
-PlatformLogSystemInit([[maybe_unused]] int InMemoryLogCount)
+PlatformLogSystemInit(int InMemoryLogCount, log_backpressure Backpressure)
 {
-	// NOTE(enlynn): since I am currently not setting up File I/O, In Memory Logs, or Thread Sync,
-	// there is nothing to do right now!
+	assert(!gLogger.IsAsync.load(std::memory_order_relaxed));
+	static_assert((cLogQueueCapacity & (cLogQueueCapacity - 1)) == 0, "Log queue capacity must be a power of 2");
+
+	allocator Allocator = allocator::Default();
+
+	if (InMemoryLogCount > 0)
+	{
+		log_history& History = gLogger.History;
+		platform_scoped_lock Lock(History.Lock);
+
+		History.Capacity = u32(InMemoryLogCount);
+		History.First    = 0;
+		History.Count    = 0;
+		History.Lines    = Allocator.AllocArray<log_history_line>(History.Capacity, allocation_strategy::zero);
+		History.Slab     = (char*)Allocator.AllocChunk(u64(History.Capacity) * cLogHistoryLineSize);
+		ForRange(u32, i, History.Capacity)
+		{
+			History.Lines[i].Text = History.Slab + u64(i) * cLogHistoryLineSize;
+		}
+	}
+
+	log_queue& Queue = gLogger.Queue;
+	Queue.Records = Allocator.AllocArray<log_record>(cLogQueueCapacity, allocation_strategy::zero);
+	Queue.Mask    = cLogQueueCapacity - 1;
+	ForRange(u64, i, cLogQueueCapacity)
+	{
+		Queue.Records[i].Sequence.store(i, std::memory_order_relaxed);
+	}
+
+	gLogger.Backpressure = Backpressure;
+	gLogger.WriteBuffer  = (char*)Allocator.AllocChunk(cLogWriteBufferSize);
+	gLogger.DecodeBuffer = (char*)Allocator.AllocChunk(cLogDecodeBufferSize);
+	gLogger.IsStopping.store(false, std::memory_order_relaxed);
+
+	if (!gLogger.Writer.Start(LogWriterMain, nullptr, "Log Writer"))
+	{ // Keep logging on the calling threads
+		return;
+	}
+
+	gLogger.IsAsync.store(true, std::memory_order_release);
 }
 
 void 
 PlatformLogSystemDeinit()
 {
-	// NOTE(enlynn): nothing for now.
+	if (gLogger.IsAsync.load(std::memory_order_acquire))
+	{
+		// The writer drains the queue before it exits
+		gLogger.IsStopping.store(true, std::memory_order_release);
+		gLogger.Queue.WakeEpoch.fetch_add(1, std::memory_order_seq_cst);
+		PlatformWakeOne(&gLogger.Queue.WakeEpoch);
+		gLogger.Writer.Join();
+
+		gLogger.IsAsync.store(false, std::memory_order_release);
+	}
+
+	PlatformLogSystemCloseFile();
+
+	allocator Allocator = allocator::Default();
+	if (gLogger.Queue.Records)
+	{
+		Allocator.FreeArray(gLogger.Queue.Records, cLogQueueCapacity);
+		Allocator.Free((void*)gLogger.WriteBuffer);
+		Allocator.Free((void*)gLogger.DecodeBuffer);
+		gLogger.Queue.Records = nullptr;
+		gLogger.WriteBuffer   = nullptr;
+		gLogger.DecodeBuffer  = nullptr;
+	}
+
+	log_history& History = gLogger.History;
+	platform_scoped_lock Lock(History.Lock);
+	if (History.Lines)
+	{
+		Allocator.FreeArray(History.Lines, History.Capacity);
+		Allocator.Free((void*)History.Slab);
+		History.Lines    = nullptr;
+		History.Slab     = nullptr;
+		History.Capacity = 0;
+		History.First    = 0;
+		History.Count    = 0;
+	}
+}
+
+void
+PlatformLogSystemFlush()
+{
+	if (!gLogger.IsAsync.load(std::memory_order_acquire) || tIsLogWriter)
+	{ // Lines are written as they are logged, only the file buffer is left
+		platform_scoped_lock Lock(gLogger.FileSink.Lock);
+		LogFileFlush(gLogger.FileSink);
+		return;
+	}
+
+	log_queue& Queue   = gLogger.Queue;
+	u64        Target  = Queue.EnqueuePos.load(std::memory_order_acquire);
+	u64        Current = Queue.FlushTarget.load(std::memory_order_relaxed);
+	while (Current < Target && !Queue.FlushTarget.compare_exchange_weak(Current, Target, std::memory_order_acq_rel))
+	{
+	}
+
+	u32 Ticket = Queue.FlushRequested.fetch_add(1, std::memory_order_acq_rel) + 1;
+	while (s32(Queue.FlushServed.load(std::memory_order_acquire) - Ticket) < 0)
+	{
+		LogQueueWaitForDrain(Queue);
+	}
+}
+
+bool
+PlatformLogSystemOpenFile(const log_file_config& Config)
+{
+	PlatformLogSystemCloseFile();
+
+	u64 Size = 0;
+	u64 File = PlatformLogFileOpen(Config.Path, &Size);
+	if (!File)
+	{
+		LogError("Unable to open log file: %s", Config.Path.Ptr());
+		return false;
+	}
+
+	log_file_sink& Sink = gLogger.FileSink;
+	platform_scoped_lock Lock(Sink.Lock);
+
+	Sink.File            = File;
+	Sink.Path            = mstr8(Config.Path);
+	Sink.Size            = Size;
+	Sink.MaxFileSize     = Config.MaxFileSize;
+	Sink.MaxRotatedFiles = Config.MaxRotatedFiles;
+	Sink.FlushIntervalNs = Config.FlushIntervalNs;
+	Sink.LastFlushNs     = PlatformQueryNanoseconds();
+	Sink.Buffer          = (char*)allocator::Default().AllocChunk(cLogFileBufferSize);
+	Sink.BufferLength    = 0;
+
+	// Continue the previous run's file unless it is already full
+	if (Sink.MaxFileSize > 0 && Sink.Size >= Sink.MaxFileSize)
+	{
+		LogFileRotate(Sink);
+	}
+
+	return true;
+}
+
+void
+PlatformLogSystemCloseFile()
+{
+	log_file_sink& Sink = gLogger.FileSink;
+	platform_scoped_lock Lock(Sink.Lock);
+	if (!Sink.Buffer) return;
+
+	LogFileFlush(Sink);
+	if (Sink.File)
+	{
+		PlatformLogFileClose(Sink.File);
+	}
+
+	allocator::Default().Free((void*)Sink.Buffer);
+	Sink.File         = 0;
+	Sink.Buffer       = nullptr;
+	Sink.BufferLength = 0;
+}
+
+void
+PlatformLogSystemVisitHistory(log_history_pfn Callback, void* UserData)
+{
+	assert(Callback);
+
+	log_history& History = gLogger.History;
+	platform_scoped_lock Lock(History.Lock);
+
+	ForRange(u32, i, History.Count)
+	{
+		const log_history_line& Line = History.Lines[(History.First + i) % History.Capacity];
+		Callback(UserData, Line.Level, istr8(Line.Text, Line.Length));
+	}
+}
+
+u64
+PlatformLogSystemGetDroppedCount()
+{
+	return gLogger.Queue.DroppedCount.load(std::memory_order_relaxed);
 }
 
 void 
@@ -85,80 +892,351 @@ PlatformLogSystemSetFlags(const log_flags_bitset& Flags)
 }
 
 
-void 
-PlatformLogSystemLog(log_level LogLevel, const char* File, int Line, const char* Format, ...)
+//
+// Deferred Logging
+//
+
+u8*
+PlatformLogSystemBeginDeferred(const log_call_site* Site, u64 ArgsSize, log_deferred_slot* Slot, bool* FormatNow)
 {
-	assert(LogLevel < log_level::count);
-	if (LogLevel < gLogger.MinLogLevel) return; 
+	assert(Site && Slot && FormatNow);
+	*FormatNow = false;
 
-	// [TRACE] [Thread] File:Line : Message
-	// --- TODO: write out the Stack Trace
-	// [Debug] [Thread] File:Line : Message
-	// [Info] Message
-	// [Warn] Message
-	// [Error] [Thread] File:Line : Message
-	// [Fatal] [Thread] File:Line : Message
-
-	const char* LogLevelNames[u32(log_level::count)] = {
-		"Trace",
-		"Debug",
-		"Info",
-		"Warn",
-		"Error",
-		"Fatal"
-	};
+	if (Site->Level < gLogger.MinLogLevel) return nullptr;
 
-	const char* LevelName = LogLevelNames[u32(LogLevel)];
+	if (!gLogger.IsAsync.load(std::memory_order_acquire) || tIsLogWriter || ArgsSize > sizeof(log_record::Message))
+	{
+		*FormatNow = true;
+		return nullptr;
+	}
 
-    constexpr int HardcodedMessageSize = 2048;
-	char PartialMessage[HardcodedMessageSize];
+	log_record* Record = LogQueueClaimWithBackpressure(gLogger.Queue, Site->Level, &Slot->Position);
+	if (!Record) return nullptr;
 
-	va_list MessageArgs;
-	va_start(MessageArgs, Format);
+	Record->Level    = Site->Level;
+	Record->ThreadId = LogCurrentThreadId();
+	Record->File     = Site->File;
+	Record->Line     = Site->Line;
+	Record->Length   = u32(ArgsSize);
+	Record->Overflow = nullptr;
+	Record->Site     = Site;
 
-	int MessageLength = vsnprintf(PartialMessage, HardcodedMessageSize, Format, MessageArgs);
-	assert(MessageLength < HardcodedMessageSize); // TODO: Are exceeding hard coded limits, prolly should do something better
+	Slot->Record = Record;
+	return (u8*)Record->Message;
+}
 
-	PartialMessage[MessageLength]     = '\n';
-	PartialMessage[MessageLength + 1] = 0;
+void
+PlatformLogSystemEndDeferred(const log_deferred_slot& Slot)
+{
+	LogQueuePublish(gLogger.Queue, (log_record*)Slot.Record, Slot.Position);
+}
 
-	va_end(MessageArgs);
+// Reads the int argument of a * width or precision. Returns false if there are no arguments left.
+fn_internal bool
+DecodeIntArgument(const u8** Cursor, const u8* End, int* Value)
+{
+	if (*Cursor + 1 > End) return false;
 
-	mstr8 FullMessage = "[";
-	FullMessage = FullMessage + LevelName + "] ";
+	log_arg_type Type = log_arg_type(**Cursor);
+	u64          Size = (Type == log_arg_type::s32 || Type == log_arg_type::u32) ? sizeof(u32) : sizeof(u64);
+	if (*Cursor + 1 + Size > End) return false;
 
-	if (LogLevel != log_level::info && LogLevel != log_level::warn)
+	if (Type == log_arg_type::s32 || Type == log_arg_type::u32)
 	{
-		FullMessage += mstr8::Format("%s:%d ", File, Line);
+		s32 Bits = 0;
+		memcpy(&Bits, *Cursor + 1, sizeof(Bits));
+		*Value = Bits;
+	}
+	else if (Type == log_arg_type::s64 || Type == log_arg_type::u64)
+	{ // A size_t passed for the width, say
+		s64 Bits = 0;
+		memcpy(&Bits, *Cursor + 1, sizeof(Bits));
+		*Value = int(Bits);
+	}
+	else
+	{ // Not an integer, the arguments do not match the format
+		return false;
 	}
 
-	FullMessage += PartialMessage;
+	*Cursor += 1 + Size;
+	return true;
+}
 
-	if (gLogger.Flags.IsSet(log_flags::file))
-	{ //TODO:
+u64
+PlatformLogSystemDecodeDeferred(char* Buffer, u64 BufferSize, const char* Format, const u8* Args, u64 ArgsSize)
+{
+	const u8* Cursor = Args;
+	const u8* End    = Args + ArgsSize;
+	u64       Length = 0;
+
+	auto Remaining = [&]() -> u64   { return Length < BufferSize ? BufferSize - Length : 0; };
+	auto Dest      = [&]() -> char* { return Length < BufferSize ? Buffer + Length : nullptr; };
+	auto PutChar   = [&](char C)    { if (Length + 1 < BufferSize) Buffer[Length] = C; Length += 1; };
+
+	const char* Char = Format;
+	while (*Char)
+	{
+		if (*Char != '%')
+		{
+			PutChar(*Char++);
+			continue;
+		}
+
+		if (Char[1] == '%')
+		{
+			PutChar('%');
+			Char += 2;
+			continue;
+		}
+
+		// %[flags][width][.precision][length]conversion. The length modifier is replaced with the one
+		// matching the stored argument. A * width or precision takes its value from the next argument,
+		// like printf, and is written into the spec so snprintf gets a single argument.
+		const char* FlagsBegin = ++Char;
+		while (*Char && strchr("-+ #0", *Char)) Char++;
+		u64 FlagsLength = u64(Char - FlagsBegin);
+
+		bool MissingArgument = false;
+		bool HasWidth        = false;
+		int  Width           = 0;
+		if (*Char == '*')
+		{
+			Char++;
+			HasWidth        = true;
+			MissingArgument = !DecodeIntArgument(&Cursor, End, &Width);
+		}
+		else if (*Char >= '0' && *Char <= '9')
+		{
+			HasWidth = true;
+			Width    = atoi(Char);
+			while (*Char >= '0' && *Char <= '9') Char++;
+		}
+
+		// A negative precision is the same as none
+		int Precision = -1;
+		if (*Char == '.')
+		{
+			Char++;
+			if (*Char == '*')
+			{
+				Char++;
+				MissingArgument = !DecodeIntArgument(&Cursor, End, &Precision) || MissingArgument;
+			}
+			else
+			{
+				Precision = atoi(Char);
+				while (*Char >= '0' && *Char <= '9') Char++;
+			}
+		}
+
+		while (*Char && strchr("hlLqjzt", *Char)) Char++;
+
+		char Conversion = *Char;
+		if (!Conversion) break;
+		Char++;
+
+		if (MissingArgument || Cursor + 1 > End)
+		{ // More specs than arguments
+			continue;
+		}
+
+		log_arg_type Type = log_arg_type(*Cursor++);
+
+		// Room for the flags, both numbers, a length modifier and the conversion
+		char Spec[48];
+		u64  SpecLength = 0;
+		Spec[SpecLength++] = '%';
+
+		FlagsLength = FlagsLength < 8 ? FlagsLength : 8;
+		memcpy(Spec + SpecLength, FlagsBegin, FlagsLength);
+		SpecLength += FlagsLength;
+
+		// A negative width is printed as the - flag followed by the width, which is what printf makes of it
+		if (HasWidth) SpecLength += u64(snprintf(Spec + SpecLength, sizeof(Spec) - SpecLength, "%d", Width));
+		u64 WidthSpecLength = SpecLength;
+
+		if (Precision >= 0) SpecLength += u64(snprintf(Spec + SpecLength, sizeof(Spec) - SpecLength, ".%d", Precision));
+
+		int Written = 0;
+		switch (Type)
+		{
+			case log_arg_type::s32:
+			case log_arg_type::u32:
+			{
+				u32 Bits = 0;
+				memcpy(&Bits, Cursor, sizeof(Bits));
+				Cursor += sizeof(Bits);
+
+				Spec[SpecLength]     = strchr("diouxXc", Conversion) ? Conversion : (Type == log_arg_type::s32 ? 'd' : 'u');
+				Spec[SpecLength + 1] = 0;
+				Written = snprintf(Dest(), size_t(Remaining()), Spec, Bits);
+			} break;
+
+			case log_arg_type::s64:
+			case log_arg_type::u64:
+			{
+				u64 Bits = 0;
+				memcpy(&Bits, Cursor, sizeof(Bits));
+				Cursor += sizeof(Bits);
+
+				Spec[SpecLength]     = 'l';
+				Spec[SpecLength + 1] = 'l';
+				Spec[SpecLength + 2] = strchr("diouxX", Conversion) ? Conversion : (Type == log_arg_type::s64 ? 'd' : 'u');
+				Spec[SpecLength + 3] = 0;
+				Written = snprintf(Dest(), size_t(Remaining()), Spec, (unsigned long long)Bits);
+			} break;
+
+			case log_arg_type::f64:
+			{
+				f64 Value = 0;
+				memcpy(&Value, Cursor, sizeof(Value));
+				Cursor += sizeof(Value);
+
+				Spec[SpecLength]     = strchr("fFeEgGaA", Conversion) ? Conversion : 'g';
+				Spec[SpecLength + 1] = 0;
+				Written = snprintf(Dest(), size_t(Remaining()), Spec, Value);
+			} break;
+
+			case log_arg_type::pointer:
+			{
+				u64 Bits = 0;
+				memcpy(&Bits, Cursor, sizeof(Bits));
+				Cursor += sizeof(Bits);
+
+				Spec[SpecLength]     = 'p';
+				Spec[SpecLength + 1] = 0;
+				Written = snprintf(Dest(), size_t(Remaining()), Spec, (void*)uptr(Bits));
+			} break;
+
+			case log_arg_type::string:
+			{
+				u32 StringLength = 0;
+				memcpy(&StringLength, Cursor, sizeof(StringLength));
+				const char* String = (const char*)Cursor + sizeof(StringLength);
+				Cursor += sizeof(StringLength);
+
+				if (StringLength == cLogNullStringLength)
+				{ // What glibc and the MSVC CRT print for a null %s
+					String       = "(null)";
+					StringLength = 6;
+				}
+				else
+				{
+					Cursor += StringLength;
+				}
+
+				// The copy is not null terminated, print it with an explicit precision
+				int StringPrecision = int(StringLength);
+				if (Precision >= 0 && Precision < StringPrecision)
+				{
+					StringPrecision = Precision;
+				}
+
+				Spec[WidthSpecLength]     = '.';
+				Spec[WidthSpecLength + 1] = '*';
+				Spec[WidthSpecLength + 2] = 's';
+				Spec[WidthSpecLength + 3] = 0;
+				Written = snprintf(Dest(), size_t(Remaining()), Spec, StringPrecision, String);
+			} break;
+
+			default:
+			{ // Corrupt arguments, stop decoding
+				Cursor = End;
+			} break;
+		}
+
+		Length += Written > 0 ? u64(Written) : 0;
 	}
 
-	if (gLogger.Flags.IsSet(log_flags::editor))
-	{ //TODO:
+	if (Length < BufferSize)
+	{
+		Buffer[Length] = 0;
+	}
+	else if (BufferSize > 0)
+	{
+		Buffer[BufferSize - 1] = 0;
 	}
 
-	if (gLogger.Flags.IsSet(log_flags::console))
+	return Length;
+}
+
+void 
+PlatformLogSystemLog(log_level LogLevel, const char* File, int Line, const char* Format, ...)
+{
+	assert(LogLevel < log_level::count);
+	if (LogLevel < gLogger.MinLogLevel) return; 
+
+	va_list MessageArgs;
+	va_start(MessageArgs, Format);
+
+	if (gLogger.IsAsync.load(std::memory_order_acquire) && !tIsLogWriter)
 	{
-		PlatformLogToConsole(LogLevel > log_level::warn,
-			gLogger.ForegroundColors[u32(LogLevel)],
-			gLogger.BackgroundColors[u32(LogLevel)],
-			FullMessage);
+		// Only the message is formatted here, the log thread adds the prefix and does the I/O.
+		log_queue&  Queue = gLogger.Queue;
+		u64         Position;
+		log_record* Record = LogQueueClaimWithBackpressure(Queue, LogLevel, &Position);
+		if (Record)
+		{
+			Record->Level    = LogLevel;
+			Record->ThreadId = LogCurrentThreadId();
+			Record->File     = File;
+			Record->Line     = Line;
+			Record->Overflow = nullptr;
+			Record->Site     = nullptr;
+
+			va_list CopiedArgs;
+			va_copy(CopiedArgs, MessageArgs);
+			int MessageLength = vsnprintf(Record->Message, sizeof(Record->Message), Format, CopiedArgs);
+			va_end(CopiedArgs);
+
+			MessageLength = MessageLength > 0 ? MessageLength : 0;
+			if (u64(MessageLength) >= sizeof(Record->Message))
+			{
+				Record->Overflow = (char*)allocator::Default().AllocChunk(u64(MessageLength) + 1);
+				vsnprintf(Record->Overflow, size_t(MessageLength) + 1, Format, MessageArgs);
+			}
+
+			Record->Length = u32(MessageLength);
+			LogQueuePublish(Queue, Record, Position);
+		}
+
+		va_end(MessageArgs);
+
+		if (LogLevel == log_level::fatal)
+		{
+			PlatformLogSystemFlush();
+			PlatformExitProcess();
+		}
+		return;
 	}
 
-#if _DEBUG
-	if (gLogger.Flags.IsSet(log_flags::debug_console))
+	constexpr int HardcodedMessageSize = 2048;
+	char  PartialMessage[HardcodedMessageSize];
+	char* Message = PartialMessage;
+
+	va_list CopiedArgs;
+	va_copy(CopiedArgs, MessageArgs);
+	int MessageLength = vsnprintf(PartialMessage, HardcodedMessageSize, Format, CopiedArgs);
+	va_end(CopiedArgs);
+
+	MessageLength = MessageLength > 0 ? MessageLength : 0;
+	if (MessageLength >= HardcodedMessageSize)
 	{
-		PlatformLogToDebugConsole(FullMessage);
+		Message = (char*)allocator::Default().AllocChunk(u64(MessageLength) + 1);
+		vsnprintf(Message, size_t(MessageLength) + 1, Format, MessageArgs);
+	}
+
+	va_end(MessageArgs);
+
+	LogWriteLineNow(LogLevel, LogCurrentThreadId(), File, Line, Message, u64(MessageLength));
+
+	if (Message != PartialMessage)
+	{
+		allocator::Default().Free((void*)Message);
 	}
-#endif
 
 	if (LogLevel == log_level::fatal)
 	{
 		PlatformExitProcess();
 	}
-}
\ No newline at end of file
+}
@@ -0,0 +1,205 @@
+#include "platform.h"
+
+// Time left until DeadlineNs, for waits that loop over several parks. cPlatformWaitForever passes through.
+fn_internal u64
+RemainingNanoseconds(u64 DeadlineNs)
+{
+	if (DeadlineNs == cPlatformWaitForever) return cPlatformWaitForever;
+
+	u64 Now = PlatformQueryNanoseconds();
+	return Now < DeadlineNs ? DeadlineNs - Now : 0;
+}
+
+fn_internal u64
+DeadlineFromTimeout(u64 TimeoutNs)
+{
+	if (TimeoutNs == cPlatformWaitForever) return cPlatformWaitForever;
+	return PlatformQueryNanoseconds() + TimeoutNs;
+}
+
+//
+// Mutex
+//
+
+bool
+platform_mutex::TryLock()
+{
+	u32 Expected = 0;
+	return mState.compare_exchange_strong(Expected, 1, std::memory_order_acquire, std::memory_order_relaxed);
+}
+
+void
+platform_mutex::Lock()
+{
+	u32 State = 0;
+	if (mState.compare_exchange_strong(State, 1, std::memory_order_acquire, std::memory_order_relaxed))
+		return;
+
+	// Spin while the holder is likely to release soon. Once a thread is parked there is a queue, join it.
+	ForRange(u32, i, mSpinCount)
+	{
+		if (State == 2) break;
+
+		if (State == 0 && mState.compare_exchange_weak(State, 1, std::memory_order_acquire, std::memory_order_relaxed))
+			return;
+
+		PlatformCpuRelax();
+		State = mState.load(std::memory_order_relaxed);
+	}
+
+	// Taking the lock as 2 is conservative: other threads may still be parked, and the unlock has to
+	// wake them.
+	State = mState.exchange(2, std::memory_order_acquire);
+	while (State != 0)
+	{
+		PlatformWaitOnAddress(&mState, 2);
+		State = mState.exchange(2, std::memory_order_acquire);
+	}
+}
+
+void
+platform_mutex::Unlock()
+{
+	if (mState.exchange(0, std::memory_order_release) == 2)
+	{
+		PlatformWakeOne(&mState);
+	}
+}
+
+//
+// Condition Variable
+//
+
+bool
+platform_condition_variable::Wait(platform_mutex& Mutex, u64 TimeoutNs)
+{
+	// Read before unlocking: a notify that happens after the unlock changes the sequence, and the
+	// wait below returns right away instead of missing it.
+	u32 Sequence = mSequence.load(std::memory_order_seq_cst);
+	mWaiters.fetch_add(1, std::memory_order_seq_cst);
+
+	Mutex.Unlock();
+	bool Notified = PlatformWaitOnAddress(&mSequence, Sequence, TimeoutNs);
+	mWaiters.fetch_sub(1, std::memory_order_relaxed);
+
+	// The other notified threads are racing for the mutex, lock it as contended so they get woken.
+	u32 State = Mutex.mState.exchange(2, std::memory_order_acquire);
+	while (State != 0)
+	{
+		PlatformWaitOnAddress(&Mutex.mState, 2);
+		State = Mutex.mState.exchange(2, std::memory_order_acquire);
+	}
+
+	return Notified;
+}
+
+void
+platform_condition_variable::NotifyOne()
+{
+	mSequence.fetch_add(1, std::memory_order_seq_cst);
+	if (mWaiters.load(std::memory_order_seq_cst) > 0)
+	{
+		PlatformWakeOne(&mSequence);
+	}
+}
+
+void
+platform_condition_variable::NotifyAll()
+{
+	mSequence.fetch_add(1, std::memory_order_seq_cst);
+	if (mWaiters.load(std::memory_order_seq_cst) > 0)
+	{
+		PlatformWakeAll(&mSequence);
+	}
+}
+
+//
+// Event
+//
+
+void
+platform_event::Signal()
+{
+	mState.store(1, std::memory_order_seq_cst);
+	if (mWaiters.load(std::memory_order_seq_cst) > 0)
+	{
+		if (mAutoReset) PlatformWakeOne(&mState);
+		else            PlatformWakeAll(&mState);
+	}
+}
+
+void
+platform_event::Reset()
+{
+	mState.store(0, std::memory_order_release);
+}
+
+bool
+platform_event::Wait(u64 TimeoutNs)
+{
+	u64 DeadlineNs = DeadlineFromTimeout(TimeoutNs);
+	while (true)
+	{
+		if (mAutoReset)
+		{
+			u32 Expected = 1;
+			if (mState.compare_exchange_strong(Expected, 0, std::memory_order_acquire, std::memory_order_relaxed))
+				return true;
+		}
+		else if (mState.load(std::memory_order_acquire) != 0)
+		{
+			return true;
+		}
+
+		u64 RemainingNs = RemainingNanoseconds(DeadlineNs);
+		if (RemainingNs == 0) return false;
+
+		mWaiters.fetch_add(1, std::memory_order_seq_cst);
+		PlatformWaitOnAddress(&mState, 0, RemainingNs);
+		mWaiters.fetch_sub(1, std::memory_order_relaxed);
+	}
+}
+
+//
+// Semaphore
+//
+
+void
+platform_semaphore::Signal(u32 Count)
+{
+	mCount.fetch_add(Count, std::memory_order_seq_cst);
+	if (mWaiters.load(std::memory_order_seq_cst) > 0)
+	{
+		if (Count == 1) PlatformWakeOne(&mCount);
+		else            PlatformWakeAll(&mCount);
+	}
+}
+
+bool
+platform_semaphore::TryWait()
+{
+	u32 Count = mCount.load(std::memory_order_relaxed);
+	while (Count > 0)
+	{
+		if (mCount.compare_exchange_weak(Count, Count - 1, std::memory_order_acquire, std::memory_order_relaxed))
+			return true;
+	}
+	return false;
+}
+
+bool
+platform_semaphore::Wait(u64 TimeoutNs)
+{
+	u64 DeadlineNs = DeadlineFromTimeout(TimeoutNs);
+	while (true)
+	{
+		if (TryWait()) return true;
+
+		u64 RemainingNs = RemainingNanoseconds(DeadlineNs);
+		if (RemainingNs == 0) return false;
+
+		mWaiters.fetch_add(1, std::memory_order_seq_cst);
+		PlatformWaitOnAddress(&mCount, 0, RemainingNs);
+		mWaiters.fetch_sub(1, std::memory_order_relaxed);
+	}
+}
@@ -0,0 +1,244 @@
+#include "platform.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+//
+// Platform Timer
+//
+
+platform_timer::platform_timer()
+{
+	mFrequency    = PlatformGetTickFrequency();
+	mStartTicks   = 0;
+	mElapsedTicks = 0;
+}
+
+void
+platform_timer::Start()
+{
+	mStartTicks   = PlatformQueryTicks();
+	mElapsedTicks = mStartTicks;
+}
+
+void
+platform_timer::Update()
+{
+	mElapsedTicks = PlatformQueryTicks();
+}
+
+f64
+platform_timer::GetSecondsElapsed() const
+{ // Only the difference goes through floating point
+	return f64(GetTicksElapsed()) / f64(mFrequency);
+}
+
+//
+// Cycle Counter Calibration
+//
+
+// Long enough that the clock's resolution and the cost of reading it are noise (< 0.01%), short enough
+// not to be noticed at startup.
+var_global constexpr u64 cCycleCounterCalibrationNanoseconds = 10'000'000;
+// Bracketed reads taken at each end of the calibration, the tightest one is kept.
+var_global constexpr u32 cCycleCounterBracketReads           = 8;
+
+// Reads the cycle counter between two clock reads, a few times over, and keeps the read with the tightest
+// bracket. A preemption between the reads widens the bracket, so it is thrown away rather than skewing
+// the result. Nanoseconds is the middle of the kept bracket.
+fn_internal void
+ReadCycleCounterBracketed(u64* Cycles, u64* Nanoseconds)
+{
+	u64 BestWidth = U64_MAX;
+	ForRange(u32, i, cCycleCounterBracketReads)
+	{
+		u64 Before  = PlatformQueryNanoseconds();
+		u64 Counter = PlatformReadCycleCounterSerialized();
+		u64 After   = PlatformQueryNanoseconds();
+
+		if (After - Before < BestWidth)
+		{
+			BestWidth    = After - Before;
+			*Cycles      = Counter;
+			*Nanoseconds = Before + BestWidth / 2;
+		}
+	}
+}
+
+fn_internal u64
+MeasureCycleCounterFrequency()
+{
+#if defined(_M_ARM64) || defined(__aarch64__)
+	// The virtual counter's frequency is published by the firmware
+	u64 Frequency;
+# if defined(_M_ARM64)
+	Frequency = _ReadStatusReg(0x5F00); // CNTFRQ_EL0
+# else
+	__asm__ volatile("mrs %0, cntfrq_el0" : "=r"(Frequency));
+# endif
+	if (Frequency != 0) return Frequency;
+#endif
+
+	u64 StartCycles = 0;
+	u64 StartNs     = 0;
+	ReadCycleCounterBracketed(&StartCycles, &StartNs);
+
+	while (PlatformQueryNanoseconds() - StartNs < cCycleCounterCalibrationNanoseconds)
+	{ // Spin rather than sleep, so the end is read right as the period is up
+	}
+
+	u64 EndCycles = 0;
+	u64 EndNs     = 0;
+	ReadCycleCounterBracketed(&EndCycles, &EndNs);
+
+	u64 ElapsedNs     = EndNs - StartNs;
+	u64 ElapsedCycles = EndCycles - StartCycles;
+	assert(ElapsedNs > 0);
+
+	// ElapsedCycles * 1e9 overflows past ~18s of cycles at 1GHz, the calibration is far shorter
+	return (ElapsedCycles * 1'000'000'000) / ElapsedNs;
+}
+
+u64
+PlatformGetCycleCounterFrequency()
+{
+	var_persist const u64 Frequency = MeasureCycleCounterFrequency();
+	return Frequency;
+}
+
+//
+// Platform Frame Limiter
+//
+
+// Assumed until the first sleep has been measured: the Windows scheduler tick after timeBeginPeriod(1).
+var_global constexpr u64 cInitialSleepOvershootNs = 1'000'000;
+// Waits shorter than this are only spun, a sleep this short would mostly be overshoot.
+var_global constexpr u64 cMinSleepNs              = 200'000;
+
+fn_internal int
+CompareU64(const void* Lhs, const void* Rhs)
+{
+	u64 A = *(const u64*)Lhs;
+	u64 B = *(const u64*)Rhs;
+	return A < B ? -1 : (A > B ? 1 : 0);
+}
+
+// Nearest rank percentile of a sorted array
+fn_internal u64
+SortedPercentile(const u64* Sorted, u32 Count, u32 Percent)
+{
+	u32 Rank = DivideCeil(Count * Percent, 100u);
+	return Sorted[Rank > 0 ? Rank - 1 : 0];
+}
+
+void
+platform_frame_limiter::SetTargetFrameRate(f64 FramesPerSecond)
+{
+	mTargetPeriodNs = FramesPerSecond > 0.0 ? u64(1'000'000'000.0 / FramesPerSecond + 0.5) : 0;
+}
+
+void
+platform_frame_limiter::BeginFrame()
+{
+	u64 Now = PlatformQueryNanoseconds();
+	mFrameStartNs = Now;
+
+	if (IsUncapped())
+	{
+		mDeadlineNs = 0;
+		return;
+	}
+
+	// Stay on the grid of the previous deadlines, unless the previous frame ran far over (a hitch, a
+	// window drag, a breakpoint) and catching up would mean a burst of unpaced frames.
+	u64 GridStart = mDeadlineNs;
+	if (mDeadlineNs == 0 || Now >= mDeadlineNs + mTargetPeriodNs)
+	{
+		GridStart = Now;
+	}
+
+	mDeadlineNs = GridStart + mTargetPeriodNs;
+}
+
+void
+platform_frame_limiter::EndFrame()
+{
+	u64 WorkEndNs = PlatformQueryNanoseconds();
+
+	if (!IsUncapped() && mDeadlineNs != 0)
+	{
+		WaitUntil(mDeadlineNs);
+	}
+
+	u64 FrameEndNs = IsUncapped() ? WorkEndNs : PlatformQueryNanoseconds();
+
+	u32 Slot = mFrameCount & (cHistorySize - 1);
+	mFrameTimesNs[Slot] = FrameEndNs - mFrameStartNs;
+	mWorkTimesNs[Slot]  = WorkEndNs - mFrameStartNs;
+	mFrameCount += 1;
+}
+
+void
+platform_frame_limiter::WaitUntil(u64 DeadlineNs)
+{
+	if (mSleepOvershootNs == 0)
+	{
+		mSleepOvershootNs = cInitialSleepOvershootNs;
+	}
+
+	u64 Now = PlatformQueryNanoseconds();
+	if (Now < DeadlineNs && DeadlineNs - Now > mSleepOvershootNs + cMinSleepNs)
+	{
+		u64 Request = DeadlineNs - Now - mSleepOvershootNs;
+		PlatformSleepNanoseconds(Request);
+
+		u64 AfterSleep = PlatformQueryNanoseconds();
+		u64 Slept      = AfterSleep - Now;
+		u64 Overshoot  = Slept > Request ? Slept - Request : 0;
+
+		// Follow a worse overshoot right away (a late wake up costs a missed deadline), and let the
+		// estimate decay slowly otherwise (an early wake up only costs a bit more spinning).
+		if (Overshoot > mSleepOvershootNs)
+		{
+			mSleepOvershootNs = Overshoot;
+		}
+		else
+		{
+			mSleepOvershootNs -= (mSleepOvershootNs - Overshoot) / 16;
+		}
+
+		Now = AfterSleep;
+	}
+
+	while (Now < DeadlineNs)
+	{
+		PlatformCpuRelax();
+		Now = PlatformQueryNanoseconds();
+	}
+}
+
+frame_time_stats
+platform_frame_limiter::GetStats() const
+{
+	frame_time_stats Stats = {};
+
+	u32 Count = mFrameCount < cHistorySize ? mFrameCount : cHistorySize;
+	if (Count == 0) return Stats;
+
+	u64 Sorted[cHistorySize];
+
+	memcpy(Sorted, mFrameTimesNs, Count * sizeof(u64));
+	qsort(Sorted, Count, sizeof(u64), CompareU64);
+	Stats.FrameP50Ns = SortedPercentile(Sorted, Count, 50);
+	Stats.FrameP99Ns = SortedPercentile(Sorted, Count, 99);
+	Stats.FrameMaxNs = Sorted[Count - 1];
+
+	memcpy(Sorted, mWorkTimesNs, Count * sizeof(u64));
+	qsort(Sorted, Count, sizeof(u64), CompareU64);
+	Stats.WorkP50Ns = SortedPercentile(Sorted, Count, 50);
+	Stats.WorkP99Ns = SortedPercentile(Sorted, Count, 99);
+	Stats.WorkMaxNs = Sorted[Count - 1];
+
+	Stats.SampleCount = Count;
+	return Stats;
+}
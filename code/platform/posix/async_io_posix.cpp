@@ -0,0 +1,612 @@
+#include "common_posix.h"
+
+#include <util/allocator.h>
+#include <util/str8.h>
+
+#include <pthread.h>
+#include <string.h>
+#include <sys/uio.h>
+
+#if defined(__linux__)
+# include <linux/io_uring.h>
+# include <sys/syscall.h>
+# define POSIX_HAS_IO_URING 1
+#else
+# define POSIX_HAS_IO_URING 0
+#endif
+
+// Linux read() transfers at most 0x7ffff000 bytes per call, larger reads are split into chunks.
+var_global constexpr u64 cMaxReadSize        = _1GB;
+// Enough reads in flight to keep an NVMe queue busy without making the fallback a burden.
+var_global constexpr u32 cFallbackThreadCount = 4;
+
+struct posix_read_slot
+{
+	int   File;
+	u8*   Destination;
+	u64   Offset;
+	u64   Size;
+	u64   BytesRead;
+	void* UserData;
+	iovec Vector;       // io_uring reads from this until the read completes
+	bool  Failed;
+};
+
+#if POSIX_HAS_IO_URING
+struct posix_io_uring
+{
+	int           RingFile    = -1;
+	u32           SqMask      = 0;
+	u32           CqMask      = 0;
+	u32*          SqHead      = nullptr;
+	u32*          SqTail      = nullptr;
+	u32*          SqArray     = nullptr;
+	u32*          CqHead      = nullptr;
+	u32*          CqTail      = nullptr;
+	io_uring_sqe* Sqes        = nullptr;
+	io_uring_cqe* Cqes        = nullptr;
+
+	void*         SqRing      = nullptr;
+	u64           SqRingSize  = 0;
+	void*         CqRing      = nullptr; // same as SqRing with IORING_FEAT_SINGLE_MMAP
+	u64           CqRingSize  = 0;
+	u64           SqesSize    = 0;
+
+	u32           Unsubmitted = 0;       // queued in the SQ, not yet passed to io_uring_enter
+};
+#endif
+
+struct posix_async_reader
+{
+	allocator        Allocator     = {};
+	u32              MaxInFlight   = 0;
+
+	posix_read_slot* Slots         = nullptr;
+	u32*             FreeSlots     = nullptr;
+	u32              FreeSlotCount = 0;
+
+	// Slots whose read finished, FIFO. Written by the workers in the thread pool fallback.
+	u32*             Finished      = nullptr;
+	u32              FinishedFirst = 0;
+	u32              FinishedCount = 0;
+
+	bool             UsesIoUring   = false;
+#if POSIX_HAS_IO_URING
+	posix_io_uring   Ring          = {};
+#endif
+
+	// Thread pool fallback. Pending is a FIFO of slots waiting for a worker.
+	pthread_t        Threads[cFallbackThreadCount];
+	u32              ThreadCount   = 0;
+	pthread_mutex_t  Lock;
+	pthread_cond_t   WorkReady;
+	pthread_cond_t   WorkDone;
+	u32*             Pending       = nullptr;
+	u32              PendingFirst  = 0;
+	u32              PendingCount  = 0;
+	bool             Quit          = false;
+};
+
+fn_internal void
+PushFinished(posix_async_reader* Reader, u32 Slot)
+{
+	assert(Reader->FinishedCount < Reader->MaxInFlight);
+	Reader->Finished[(Reader->FinishedFirst + Reader->FinishedCount) % Reader->MaxInFlight] = Slot;
+	Reader->FinishedCount += 1;
+}
+
+fn_internal void
+FinishRead(posix_async_reader* Reader, u32 Slot)
+{
+	posix_read_slot& Read = Reader->Slots[Slot];
+	if (Read.File >= 0)
+	{
+		close(Read.File);
+		Read.File = -1;
+	}
+	PushFinished(Reader, Slot);
+}
+
+//
+// io_uring
+//
+
+#if POSIX_HAS_IO_URING
+
+// Raw syscalls, so there is no dependency on liburing.
+fn_internal int
+IoUringSetup(u32 Entries, io_uring_params* Params)
+{
+	return int(syscall(__NR_io_uring_setup, Entries, Params));
+}
+
+fn_internal int
+IoUringEnter(int RingFile, u32 ToSubmit, u32 MinComplete, u32 Flags)
+{
+	return int(syscall(__NR_io_uring_enter, RingFile, ToSubmit, MinComplete, Flags, nullptr, 0));
+}
+
+fn_internal bool
+IoUringInit(posix_io_uring* Ring, u32 Entries)
+{
+	if (getenv("CHIBI_DISABLE_IO_URING"))
+		return false;
+
+	io_uring_params Params = {};
+	int RingFile = IoUringSetup(Entries, &Params);
+	if (RingFile < 0)
+		return false;
+
+	Ring->RingFile   = RingFile;
+	Ring->SqRingSize = Params.sq_off.array + Params.sq_entries * sizeof(u32);
+	Ring->CqRingSize = Params.cq_off.cqes + Params.cq_entries * sizeof(io_uring_cqe);
+	Ring->SqesSize   = Params.sq_entries * sizeof(io_uring_sqe);
+
+	bool SingleMap = (Params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+	if (SingleMap)
+	{
+		Ring->SqRingSize = Ring->SqRingSize > Ring->CqRingSize ? Ring->SqRingSize : Ring->CqRingSize;
+		Ring->CqRingSize = Ring->SqRingSize;
+	}
+
+	Ring->SqRing = mmap(nullptr, Ring->SqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, RingFile, IORING_OFF_SQ_RING);
+	Ring->CqRing = SingleMap ? Ring->SqRing : mmap(nullptr, Ring->CqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, RingFile, IORING_OFF_CQ_RING);
+	Ring->Sqes   = (io_uring_sqe*)mmap(nullptr, Ring->SqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, RingFile, IORING_OFF_SQES);
+
+	if (Ring->SqRing == MAP_FAILED || Ring->CqRing == MAP_FAILED || (void*)Ring->Sqes == MAP_FAILED)
+	{
+		if (Ring->SqRing != MAP_FAILED)               munmap(Ring->SqRing, Ring->SqRingSize);
+		if (!SingleMap && Ring->CqRing != MAP_FAILED) munmap(Ring->CqRing, Ring->CqRingSize);
+		if ((void*)Ring->Sqes != MAP_FAILED)          munmap(Ring->Sqes, Ring->SqesSize);
+		close(RingFile);
+		*Ring = {};
+		return false;
+	}
+
+	u8* Sq = (u8*)Ring->SqRing;
+	u8* Cq = (u8*)Ring->CqRing;
+
+	Ring->SqMask  = *(u32*)(Sq + Params.sq_off.ring_mask);
+	Ring->SqHead  =  (u32*)(Sq + Params.sq_off.head);
+	Ring->SqTail  =  (u32*)(Sq + Params.sq_off.tail);
+	Ring->SqArray =  (u32*)(Sq + Params.sq_off.array);
+	Ring->CqMask  = *(u32*)(Cq + Params.cq_off.ring_mask);
+	Ring->CqHead  =  (u32*)(Cq + Params.cq_off.head);
+	Ring->CqTail  =  (u32*)(Cq + Params.cq_off.tail);
+	Ring->Cqes    =  (io_uring_cqe*)(Cq + Params.cq_off.cqes);
+
+	return true;
+}
+
+fn_internal void
+IoUringDeinit(posix_io_uring* Ring)
+{
+	munmap(Ring->Sqes, Ring->SqesSize);
+	if (Ring->CqRing != Ring->SqRing)
+	{
+		munmap(Ring->CqRing, Ring->CqRingSize);
+	}
+	munmap(Ring->SqRing, Ring->SqRingSize);
+	close(Ring->RingFile);
+	*Ring = {};
+}
+
+// Queues the next chunk of a read. Each slot has at most one SQE in flight and the SQ has room for
+// every slot, so the SQ can't be full.
+fn_internal void
+IoUringQueueRead(posix_io_uring* Ring, posix_read_slot* Read, u32 Slot)
+{
+	u64 Remaining = Read->Size - Read->BytesRead;
+
+	Read->Vector.iov_base = Read->Destination + Read->BytesRead;
+	Read->Vector.iov_len  = size_t(Remaining < cMaxReadSize ? Remaining : cMaxReadSize);
+
+	u32 Tail  = *Ring->SqTail;
+	u32 Index = Tail & Ring->SqMask;
+
+	// READV rather than READ, it is available on every kernel with io_uring (5.1+).
+	io_uring_sqe* Sqe = &Ring->Sqes[Index];
+	memset(Sqe, 0, sizeof(*Sqe));
+	Sqe->opcode    = IORING_OP_READV;
+	Sqe->fd        = Read->File;
+	Sqe->off       = Read->Offset + Read->BytesRead;
+	Sqe->addr      = u64(&Read->Vector);
+	Sqe->len       = 1;
+	Sqe->user_data = Slot;
+
+	Ring->SqArray[Index] = Index;
+	__atomic_store_n(Ring->SqTail, Tail + 1, __ATOMIC_RELEASE);
+	Ring->Unsubmitted += 1;
+}
+
+// Hands the queued SQEs to the kernel. With MinComplete > 0, also blocks until that many reads finished.
+fn_internal void
+IoUringSubmit(posix_async_reader* Reader, u32 MinComplete)
+{
+	posix_io_uring* Ring = &Reader->Ring;
+	if (Ring->Unsubmitted == 0 && MinComplete == 0)
+		return;
+
+	u32 Flags = MinComplete > 0 ? IORING_ENTER_GETEVENTS : 0;
+	int Result = IoUringEnter(Ring->RingFile, Ring->Unsubmitted, MinComplete, Flags);
+	if (Result >= 0)
+	{
+		Ring->Unsubmitted -= u32(Result);
+		return;
+	}
+
+	// EINTR and EAGAIN/EBUSY are retried by the next Submit/Poll/Wait
+	if (errno == EINTR || errno == EAGAIN || errno == EBUSY)
+		return;
+
+	// Anything else will fail again on every retry. The SQEs past the kernel's head were never consumed,
+	// take them back and fail their reads, otherwise Wait would spin on reads that can't complete.
+	LogError("io_uring_enter failed, with error: %s", strerror(errno));
+
+	u32 Head = __atomic_load_n(Ring->SqHead, __ATOMIC_ACQUIRE);
+	u32 Tail = *Ring->SqTail;
+	for (u32 i = Head; i != Tail; ++i)
+	{
+		u32 Slot = u32(Ring->Sqes[Ring->SqArray[i & Ring->SqMask]].user_data);
+		Reader->Slots[Slot].Failed = true;
+		FinishRead(Reader, Slot);
+	}
+
+	__atomic_store_n(Ring->SqTail, Head, __ATOMIC_RELEASE);
+	Ring->Unsubmitted = 0;
+}
+
+// Moves the CQEs into the finished list, requeueing reads that came back short.
+fn_internal void
+IoUringReap(posix_async_reader* Reader)
+{
+	posix_io_uring* Ring = &Reader->Ring;
+
+	u32 Head = *Ring->CqHead;
+	u32 Tail = __atomic_load_n(Ring->CqTail, __ATOMIC_ACQUIRE);
+
+	for (; Head != Tail; ++Head)
+	{
+		const io_uring_cqe* Cqe = &Ring->Cqes[Head & Ring->CqMask];
+		u32              Slot = u32(Cqe->user_data);
+		posix_read_slot& Read = Reader->Slots[Slot];
+
+		if (Cqe->res > 0)
+		{
+			Read.BytesRead += u64(Cqe->res);
+			if (Read.BytesRead < Read.Size) IoUringQueueRead(Ring, &Read, Slot);
+			else                            FinishRead(Reader, Slot);
+		}
+		else if (Cqe->res == -EINTR || Cqe->res == -EAGAIN)
+		{
+			IoUringQueueRead(Ring, &Read, Slot);
+		}
+		else
+		{ // 0 is the end of the file
+			Read.Failed = Cqe->res < 0;
+			FinishRead(Reader, Slot);
+		}
+	}
+
+	__atomic_store_n(Ring->CqHead, Head, __ATOMIC_RELEASE);
+	IoUringSubmit(Reader, 0);
+}
+
+#endif // POSIX_HAS_IO_URING
+
+//
+// Thread pool fallback
+//
+
+fn_internal void
+PosixReadAll(posix_read_slot* Read)
+{
+	while (Read->BytesRead < Read->Size)
+	{
+		u64 Remaining = Read->Size - Read->BytesRead;
+		ssize_t Result = pread(Read->File, Read->Destination + Read->BytesRead, size_t(Remaining < cMaxReadSize ? Remaining : cMaxReadSize), off_t(Read->Offset + Read->BytesRead));
+
+		if (Result < 0 && errno == EINTR)
+			continue;
+
+		if (Result <= 0)
+		{ // 0 is the end of the file
+			Read->Failed = Result < 0;
+			return;
+		}
+
+		Read->BytesRead += u64(Result);
+	}
+}
+
+fn_internal void*
+PosixReadWorker(void* Data)
+{
+	posix_async_reader* Reader = (posix_async_reader*)Data;
+
+	pthread_mutex_lock(&Reader->Lock);
+	while (true)
+	{
+		while (Reader->PendingCount == 0 && !Reader->Quit)
+		{
+			pthread_cond_wait(&Reader->WorkReady, &Reader->Lock);
+		}
+
+		if (Reader->PendingCount == 0)
+			break;
+
+		u32 Slot = Reader->Pending[Reader->PendingFirst];
+		Reader->PendingFirst  = (Reader->PendingFirst + 1) % Reader->MaxInFlight;
+		Reader->PendingCount -= 1;
+
+		pthread_mutex_unlock(&Reader->Lock);
+		PosixReadAll(&Reader->Slots[Slot]);
+		pthread_mutex_lock(&Reader->Lock);
+
+		FinishRead(Reader, Slot);
+		pthread_cond_signal(&Reader->WorkDone);
+	}
+	pthread_mutex_unlock(&Reader->Lock);
+
+	return nullptr;
+}
+
+//
+// platform_async_reader
+//
+
+void
+platform_async_reader::Init(const allocator& Allocator, u32 MaxInFlight)
+{
+	assert(!mInternalState && MaxInFlight > 0);
+
+	allocator           InternalAllocator = Allocator.Clone();
+	posix_async_reader* Reader            = InternalAllocator.AllocEmplace<posix_async_reader>();
+
+	Reader->Allocator     = InternalAllocator;
+	Reader->MaxInFlight   = MaxInFlight;
+	Reader->Slots         = InternalAllocator.AllocArray<posix_read_slot>(MaxInFlight, allocation_strategy::zero);
+	Reader->FreeSlots     = InternalAllocator.AllocArray<u32>(MaxInFlight);
+	Reader->Finished      = InternalAllocator.AllocArray<u32>(MaxInFlight);
+	Reader->FreeSlotCount = MaxInFlight;
+
+	// Pop in increasing order
+	ForRange(u32, i, MaxInFlight)
+	{
+		Reader->FreeSlots[i] = MaxInFlight - 1 - i;
+	}
+
+	pthread_mutex_init(&Reader->Lock, nullptr);
+	pthread_cond_init(&Reader->WorkReady, nullptr);
+	pthread_cond_init(&Reader->WorkDone, nullptr);
+
+#if POSIX_HAS_IO_URING
+	Reader->UsesIoUring = IoUringInit(&Reader->Ring, NextHighestPow2_u32(MaxInFlight));
+#endif
+
+	if (!Reader->UsesIoUring)
+	{
+		Reader->Pending = InternalAllocator.AllocArray<u32>(MaxInFlight);
+
+		// Fewer workers only means fewer reads in parallel, Submit reads inline if none started.
+		u32 ThreadCount = MaxInFlight < cFallbackThreadCount ? MaxInFlight : cFallbackThreadCount;
+		while (Reader->ThreadCount < ThreadCount)
+		{
+			int CreateResult = pthread_create(&Reader->Threads[Reader->ThreadCount], nullptr, PosixReadWorker, Reader);
+			if (CreateResult != 0)
+			{
+				LogError("Unable to create async read thread, with error: %s", strerror(CreateResult));
+				break;
+			}
+			Reader->ThreadCount += 1;
+		}
+	}
+
+	mInFlight      = 0;
+	mInternalState = Reader;
+}
+
+void
+platform_async_reader::Deinit()
+{
+	if (!mInternalState) return;
+	posix_async_reader* Reader = (posix_async_reader*)mInternalState;
+
+	// The kernel or the workers may still be writing into the callers' buffers.
+	platform_read_completion Dropped[16];
+	while (mInFlight > 0)
+	{
+		Wait(Dropped, ArrayCount(Dropped));
+	}
+
+#if POSIX_HAS_IO_URING
+	if (Reader->UsesIoUring)
+	{
+		IoUringDeinit(&Reader->Ring);
+	}
+#endif
+
+	if (Reader->ThreadCount > 0)
+	{
+		pthread_mutex_lock(&Reader->Lock);
+		Reader->Quit = true;
+		pthread_cond_broadcast(&Reader->WorkReady);
+		pthread_mutex_unlock(&Reader->Lock);
+
+		ForRange(u32, i, Reader->ThreadCount)
+		{
+			pthread_join(Reader->Threads[i], nullptr);
+		}
+	}
+
+	pthread_cond_destroy(&Reader->WorkDone);
+	pthread_cond_destroy(&Reader->WorkReady);
+	pthread_mutex_destroy(&Reader->Lock);
+
+	allocator Allocator = Reader->Allocator;
+	if (Reader->Pending) Allocator.Free(Reader->Pending);
+	Allocator.Free(Reader->Finished);
+	Allocator.Free(Reader->FreeSlots);
+	Allocator.Free(Reader->Slots);
+	Allocator.Free(Reader, allocation_strategy::deconstruct);
+
+	mInFlight      = 0;
+	mInternalState = nullptr;
+}
+
+u32
+platform_async_reader::Submit(const platform_read_request* Requests, u32 Count)
+{
+	assert(mInternalState);
+	posix_async_reader* Reader = (posix_async_reader*)mInternalState;
+
+	// Files are opened here rather than with IORING_OP_OPENAT, opening is cheap next to the read and it
+	// keeps the error handling in one place.
+	u32 Taken = 0;
+	for (; Taken < Count && Reader->FreeSlotCount > 0; ++Taken)
+	{
+		const platform_read_request& Request = Requests[Taken];
+		assert(Request.Destination || Request.Size == 0);
+
+		Reader->FreeSlotCount -= 1;
+		u32 Slot = Reader->FreeSlots[Reader->FreeSlotCount];
+
+		posix_read_slot& Read = Reader->Slots[Slot];
+		Read             = {};
+		Read.File        = open(Request.AbsolutePath.Ptr(), O_RDONLY | O_CLOEXEC);
+		Read.Destination = (u8*)Request.Destination;
+		Read.Offset      = Request.Offset;
+		Read.Size        = Request.Size;
+		Read.UserData    = Request.UserData;
+
+		bool CompleteNow = Read.File < 0 || Read.Size == 0;
+		if (Read.File < 0)
+		{
+			LogError("Unable to open file: %s, with error: %s", Request.AbsolutePath.Ptr(), strerror(errno));
+			Read.Failed = true;
+		}
+
+		if (Reader->UsesIoUring)
+		{
+#if POSIX_HAS_IO_URING
+			if (CompleteNow) FinishRead(Reader, Slot);
+			else             IoUringQueueRead(&Reader->Ring, &Read, Slot);
+#endif
+		}
+		else
+		{
+			if (!CompleteNow && Reader->ThreadCount == 0)
+			{ // No worker to hand the read to, so it runs on the calling thread
+				PosixReadAll(&Read);
+				CompleteNow = true;
+			}
+
+			pthread_mutex_lock(&Reader->Lock);
+			if (CompleteNow)
+			{
+				FinishRead(Reader, Slot);
+			}
+			else
+			{
+				Reader->Pending[(Reader->PendingFirst + Reader->PendingCount) % Reader->MaxInFlight] = Slot;
+				Reader->PendingCount += 1;
+				pthread_cond_signal(&Reader->WorkReady);
+			}
+			pthread_mutex_unlock(&Reader->Lock);
+		}
+	}
+
+#if POSIX_HAS_IO_URING
+	if (Reader->UsesIoUring)
+	{ // The whole batch goes to the kernel in one syscall
+		IoUringSubmit(Reader, 0);
+	}
+#endif
+
+	mInFlight += Taken;
+	return Taken;
+}
+
+// Copies out the finished reads and returns their slots to the free list. Takes the lock in the
+// thread pool fallback.
+fn_internal u32
+PopFinished(posix_async_reader* Reader, platform_read_completion* Completions, u32 MaxCompletions)
+{
+	u32 Count = Reader->FinishedCount < MaxCompletions ? Reader->FinishedCount : MaxCompletions;
+	ForRange(u32, i, Count)
+	{
+		u32 Slot = Reader->Finished[Reader->FinishedFirst];
+		Reader->FinishedFirst = (Reader->FinishedFirst + 1) % Reader->MaxInFlight;
+
+		const posix_read_slot& Read = Reader->Slots[Slot];
+		Completions[i].UserData  = Read.UserData;
+		Completions[i].BytesRead = Read.BytesRead;
+		Completions[i].Succeeded = !Read.Failed;
+
+		Reader->FreeSlots[Reader->FreeSlotCount] = Slot;
+		Reader->FreeSlotCount += 1;
+	}
+
+	Reader->FinishedCount -= Count;
+	return Count;
+}
+
+u32
+platform_async_reader::Poll(platform_read_completion* Completions, u32 MaxCompletions)
+{
+	assert(mInternalState);
+	posix_async_reader* Reader = (posix_async_reader*)mInternalState;
+
+	u32 Count = 0;
+	if (Reader->UsesIoUring)
+	{
+#if POSIX_HAS_IO_URING
+		IoUringReap(Reader);
+		Count = PopFinished(Reader, Completions, MaxCompletions);
+#endif
+	}
+	else
+	{
+		pthread_mutex_lock(&Reader->Lock);
+		Count = PopFinished(Reader, Completions, MaxCompletions);
+		pthread_mutex_unlock(&Reader->Lock);
+	}
+
+	mInFlight -= Count;
+	return Count;
+}
+
+u32
+platform_async_reader::Wait(platform_read_completion* Completions, u32 MaxCompletions)
+{
+	assert(mInternalState && MaxCompletions > 0);
+	posix_async_reader* Reader = (posix_async_reader*)mInternalState;
+
+	u32 Count = 0;
+	if (Reader->UsesIoUring)
+	{
+#if POSIX_HAS_IO_URING
+		while (mInFlight > 0)
+		{
+			IoUringReap(Reader);
+			Count = PopFinished(Reader, Completions, MaxCompletions);
+			if (Count > 0) break;
+
+			IoUringSubmit(Reader, 1);
+		}
+#endif
+	}
+	else
+	{
+		pthread_mutex_lock(&Reader->Lock);
+		while (Reader->FinishedCount == 0 && mInFlight > 0)
+		{
+			pthread_cond_wait(&Reader->WorkDone, &Reader->Lock);
+		}
+		Count = PopFinished(Reader, Completions, MaxCompletions);
+		pthread_mutex_unlock(&Reader->Lock);
+	}
+
+	mInFlight -= Count;
+	return Count;
+}
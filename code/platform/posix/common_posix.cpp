@@ -0,0 +1,47 @@
+#include "common_posix.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+void PlatformInit()
+{ // NOTE: nothing for now, the scheduler resolution is not adjustable (nor needs to be) on Linux
+}
+
+void PlatformDeinit()
+{ // NOTE: nothing for now
+}
+
+bool
+PosixSleep(u64 Nanoseconds)
+{
+	timespec Remaining = {};
+	Remaining.tv_sec  = time_t(Nanoseconds / 1'000'000'000);
+	Remaining.tv_nsec = long(Nanoseconds % 1'000'000'000);
+
+	// A signal interrupts the sleep and reports how much of it is left.
+	while (nanosleep(&Remaining, &Remaining) != 0)
+	{
+		if (errno != EINTR)
+			return false;
+	}
+
+	return true;
+}
+
+void PlatformSleepMainThread(u32 TimeMS)
+{
+	PosixSleep(u64(TimeMS) * 1'000'000);
+}
+
+void PlatformSleepNanoseconds(u64 Nanoseconds)
+{
+	PosixSleep(Nanoseconds);
+}
+
+void PlatformExitProcess()
+{
+	// Flush stdio so the fatal message is not lost, but skip the static destructors like ExitProcess does.
+	fflush(stdout);
+	fflush(stderr);
+	_exit(EXIT_FAILURE);
+}
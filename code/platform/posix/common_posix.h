@@ -0,0 +1,19 @@
+#ifndef _PLATFORM_POSIX_COMMON_
+#define _PLATFORM_POSIX_COMMON_
+
+#include <types.h>
+
+#include "../platform.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+// Sleeps the calling thread, resuming after signals. Returns false if nanosleep failed for another reason.
+bool PosixSleep(u64 Nanoseconds);
+
+#endif //_PLATFORM_POSIX_COMMON_
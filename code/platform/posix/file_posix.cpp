@@ -0,0 +1,166 @@
+#include "common_posix.h"
+
+#include <util/allocator.h>
+#include <util/str8.h>
+
+#include <string.h>
+
+bool 
+PlatformLoadFileIntoBuffer(allocator& Allocator, istr8 AbsolutePath, u8** Buffer, u64* BufferSize)
+{
+	int FileHandle = open(AbsolutePath.Ptr(), O_RDONLY | O_CLOEXEC);
+	if (FileHandle < 0)
+	{
+		LogFatal("Unable to open file: %s, with error: %s", AbsolutePath.Ptr(), strerror(errno));
+		return false;
+	}
+
+	// Get the file info so we can know the size of the file. off_t is 64 bits on every target we build
+	// for, so there is no 4GB limit here.
+	struct stat FileInfo = {};
+	if (fstat(FileHandle, &FileInfo) != 0)
+	{
+		LogError("Unable to query file: %s, with error: %s", AbsolutePath.Ptr(), strerror(errno));
+		close(FileHandle);
+		return false;
+	}
+
+	*BufferSize = u64(FileInfo.st_size);
+	*Buffer = (u8*)Allocator.AllocChunk(*BufferSize);
+
+	// read() returns at most ~2GB per call and may return less than requested, so loop until done.
+	u64 BytesRead = 0;
+	while (BytesRead < *BufferSize)
+	{
+		ssize_t ReadResult = read(FileHandle, *Buffer + BytesRead, *BufferSize - BytesRead);
+		if (ReadResult < 0 && errno == EINTR)
+			continue;
+
+		if (ReadResult <= 0)
+		{
+			LogError("Failed to read file: %s, with error: %s", AbsolutePath.Ptr(), ReadResult < 0 ? strerror(errno) : "unexpected end of file");
+			Allocator.Free(*Buffer);
+			*Buffer     = nullptr;
+			*BufferSize = 0;
+			close(FileHandle);
+			return false;
+		}
+
+		BytesRead += u64(ReadResult);
+	}
+
+	close(FileHandle);
+	return true;
+}
+
+fn_internal int
+PosixAdviceFromHint(file_access_hint Hint)
+{
+	int Advice = MADV_NORMAL;
+	switch (Hint)
+	{
+	case file_access_hint::normal:     Advice = MADV_NORMAL;     break;
+	case file_access_hint::sequential: Advice = MADV_SEQUENTIAL; break;
+	case file_access_hint::random:     Advice = MADV_RANDOM;     break;
+	case file_access_hint::will_need:  Advice = MADV_WILLNEED;   break;
+	}
+	return Advice;
+}
+
+bool 
+PlatformMapFile(istr8 AbsolutePath, platform_mapped_file* File, file_access_hint Hint)
+{
+	assert(File);
+	*File = {};
+
+	int FileHandle = open(AbsolutePath.Ptr(), O_RDONLY | O_CLOEXEC);
+	if (FileHandle < 0)
+	{
+		LogError("Unable to open file: %s, with error: %s", AbsolutePath.Ptr(), strerror(errno));
+		return false;
+	}
+
+	struct stat FileInfo = {};
+	if (fstat(FileHandle, &FileInfo) != 0)
+	{
+		LogError("Unable to query file: %s, with error: %s", AbsolutePath.Ptr(), strerror(errno));
+		close(FileHandle);
+		return false;
+	}
+
+	// mmap rejects zero length mappings, an empty file is just an empty view.
+	if (FileInfo.st_size == 0)
+	{
+		close(FileHandle);
+		return true;
+	}
+
+	u64 FileSize = u64(FileInfo.st_size);
+	if (FileSize > u64(SIZE_MAX))
+	{
+		LogError("File: %s, is too large to map into the address space", AbsolutePath.Ptr());
+		close(FileHandle);
+		return false;
+	}
+
+	void* View = mmap(nullptr, size_t(FileSize), PROT_READ, MAP_PRIVATE, FileHandle, 0);
+	// The mapping holds its own reference to the file.
+	close(FileHandle);
+
+	if (View == MAP_FAILED)
+	{
+		LogError("Unable to map file: %s, with error: %s", AbsolutePath.Ptr(), strerror(errno));
+		return false;
+	}
+
+	File->Data = (const u8*)View;
+	File->Size = FileSize;
+
+	if (Hint != file_access_hint::normal)
+	{
+		madvise(View, size_t(FileSize), PosixAdviceFromHint(Hint));
+	}
+
+	return true;
+}
+
+void 
+PlatformUnmapFile(platform_mapped_file* File)
+{
+	assert(File);
+	if (File->Data)
+	{
+		// Only fails for a range that was never mapped, which means the view was corrupted.
+		if (munmap((void*)File->Data, size_t(File->Size)) != 0)
+		{
+			LogError("Unable to unmap file view, with error: %s", strerror(errno));
+		}
+	}
+
+	*File = {};
+}
+
+void 
+PlatformAdviseMappedFile(const platform_mapped_file& File, u64 Offset, u64 Size, file_access_hint Hint)
+{
+	assert(Offset <= File.Size && Size <= File.Size - Offset);
+	if (!File.Data || Size == 0) return;
+
+	// madvise wants a page aligned start, so round the range out to whole pages.
+	u64 PageSize = u64(sysconf(_SC_PAGESIZE));
+	u64 Begin    = BackwardAlign(u64(File.Data) + Offset, PageSize);
+	u64 End      = u64(File.Data) + Offset + Size;
+
+	madvise((void*)Begin, size_t(End - Begin), PosixAdviceFromHint(Hint));
+}
+
+bool 
+PlatformGetFileSize(istr8 AbsolutePath, u64* Size)
+{
+	struct stat FileInfo = {};
+	if (stat(AbsolutePath.Ptr(), &FileInfo) != 0)
+		return false;
+
+	*Size = u64(FileInfo.st_size);
+	return true;
+}
@@ -0,0 +1,292 @@
+#include "common_posix.h"
+
+#include <util/allocator.h>
+#include <util/str8.h>
+
+#include <string.h>
+#include <utility>
+
+#if defined(__linux__)
+# include <dirent.h>
+# include <sys/inotify.h>
+# define POSIX_HAS_INOTIFY 1
+#else
+# define POSIX_HAS_INOTIFY 0
+#endif
+
+#if POSIX_HAS_INOTIFY
+
+// IN_CLOSE_WRITE alone would report each save once, but misses writers that keep the file open.
+var_global constexpr u32 cWatchMask = IN_MODIFY | IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR | IN_EXCL_UNLINK;
+
+struct posix_watch
+{
+	int   Descriptor = -1;
+	mstr8 Directory  = {}; // relative to the root, empty for the root itself
+};
+
+struct posix_file_watcher
+{
+	allocator    Allocator     = {};
+	int          Inotify       = -1;
+	mstr8        Root          = {};
+
+	posix_watch* Watches       = nullptr;
+	u32          WatchCount    = 0;
+	u32          WatchCapacity = 0;
+};
+
+fn_internal mstr8
+PosixJoinPath(istr8 Directory, istr8 Name)
+{
+	if (Name.Length()      == 0) return mstr8(Directory);
+	if (Directory.Length() == 0) return mstr8(Name);
+	return mstr8(Directory) + "/" + Name;
+}
+
+fn_internal posix_watch*
+PosixFindWatch(posix_file_watcher* Watcher, int Descriptor)
+{
+	ForRange(u32, i, Watcher->WatchCount)
+	{
+		if (Watcher->Watches[i].Descriptor == Descriptor)
+			return &Watcher->Watches[i];
+	}
+	return nullptr;
+}
+
+fn_internal void
+PosixRemoveWatchAt(posix_file_watcher* Watcher, u32 Index)
+{
+	Watcher->WatchCount -= 1;
+	if (Index != Watcher->WatchCount)
+	{
+		Watcher->Watches[Index] = std::move(Watcher->Watches[Watcher->WatchCount]);
+	}
+	Watcher->Watches[Watcher->WatchCount] = {};
+}
+
+// Watches Directory and every directory below it. The files found on the way are reported as created
+// when there is a callback: they may have been written before their directory was watched.
+fn_internal void
+PosixWatchTree(posix_file_watcher* Watcher, istr8 Directory, platform_file_change_pfn Callback, void* UserData)
+{
+	mstr8 AbsolutePath = PosixJoinPath(Watcher->Root, Directory);
+
+	int Descriptor = inotify_add_watch(Watcher->Inotify, AbsolutePath.Ptr(), cWatchMask);
+	if (Descriptor < 0)
+	{
+		LogError("Unable to watch directory: %s, with error: %d", AbsolutePath.Ptr(), errno);
+		return;
+	}
+
+	// inotify hands out the same descriptor for a directory that is already watched
+	if (posix_watch* Existing = PosixFindWatch(Watcher, Descriptor))
+	{
+		Existing->Directory = mstr8(Directory);
+	}
+	else
+	{
+		if (Watcher->WatchCount == Watcher->WatchCapacity)
+		{
+			u32          NewCapacity = Watcher->WatchCapacity > 0 ? Watcher->WatchCapacity * 2 : 16;
+			posix_watch* NewWatches  = Watcher->Allocator.AllocArray<posix_watch>(NewCapacity, allocation_strategy::default_init);
+			ForRange(u32, i, Watcher->WatchCount)
+			{
+				NewWatches[i] = std::move(Watcher->Watches[i]);
+			}
+
+			Watcher->Allocator.FreeArray(Watcher->Watches, Watcher->WatchCapacity, allocation_strategy::deconstruct);
+			Watcher->Watches       = NewWatches;
+			Watcher->WatchCapacity = NewCapacity;
+		}
+
+		posix_watch& Watch = Watcher->Watches[Watcher->WatchCount++];
+		Watch.Descriptor = Descriptor;
+		Watch.Directory  = mstr8(Directory);
+	}
+
+	DIR* Dir = opendir(AbsolutePath.Ptr());
+	if (!Dir) return;
+
+	while (dirent* Entry = readdir(Dir))
+	{
+		if (strcmp(Entry->d_name, ".") == 0 || strcmp(Entry->d_name, "..") == 0)
+			continue;
+
+		mstr8 EntryPath = PosixJoinPath(Directory, Entry->d_name);
+
+		bool IsDirectory = Entry->d_type == DT_DIR;
+		if (Entry->d_type == DT_UNKNOWN)
+		{ // Some file systems don't fill in d_type
+			struct stat Stat = {};
+			mstr8 EntryAbsolutePath = PosixJoinPath(Watcher->Root, EntryPath);
+			IsDirectory = stat(EntryAbsolutePath.Ptr(), &Stat) == 0 && S_ISDIR(Stat.st_mode);
+		}
+
+		if (IsDirectory)
+		{
+			PosixWatchTree(Watcher, EntryPath, Callback, UserData);
+		}
+		else if (Callback)
+		{
+			Callback(UserData, EntryPath, file_change_type::created);
+		}
+	}
+
+	closedir(Dir);
+}
+
+// A directory moved out of the tree keeps its watches, and they would report paths that no longer
+// exist. (Deleted directories are cleaned up through IN_IGNORED instead.)
+fn_internal void
+PosixUnwatchTree(posix_file_watcher* Watcher, istr8 Directory)
+{
+	for (u32 i = 0; i < Watcher->WatchCount;)
+	{
+		const mstr8& WatchDirectory = Watcher->Watches[i].Directory;
+
+		bool IsInTree = WatchDirectory.Length() >= Directory.Length()
+			&& memcmp(WatchDirectory.Ptr(), Directory.Ptr(), Directory.Length()) == 0
+			&& (WatchDirectory.Length() == Directory.Length() || WatchDirectory[Directory.Length()] == '/');
+
+		if (IsInTree)
+		{
+			inotify_rm_watch(Watcher->Inotify, Watcher->Watches[i].Descriptor);
+			PosixRemoveWatchAt(Watcher, i);
+		}
+		else
+		{
+			i += 1;
+		}
+	}
+}
+
+#endif // POSIX_HAS_INOTIFY
+
+bool
+platform_file_watcher::Init(const allocator& Allocator, istr8 Directory)
+{
+	assert(!mInternalState);
+
+#if POSIX_HAS_INOTIFY
+	int Inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (Inotify < 0)
+	{
+		LogError("Unable to create an inotify instance, with error: %d", errno);
+		return false;
+	}
+
+	allocator           InternalAllocator = Allocator.Clone();
+	posix_file_watcher* Watcher           = InternalAllocator.AllocEmplace<posix_file_watcher>();
+
+	Watcher->Allocator = InternalAllocator;
+	Watcher->Inotify   = Inotify;
+	Watcher->Root      = mstr8(Directory);
+
+	PosixWatchTree(Watcher, "", nullptr, nullptr);
+	mInternalState = Watcher;
+
+	if (Watcher->WatchCount == 0)
+	{ // The root itself could not be watched
+		Deinit();
+		return false;
+	}
+
+	return true;
+#else
+	LogError("File watching is not supported on this platform, unable to watch: %s", Directory.Ptr());
+	return false;
+#endif
+}
+
+void
+platform_file_watcher::Deinit()
+{
+	if (!mInternalState) return;
+
+#if POSIX_HAS_INOTIFY
+	posix_file_watcher* Watcher = (posix_file_watcher*)mInternalState;
+
+	close(Watcher->Inotify); // drops every watch
+
+	allocator Allocator = Watcher->Allocator;
+	Allocator.FreeArray(Watcher->Watches, Watcher->WatchCapacity, allocation_strategy::deconstruct);
+	Allocator.Free(Watcher, allocation_strategy::deconstruct);
+#endif
+
+	mInternalState = nullptr;
+}
+
+void
+platform_file_watcher::Poll(platform_file_change_pfn Callback, void* UserData)
+{
+	assert(mInternalState && Callback);
+
+#if POSIX_HAS_INOTIFY
+	posix_file_watcher* Watcher = (posix_file_watcher*)mInternalState;
+
+	alignas(inotify_event) char Buffer[4096];
+	while (true)
+	{
+		ssize_t BytesRead = read(Watcher->Inotify, Buffer, sizeof(Buffer));
+		if (BytesRead <= 0)
+		{ // EAGAIN, nothing left
+			if (BytesRead < 0 && errno == EINTR) continue;
+			break;
+		}
+
+		for (char* Cursor = Buffer; Cursor < Buffer + BytesRead;)
+		{
+			const inotify_event* Event = (const inotify_event*)Cursor;
+			Cursor += sizeof(inotify_event) + Event->len;
+
+			if (Event->mask & IN_Q_OVERFLOW)
+			{
+				Callback(UserData, "", file_change_type::overflow);
+				continue;
+			}
+
+			posix_watch* Watch = PosixFindWatch(Watcher, Event->wd);
+			if (!Watch) continue; // the watch was removed while this event was queued
+
+			if (Event->mask & IN_IGNORED)
+			{ // The directory was deleted or unmounted
+				PosixRemoveWatchAt(Watcher, u32(Watch - Watcher->Watches));
+				continue;
+			}
+
+			if (Event->len == 0) continue; // about the watched directory itself
+
+			// Watch can move when the watch array changes below
+			mstr8 Path = PosixJoinPath(Watch->Directory, Event->name);
+
+			if (Event->mask & IN_ISDIR)
+			{
+				if (Event->mask & (IN_CREATE | IN_MOVED_TO))
+				{
+					PosixWatchTree(Watcher, Path, Callback, UserData);
+				}
+				else if (Event->mask & IN_MOVED_FROM)
+				{
+					PosixUnwatchTree(Watcher, Path);
+				}
+				continue;
+			}
+
+			if (Event->mask & (IN_CREATE | IN_MOVED_TO))
+			{
+				Callback(UserData, Path, file_change_type::created);
+			}
+			else if (Event->mask & (IN_DELETE | IN_MOVED_FROM))
+			{
+				Callback(UserData, Path, file_change_type::removed);
+			}
+			else if (Event->mask & (IN_MODIFY | IN_CLOSE_WRITE))
+			{
+				Callback(UserData, Path, file_change_type::modified);
+			}
+		}
+	}
+#endif
+}
@@ -0,0 +1,159 @@
+#include "common_posix.h"
+#include <util/str8.h>
+
+#include <stdio.h>
+#include <string.h>
+
+struct posix_standard_stream
+{
+    int  Handle;                           // File descriptor (STDOUT_FILENO or STDERR_FILENO).
+    bool IsRedirected;                     // True if redirected to a file or pipe, colors are not written.
+};
+
+// SGR (Select Graphic Rendition) codes for the 16 color palette. The dark colors are the standard
+// 30-37 foreground codes, the bright colors are the aixterm 90-97 codes. Background codes are the
+// foreground codes + 10.
+fn_internal int 
+LogColorToAnsiForeground(log_color InColor)
+{
+    int OutColor = 37;
+    switch (InColor)
+    {
+    case log_color::black:        OutColor = 30; break;
+    case log_color::dark_blue:    OutColor = 34; break;
+    case log_color::dark_green:   OutColor = 32; break;
+    case log_color::dark_cyan:    OutColor = 36; break;
+    case log_color::dark_red:     OutColor = 31; break;
+    case log_color::dark_magenta: OutColor = 35; break;
+    case log_color::dark_yellow:  OutColor = 33; break;
+    case log_color::grey:         OutColor = 37; break;
+    case log_color::dark_grey:    OutColor = 90; break;
+    case log_color::blue:         OutColor = 94; break;
+    case log_color::green:        OutColor = 92; break;
+    case log_color::cyan:         OutColor = 96; break;
+    case log_color::red:          OutColor = 91; break;
+    case log_color::magenta:      OutColor = 95; break;
+    case log_color::yellow:       OutColor = 93; break;
+    case log_color::white:        OutColor = 97; break;
+    case log_color::max:                         break;
+    }
+    return OutColor;
+}
+
+fn_internal posix_standard_stream 
+PosixGetStandardStream(int StreamType)
+{
+    posix_standard_stream Result{};
+    Result.Handle = StreamType;
+
+    // Escape codes are noise in log files and pipes. Honour the NO_COLOR convention (https://no-color.org)
+    // and dumb terminals as well.
+    const char* Term = getenv("TERM");
+    Result.IsRedirected = !isatty(StreamType) || getenv("NO_COLOR") != nullptr || (Term && strcmp(Term, "dumb") == 0);
+
+    return Result;
+}
+
+fn_internal bool 
+PosixWriteAll(int Handle, const char* Message, u64 MessageLength)
+{
+    while (MessageLength > 0)
+    {
+        ssize_t Written = write(Handle, Message, MessageLength);
+        if (Written < 0 && errno == EINTR)
+            continue;
+        if (Written <= 0)
+            return false; // Nowhere left to report the failure to.
+
+        Message       += Written;
+        MessageLength -= u64(Written);
+    }
+    return true;
+}
+
+// Prints a message to a platform stream. If the stream is a terminal, uses supplied colors.
+fn_internal void 
+PosixPrintToStream(const char* Message, u64 MessageLength, posix_standard_stream Stream, log_color Foreground, log_color Background)
+{
+    // Messages are written straight to the file descriptor, bypassing stdio, so they are not held in a
+    // buffer if the process is killed.
+    if (Stream.IsRedirected)
+    {
+        PosixWriteAll(Stream.Handle, Message, MessageLength);
+    }
+    else
+    {
+        // The messages end in a newline. Reset the colors before it, otherwise some terminals fill the
+        // rest of the line with the background color.
+        u64 TextLength = (MessageLength > 0 && Message[MessageLength - 1] == '\n') ? MessageLength - 1 : MessageLength;
+
+        char SetColor[16];
+        int  SetColorLength = snprintf(SetColor, sizeof(SetColor), "\x1b[%d;%dm", LogColorToAnsiForeground(Foreground), LogColorToAnsiForeground(Background) + 10);
+
+        constexpr char ResetColor[] = "\x1b[0m";
+
+        PosixWriteAll(Stream.Handle, SetColor, u64(SetColorLength));
+        PosixWriteAll(Stream.Handle, Message, TextLength);
+        PosixWriteAll(Stream.Handle, ResetColor, sizeof(ResetColor) - 1);
+        PosixWriteAll(Stream.Handle, Message + TextLength, MessageLength - TextLength);
+    }
+}
+
+void 
+PlatformLogToConsole(bool IsError, log_color Foreground, log_color Background, const istr8& Message)
+{
+    if (IsError)
+    {
+        var_persist posix_standard_stream ErrorStream = PosixGetStandardStream(STDERR_FILENO);
+        PosixPrintToStream(Message.Ptr(), Message.Length(), ErrorStream, Foreground, Background);
+    }
+    else
+    {
+        var_persist posix_standard_stream StandardStream = PosixGetStandardStream(STDOUT_FILENO);
+        PosixPrintToStream(Message.Ptr(), Message.Length(), StandardStream, Foreground, Background);
+    }
+}
+
+void 
+PlatformLogToDebugConsole([[maybe_unused]] const istr8& Message)
+{
+    // NOTE: there is no debugger output channel on Linux, debuggers read the console.
+}
+
+u64
+PlatformLogFileOpen(istr8 Path, u64* FileSize)
+{
+    int Handle = open(Path.Ptr(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (Handle < 0)
+        return 0;
+
+    struct stat FileInfo = {};
+    *FileSize = fstat(Handle, &FileInfo) == 0 ? u64(FileInfo.st_size) : 0;
+
+    // 0 is a valid descriptor, offset by one so 0 can mean "no file".
+    return u64(Handle) + 1;
+}
+
+bool
+PlatformLogFileWrite(u64 File, const void* Data, u64 Size)
+{
+    return PosixWriteAll(int(File - 1), (const char*)Data, Size);
+}
+
+void
+PlatformLogFileClose(u64 File)
+{
+    close(int(File - 1));
+}
+
+bool
+PlatformLogFileRename(istr8 From, istr8 To)
+{
+    return rename(From.Ptr(), To.Ptr()) == 0;
+}
+
+bool
+PlatformLogFileDelete(istr8 Path)
+{
+    return unlink(Path.Ptr()) == 0;
+}
@@ -0,0 +1,198 @@
+#include "common_posix.h"
+
+#include <stdio.h>
+#include <string.h>
+
+// Used when the kernel does not say, the PMD size on x64 and on ARM64 with 4KB pages.
+var_global constexpr u64 cDefaultHugePageSize = 2 * 1024 * 1024;
+
+fn_internal u64
+PosixQueryHugePageSize()
+{
+#if defined(__linux__)
+	FILE* File = fopen("/sys/kernel/mm/transparent_hugepage/hpage_pmd_size", "r");
+	if (File)
+	{
+		unsigned long long Size = 0;
+		int Matched = fscanf(File, "%llu", &Size);
+		fclose(File);
+
+		if (Matched == 1 && Size > 0) return u64(Size);
+	}
+	return cDefaultHugePageSize;
+#else
+	return 0;
+#endif
+}
+
+fn_internal int
+PosixProtectionFlags(page_protection Protection)
+{
+	int Flags = PROT_NONE;
+	switch (Protection)
+	{
+	case page_protection::none:       Flags = PROT_NONE;              break;
+	case page_protection::read:       Flags = PROT_READ;              break;
+	case page_protection::read_write: Flags = PROT_READ | PROT_WRITE; break;
+	}
+	return Flags;
+}
+
+// Rounds [Offset, Offset + Size) out to whole pages of the reservation.
+fn_internal void
+PosixPageRange(const platform_reservation& Reservation, u64 Offset, u64 Size, u8** Begin, u64* Length)
+{
+	assert(Offset <= Reservation.Size && Size <= Reservation.Size - Offset);
+
+	u64 First = BackwardAlign(Offset, Reservation.PageSize);
+	u64 Last  = ForwardAlign(Offset + Size, Reservation.PageSize);
+
+	*Begin  = Reservation.Base + First;
+	*Length = Last - First;
+}
+
+u64
+PlatformGetPageSize()
+{
+	var_persist const u64 PageSize = u64(sysconf(_SC_PAGESIZE));
+	return PageSize;
+}
+
+u64
+PlatformGetHugePageSize()
+{
+	var_persist const u64 HugePageSize = PosixQueryHugePageSize();
+	return HugePageSize;
+}
+
+bool
+PlatformReserve(u64 Size, platform_reservation* Reservation, page_hint Hint)
+{
+	assert(Reservation && Size > 0);
+	*Reservation = {};
+
+	u64 PageSize     = PlatformGetPageSize();
+	u64 HugePageSize = PlatformGetHugePageSize();
+
+#if defined(MAP_HUGETLB)
+	if (Hint == page_hint::huge && HugePageSize > 0)
+	{
+		// Without MAP_NORESERVE the huge pages are set aside now, so an empty pool fails here rather
+		// than with a SIGBUS on first touch.
+		u64   HugeSize = ForwardAlign(Size, HugePageSize);
+		void* Base     = mmap(nullptr, size_t(HugeSize), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+		if (Base != MAP_FAILED)
+		{
+			Reservation->Base     = (u8*)Base;
+			Reservation->Size     = HugeSize;
+			Reservation->PageSize = HugePageSize;
+			Reservation->Pages    = page_hint::huge;
+			return true;
+		}
+
+		Hint = page_hint::transparent_huge; // no hugetlbfs pages configured
+	}
+#endif
+
+	bool WantsTransparentHuge = (Hint == page_hint::transparent_huge || Hint == page_hint::huge) && HugePageSize > 0;
+
+	// Transparent huge pages are only used for huge page aligned parts of a range, so over-reserve and
+	// trim down to an aligned block.
+	u64 Alignment   = WantsTransparentHuge ? HugePageSize : PageSize;
+	u64 AlignedSize = ForwardAlign(Size, Alignment);
+	u64 MappedSize  = AlignedSize + (Alignment > PageSize ? Alignment : 0);
+
+	void* Mapped = mmap(nullptr, size_t(MappedSize), PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	if (Mapped == MAP_FAILED)
+	{
+		LogError("Unable to reserve %llu bytes of address space, with error: %s", (unsigned long long)Size, strerror(errno));
+		return false;
+	}
+
+	u8* Base = (u8*)ForwardAlign(Mapped, Alignment);
+	u64 Head = u64(Base - (u8*)Mapped);
+	u64 Tail = MappedSize - Head - AlignedSize;
+	if (Head > 0) munmap(Mapped, size_t(Head));
+	if (Tail > 0) munmap(Base + AlignedSize, size_t(Tail));
+
+	Reservation->Base     = Base;
+	Reservation->Size     = AlignedSize;
+	Reservation->PageSize = PageSize;
+	Reservation->Pages    = page_hint::normal;
+
+#if defined(MADV_HUGEPAGE)
+	// Fails when transparent huge pages are disabled, the range then just uses normal pages.
+	if (WantsTransparentHuge && madvise(Base, size_t(AlignedSize), MADV_HUGEPAGE) == 0)
+	{
+		Reservation->Pages = page_hint::transparent_huge;
+	}
+#endif
+
+	return true;
+}
+
+void
+PlatformRelease(platform_reservation* Reservation)
+{
+	assert(Reservation);
+	if (Reservation->Base)
+	{
+		if (munmap(Reservation->Base, size_t(Reservation->Size)) != 0)
+		{
+			LogError("Unable to release %llu bytes, with error: %s", (unsigned long long)Reservation->Size, strerror(errno));
+		}
+	}
+
+	*Reservation = {};
+}
+
+bool
+PlatformCommit(const platform_reservation& Reservation, u64 Offset, u64 Size)
+{
+	if (Reservation.Pages == page_hint::huge || Size == 0) return true;
+
+	u8* Begin;
+	u64 Length;
+	PosixPageRange(Reservation, Offset, Size, &Begin, &Length);
+
+	// Linux commits on first touch, making the pages accessible is all there is to do.
+	if (mprotect(Begin, size_t(Length), PROT_READ | PROT_WRITE) != 0)
+	{
+		LogError("Unable to commit %llu bytes, with error: %s", (unsigned long long)Length, strerror(errno));
+		return false;
+	}
+
+	return true;
+}
+
+void
+PlatformDecommit(const platform_reservation& Reservation, u64 Offset, u64 Size)
+{
+	if (Reservation.Pages == page_hint::huge || Size == 0) return;
+
+	u8* Begin;
+	u64 Length;
+	PosixPageRange(Reservation, Offset, Size, &Begin, &Length);
+
+	// MADV_DONTNEED frees the pages right away, the next touch after a Commit maps zeroed pages.
+	madvise(Begin, size_t(Length), MADV_DONTNEED);
+	mprotect(Begin, size_t(Length), PROT_NONE);
+}
+
+bool
+PlatformProtect(const platform_reservation& Reservation, u64 Offset, u64 Size, page_protection Protection)
+{
+	if (Size == 0) return true;
+
+	u8* Begin;
+	u64 Length;
+	PosixPageRange(Reservation, Offset, Size, &Begin, &Length);
+
+	if (mprotect(Begin, size_t(Length), PosixProtectionFlags(Protection)) != 0)
+	{
+		LogError("Unable to change the protection of %llu bytes, with error: %s", (unsigned long long)Length, strerror(errno));
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,269 @@
+#include "common_posix.h"
+
+#include <util/allocator.h>
+
+#include <limits.h>
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+
+#if defined(__linux__)
+# include <linux/futex.h>
+# include <sys/syscall.h>
+# define POSIX_HAS_FUTEX 1
+#else
+# define POSIX_HAS_FUTEX 0
+#endif
+
+// Linux thread names hold 15 characters and the null terminator.
+var_global constexpr u32 cMaxThreadNameLength = 15;
+
+var_global std::atomic<u64> gParkCount = 0;
+var_global std::atomic<u64> gWakeCount = 0;
+
+struct posix_thread_start
+{
+	platform_thread_pfn Function;
+	void*               UserData;
+	u64                 AffinityMask;
+	char                Name[cMaxThreadNameLength + 1];
+};
+
+fn_internal void*
+PosixThreadEntry(void* Data)
+{
+	// Copy out and free first, the thread function may never return
+	posix_thread_start Start = *(posix_thread_start*)Data;
+	allocator::Default().Free((posix_thread_start*)Data);
+
+	if (Start.Name[0])
+	{
+		PlatformSetThreadName(Start.Name);
+	}
+
+	if (Start.AffinityMask)
+	{
+		PlatformSetThreadAffinity(Start.AffinityMask);
+	}
+
+	Start.Function(Start.UserData);
+	return nullptr;
+}
+
+fn_internal bool
+PosixSetAffinity(pthread_t Thread, u64 AffinityMask)
+{
+#if defined(__linux__)
+	cpu_set_t Set;
+	CPU_ZERO(&Set);
+	ForRange(u32, i, 64)
+	{
+		if (AffinityMask & (u64(1) << i))
+			CPU_SET(i, &Set);
+	}
+
+	int Result = pthread_setaffinity_np(Thread, sizeof(Set), &Set);
+	if (Result != 0)
+	{
+		LogError("Unable to set thread affinity to 0x%llx, with error: %s", (unsigned long long)AffinityMask, strerror(Result));
+		return false;
+	}
+	return true;
+#else
+	return false; // macOS only has affinity tags, which are hints
+#endif
+}
+
+u32
+PlatformGetLogicalProcessorCount()
+{
+#if defined(__linux__)
+	// The processors this process may run on, which is what matters under taskset or in a container
+	cpu_set_t Set;
+	if (sched_getaffinity(0, sizeof(Set), &Set) == 0)
+		return u32(CPU_COUNT(&Set));
+#endif
+
+	long Count = sysconf(_SC_NPROCESSORS_ONLN);
+	return Count > 0 ? u32(Count) : 1;
+}
+
+u32
+PlatformGetCurrentThreadId()
+{
+#if defined(__linux__)
+	return u32(syscall(SYS_gettid));
+#else
+	return u32(u64(pthread_self()));
+#endif
+}
+
+void
+PlatformYieldThread()
+{
+	sched_yield();
+}
+
+void
+PlatformSetThreadName(istr8 Name)
+{
+	char Truncated[cMaxThreadNameLength + 1] = {};
+	memcpy(Truncated, Name.Ptr(), Name.Length() < cMaxThreadNameLength ? Name.Length() : cMaxThreadNameLength);
+
+#if defined(__APPLE__)
+	pthread_setname_np(Truncated);
+#else
+	pthread_setname_np(pthread_self(), Truncated);
+#endif
+}
+
+bool
+PlatformSetThreadAffinity(u64 AffinityMask)
+{
+	return PosixSetAffinity(pthread_self(), AffinityMask);
+}
+
+bool
+platform_thread::Start(platform_thread_pfn Function, void* UserData, istr8 Name, u64 AffinityMask)
+{
+	assert(!IsStarted() && Function);
+
+	posix_thread_start* Start = allocator::Default().Alloc<posix_thread_start>(allocation_strategy::zero);
+	Start->Function     = Function;
+	Start->UserData     = UserData;
+	Start->AffinityMask = AffinityMask;
+	memcpy(Start->Name, Name.Ptr(), Name.Length() < cMaxThreadNameLength ? Name.Length() : cMaxThreadNameLength);
+
+	pthread_t Thread;
+	int Result = pthread_create(&Thread, nullptr, PosixThreadEntry, Start);
+	if (Result != 0)
+	{
+		LogError("Unable to create thread: %s, with error: %s", Start->Name, strerror(Result));
+		allocator::Default().Free(Start);
+		return false;
+	}
+
+	static_assert(sizeof(pthread_t) <= sizeof(mHandle));
+	mHandle = u64(Thread);
+	return true;
+}
+
+void
+platform_thread::Join()
+{
+	if (!IsStarted()) return;
+
+	// Fails when a thread joins itself or the handle was already joined. Either way it is no use anymore.
+	int Result = pthread_join(pthread_t(mHandle), nullptr);
+	if (Result != 0)
+	{
+		LogError("Unable to join thread, with error: %s", strerror(Result));
+	}
+	mHandle = 0;
+}
+
+bool
+platform_thread::SetAffinity(u64 AffinityMask)
+{
+	assert(IsStarted());
+	return PosixSetAffinity(pthread_t(mHandle), AffinityMask);
+}
+
+bool
+PlatformAllocTlsSlot(platform_tls_slot* Slot)
+{
+	assert(Slot);
+
+	pthread_key_t Key;
+	int Result = pthread_key_create(&Key, nullptr);
+	if (Result != 0)
+	{
+		LogError("Unable to allocate a thread local storage slot, with error: %s", strerror(Result));
+		return false;
+	}
+
+	static_assert(sizeof(pthread_key_t) <= sizeof(platform_tls_slot));
+	*Slot = platform_tls_slot(Key);
+	return true;
+}
+
+void
+PlatformFreeTlsSlot(platform_tls_slot Slot)
+{
+	pthread_key_delete(pthread_key_t(Slot));
+}
+
+void*
+PlatformGetTlsValue(platform_tls_slot Slot)
+{
+	return pthread_getspecific(pthread_key_t(Slot));
+}
+
+void
+PlatformSetTlsValue(platform_tls_slot Slot, void* Value)
+{
+	pthread_setspecific(pthread_key_t(Slot), Value);
+}
+
+//
+// Wait on Address
+//
+
+bool
+PlatformWaitOnAddress(const std::atomic<u32>* Address, u32 Expected, u64 TimeoutNs)
+{
+	static_assert(sizeof(std::atomic<u32>) == sizeof(u32), "futex needs a plain 32-bit word");
+	gParkCount.fetch_add(1, std::memory_order_relaxed);
+
+#if POSIX_HAS_FUTEX
+	timespec  Timeout    = {};
+	timespec* TimeoutPtr = nullptr;
+	if (TimeoutNs != cPlatformWaitForever)
+	{ // Relative for FUTEX_WAIT
+		Timeout.tv_sec  = time_t(TimeoutNs / 1'000'000'000);
+		Timeout.tv_nsec = long(TimeoutNs % 1'000'000'000);
+		TimeoutPtr      = &Timeout;
+	}
+
+	// EAGAIN (the value already changed) and EINTR are wake ups like any other
+	long Result = syscall(SYS_futex, (const u32*)Address, FUTEX_WAIT_PRIVATE, Expected, TimeoutPtr, nullptr, 0);
+	return !(Result != 0 && errno == ETIMEDOUT);
+#else
+	// No futex: poll, slowly. Good enough for the few platforms that only get a port.
+	u64 StartNs = PlatformQueryNanoseconds();
+	while (Address->load(std::memory_order_acquire) == Expected)
+	{
+		if (TimeoutNs != cPlatformWaitForever && PlatformQueryNanoseconds() - StartNs >= TimeoutNs)
+			return false;
+		PosixSleep(50'000);
+	}
+	return true;
+#endif
+}
+
+void
+PlatformWakeOne(const std::atomic<u32>* Address)
+{
+	gWakeCount.fetch_add(1, std::memory_order_relaxed);
+#if POSIX_HAS_FUTEX
+	syscall(SYS_futex, (const u32*)Address, FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+#endif
+}
+
+void
+PlatformWakeAll(const std::atomic<u32>* Address)
+{
+	gWakeCount.fetch_add(1, std::memory_order_relaxed);
+#if POSIX_HAS_FUTEX
+	syscall(SYS_futex, (const u32*)Address, FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+#endif
+}
+
+platform_sync_stats
+PlatformGetSyncStats()
+{
+	platform_sync_stats Stats = {};
+	Stats.Parks = gParkCount.load(std::memory_order_relaxed);
+	Stats.Wakes = gWakeCount.load(std::memory_order_relaxed);
+	return Stats;
+}
@@ -0,0 +1,23 @@
+#include "common_posix.h"
+
+// CLOCK_MONOTONIC does not jump when the wall clock is changed, and reading it goes through the vDSO
+// rather than a syscall. Ticks are nanoseconds.
+u64
+PlatformQueryTicks()
+{
+    timespec Time = {};
+    clock_gettime(CLOCK_MONOTONIC, &Time);
+    return u64(Time.tv_sec) * 1'000'000'000 + u64(Time.tv_nsec);
+}
+
+u64
+PlatformGetTickFrequency()
+{
+    return 1'000'000'000;
+}
+
+u64
+PlatformQueryNanoseconds()
+{
+    return PlatformQueryTicks();
+}
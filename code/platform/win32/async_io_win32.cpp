@@ -0,0 +1,268 @@
+#include "common_win32.h"
+
+#include <util/allocator.h>
+#include <util/str8.h>
+
+// ReadFile takes a DWORD size, larger reads are split into chunks.
+var_global constexpr u64 cMaxReadSize = _1GB;
+
+struct win32_read_slot
+{
+	OVERLAPPED Overlapped;  // first, so a completion's OVERLAPPED* is the slot
+	HANDLE     File;
+	u8*        Destination;
+	u64        Offset;
+	u64        Size;
+	u64        BytesRead;
+	void*      UserData;
+	bool       Failed;
+};
+
+struct win32_async_reader
+{
+	allocator         Allocator     = {};
+	u32               MaxInFlight   = 0;
+	HANDLE            Port          = nullptr;
+
+	win32_read_slot*  Slots         = nullptr;
+	u32*              FreeSlots     = nullptr;
+	u32               FreeSlotCount = 0;
+
+	// Slots whose read finished, FIFO
+	u32*              Finished      = nullptr;
+	u32               FinishedFirst = 0;
+	u32               FinishedCount = 0;
+
+	OVERLAPPED_ENTRY* Entries       = nullptr; // GetQueuedCompletionStatusEx output
+};
+
+fn_internal void
+Win32FinishRead(win32_async_reader* Reader, u32 Slot)
+{
+	win32_read_slot& Read = Reader->Slots[Slot];
+	if (Read.File != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(Read.File);
+		Read.File = INVALID_HANDLE_VALUE;
+	}
+
+	assert(Reader->FinishedCount < Reader->MaxInFlight);
+	Reader->Finished[(Reader->FinishedFirst + Reader->FinishedCount) % Reader->MaxInFlight] = Slot;
+	Reader->FinishedCount += 1;
+}
+
+// Issues the next chunk of a read. The completion is posted to the port even if ReadFile finishes
+// synchronously, so only immediate failures are handled here.
+fn_internal void
+Win32QueueRead(win32_async_reader* Reader, u32 Slot)
+{
+	win32_read_slot& Read = Reader->Slots[Slot];
+
+	u64 Remaining = Read.Size - Read.BytesRead;
+	u64 Offset    = Read.Offset + Read.BytesRead;
+
+	Read.Overlapped            = {};
+	Read.Overlapped.Offset     = DWORD(Offset);
+	Read.Overlapped.OffsetHigh = DWORD(Offset >> 32);
+
+	BOOL ReadResult = ReadFile(Read.File, Read.Destination + Read.BytesRead, DWORD(Remaining < cMaxReadSize ? Remaining : cMaxReadSize), nullptr, &Read.Overlapped);
+	if (ReadResult == FALSE)
+	{
+		DWORD Error = GetLastError();
+		if (Error != ERROR_IO_PENDING)
+		{
+			Read.Failed = Error != ERROR_HANDLE_EOF;
+			Win32FinishRead(Reader, Slot);
+		}
+	}
+}
+
+// Moves the completion packets into the finished list, issuing the next chunk of reads that are not done.
+fn_internal void
+Win32Reap(win32_async_reader* Reader, DWORD Timeout)
+{
+	ULONG Removed = 0;
+	if (!GetQueuedCompletionStatusEx(Reader->Port, Reader->Entries, Reader->MaxInFlight, &Removed, Timeout, FALSE))
+		return; // timed out
+
+	ForRange(ULONG, i, Removed)
+	{
+		win32_read_slot* Read = (win32_read_slot*)Reader->Entries[i].lpOverlapped;
+		u32              Slot = u32(Read - Reader->Slots);
+
+		DWORD Transferred = 0;
+		BOOL  Result      = GetOverlappedResult(Read->File, &Read->Overlapped, &Transferred, FALSE);
+		DWORD Error       = Result ? ERROR_SUCCESS : GetLastError();
+
+		Read->BytesRead += Transferred;
+		if (Error == ERROR_SUCCESS && Transferred > 0 && Read->BytesRead < Read->Size)
+		{
+			Win32QueueRead(Reader, Slot);
+		}
+		else
+		{ // 0 bytes or ERROR_HANDLE_EOF is the end of the file
+			Read->Failed = Error != ERROR_SUCCESS && Error != ERROR_HANDLE_EOF;
+			Win32FinishRead(Reader, Slot);
+		}
+	}
+}
+
+fn_internal u32
+Win32PopFinished(win32_async_reader* Reader, platform_read_completion* Completions, u32 MaxCompletions)
+{
+	u32 Count = Reader->FinishedCount < MaxCompletions ? Reader->FinishedCount : MaxCompletions;
+	ForRange(u32, i, Count)
+	{
+		u32 Slot = Reader->Finished[Reader->FinishedFirst];
+		Reader->FinishedFirst = (Reader->FinishedFirst + 1) % Reader->MaxInFlight;
+
+		const win32_read_slot& Read = Reader->Slots[Slot];
+		Completions[i].UserData  = Read.UserData;
+		Completions[i].BytesRead = Read.BytesRead;
+		Completions[i].Succeeded = !Read.Failed;
+
+		Reader->FreeSlots[Reader->FreeSlotCount] = Slot;
+		Reader->FreeSlotCount += 1;
+	}
+
+	Reader->FinishedCount -= Count;
+	return Count;
+}
+
+void
+platform_async_reader::Init(const allocator& Allocator, u32 MaxInFlight)
+{
+	assert(!mInternalState && MaxInFlight > 0);
+
+	allocator           InternalAllocator = Allocator.Clone();
+	win32_async_reader* Reader            = InternalAllocator.AllocEmplace<win32_async_reader>();
+
+	Reader->Allocator     = InternalAllocator;
+	Reader->MaxInFlight   = MaxInFlight;
+	Reader->Port          = CreateIoCompletionPort(INVALID_HANDLE_VALUE, nullptr, 0, 1);
+	Reader->Slots         = InternalAllocator.AllocArray<win32_read_slot>(MaxInFlight, allocation_strategy::zero);
+	Reader->FreeSlots     = InternalAllocator.AllocArray<u32>(MaxInFlight);
+	Reader->Finished      = InternalAllocator.AllocArray<u32>(MaxInFlight);
+	Reader->Entries       = InternalAllocator.AllocArray<OVERLAPPED_ENTRY>(MaxInFlight);
+	Reader->FreeSlotCount = MaxInFlight;
+	assert(Reader->Port);
+
+	// Pop in increasing order
+	ForRange(u32, i, MaxInFlight)
+	{
+		Reader->FreeSlots[i] = MaxInFlight - 1 - i;
+	}
+
+	mInFlight      = 0;
+	mInternalState = Reader;
+}
+
+void
+platform_async_reader::Deinit()
+{
+	if (!mInternalState) return;
+	win32_async_reader* Reader = (win32_async_reader*)mInternalState;
+
+	// The kernel may still be writing into the callers' buffers.
+	platform_read_completion Dropped[16];
+	while (mInFlight > 0)
+	{
+		Wait(Dropped, ArrayCount(Dropped));
+	}
+
+	CloseHandle(Reader->Port);
+
+	allocator Allocator = Reader->Allocator;
+	Allocator.Free(Reader->Entries);
+	Allocator.Free(Reader->Finished);
+	Allocator.Free(Reader->FreeSlots);
+	Allocator.Free(Reader->Slots);
+	Allocator.Free(Reader, allocation_strategy::deconstruct);
+
+	mInFlight      = 0;
+	mInternalState = nullptr;
+}
+
+u32
+platform_async_reader::Submit(const platform_read_request* Requests, u32 Count)
+{
+	assert(mInternalState);
+	win32_async_reader* Reader = (win32_async_reader*)mInternalState;
+
+	allocator PathAllocator = allocator::Default();
+
+	u32 Taken = 0;
+	for (; Taken < Count && Reader->FreeSlotCount > 0; ++Taken)
+	{
+		const platform_read_request& Request = Requests[Taken];
+		assert(Request.Destination || Request.Size == 0);
+
+		Reader->FreeSlotCount -= 1;
+		u32 Slot = Reader->FreeSlots[Reader->FreeSlotCount];
+
+		wchar_t* FilePathWide = Win32Utf8ToUtf16(PathAllocator, Request.AbsolutePath.Ptr(), Request.AbsolutePath.Length());
+
+		win32_read_slot& Read = Reader->Slots[Slot];
+		Read             = {};
+		Read.File        = CreateFileW(FilePathWide, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED, nullptr);
+		Read.Destination = (u8*)Request.Destination;
+		Read.Offset      = Request.Offset;
+		Read.Size        = Request.Size;
+		Read.UserData    = Request.UserData;
+
+		PathAllocator.Free(FilePathWide);
+
+		if (Read.File == INVALID_HANDLE_VALUE)
+		{
+			LogError("Unable to open file: %s, with error: %d", Request.AbsolutePath.Ptr(), GetLastError());
+			Read.Failed = true;
+			Win32FinishRead(Reader, Slot);
+		}
+		else if (Read.Size == 0)
+		{
+			Win32FinishRead(Reader, Slot);
+		}
+		else
+		{
+			HANDLE Port = CreateIoCompletionPort(Read.File, Reader->Port, 0, 0);
+			assert(Port == Reader->Port);
+			Win32QueueRead(Reader, Slot);
+		}
+	}
+
+	mInFlight += Taken;
+	return Taken;
+}
+
+u32
+platform_async_reader::Poll(platform_read_completion* Completions, u32 MaxCompletions)
+{
+	assert(mInternalState);
+	win32_async_reader* Reader = (win32_async_reader*)mInternalState;
+
+	Win32Reap(Reader, 0);
+	u32 Count = Win32PopFinished(Reader, Completions, MaxCompletions);
+
+	mInFlight -= Count;
+	return Count;
+}
+
+u32
+platform_async_reader::Wait(platform_read_completion* Completions, u32 MaxCompletions)
+{
+	assert(mInternalState && MaxCompletions > 0);
+	win32_async_reader* Reader = (win32_async_reader*)mInternalState;
+
+	u32 Count = 0;
+	while (mInFlight > 0)
+	{
+		Win32Reap(Reader, 0);
+		Count = Win32PopFinished(Reader, Completions, MaxCompletions);
+		if (Count > 0) break;
+
+		Win32Reap(Reader, INFINITE);
+	}
+
+	mInFlight -= Count;
+	return Count;
+}
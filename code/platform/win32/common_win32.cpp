@@ -2,6 +2,8 @@
 
 #include <util/allocator.h>
 
+#include <stdlib.h>
+
 var_global constexpr UINT cDesiredSchedulerMS = 1;
 
 void PlatformInit()
@@ -19,10 +21,33 @@ void PlatformSleepMainThread(u32 TimeMS)
 	Sleep(TimeMS);
 }
 
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+# define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+void PlatformSleepNanoseconds(u64 Nanoseconds)
+{
+	// High resolution waitable timers (Windows 10 1803+) wake within ~0.5ms instead of the 1ms scheduler
+	// tick. One per thread, it is never closed.
+	var_persist thread_local HANDLE Timer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+
+	if (Timer)
+	{
+		LARGE_INTEGER DueTime = {};
+		DueTime.QuadPart = -s64(DivideCeil(Nanoseconds, u64(100))); // negative is relative, in 100ns units
+		if (SetWaitableTimerEx(Timer, &DueTime, 0, nullptr, nullptr, nullptr, 0))
+		{
+			WaitForSingleObject(Timer, INFINITE);
+			return;
+		}
+	}
+
+	Sleep(DWORD(DivideCeil(Nanoseconds, u64(1'000'000))));
+}
+
 void PlatformExitProcess()
 {
-	// TODO: proper exit code?
-	ExitProcess(0);
+	ExitProcess(EXIT_FAILURE);
 }
 
 wchar_t*
@@ -0,0 +1,144 @@
+#include "common_win32.h"
+
+#include <util/allocator.h>
+#include <util/str8.h>
+
+// ReadDirectoryChangesW drops everything queued when the buffer fills between two Polls, and reports
+// that as an overflow. 64KB is the largest buffer that works on network shares.
+var_global constexpr DWORD cChangeBufferSize = 64 * 1024;
+
+var_global constexpr DWORD cNotifyFilter = FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_SIZE;
+
+struct win32_file_watcher
+{
+	allocator  Allocator  = {};
+	HANDLE     Directory  = INVALID_HANDLE_VALUE;
+	OVERLAPPED Overlapped = {};
+	u8*        Buffer     = nullptr; // DWORD aligned, FILE_NOTIFY_INFORMATION records
+	bool       Pending    = false;   // a ReadDirectoryChangesW call is in flight
+};
+
+fn_internal bool
+Win32QueueDirectoryRead(win32_file_watcher* Watcher)
+{
+	Watcher->Overlapped = {};
+	Watcher->Pending    = ReadDirectoryChangesW(Watcher->Directory, Watcher->Buffer, cChangeBufferSize, TRUE, cNotifyFilter, nullptr, &Watcher->Overlapped, nullptr) != FALSE;
+	if (!Watcher->Pending)
+	{
+		LogError("Unable to watch directory changes, with error: %d", GetLastError());
+	}
+	return Watcher->Pending;
+}
+
+bool
+platform_file_watcher::Init(const allocator& Allocator, istr8 Directory)
+{
+	assert(!mInternalState);
+
+	allocator PathAllocator = allocator::Default();
+	wchar_t*  DirectoryWide = Win32Utf8ToUtf16(PathAllocator, Directory.Ptr(), Directory.Length());
+
+	HANDLE DirectoryHandle = CreateFileW(DirectoryWide, FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+	PathAllocator.Free(DirectoryWide);
+
+	if (DirectoryHandle == INVALID_HANDLE_VALUE)
+	{
+		LogError("Unable to open directory: %s, with error: %d", Directory.Ptr(), GetLastError());
+		return false;
+	}
+
+	allocator           InternalAllocator = Allocator.Clone();
+	win32_file_watcher* Watcher           = InternalAllocator.AllocEmplace<win32_file_watcher>();
+
+	Watcher->Allocator = InternalAllocator;
+	Watcher->Directory = DirectoryHandle;
+	Watcher->Buffer    = (u8*)InternalAllocator.AllocChunk(cChangeBufferSize);
+
+	mInternalState = Watcher;
+	if (!Win32QueueDirectoryRead(Watcher))
+	{
+		Deinit();
+		return false;
+	}
+
+	return true;
+}
+
+void
+platform_file_watcher::Deinit()
+{
+	if (!mInternalState) return;
+	win32_file_watcher* Watcher = (win32_file_watcher*)mInternalState;
+
+	if (Watcher->Pending)
+	{ // The kernel writes into Buffer until the read is cancelled
+		DWORD Transferred = 0;
+		CancelIoEx(Watcher->Directory, &Watcher->Overlapped);
+		GetOverlappedResult(Watcher->Directory, &Watcher->Overlapped, &Transferred, TRUE);
+	}
+
+	CloseHandle(Watcher->Directory);
+
+	allocator Allocator = Watcher->Allocator;
+	Allocator.Free(Watcher->Buffer);
+	Allocator.Free(Watcher, allocation_strategy::deconstruct);
+
+	mInternalState = nullptr;
+}
+
+void
+platform_file_watcher::Poll(platform_file_change_pfn Callback, void* UserData)
+{
+	assert(mInternalState && Callback);
+	win32_file_watcher* Watcher = (win32_file_watcher*)mInternalState;
+
+	while (Watcher->Pending)
+	{
+		DWORD Transferred = 0;
+		if (!GetOverlappedResult(Watcher->Directory, &Watcher->Overlapped, &Transferred, FALSE))
+		{
+			DWORD Error = GetLastError();
+			if (Error == ERROR_IO_INCOMPLETE) return; // no changes yet
+
+			LogError("Failed to read directory changes, with error: %d", Error);
+			Watcher->Pending = false;
+			return;
+		}
+
+		if (Transferred == 0)
+		{ // The changes did not fit in the buffer
+			Callback(UserData, "", file_change_type::overflow);
+		}
+
+		// Report every record before the next read is queued over the buffer
+		u8* Record = Transferred > 0 ? Watcher->Buffer : nullptr;
+		while (Record)
+		{
+			const FILE_NOTIFY_INFORMATION* Info = (const FILE_NOTIFY_INFORMATION*)Record;
+			Record = Info->NextEntryOffset ? Record + Info->NextEntryOffset : nullptr;
+
+			char Path[4 * MAX_PATH];
+			int  PathLength = WideCharToMultiByte(CP_UTF8, 0, Info->FileName, int(Info->FileNameLength / sizeof(wchar_t)), Path, int(sizeof(Path)), nullptr, nullptr);
+			if (PathLength <= 0) continue;
+
+			ForRange(int, i, PathLength)
+			{
+				if (Path[i] == '\\') Path[i] = '/';
+			}
+
+			file_change_type Type = file_change_type::modified;
+			switch (Info->Action)
+			{
+				case FILE_ACTION_ADDED:
+				case FILE_ACTION_RENAMED_NEW_NAME: Type = file_change_type::created;  break;
+				case FILE_ACTION_REMOVED:
+				case FILE_ACTION_RENAMED_OLD_NAME: Type = file_change_type::removed;  break;
+				default:                           Type = file_change_type::modified; break;
+			}
+
+			Callback(UserData, istr8(Path, u64(PathLength)), Type);
+		}
+
+		if (!Win32QueueDirectoryRead(Watcher)) return;
+	}
+}
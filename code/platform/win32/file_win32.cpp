@@ -17,25 +17,150 @@ PlatformLoadFileIntoBuffer(allocator& Allocator, istr8 AbsolutePath, u8** Buffer
 		return false;
 	}
 
-	// Get the file info so we can know the size of the file
-	BY_HANDLE_FILE_INFORMATION FileInfo = {};
-	BOOL FileInfoResult = GetFileInformationByHandle(FileHandle, &FileInfo);
-	assert(FileInfoResult != 0);
+	// Get the file size so we can know how big of a buffer to allocate
+	LARGE_INTEGER FileSize = {};
+	BOOL FileSizeResult = GetFileSizeEx(FileHandle, &FileSize);
+	assert(FileSizeResult != 0);
 
-	// Not going to properly composite the high and low order size bits, and
-	// not going to read in files greater than U32_MAX.
+	*BufferSize = u64(FileSize.QuadPart);
+	*Buffer = (u8*)Allocator.AllocChunk(*BufferSize);
 
-	// If this ever happens, need to do something special. Can't just dump a file this large into memory.
-	assert(FileInfo.nFileSizeHigh == 0); 
+	// ReadFile takes a DWORD size, so files over 4GB are read in chunks.
+	constexpr u64 cMaxReadSize = _1GB;
 
-	*BufferSize = FileInfo.nFileSizeLow;
-	*Buffer = (u8*)Allocator.AllocChunk(*BufferSize);
+	u64 TotalBytesRead = 0;
+	while (TotalBytesRead < *BufferSize)
+	{
+		u64   BytesToRead = *BufferSize - TotalBytesRead;
+		DWORD BytesRead   = 0;
+		BOOL FileReadResult = ReadFile(FileHandle, *Buffer + TotalBytesRead, DWORD(BytesToRead < cMaxReadSize ? BytesToRead : cMaxReadSize), &BytesRead, nullptr);
+		if (FileReadResult == FALSE || BytesRead == 0)
+		{
+			LogError("Failed to read file: %s, with error: %d", AbsolutePath.Ptr(), GetLastError());
+			Allocator.Free(*Buffer);
+			*Buffer     = nullptr;
+			*BufferSize = 0;
+			Allocator.Free(FilePathWide);
+			CloseHandle(FileHandle);
+			return false;
+		}
+
+		TotalBytesRead += BytesRead;
+	}
+
+	Allocator.Free(FilePathWide);
+	CloseHandle(FileHandle);
+	return true;
+}
+
+fn_internal void
+Win32PrefetchRange(const void* Base, u64 Size)
+{
+	WIN32_MEMORY_RANGE_ENTRY Range = {};
+	Range.VirtualAddress = (PVOID)Base;
+	Range.NumberOfBytes  = SIZE_T(Size);
+	PrefetchVirtualMemory(GetCurrentProcess(), 1, &Range, 0);
+}
+
+bool 
+PlatformMapFile(istr8 AbsolutePath, platform_mapped_file* File, file_access_hint Hint)
+{
+	assert(File);
+	*File = {};
 
-	DWORD BytesRead;
-	BOOL FileReadResult = ReadFile(FileHandle, *Buffer, DWORD(*BufferSize), &BytesRead, nullptr);
-	assert(FileReadResult != FALSE);
+	allocator Allocator    = allocator::Default();
+	wchar_t*  FilePathWide = Win32Utf8ToUtf16(Allocator, AbsolutePath.Ptr(), AbsolutePath.Length());
 
+	// The access flags only tune the file cache's read-ahead, which is also what services the page faults of a view.
+	DWORD Flags = FILE_ATTRIBUTE_NORMAL;
+	if      (Hint == file_access_hint::sequential) Flags |= FILE_FLAG_SEQUENTIAL_SCAN;
+	else if (Hint == file_access_hint::random)     Flags |= FILE_FLAG_RANDOM_ACCESS;
+
+	HANDLE FileHandle = CreateFileW(FilePathWide, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, Flags, nullptr);
 	Allocator.Free(FilePathWide);
+
+	if (FileHandle == INVALID_HANDLE_VALUE)
+	{
+		LogError("Unable to open file: %s, with error: %d", AbsolutePath.Ptr(), GetLastError());
+		return false;
+	}
+
+	LARGE_INTEGER FileSize = {};
+	BOOL FileSizeResult = GetFileSizeEx(FileHandle, &FileSize);
+	assert(FileSizeResult != 0);
+
+	// CreateFileMapping rejects empty files, an empty file is just an empty view.
+	if (FileSize.QuadPart == 0)
+	{
+		CloseHandle(FileHandle);
+		return true;
+	}
+
+	// A size of 0 maps the whole file, whatever its size.
+	HANDLE MappingHandle = CreateFileMappingW(FileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	const void* View = MappingHandle ? MapViewOfFile(MappingHandle, FILE_MAP_READ, 0, 0, 0) : nullptr;
+	DWORD Error = GetLastError();
+
+	// The view holds its own references to the mapping and the file.
+	if (MappingHandle) CloseHandle(MappingHandle);
 	CloseHandle(FileHandle);
+
+	if (!View)
+	{
+		LogError("Unable to map file: %s, with error: %d", AbsolutePath.Ptr(), Error);
+		return false;
+	}
+
+	File->Data = (const u8*)View;
+	File->Size = u64(FileSize.QuadPart);
+
+	if (Hint == file_access_hint::will_need)
+	{
+		Win32PrefetchRange(File->Data, File->Size);
+	}
+
+	return true;
+}
+
+void 
+PlatformUnmapFile(platform_mapped_file* File)
+{
+	assert(File);
+	if (File->Data)
+	{
+		BOOL UnmapResult = UnmapViewOfFile(File->Data);
+		assert(UnmapResult != 0);
+	}
+
+	*File = {};
+}
+
+void 
+PlatformAdviseMappedFile(const platform_mapped_file& File, u64 Offset, u64 Size, file_access_hint Hint)
+{
+	assert(Offset <= File.Size && Size <= File.Size - Offset);
+	if (!File.Data || Size == 0) return;
+
+	// Read-ahead is fixed when the file is opened, so only will_need does anything here.
+	if (Hint == file_access_hint::will_need)
+	{
+		Win32PrefetchRange(File.Data + Offset, Size);
+	}
+}
+
+bool 
+PlatformGetFileSize(istr8 AbsolutePath, u64* Size)
+{
+	allocator Allocator    = allocator::Default();
+	wchar_t*  FilePathWide = Win32Utf8ToUtf16(Allocator, AbsolutePath.Ptr(), AbsolutePath.Length());
+
+	WIN32_FILE_ATTRIBUTE_DATA FileInfo = {};
+	BOOL Result = GetFileAttributesExW(FilePathWide, GetFileExInfoStandard, &FileInfo);
+	Allocator.Free(FilePathWide);
+
+	if (!Result)
+		return false;
+
+	*Size = (u64(FileInfo.nFileSizeHigh) << 32) | u64(FileInfo.nFileSizeLow);
 	return true;
-}
\ No newline at end of file
+}
@@ -1,5 +1,6 @@
 #include "common_win32.h"
 #include <util/str8.h>
+#include <util/allocator.h>
 
 #include <cstdio>
 
@@ -222,3 +223,70 @@ PlatformLogToDebugConsole(const istr8& Message)
     }
 #endif
 }
+
+u64
+PlatformLogFileOpen(istr8 Path, u64* FileSize)
+{
+    allocator Allocator = allocator::Default();
+    wchar_t*  PathWide  = Win32Utf8ToUtf16(Allocator, Path.Ptr(), Path.Length());
+
+    // FILE_SHARE_DELETE lets a tool tail or delete the log while the engine runs.
+    HANDLE File = CreateFileW(PathWide, FILE_APPEND_DATA, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    Allocator.Free(PathWide);
+
+    if (File == INVALID_HANDLE_VALUE)
+        return 0;
+
+    LARGE_INTEGER Size = {};
+    *FileSize = GetFileSizeEx(File, &Size) ? u64(Size.QuadPart) : 0;
+    return u64(File);
+}
+
+bool
+PlatformLogFileWrite(u64 File, const void* Data, u64 Size)
+{
+    const u8* Bytes = (const u8*)Data;
+    while (Size > 0)
+    {
+        DWORD ToWrite = Size > MAXDWORD ? MAXDWORD : DWORD(Size);
+        DWORD Written = 0;
+        if (!WriteFile(HANDLE(File), Bytes, ToWrite, &Written, nullptr) || Written == 0)
+            return false;
+
+        Bytes += Written;
+        Size  -= Written;
+    }
+    return true;
+}
+
+void
+PlatformLogFileClose(u64 File)
+{
+    CloseHandle(HANDLE(File));
+}
+
+bool
+PlatformLogFileRename(istr8 From, istr8 To)
+{
+    allocator Allocator = allocator::Default();
+    wchar_t*  FromWide  = Win32Utf8ToUtf16(Allocator, From.Ptr(), From.Length());
+    wchar_t*  ToWide    = Win32Utf8ToUtf16(Allocator, To.Ptr(), To.Length());
+
+    BOOL Result = MoveFileExW(FromWide, ToWide, MOVEFILE_REPLACE_EXISTING);
+
+    Allocator.Free(FromWide);
+    Allocator.Free(ToWide);
+    return Result != 0;
+}
+
+bool
+PlatformLogFileDelete(istr8 Path)
+{
+    allocator Allocator = allocator::Default();
+    wchar_t*  PathWide  = Win32Utf8ToUtf16(Allocator, Path.Ptr(), Path.Length());
+
+    BOOL Result = DeleteFileW(PathWide);
+
+    Allocator.Free(PathWide);
+    return Result != 0;
+}
@@ -0,0 +1,170 @@
+#include "common_win32.h"
+
+fn_internal DWORD
+Win32ProtectionFlags(page_protection Protection)
+{
+	DWORD Flags = PAGE_NOACCESS;
+	switch (Protection)
+	{
+	case page_protection::none:       Flags = PAGE_NOACCESS;  break;
+	case page_protection::read:       Flags = PAGE_READONLY;  break;
+	case page_protection::read_write: Flags = PAGE_READWRITE; break;
+	}
+	return Flags;
+}
+
+// Large pages need SeLockMemoryPrivilege, which the user must have been granted ("Lock pages in memory"
+// policy) and which is disabled in the process token until it is enabled here.
+fn_internal bool
+Win32EnableLockMemoryPrivilege()
+{
+	HANDLE Token = nullptr;
+	if (!OpenProcessToken(GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &Token))
+		return false;
+
+	TOKEN_PRIVILEGES Privileges = {};
+	Privileges.PrivilegeCount           = 1;
+	Privileges.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+
+	bool Enabled = false;
+	if (LookupPrivilegeValueW(nullptr, SE_LOCK_MEMORY_NAME, &Privileges.Privileges[0].Luid))
+	{ // Succeeds without assigning anything when the privilege is not held, hence the extra check
+		Enabled = AdjustTokenPrivileges(Token, FALSE, &Privileges, 0, nullptr, nullptr) && GetLastError() == ERROR_SUCCESS;
+	}
+
+	CloseHandle(Token);
+	return Enabled;
+}
+
+fn_internal void
+Win32PageRange(const platform_reservation& Reservation, u64 Offset, u64 Size, u8** Begin, u64* Length)
+{
+	assert(Offset <= Reservation.Size && Size <= Reservation.Size - Offset);
+
+	u64 First = BackwardAlign(Offset, Reservation.PageSize);
+	u64 Last  = ForwardAlign(Offset + Size, Reservation.PageSize);
+
+	*Begin  = Reservation.Base + First;
+	*Length = Last - First;
+}
+
+u64
+PlatformGetPageSize()
+{
+	SYSTEM_INFO SystemInfo = {};
+	GetSystemInfo(&SystemInfo);
+	return u64(SystemInfo.dwPageSize);
+}
+
+u64
+PlatformGetHugePageSize()
+{
+	return u64(GetLargePageMinimum());
+}
+
+bool
+PlatformReserve(u64 Size, platform_reservation* Reservation, page_hint Hint)
+{
+	assert(Reservation && Size > 0);
+	*Reservation = {};
+
+	u64 PageSize = PlatformGetPageSize();
+
+	if (Hint == page_hint::huge)
+	{
+		var_persist const bool CanLockMemory = Win32EnableLockMemoryPrivilege();
+		u64                    HugePageSize  = PlatformGetHugePageSize();
+
+		if (CanLockMemory && HugePageSize > 0)
+		{
+			u64   HugeSize = ForwardAlign(Size, HugePageSize);
+			void* Base     = VirtualAlloc(nullptr, SIZE_T(HugeSize), MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+			if (Base)
+			{
+				Reservation->Base     = (u8*)Base;
+				Reservation->Size     = HugeSize;
+				Reservation->PageSize = HugePageSize;
+				Reservation->Pages    = page_hint::huge;
+				return true;
+			}
+		}
+	}
+
+	// No transparent huge pages on Windows, the hint falls back to normal pages.
+	u64   AlignedSize = ForwardAlign(Size, PageSize);
+	void* Base        = VirtualAlloc(nullptr, SIZE_T(AlignedSize), MEM_RESERVE, PAGE_NOACCESS);
+	if (!Base)
+	{
+		LogError("Unable to reserve %llu bytes of address space, with error: %d", (unsigned long long)Size, GetLastError());
+		return false;
+	}
+
+	Reservation->Base     = (u8*)Base;
+	Reservation->Size     = AlignedSize;
+	Reservation->PageSize = PageSize;
+	Reservation->Pages    = page_hint::normal;
+	return true;
+}
+
+void
+PlatformRelease(platform_reservation* Reservation)
+{
+	assert(Reservation);
+	if (Reservation->Base)
+	{
+		BOOL FreeResult = VirtualFree(Reservation->Base, 0, MEM_RELEASE);
+		assert(FreeResult);
+	}
+
+	*Reservation = {};
+}
+
+bool
+PlatformCommit(const platform_reservation& Reservation, u64 Offset, u64 Size)
+{
+	if (Reservation.Pages == page_hint::huge || Size == 0) return true;
+
+	u8* Begin;
+	u64 Length;
+	Win32PageRange(Reservation, Offset, Size, &Begin, &Length);
+
+	// Committing charges the pagefile, physical pages are only assigned on first touch.
+	if (!VirtualAlloc(Begin, SIZE_T(Length), MEM_COMMIT, PAGE_READWRITE))
+	{
+		LogError("Unable to commit %llu bytes, with error: %d", (unsigned long long)Length, GetLastError());
+		return false;
+	}
+
+	return true;
+}
+
+void
+PlatformDecommit(const platform_reservation& Reservation, u64 Offset, u64 Size)
+{
+	if (Reservation.Pages == page_hint::huge || Size == 0) return;
+
+	u8* Begin;
+	u64 Length;
+	Win32PageRange(Reservation, Offset, Size, &Begin, &Length);
+
+	VirtualFree(Begin, SIZE_T(Length), MEM_DECOMMIT);
+}
+
+bool
+PlatformProtect(const platform_reservation& Reservation, u64 Offset, u64 Size, page_protection Protection)
+{
+	if (Size == 0) return true;
+
+	u8* Begin;
+	u64 Length;
+	Win32PageRange(Reservation, Offset, Size, &Begin, &Length);
+
+	DWORD OldProtection = 0;
+	if (!VirtualProtect(Begin, SIZE_T(Length), Win32ProtectionFlags(Protection), &OldProtection))
+	{
+		LogError("Unable to change the protection of %llu bytes, with error: %d", (unsigned long long)Length, GetLastError());
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,217 @@
+#include "common_win32.h"
+
+#include <util/allocator.h>
+
+var_global std::atomic<u64> gParkCount = 0;
+var_global std::atomic<u64> gWakeCount = 0;
+
+struct win32_thread_start
+{
+	platform_thread_pfn Function;
+	void*               UserData;
+	u64                 AffinityMask;
+	mstr8               Name;
+};
+
+fn_internal DWORD WINAPI
+Win32ThreadEntry(LPVOID Data)
+{
+	win32_thread_start* Start = (win32_thread_start*)Data;
+
+	if (Start->Name.Length() > 0)
+	{
+		PlatformSetThreadName(Start->Name);
+	}
+
+	if (Start->AffinityMask)
+	{
+		PlatformSetThreadAffinity(Start->AffinityMask);
+	}
+
+	// Free before running, the thread function may never return
+	platform_thread_pfn Function = Start->Function;
+	void*               UserData = Start->UserData;
+	allocator::Default().Free(Start, allocation_strategy::deconstruct);
+
+	Function(UserData);
+	return 0;
+}
+
+u32
+PlatformGetLogicalProcessorCount()
+{
+	DWORD_PTR ProcessMask = 0;
+	DWORD_PTR SystemMask  = 0;
+	if (GetProcessAffinityMask(GetCurrentProcess(), &ProcessMask, &SystemMask) && ProcessMask != 0)
+	{
+		return u32(__popcnt64(u64(ProcessMask)));
+	}
+
+	SYSTEM_INFO SystemInfo = {};
+	GetSystemInfo(&SystemInfo);
+	return u32(SystemInfo.dwNumberOfProcessors);
+}
+
+u32
+PlatformGetCurrentThreadId()
+{
+	return u32(GetCurrentThreadId());
+}
+
+void
+PlatformYieldThread()
+{
+	SwitchToThread();
+}
+
+void
+PlatformSetThreadName(istr8 Name)
+{
+	// SetThreadDescription is Windows 10 1607+, look it up rather than fail to load on older versions.
+	using set_thread_description_pfn = HRESULT (WINAPI*)(HANDLE Thread, PCWSTR Description);
+	var_persist set_thread_description_pfn SetThreadDescriptionFn = (set_thread_description_pfn)GetProcAddress(GetModuleHandleW(L"kernel32.dll"), "SetThreadDescription");
+
+	if (!SetThreadDescriptionFn) return;
+
+	allocator Allocator = allocator::Default();
+	wchar_t*  NameWide  = Win32Utf8ToUtf16(Allocator, Name.Ptr(), Name.Length());
+	SetThreadDescriptionFn(GetCurrentThread(), NameWide);
+	Allocator.Free(NameWide);
+}
+
+bool
+PlatformSetThreadAffinity(u64 AffinityMask)
+{
+	if (SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(AffinityMask)) == 0)
+	{
+		LogError("Unable to set thread affinity to 0x%llx, with error: %d", (unsigned long long)AffinityMask, GetLastError());
+		return false;
+	}
+	return true;
+}
+
+bool
+platform_thread::Start(platform_thread_pfn Function, void* UserData, istr8 Name, u64 AffinityMask)
+{
+	assert(!IsStarted() && Function);
+
+	win32_thread_start* Start = allocator::Default().AllocEmplace<win32_thread_start>();
+	Start->Function     = Function;
+	Start->UserData     = UserData;
+	Start->AffinityMask = AffinityMask;
+	Start->Name         = mstr8(Name);
+
+	HANDLE Thread = CreateThread(nullptr, 0, Win32ThreadEntry, Start, 0, nullptr);
+	if (!Thread)
+	{
+		LogError("Unable to create thread: %s, with error: %d", Start->Name.Ptr(), GetLastError());
+		allocator::Default().Free(Start, allocation_strategy::deconstruct);
+		return false;
+	}
+
+	mHandle = u64(Thread);
+	return true;
+}
+
+void
+platform_thread::Join()
+{
+	if (!IsStarted()) return;
+
+	WaitForSingleObject(HANDLE(mHandle), INFINITE);
+	CloseHandle(HANDLE(mHandle));
+	mHandle = 0;
+}
+
+bool
+platform_thread::SetAffinity(u64 AffinityMask)
+{
+	assert(IsStarted());
+	if (SetThreadAffinityMask(HANDLE(mHandle), DWORD_PTR(AffinityMask)) == 0)
+	{
+		LogError("Unable to set thread affinity to 0x%llx, with error: %d", (unsigned long long)AffinityMask, GetLastError());
+		return false;
+	}
+	return true;
+}
+
+bool
+PlatformAllocTlsSlot(platform_tls_slot* Slot)
+{
+	assert(Slot);
+
+	DWORD Index = TlsAlloc();
+	if (Index == TLS_OUT_OF_INDEXES)
+	{
+		LogError("Unable to allocate a thread local storage slot, with error: %d", GetLastError());
+		return false;
+	}
+
+	*Slot = platform_tls_slot(Index);
+	return true;
+}
+
+void
+PlatformFreeTlsSlot(platform_tls_slot Slot)
+{
+	TlsFree(DWORD(Slot));
+}
+
+void*
+PlatformGetTlsValue(platform_tls_slot Slot)
+{
+	return TlsGetValue(DWORD(Slot));
+}
+
+void
+PlatformSetTlsValue(platform_tls_slot Slot, void* Value)
+{
+	TlsSetValue(DWORD(Slot), Value);
+}
+
+//
+// Wait on Address
+//
+
+bool
+PlatformWaitOnAddress(const std::atomic<u32>* Address, u32 Expected, u64 TimeoutNs)
+{
+	static_assert(sizeof(std::atomic<u32>) == sizeof(u32), "WaitOnAddress compares a plain 32-bit word");
+	gParkCount.fetch_add(1, std::memory_order_relaxed);
+
+	DWORD TimeoutMS = INFINITE;
+	if (TimeoutNs != cPlatformWaitForever)
+	{ // Round up, a wait shorter than asked would look like a spurious timeout
+		u64 Milliseconds = DivideCeil(TimeoutNs, u64(1'000'000));
+		TimeoutMS = Milliseconds < u64(INFINITE) ? DWORD(Milliseconds) : INFINITE - 1;
+	}
+
+	if (!WaitOnAddress((volatile void*)Address, &Expected, sizeof(u32), TimeoutMS))
+	{
+		return GetLastError() != ERROR_TIMEOUT;
+	}
+	return true;
+}
+
+void
+PlatformWakeOne(const std::atomic<u32>* Address)
+{
+	gWakeCount.fetch_add(1, std::memory_order_relaxed);
+	WakeByAddressSingle((void*)Address);
+}
+
+void
+PlatformWakeAll(const std::atomic<u32>* Address)
+{
+	gWakeCount.fetch_add(1, std::memory_order_relaxed);
+	WakeByAddressAll((void*)Address);
+}
+
+platform_sync_stats
+PlatformGetSyncStats()
+{
+	platform_sync_stats Stats = {};
+	Stats.Parks = gParkCount.load(std::memory_order_relaxed);
+	Stats.Wakes = gWakeCount.load(std::memory_order_relaxed);
+	return Stats;
+}
@@ -1,33 +1,31 @@
 #include "common_win32.h"
 
-platform_timer::platform_timer()
+// Fixed at boot, query it once.
+fn_internal u64
+Win32QueryPerformanceFrequency()
 {
-    LARGE_INTEGER FrequencyResult;
+    LARGE_INTEGER FrequencyResult{};
     QueryPerformanceFrequency(&FrequencyResult);
-
-    mFrequency   = 1.0 / (f64)FrequencyResult.QuadPart;
-    mElapsedTime = 0.0;
-    mStartTime   = 0.0;
+    return (u64)FrequencyResult.QuadPart;
 }
 
-void
-platform_timer::Start()
+u64
+PlatformQueryTicks()
 {
     LARGE_INTEGER QueryResult{};
     QueryPerformanceCounter(&QueryResult);
-    mStartTime = QueryResult.QuadPart * mFrequency;
+    return (u64)QueryResult.QuadPart;
 }
 
-void 
-platform_timer::Update()
+u64
+PlatformGetTickFrequency()
 {
-    LARGE_INTEGER QueryResult{};
-    QueryPerformanceCounter(&QueryResult);
-    mElapsedTime = QueryResult.QuadPart * mFrequency;
+    var_persist const u64 Frequency = Win32QueryPerformanceFrequency();
+    return Frequency;
 }
 
-f64 
-platform_timer::GetSecondsElapsed() const
+u64
+PlatformQueryNanoseconds()
 {
-    return mElapsedTime - mStartTime;
+    return PlatformTicksToNanoseconds(PlatformQueryTicks(), PlatformGetTickFrequency());
 }
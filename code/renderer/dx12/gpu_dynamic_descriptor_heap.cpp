@@ -126,9 +126,11 @@ gpu_dynamic_descriptor_heap::ParseRootSignature(const gpu_root_signature& RootSi
 	u64 TableBitmask              = mCachedDescriptorTableBitmask;
 
 	u32 CurrentDescriptorOffset = 0;
-	DWORD RootIndex;
-	while (_BitScanForward64(&RootIndex, TableBitmask) && RootIndex < RootParameterCount)
+	while (TableBitmask)
 	{
+		u32 RootIndex = BitFindFirstSet64(TableBitmask);
+		if (RootIndex >= RootParameterCount) break;
+
 		u32 NumDescriptors = RootSignature.GetNumDescriptors(RootIndex);
 		assert(CurrentDescriptorOffset <= mDescriptorsPerHeap && "Root signature requires more than the max number of descriptors per descriptor heap. Consider enlaring the maximum.");
 
@@ -140,8 +142,8 @@ gpu_dynamic_descriptor_heap::ParseRootSignature(const gpu_root_signature& RootSi
 
 		CurrentDescriptorOffset += NumDescriptors;
 
-		// Flip the descirptor table so it's not scanned again
-		TableBitmask = BitFlip(TableBitmask, (u64)RootIndex);
+		// Clear the descirptor table so it's not scanned again
+		TableBitmask = BitClearLowest(TableBitmask);
 	}
 }
 
@@ -179,9 +181,10 @@ gpu_dynamic_descriptor_heap::CommitDescriptorTables(gpu_command_list* CommandLis
 	
 	// Scan for the descriptor tables that have been updated, and only copy the new descriptors.
 	// If this is a new heap, all descriptors are updated since they have to be on the same heap.
-	DWORD RootIndex;
-	while (_BitScanForward64(&RootIndex, mStaleDescriptorTableBitmask))
+	while (mStaleDescriptorTableBitmask)
 	{
+		u32 RootIndex = BitFindFirstSet64(mStaleDescriptorTableBitmask);
+
 		UINT                         DescriptorCount      = mDescriptorTableCache[RootIndex].mNumDescriptors;
 		D3D12_CPU_DESCRIPTOR_HANDLE* SrcDescriptorHandles = mDescriptorTableCache[RootIndex].mBaseDescriptor;
 
@@ -202,7 +205,7 @@ gpu_dynamic_descriptor_heap::CommitDescriptorTables(gpu_command_list* CommandLis
 		mNumFreeHandles      -= DescriptorCount;
 
 		// Flip the stale bit so the descriptor table is not recopied until the descriptor is updated
-		mStaleDescriptorTableBitmask = BitFlip(mStaleDescriptorTableBitmask, u64(RootIndex));
+		mStaleDescriptorTableBitmask = BitClearLowest(mStaleDescriptorTableBitmask);
 	}
 }
 
@@ -216,12 +219,12 @@ gpu_dynamic_descriptor_heap::CommitInlineDescriptors(
 	u32 Bitmask = *DescriptorBitmask;
 	if (Bitmask == 0) return; // Don't do anything if no descriptors have been updated
 	
-	DWORD RootIndex;
-	while (_BitScanForward(&RootIndex, Bitmask))
+	while (Bitmask)
 	{
+		u32 RootIndex = BitFindFirstSet32(Bitmask);
 		CommitInlinePFN(CommandList->AsHandle(), RootIndex, GpuDescriptorHandles[RootIndex]);
 		// Flip the stale bit so the descriptor is not recopied until updated again
-		Bitmask = BitFlip(Bitmask, (u32)RootIndex);
+		Bitmask = BitClearLowest(Bitmask);
 	}
 
 	*DescriptorBitmask = Bitmask;
@@ -310,15 +313,10 @@ gpu_dynamic_descriptor_heap::ComputeStaleDescriptorTableCount()
 {
 	u32 StaleDescriptorCount = 0;
 	
-	DWORD BitIndex;
-	u64   Bitmask = mStaleDescriptorTableBitmask;
-
-	// Count the number of bits set to 1
-	while (_BitScanForward64(&BitIndex, Bitmask))
-	{
+	// Sum the descriptor counts of every stale table
+	BitForEachSet64(mStaleDescriptorTableBitmask, [&](u32 BitIndex) {
 		StaleDescriptorCount += mDescriptorTableCache[BitIndex].mNumDescriptors;
-		Bitmask = BitFlip(Bitmask, (u64)BitIndex);
-	}
+	});
 
 	return StaleDescriptorCount;
 }
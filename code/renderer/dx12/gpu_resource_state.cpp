@@ -239,7 +239,8 @@ void gpu_global_resource_state::AddResource(gpu_resource& Resource, D3D12_RESOUR
         // This is a known resource, we can't override the existing state
         if (SubResource == D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES)
         {
-            LogWarn("Attempting to add a resource to the global state map, but resource exists. Replacing old resource");
+            // Can be hit every frame, report it at most once a second
+            LogRateLimited(1'000'000'000, log_level::warn, "Attempting to add a resource to the global state map, but resource exists. Replacing old resource");
             return;
         }
 
@@ -249,7 +250,7 @@ void gpu_global_resource_state::AddResource(gpu_resource& Resource, D3D12_RESOUR
             gpu_subresource_state& SubresourceState = KnownResource->mState.mSubresources[i];
             if (SubresourceState.mIndex == SubResource)
             {
-                LogWarn("Attempting to add a resource to the global state map, but resource exists. Replacing old resource");
+                LogRateLimited(1'000'000'000, log_level::warn, "Attempting to add a resource to the global state map, but resource exists. Replacing old resource");
                 return;
             }
         }
@@ -19,14 +19,15 @@ shader_resource::GetResourceLoader()
 	Loader.mRelativePath   = "shaders/out";
 	Loader.Load            = Load;
 	Loader.Unload          = Unload;
+	Loader.GetFilePath     = GetFilePath;
 	Loader.mType           = resource_type::builtin_shader;
 	return Loader;
 };
 
-bool 
-shader_resource::Load(resource_loader* Self, const istr8 AbsolutePath, const istr8 ResourceName, resource* OutResource)
+mstr8 
+shader_resource::GetFilePath(resource_loader* Self, const istr8 AbsolutePath, const istr8 ResourceName, resource* Resource)
 {
-	shader_resource* ShaderResource = (shader_resource*)OutResource;
+	shader_resource* ShaderResource = (shader_resource*)Resource;
 
 	mstr8 FilePath = mstr8(AbsolutePath) + "/" + ResourceName;
 	if (ShaderResource->mStage == shader_stage::vertex)
@@ -42,6 +43,16 @@ shader_resource::Load(resource_loader* Self, const istr8 AbsolutePath, const ist
 		FilePath += ".Cpt.cso";
 	}
 
+	return FilePath;
+}
+
+bool 
+shader_resource::Load(resource_loader* Self, const istr8 AbsolutePath, const istr8 ResourceName, resource* OutResource)
+{
+	shader_resource* ShaderResource = (shader_resource*)OutResource;
+
+	mstr8 FilePath = GetFilePath(Self, AbsolutePath, ResourceName, OutResource);
+
 	allocator FileAllocator = allocator::Default(); // TODO(enlynn): assign a proper allocator.
 	PlatformLoadFileIntoBuffer(FileAllocator, FilePath, (u8**)&OutResource->mBaseData, &OutResource->mBaseDataSize);
 	
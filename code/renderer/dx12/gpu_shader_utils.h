@@ -35,6 +35,7 @@ struct shader_resource : public resource
 
 	static bool Load(resource_loader* Self, const istr8 AbsolutePath, const istr8 ResourceName, resource* OutResource);
 	static void Unload(resource_loader* self, resource* resource);
+	static mstr8 GetFilePath(resource_loader* Self, const istr8 AbsolutePath, const istr8 ResourceName, resource* Resource);
 
 	static constexpr resource_type sType = resource_type::builtin_shader;
 	static constexpr const char* sPath = "shader/bin";
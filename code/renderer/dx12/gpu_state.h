@@ -159,6 +159,12 @@ struct gpu_frame_cache
     {
         mGlobal->mResourceSystem->Load(resource_type::builtin_shader, ShaderName, Shader);
     }
+
+    // Reads the shader files in parallel, use over LoadShader when there are several to load.
+    void LoadShaders(resource** Shaders, const istr8* ShaderNames, u32 Count)
+    {
+        mGlobal->mResourceSystem->LoadBatch(resource_type::builtin_shader, ShaderNames, Shaders, Count);
+    }
 };
 
 inline gpu_frame_cache* gpu_state::GetFrameCache() const { return &mPerFrameCache[mFrameCount % cMaxFrameCache]; }
@@ -7,8 +7,12 @@
 
 #include <types.h>
 #include <util/allocator.h>
+#include <math/culling.h>
 #include <platform/platform.h>
 #include <systems/resource_system.h>
+#include <systems/transform_system.h>
+#include <systems/bvh.h>
+#include <util/job_system.h>
 
 enum class triangle_root_parameter
 {
@@ -77,6 +81,17 @@ var_global gpu_buffer      gVertexResource  = {};
 var_global gpu_buffer      gIndexResource   = {};
 var_global gpu_buffer      gPerObjectData   = {};
 
+// Objects that passed frustum culling this frame, indices into gPerObjectData
+var_global constexpr u32   cMaxSceneObjects   = 3;
+var_global u32             gVisibleObjects[cMaxSceneObjects] = {};
+var_global u32             gVisibleObjectCount = 0;
+
+// Test scene: a spinning cube with two smaller cubes orbiting it. Node i draws gPerObjectData[i].
+var_global transform_system gSceneTransforms = {};
+var_global transform_id     gSceneNodes[cMaxSceneObjects];
+var_global bvh              gSceneBvh        = {};
+var_global constexpr aabb   cCubeBounds      = { { -0.5f, -0.5f, -0.5f }, { 0.5f, 0.5f, 0.5f } };
+
 // Render Passes
 var_global scene_pass      gScenePass       = {};
 var_global resolve_pass    gResolvePass     = {};
@@ -180,8 +195,9 @@ void scene_pass::OnInit(gpu_frame_cache* FrameCache)
     auto VertexShader = shader_resource(shader_stage::vertex);
     auto PixelShader  = shader_resource(shader_stage::pixel);
 
-    FrameCache->LoadShader(&VertexShader, "TestTriangle");
-    FrameCache->LoadShader(&PixelShader,  "TestTriangle");
+    resource* Shaders[]     = { &VertexShader,  &PixelShader    };
+    istr8     ShaderNames[] = { "TestTriangle", "TestTriangle" };
+    FrameCache->LoadShaders(Shaders, ShaderNames, ArrayCount(Shaders));
 
     { // Create a simple root signature
         gpu_root_descriptor VertexBuffers[]    = {
@@ -278,12 +294,17 @@ void scene_pass::OnRender(gpu_frame_cache* FrameCache)
     CommandList->SetShaderResourceViewInline(u32(triangle_root_parameter::vertex_buffer), gVertexResource.GetGPUResource());
     CommandList->SetShaderResourceViewInline(u32(triangle_root_parameter::mesh_data), gPerObjectData.GetGPUResource(), gPerObjectData.GetMappedDataOffset());
 
-    vertex_draw_constants Constants = {};
-    CommandList->SetGraphics32BitConstants(u32(triangle_root_parameter::per_draw), &Constants);
-
     FrameCache->FlushResourceBarriers(CommandList); // Flush barriers before drawing
 
-    CommandList->DrawIndexedInstanced(gIndexResource.GetIndexCount());
+    // Only the objects that survived culling are drawn
+    ForRange(u32, i, gVisibleObjectCount)
+    {
+        vertex_draw_constants Constants = {};
+        Constants.uMeshDataIndex = gVisibleObjects[i];
+        CommandList->SetGraphics32BitConstants(u32(triangle_root_parameter::per_draw), &Constants);
+
+        CommandList->DrawIndexedInstanced(gIndexResource.GetIndexCount());
+    }
 }
 
 void resolve_pass::OnInit(gpu_frame_cache* FrameCache)   {} // Does not need to initialize frame resources
@@ -450,11 +471,41 @@ SimpleRendererInit(simple_renderer_info& RenderInfo)
     gIndexResource = gpu_buffer::CreateIndexBuffer(FrameCache, IndexInfo);
 
     gpu_structured_buffer_info PerObjectInfo = {};
-    PerObjectInfo.mCount  = 1; // only one object for now
+    PerObjectInfo.mCount  = cMaxSceneObjects;
     PerObjectInfo.mStride = sizeof(per_mesh_data);
     PerObjectInfo.mFrames = 3;
     gPerObjectData = gpu_buffer::CreateStructuredBuffer(FrameCache, PerObjectInfo);
 
+    // One copy of the dirty state per copy of the upload buffer
+    gSceneTransforms = transform_system(gGlobal.mHeapAllocator, cMaxSceneObjects, PerObjectInfo.mFrames);
+    gSceneNodes[0]   = gSceneTransforms.Create(transform_id(cInvalidId), 0);
+    gSceneNodes[1]   = gSceneTransforms.Create(gSceneNodes[0], 1);
+    gSceneNodes[2]   = gSceneTransforms.Create(gSceneNodes[0], 2);
+
+    gSceneTransforms.SetLocalPosition(gSceneNodes[0], {  0.0f, 0.0f, -2.0f });
+    gSceneTransforms.SetLocalPosition(gSceneNodes[1], {  1.5f, 0.0f,  0.0f });
+    gSceneTransforms.SetLocalPosition(gSceneNodes[2], { -1.5f, 0.0f,  0.0f });
+    gSceneTransforms.SetLocalScale(gSceneNodes[1], { 0.4f, 0.4f, 0.4f });
+    gSceneTransforms.SetLocalScale(gSceneNodes[2], { 0.4f, 0.4f, 0.4f });
+    gSceneTransforms.Update();
+
+    // The objects only move, so the tree is built once and refit every frame
+    aabb SceneBounds[cMaxSceneObjects];
+    ForRange(u32, i, cMaxSceneObjects)
+    {
+        SceneBounds[i] = TransformAabb(gSceneTransforms.GetWorld(gSceneNodes[i]), cCubeBounds);
+    }
+
+    gSceneBvh = bvh(gGlobal.mHeapAllocator, cMaxSceneObjects);
+    if (RenderInfo.JobSystem)
+    {
+        gSceneBvh.Build(SceneBounds, cMaxSceneObjects, job_system::ParallelForCallback, RenderInfo.JobSystem);
+    }
+    else
+    {
+        gSceneBvh.Build(SceneBounds, cMaxSceneObjects);
+    }
+
     FrameCache->SubmitCopyCommandList();
     FrameCache->FlushGPU(); // Forcibly upload all of the geometry (for now)
 
@@ -517,22 +568,40 @@ SimpleRendererRender()
     f32x44 ProjectionMatrix = PerspectiveMatrixRH(45.0f, (f32)WindowWidth / (f32)WindowHeight, 0.01f, 100.0f);
     f32x44 LookAtMatrix     = LookAtMatrixRH({0,0,5}, {0,0,-1}, {0,1,0});
 
-    MeshData[0].Projection = F32x44MulRH(ProjectionMatrix, LookAtMatrix);
-    MeshData[0].View       = {};
+    f32x44 ViewProjection   = F32x44MulRH(ProjectionMatrix, LookAtMatrix);
+
+    ForRange(u32, i, cMaxSceneObjects)
+    {
+        MeshData[i].Projection = ViewProjection;
+        MeshData[i].View       = {};
+    }
 
     static f32 SpinnyTheta = 0.0f;
     SpinnyTheta += 0.16;
+    if (SpinnyTheta >= 360.0f)
+    {
+        // Keep the angle small so it stays precise; 2 * SpinnyTheta wraps at 720, which is also a full turn
+        SpinnyTheta -= 360.0f;
+    }
 
-    f32x3 Axis = {1, 1, 0};
+    // The children inherit the parent's spin and add their own
+    gSceneTransforms.SetLocalRotation(gSceneNodes[0], QuaternionFromAxisAngle({1, 1, 1}, SpinnyTheta));
+    gSceneTransforms.SetLocalRotation(gSceneNodes[1], QuaternionFromAxisAngle({0, 1, 0}, 2.0f * SpinnyTheta));
+    gSceneTransforms.SetLocalRotation(gSceneNodes[2], QuaternionFromAxisAngle({1, 0, 0}, 2.0f * SpinnyTheta));
 
-    quaternion SpinnyQuat = {};
-    SpinnyQuat.XYZ = Axis;
-    SpinnyQuat.Theta = SpinnyTheta;
+    gSceneTransforms.Update();
+    gSceneTransforms.WriteWorldMatrices(&MeshData[0].Transforms, sizeof(per_mesh_data), gGlobal.mFrameCount);
 
-    f32x44 SpinnyMatrix      = RotateMatrix(SpinnyTheta, {1,1,1});
-    f32x44 TranslationMatrix = TranslateMatrix({ 0, 0, -2});
+    // Cull the scene against the camera. Bounds are read from the transform system, not the
+    // write-combined upload buffer.
+    aabb SceneBounds[cMaxSceneObjects];
+    ForRange(u32, i, cMaxSceneObjects)
+    {
+        SceneBounds[i] = TransformAabb(gSceneTransforms.GetWorld(gSceneNodes[i]), cCubeBounds);
+    }
 
-    MeshData[0].Transforms = F32x44MulRH(TranslationMatrix, SpinnyMatrix);
+    gSceneBvh.Refit(SceneBounds);
+    gVisibleObjectCount = gSceneBvh.CullFrustum(FrustumFromMatrix(ViewProjection), gVisibleObjects);
 
     // End Data Setup
     //------------------------------------------------------------------------------------------------------------------
@@ -566,6 +635,9 @@ SimpleRendererDeinit()
 
         ResourceHandle = gPerObjectData.GetGPUResource()->AsHandle();
         ComSafeRelease(ResourceHandle);
+
+        gSceneTransforms.Deinit();
+        gSceneBvh.Deinit();
 	}
 
 	gScenePass.OnDeinit(gGlobal.GetFrameCache());
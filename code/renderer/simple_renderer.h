@@ -7,6 +7,8 @@ struct simple_renderer_info
 	const class platform_window& ClientWindow;
 	// Resource System is required for loading builtin shaders
 	class resource_system&       ResourceSystem;
+	// optional, if provided, scene work (e.g. building the BVH) is spread over its threads
+	class job_system*            JobSystem = nullptr;
 };
 
 void SimpleRendererInit(simple_renderer_info &RenderInfo);
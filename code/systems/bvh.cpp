@@ -0,0 +1,847 @@
+#include "bvh.h"
+
+// Bounds of empty children and padding lanes. Large enough to never overlap a real box, small enough
+// that the plane and slab math on them stays finite.
+var_global constexpr f32 cEmptyBound         = 1e30f;
+
+var_global constexpr u32 cBinCount           = 16;
+var_global constexpr u32 cMaxSahDepth        = 48;    // deeper ranges split at the middle, which bounds the depth
+var_global constexpr u32 cMinTaskObjects     = 1024;
+var_global constexpr u32 cMaxBuildTasks      = 128;
+
+// Tree depth is at most cMaxSahDepth + log2(cLeafFirstMask), and each visited node pushes at most 3
+// more entries than it pops.
+var_global constexpr u32 cTraversalStackSize = 256;
+
+#if SIMD_SSE2
+using bvh_lanes = math_internal::lanes_x4;
+#else
+using bvh_lanes = math_internal::lanes_x1;
+#endif
+
+fn_internal aabb
+EmptyAabb()
+{
+	return { { cEmptyBound, cEmptyBound, cEmptyBound }, { -cEmptyBound, -cEmptyBound, -cEmptyBound } };
+}
+
+// Plain compares rather than fminf/fmaxf, which are library calls on some compilers
+fn_internal void
+GrowAabb(aabb& Box, f32x3 Min, f32x3 Max)
+{
+	Box.Min.X = (Min.X < Box.Min.X) ? Min.X : Box.Min.X;
+	Box.Min.Y = (Min.Y < Box.Min.Y) ? Min.Y : Box.Min.Y;
+	Box.Min.Z = (Min.Z < Box.Min.Z) ? Min.Z : Box.Min.Z;
+	Box.Max.X = (Max.X > Box.Max.X) ? Max.X : Box.Max.X;
+	Box.Max.Y = (Max.Y > Box.Max.Y) ? Max.Y : Box.Max.Y;
+	Box.Max.Z = (Max.Z > Box.Max.Z) ? Max.Z : Box.Max.Z;
+}
+
+// Half the surface area, which is all the SAH needs
+fn_internal f32
+HalfArea(const aabb& Box)
+{
+	f32x3 Size = Box.Max - Box.Min;
+	return Size.X * Size.Y + Size.Y * Size.Z + Size.Z * Size.X;
+}
+
+//
+// Build
+//
+
+struct bvh_build_task
+{
+	u32 Node;
+	u32 NextNode; // first build node this subtree may allocate, it owns 2 * Count - 2 of them
+};
+
+fn_internal u32
+BinIndex(f32 Centroid, f32 Origin, f32 Scale, u32 BinCount)
+{
+	u32 Bin = u32((Centroid - Origin) * Scale);
+	return (Bin < BinCount) ? Bin : BinCount - 1;
+}
+
+struct bvh_build_context
+{
+	using build_node = bvh::build_node;
+	using build_ref  = bvh::build_ref;
+
+	build_ref*            Refs;
+	build_node*           Nodes;
+	u32*                  Stack;
+	const bvh_build_task* Tasks;
+
+	// Bounds and centroid bounds of Refs[First, First + Count)
+	void ComputeBounds(u32 First, u32 Count, aabb* Box, aabb* CentroidBox) const
+	{
+		*Box         = EmptyAabb();
+		*CentroidBox = EmptyAabb();
+		for (u32 i = First; i < First + Count; ++i)
+		{
+			GrowAabb(*Box, Refs[i].Bounds.Min, Refs[i].Bounds.Max);
+			GrowAabb(*CentroidBox, Refs[i].Centroid, Refs[i].Centroid);
+		}
+	}
+
+	// Either leaves the node a leaf, or splits its objects in two and allocates the children. Returns
+	// true when the node was split. The node's bounds are already set, and the children's are set here,
+	// so each level of the tree makes one binning pass and one partition pass over the objects.
+	bool SplitNode(u32 NodeIndex, u32* NextNode) const
+	{
+		build_node& Node  = Nodes[NodeIndex];
+		u32         First = Node.First;
+		u32         Count = Node.Count;
+
+		// Leaf objects are tested 4 at a time, so a full leaf costs about the same as a single object
+		Node.Left = 0;
+		if (Count <= bvh::cMaxLeafSize) return false;
+
+		u32  Mid = First;
+		aabb ChildBounds[2]    = { EmptyAabb(), EmptyAabb() };
+		aabb ChildCentroids[2] = { EmptyAabb(), EmptyAabb() };
+
+		if (Node.Depth < cMaxSahDepth)
+		{
+			// Bin all three axes in one pass. An axis with no centroid extent puts everything in bin 0,
+			// which never produces a split. Small nodes, which are most of the tree, use fewer bins since
+			// the fixed cost of the bins would dominate.
+			u32   BinCount = (Count < cBinCount) ? Count : cBinCount;
+			f32x3 Origin   = Node.CentroidBounds.Min;
+			f32x3 Scale    = {};
+			ForRange(u32, Axis, 3)
+			{
+				f32 Extent      = Node.CentroidBounds.Max.Ptr[Axis] - Origin.Ptr[Axis];
+				Scale.Ptr[Axis] = (Extent > 0.0f) ? f32(BinCount) / Extent : 0.0f;
+			}
+
+			aabb BinBounds[3][cBinCount];
+			u32  BinObjects[3][cBinCount] = {};
+			ForRange(u32, Axis, 3)
+			{
+				ForRange(u32, Bin, BinCount)
+				{
+					BinBounds[Axis][Bin] = EmptyAabb();
+				}
+			}
+
+			for (u32 i = First; i < First + Count; ++i)
+			{
+				const build_ref& Ref = Refs[i];
+				ForRange(u32, Axis, 3)
+				{
+					u32 Bin = BinIndex(Ref.Centroid.Ptr[Axis], Origin.Ptr[Axis], Scale.Ptr[Axis], BinCount);
+					BinObjects[Axis][Bin] += 1;
+					GrowAabb(BinBounds[Axis][Bin], Ref.Bounds.Min, Ref.Bounds.Max);
+				}
+			}
+
+			// Sweep from the left storing the cost of each prefix, then from the right to finish each split
+			f32 BestCost = F32_MAX;
+			u32 BestAxis = 0;
+			u32 BestBin  = 0;
+			ForRange(u32, Axis, 3)
+			{
+				f32  LeftCost[cBinCount];
+				u32  LeftObjects[cBinCount];
+				aabb Accumulated = EmptyAabb();
+				u32  Running     = 0;
+				ForRange(u32, Bin, BinCount - 1)
+				{
+					Running += BinObjects[Axis][Bin];
+					GrowAabb(Accumulated, BinBounds[Axis][Bin].Min, BinBounds[Axis][Bin].Max);
+					LeftObjects[Bin] = Running;
+					LeftCost[Bin]    = (Running > 0) ? HalfArea(Accumulated) * f32(Running) : 0.0f;
+				}
+
+				Accumulated = EmptyAabb();
+				Running     = 0;
+				for (u32 Bin = BinCount - 1; Bin > 0; --Bin)
+				{
+					Running += BinObjects[Axis][Bin];
+					GrowAabb(Accumulated, BinBounds[Axis][Bin].Min, BinBounds[Axis][Bin].Max);
+					if (Running == 0 || LeftObjects[Bin - 1] == 0) continue;
+
+					f32 Cost = LeftCost[Bin - 1] + HalfArea(Accumulated) * f32(Running);
+					if (Cost < BestCost)
+					{
+						BestCost = Cost;
+						BestAxis = Axis;
+						BestBin  = Bin;
+					}
+				}
+			}
+
+			if (BestCost < F32_MAX)
+			{
+				// The children's centroid bounds are gathered while partitioning, their bounds come from the bins
+				ChildBounds[0]    = EmptyAabb();
+				ChildBounds[1]    = EmptyAabb();
+				ChildCentroids[0] = EmptyAabb();
+				ChildCentroids[1] = EmptyAabb();
+				ForRange(u32, Bin, BinCount)
+				{
+					u32 Side = (Bin < BestBin) ? 0 : 1;
+					GrowAabb(ChildBounds[Side], BinBounds[BestAxis][Bin].Min, BinBounds[BestAxis][Bin].Max);
+				}
+
+				u32 Low  = First;
+				u32 High = First + Count;
+				while (Low < High)
+				{
+					u32 Bin = BinIndex(Refs[Low].Centroid.Ptr[BestAxis], Origin.Ptr[BestAxis], Scale.Ptr[BestAxis], BinCount);
+					if (Bin < BestBin)
+					{
+						GrowAabb(ChildCentroids[0], Refs[Low].Centroid, Refs[Low].Centroid);
+						Low += 1;
+					}
+					else
+					{
+						GrowAabb(ChildCentroids[1], Refs[Low].Centroid, Refs[Low].Centroid);
+						High -= 1;
+						build_ref Swap = Refs[Low];
+						Refs[Low]      = Refs[High];
+						Refs[High]     = Swap;
+					}
+				}
+				Mid = Low;
+			}
+		}
+
+		// No useful split (all centroids in one place, or too deep): split the range in half
+		if (Mid == First || Mid == First + Count)
+		{
+			Mid = First + Count / 2;
+			ComputeBounds(First, Mid - First,         &ChildBounds[0], &ChildCentroids[0]);
+			ComputeBounds(Mid,   First + Count - Mid, &ChildBounds[1], &ChildCentroids[1]);
+		}
+
+		u32 Left    = *NextNode;
+		*NextNode  += 2;
+		Node.Left   = Left;
+
+		Nodes[Left]     = { ChildBounds[0], ChildCentroids[0], First, Mid - First,         0, Node.Depth + 1 };
+		Nodes[Left + 1] = { ChildBounds[1], ChildCentroids[1], Mid,   First + Count - Mid, 0, Node.Depth + 1 };
+		return true;
+	}
+
+	// Builds everything below Root. The pending nodes cover disjoint object ranges of Root, so the
+	// matching range of Stack is enough and is not shared with other subtrees.
+	void BuildSubtree(u32 Root, u32 NextNode) const
+	{
+		u32* SubtreeStack = Stack + Nodes[Root].First;
+		u32  Top          = 0;
+
+		SubtreeStack[Top++] = Root;
+		while (Top > 0)
+		{
+			u32 NodeIndex = SubtreeStack[--Top];
+			if (SplitNode(NodeIndex, &NextNode))
+			{
+				SubtreeStack[Top++] = Nodes[NodeIndex].Left;
+				SubtreeStack[Top++] = Nodes[NodeIndex].Left + 1;
+			}
+		}
+	}
+
+	static void BuildTask(void* Data, u32 Index)
+	{
+		const bvh_build_context* Context = (const bvh_build_context*)Data;
+		Context->BuildSubtree(Context->Tasks[Index].Node, Context->Tasks[Index].NextNode);
+	}
+};
+
+bvh::bvh(const allocator& Allocator, u32 MaxObjects)
+	: mAllocator(Allocator)
+	, mCapacity(MaxObjects)
+{
+	assert(MaxObjects > 0 && MaxObjects <= cLeafFirstMask);
+
+	mNodes      = mAllocator.AllocArray<node>(mCapacity);
+	mObjects    = mAllocator.AllocArray<u32>(mCapacity);
+	mLeafMinX   = mAllocator.AllocArray<f32>(mCapacity + 3);
+	mLeafMinY   = mAllocator.AllocArray<f32>(mCapacity + 3);
+	mLeafMinZ   = mAllocator.AllocArray<f32>(mCapacity + 3);
+	mLeafMaxX   = mAllocator.AllocArray<f32>(mCapacity + 3);
+	mLeafMaxY   = mAllocator.AllocArray<f32>(mCapacity + 3);
+	mLeafMaxZ   = mAllocator.AllocArray<f32>(mCapacity + 3);
+	mBuildNodes = mAllocator.AllocArray<build_node>(2 * mCapacity);
+	mBuildRefs  = mAllocator.AllocArray<build_ref>(mCapacity);
+	mStack      = mAllocator.AllocArray<u32>(2 * mCapacity);
+
+	// The lanes past the last leaf are loaded but always masked off
+	ForRange(u32, i, mCapacity + 3)
+	{
+		mLeafMinX[i] = mLeafMinY[i] = mLeafMinZ[i] =  cEmptyBound;
+		mLeafMaxX[i] = mLeafMaxY[i] = mLeafMaxZ[i] = -cEmptyBound;
+	}
+}
+
+void
+bvh::Deinit()
+{
+	if (!mNodes) return;
+
+	mAllocator.FreeArray(mNodes,      mCapacity);
+	mAllocator.FreeArray(mObjects,    mCapacity);
+	mAllocator.FreeArray(mLeafMinX,   mCapacity + 3);
+	mAllocator.FreeArray(mLeafMinY,   mCapacity + 3);
+	mAllocator.FreeArray(mLeafMinZ,   mCapacity + 3);
+	mAllocator.FreeArray(mLeafMaxX,   mCapacity + 3);
+	mAllocator.FreeArray(mLeafMaxY,   mCapacity + 3);
+	mAllocator.FreeArray(mLeafMaxZ,   mCapacity + 3);
+	mAllocator.FreeArray(mBuildNodes, 2 * mCapacity);
+	mAllocator.FreeArray(mBuildRefs,  mCapacity);
+	mAllocator.FreeArray(mStack,      2 * mCapacity);
+
+	*this = bvh();
+}
+
+void
+bvh::Build(const aabb* Bounds, u32 Count, bvh_parallel_for_pfn ParallelFor, void* ParallelForContext)
+{
+	assert(Count <= mCapacity);
+
+	mCount     = Count;
+	mNodeCount = 0;
+	if (Count == 0) return;
+
+	ForRange(u32, i, Count)
+	{
+		mBuildRefs[i].Bounds   = Bounds[i];
+		mBuildRefs[i].Centroid = (Bounds[i].Min + Bounds[i].Max) * 0.5f;
+		mBuildRefs[i].Object   = i;
+	}
+
+	bvh_build_task Tasks[cMaxBuildTasks];
+	u32            TaskCount = 0;
+
+	bvh_build_context Context = {};
+	Context.Refs      = mBuildRefs;
+	Context.Nodes     = mBuildNodes;
+	Context.Stack     = mStack;
+	Context.Tasks     = Tasks;
+
+	// The top of the tree is split here until the ranges are small enough to hand out as tasks
+	u32 TaskObjects = (Count / 64 > cMinTaskObjects) ? Count / 64 : cMinTaskObjects;
+	u32 NextNode    = 1;
+	u32 Top         = 0;
+
+	mBuildNodes[0] = { EmptyAabb(), EmptyAabb(), 0, Count, 0, 0 };
+	Context.ComputeBounds(0, Count, &mBuildNodes[0].Bounds, &mBuildNodes[0].CentroidBounds);
+
+	mStack[Top++]  = 0;
+	while (Top > 0)
+	{
+		u32         NodeIndex = mStack[--Top];
+		build_node& Node      = mBuildNodes[NodeIndex];
+
+		if (ParallelFor && Node.Count <= TaskObjects && TaskCount < cMaxBuildTasks)
+		{
+			Tasks[TaskCount++] = { NodeIndex, NextNode };
+			NextNode          += 2 * Node.Count - 2;
+			continue;
+		}
+
+		if (Context.SplitNode(NodeIndex, &NextNode))
+		{
+			mStack[Top++] = Node.Left;
+			mStack[Top++] = Node.Left + 1;
+		}
+	}
+
+	if (TaskCount > 0)
+	{
+		ParallelFor(ParallelForContext, TaskCount, bvh_build_context::BuildTask, &Context);
+	}
+
+	ForRange(u32, i, Count)
+	{
+		mObjects[i] = mBuildRefs[i].Object;
+	}
+
+	Collapse();
+	RefitLeaves(Bounds);
+}
+
+// Turns the binary build tree into 4-wide nodes. Each node takes its two children and then keeps
+// opening the largest inner child until it has four.
+void
+bvh::Collapse()
+{
+	auto SetChild = [](node& Node, u32 Lane, const aabb& Box, u32 Child) {
+		Node.MinX[Lane]  = Box.Min.X;
+		Node.MinY[Lane]  = Box.Min.Y;
+		Node.MinZ[Lane]  = Box.Min.Z;
+		Node.MaxX[Lane]  = Box.Max.X;
+		Node.MaxY[Lane]  = Box.Max.Y;
+		Node.MaxZ[Lane]  = Box.Max.Z;
+		Node.Child[Lane] = Child;
+	};
+
+	mNodeCount = 1;
+	ForRange(u32, Lane, 4)
+	{
+		SetChild(mNodes[0], Lane, EmptyAabb(), cEmptyChild);
+	}
+
+	const build_node& Root = mBuildNodes[0];
+	if (Root.Left == 0)
+	{
+		SetChild(mNodes[0], 0, Root.Bounds, MakeLeaf(Root.First, Root.Count));
+		return;
+	}
+
+	// Pairs of (node, build node)
+	u32 Top = 0;
+	mStack[Top++] = 0;
+	mStack[Top++] = 0;
+	while (Top > 0)
+	{
+		u32 BuildIndex = mStack[--Top];
+		u32 NodeIndex  = mStack[--Top];
+
+		u32 Gathered[4]  = { mBuildNodes[BuildIndex].Left, mBuildNodes[BuildIndex].Left + 1 };
+		u32 GatherCount  = 2;
+		while (GatherCount < 4)
+		{
+			u32 Largest     = U32_MAX;
+			f32 LargestArea = -1.0f;
+			ForRange(u32, i, GatherCount)
+			{
+				const build_node& Candidate = mBuildNodes[Gathered[i]];
+				if (Candidate.Left != 0 && HalfArea(Candidate.Bounds) > LargestArea)
+				{
+					Largest     = i;
+					LargestArea = HalfArea(Candidate.Bounds);
+				}
+			}
+			if (Largest == U32_MAX) break;
+
+			u32 Opened              = mBuildNodes[Gathered[Largest]].Left;
+			Gathered[Largest]       = Opened;
+			Gathered[GatherCount++] = Opened + 1;
+		}
+
+		ForRange(u32, Lane, 4)
+		{
+			node& Node = mNodes[NodeIndex];
+			if (Lane >= GatherCount)
+			{
+				SetChild(Node, Lane, EmptyAabb(), cEmptyChild);
+				continue;
+			}
+
+			const build_node& Child = mBuildNodes[Gathered[Lane]];
+			if (Child.Left == 0)
+			{
+				SetChild(Node, Lane, Child.Bounds, MakeLeaf(Child.First, Child.Count));
+			}
+			else
+			{
+				u32 ChildIndex = mNodeCount++;
+				SetChild(Node, Lane, Child.Bounds, ChildIndex);
+
+				mStack[Top++] = ChildIndex;
+				mStack[Top++] = Gathered[Lane];
+			}
+		}
+	}
+}
+
+void
+bvh::RefitLeaves(const aabb* Bounds)
+{
+	ForRange(u32, i, mCount)
+	{
+		const aabb& Box = Bounds[mObjects[i]];
+		mLeafMinX[i] = Box.Min.X;
+		mLeafMinY[i] = Box.Min.Y;
+		mLeafMinZ[i] = Box.Min.Z;
+		mLeafMaxX[i] = Box.Max.X;
+		mLeafMaxY[i] = Box.Max.Y;
+		mLeafMaxZ[i] = Box.Max.Z;
+	}
+}
+
+void
+bvh::Refit(const aabb* Bounds)
+{
+	RefitLeaves(Bounds);
+
+	// Children come after their parents, so a reverse walk sees every child before its parent
+	for (u32 NodeIndex = mNodeCount; NodeIndex-- > 0;)
+	{
+		node& Node = mNodes[NodeIndex];
+		ForRange(u32, Lane, 4)
+		{
+			u32 Child = Node.Child[Lane];
+			if (Child == cEmptyChild) continue;
+
+			aabb Box = EmptyAabb();
+			if (Child & cLeafFlag)
+			{
+				u32 First = LeafFirst(Child);
+				for (u32 i = First; i < First + LeafCount(Child); ++i)
+				{
+					GrowAabb(Box, { mLeafMinX[i], mLeafMinY[i], mLeafMinZ[i] }, { mLeafMaxX[i], mLeafMaxY[i], mLeafMaxZ[i] });
+				}
+			}
+			else
+			{
+				const node& Inner = mNodes[Child];
+				ForRange(u32, InnerLane, 4)
+				{
+					GrowAabb(Box, { Inner.MinX[InnerLane], Inner.MinY[InnerLane], Inner.MinZ[InnerLane] },
+					              { Inner.MaxX[InnerLane], Inner.MaxY[InnerLane], Inner.MaxZ[InnerLane] });
+				}
+			}
+
+			Node.MinX[Lane] = Box.Min.X;
+			Node.MinY[Lane] = Box.Min.Y;
+			Node.MinZ[Lane] = Box.Min.Z;
+			Node.MaxX[Lane] = Box.Max.X;
+			Node.MaxY[Lane] = Box.Max.Y;
+			Node.MaxZ[Lane] = Box.Max.Z;
+		}
+	}
+}
+
+aabb
+bvh::Bounds() const
+{
+	aabb Box = EmptyAabb();
+	if (mCount == 0) return Box;
+
+	const node& Root = mNodes[0];
+	ForRange(u32, Lane, 4)
+	{
+		GrowAabb(Box, { Root.MinX[Lane], Root.MinY[Lane], Root.MinZ[Lane] }, { Root.MaxX[Lane], Root.MaxY[Lane], Root.MaxZ[Lane] });
+	}
+	return Box;
+}
+
+//
+// Queries
+//
+// Every test covers 4 boxes, either the children of a node or the objects of a leaf, and returns a
+// 4 bit mask. Leaves pass their object bounds directly, the padding keeps the loads in bounds.
+//
+
+struct bvh_box4
+{
+	const f32* MinX;
+	const f32* MinY;
+	const f32* MinZ;
+	const f32* MaxX;
+	const f32* MaxY;
+	const f32* MaxZ;
+};
+
+// Same plane test as FrustumCullAabbs. Also reports the boxes that are inside every plane, whose
+// subtrees need no more tests.
+template<typename lanes> fn_internal u32
+FrustumTest4(const frustum& Frustum, bvh_box4 Box, u32* InsideMask)
+{
+	using reg = typename lanes::reg;
+
+	u32 Visible = 0;
+	u32 Inside  = 0;
+	for (u32 Lane = 0; Lane < 4; Lane += lanes::cWidth)
+	{
+		reg Half = lanes::Set1(0.5f);
+		reg MinX = lanes::Load(Box.MinX + Lane), MaxX = lanes::Load(Box.MaxX + Lane);
+		reg MinY = lanes::Load(Box.MinY + Lane), MaxY = lanes::Load(Box.MaxY + Lane);
+		reg MinZ = lanes::Load(Box.MinZ + Lane), MaxZ = lanes::Load(Box.MaxZ + Lane);
+
+		reg X  = lanes::Mul(lanes::Add(MinX, MaxX), Half);
+		reg Y  = lanes::Mul(lanes::Add(MinY, MaxY), Half);
+		reg Z  = lanes::Mul(lanes::Add(MinZ, MaxZ), Half);
+		reg EX = lanes::Mul(lanes::Sub(MaxX, MinX), Half);
+		reg EY = lanes::Mul(lanes::Sub(MaxY, MinY), Half);
+		reg EZ = lanes::Mul(lanes::Sub(MaxZ, MinZ), Half);
+
+		reg MinOuter = lanes::Set1(F32_MAX);
+		reg MinInner = lanes::Set1(F32_MAX);
+		for (const f32x4& Plane : Frustum.Planes)
+		{
+			reg Radius   = lanes::Mul(lanes::Set1(fabsf(Plane.X)), EX);
+			Radius       = lanes::MulAdd(lanes::Set1(fabsf(Plane.Y)), EY, Radius);
+			Radius       = lanes::MulAdd(lanes::Set1(fabsf(Plane.Z)), EZ, Radius);
+
+			reg Distance = lanes::MulAdd(lanes::Set1(Plane.X), X, lanes::Set1(Plane.W));
+			Distance     = lanes::MulAdd(lanes::Set1(Plane.Y), Y, Distance);
+			Distance     = lanes::MulAdd(lanes::Set1(Plane.Z), Z, Distance);
+
+			MinOuter     = lanes::Min(MinOuter, lanes::Add(Distance, Radius));
+			MinInner     = lanes::Min(MinInner, lanes::Sub(Distance, Radius));
+		}
+
+		Visible |= lanes::NonNegativeMask(MinOuter) << Lane;
+		Inside  |= lanes::NonNegativeMask(MinInner) << Lane;
+	}
+
+	*InsideMask = Inside & Visible;
+	return Visible;
+}
+
+template<typename lanes> fn_internal u32
+OverlapTest4(const aabb& Query, bvh_box4 Box)
+{
+	u32 Overlapping = 0;
+	for (u32 Lane = 0; Lane < 4; Lane += lanes::cWidth)
+	{
+		u32 Mask = lanes::NonNegativeMask(lanes::Sub(lanes::Set1(Query.Max.X), lanes::Load(Box.MinX + Lane)));
+		Mask    &= lanes::NonNegativeMask(lanes::Sub(lanes::Set1(Query.Max.Y), lanes::Load(Box.MinY + Lane)));
+		Mask    &= lanes::NonNegativeMask(lanes::Sub(lanes::Set1(Query.Max.Z), lanes::Load(Box.MinZ + Lane)));
+		Mask    &= lanes::NonNegativeMask(lanes::Sub(lanes::Load(Box.MaxX + Lane), lanes::Set1(Query.Min.X)));
+		Mask    &= lanes::NonNegativeMask(lanes::Sub(lanes::Load(Box.MaxY + Lane), lanes::Set1(Query.Min.Y)));
+		Mask    &= lanes::NonNegativeMask(lanes::Sub(lanes::Load(Box.MaxZ + Lane), lanes::Set1(Query.Min.Z)));
+		Overlapping |= Mask << Lane;
+	}
+	return Overlapping;
+}
+
+struct bvh_ray
+{
+	f32x3 Origin;
+	f32x3 InvDirection; // finite even for axis-aligned rays, so the slab math cannot make 0 * inf
+};
+
+// Slab test. Writes the entry distance of each box to TNear.
+template<typename lanes> fn_internal u32
+RayTest4(const bvh_ray& Ray, f32 MaxT, bvh_box4 Box, f32* TNear)
+{
+	using reg = typename lanes::reg;
+
+	u32 Hit = 0;
+	for (u32 Lane = 0; Lane < 4; Lane += lanes::cWidth)
+	{
+		reg X0 = lanes::Mul(lanes::Sub(lanes::Load(Box.MinX + Lane), lanes::Set1(Ray.Origin.X)), lanes::Set1(Ray.InvDirection.X));
+		reg X1 = lanes::Mul(lanes::Sub(lanes::Load(Box.MaxX + Lane), lanes::Set1(Ray.Origin.X)), lanes::Set1(Ray.InvDirection.X));
+		reg Y0 = lanes::Mul(lanes::Sub(lanes::Load(Box.MinY + Lane), lanes::Set1(Ray.Origin.Y)), lanes::Set1(Ray.InvDirection.Y));
+		reg Y1 = lanes::Mul(lanes::Sub(lanes::Load(Box.MaxY + Lane), lanes::Set1(Ray.Origin.Y)), lanes::Set1(Ray.InvDirection.Y));
+		reg Z0 = lanes::Mul(lanes::Sub(lanes::Load(Box.MinZ + Lane), lanes::Set1(Ray.Origin.Z)), lanes::Set1(Ray.InvDirection.Z));
+		reg Z1 = lanes::Mul(lanes::Sub(lanes::Load(Box.MaxZ + Lane), lanes::Set1(Ray.Origin.Z)), lanes::Set1(Ray.InvDirection.Z));
+
+		reg Enter = lanes::Max(lanes::Max(lanes::Min(X0, X1), lanes::Min(Y0, Y1)), lanes::Max(lanes::Min(Z0, Z1), lanes::Set1(0.0f)));
+		reg Exit  = lanes::Min(lanes::Min(lanes::Max(X0, X1), lanes::Max(Y0, Y1)), lanes::Min(lanes::Max(Z0, Z1), lanes::Set1(MaxT)));
+
+		lanes::Store(TNear + Lane, Enter);
+		Hit |= lanes::NonNegativeMask(lanes::Sub(Exit, Enter)) << Lane;
+	}
+	return Hit;
+}
+
+u32
+bvh::AppendSubtree(u32 Child, u32* Objects, u32 Count) const
+{
+	u32 Stack[cTraversalStackSize];
+	u32 Top = 0;
+
+	Stack[Top++] = Child;
+	while (Top > 0)
+	{
+		u32 Entry = Stack[--Top];
+		if (Entry & cLeafFlag)
+		{
+			u32 First = LeafFirst(Entry);
+			for (u32 i = First; i < First + LeafCount(Entry); ++i)
+			{
+				Objects[Count++] = mObjects[i];
+			}
+			continue;
+		}
+
+		const node& Node = mNodes[Entry];
+		ForRange(u32, Lane, 4)
+		{
+			if (Node.Child[Lane] == cEmptyChild) continue;
+
+			assert(Top < cTraversalStackSize);
+			Stack[Top++] = Node.Child[Lane];
+		}
+	}
+	return Count;
+}
+
+u32
+bvh::CullFrustum(const frustum& Frustum, u32* VisibleObjects) const
+{
+	if (mCount == 0) return 0;
+
+	u32 Count = 0;
+	u32 Stack[cTraversalStackSize];
+	u32 Top   = 0;
+
+	Stack[Top++] = 0;
+	while (Top > 0)
+	{
+		const node& Node = mNodes[Stack[--Top]];
+
+		u32 Inside;
+		u32 Visible = FrustumTest4<bvh_lanes>(Frustum, { Node.MinX, Node.MinY, Node.MinZ, Node.MaxX, Node.MaxY, Node.MaxZ }, &Inside);
+		ForRange(u32, Lane, 4)
+		{
+			if (!((Visible >> Lane) & 1)) continue;
+
+			u32 Child = Node.Child[Lane];
+			if ((Inside >> Lane) & 1)
+			{
+				Count = AppendSubtree(Child, VisibleObjects, Count);
+			}
+			else if (Child & cLeafFlag)
+			{
+				u32 First       = LeafFirst(Child);
+				u32 LeafInside;
+				u32 LeafVisible = FrustumTest4<bvh_lanes>(Frustum,
+					{ mLeafMinX + First, mLeafMinY + First, mLeafMinZ + First, mLeafMaxX + First, mLeafMaxY + First, mLeafMaxZ + First }, &LeafInside);
+
+				ForRange(u32, i, LeafCount(Child))
+				{
+					VisibleObjects[Count] = mObjects[First + i];
+					Count += (LeafVisible >> i) & 1;
+				}
+			}
+			else
+			{
+				assert(Top < cTraversalStackSize);
+				Stack[Top++] = Child;
+			}
+		}
+	}
+	return Count;
+}
+
+u32
+bvh::Overlap(const aabb& Box, u32* Objects) const
+{
+	if (mCount == 0) return 0;
+
+	u32 Count = 0;
+	u32 Stack[cTraversalStackSize];
+	u32 Top   = 0;
+
+	Stack[Top++] = 0;
+	while (Top > 0)
+	{
+		const node& Node        = mNodes[Stack[--Top]];
+		u32         Overlapping = OverlapTest4<bvh_lanes>(Box, { Node.MinX, Node.MinY, Node.MinZ, Node.MaxX, Node.MaxY, Node.MaxZ });
+		ForRange(u32, Lane, 4)
+		{
+			if (!((Overlapping >> Lane) & 1)) continue;
+
+			u32 Child = Node.Child[Lane];
+			if (Child & cLeafFlag)
+			{
+				u32 First       = LeafFirst(Child);
+				u32 LeafOverlap = OverlapTest4<bvh_lanes>(Box,
+					{ mLeafMinX + First, mLeafMinY + First, mLeafMinZ + First, mLeafMaxX + First, mLeafMaxY + First, mLeafMaxZ + First });
+
+				ForRange(u32, i, LeafCount(Child))
+				{
+					Objects[Count] = mObjects[First + i];
+					Count += (LeafOverlap >> i) & 1;
+				}
+			}
+			else
+			{
+				assert(Top < cTraversalStackSize);
+				Stack[Top++] = Child;
+			}
+		}
+	}
+	return Count;
+}
+
+u32
+bvh::RayCast(f32x3 Origin, f32x3 Direction, f32 MaxT, f32* HitT) const
+{
+	return RayCast(Origin, Direction, MaxT, nullptr, nullptr, HitT);
+}
+
+u32
+bvh::RayCast(f32x3 Origin, f32x3 Direction, f32 MaxT, bvh_ray_intersect_pfn Intersect, void* Context, f32* HitT) const
+{
+	if (mCount == 0) return cNoHit;
+
+	auto SafeInverse = [](f32 Value) {
+		return (fabsf(Value) > 1.0f / cEmptyBound) ? 1.0f / Value : copysignf(cEmptyBound, Value);
+	};
+
+	bvh_ray Ray = {};
+	Ray.Origin       = Origin;
+	Ray.InvDirection = { SafeInverse(Direction.X), SafeInverse(Direction.Y), SafeInverse(Direction.Z) };
+
+	struct entry
+	{
+		u32 Child;
+		f32 TNear;
+	};
+
+	entry Stack[cTraversalStackSize];
+	u32   Top       = 0;
+	u32   HitObject = cNoHit;
+	f32   Closest   = MaxT;
+
+	Stack[Top++] = { 0, 0.0f };
+	while (Top > 0)
+	{
+		entry Entry = Stack[--Top];
+		if (Entry.TNear > Closest) continue;
+
+		f32 TNear[4];
+		if (Entry.Child & cLeafFlag)
+		{
+			u32 First = LeafFirst(Entry.Child);
+			u32 Hit   = RayTest4<bvh_lanes>(Ray, Closest,
+				{ mLeafMinX + First, mLeafMinY + First, mLeafMinZ + First, mLeafMaxX + First, mLeafMaxY + First, mLeafMaxZ + First }, TNear);
+
+			ForRange(u32, i, LeafCount(Entry.Child))
+			{
+				if (!((Hit >> i) & 1)) continue;
+
+				u32 Object = mObjects[First + i];
+				f32 T      = Intersect ? Intersect(Context, Object, Origin, Direction, Closest) : TNear[i];
+				if (T < Closest || (T == Closest && HitObject == cNoHit))
+				{
+					Closest   = T;
+					HitObject = Object;
+				}
+			}
+			continue;
+		}
+
+		const node& Node = mNodes[Entry.Child];
+		u32         Hit  = RayTest4<bvh_lanes>(Ray, Closest, { Node.MinX, Node.MinY, Node.MinZ, Node.MaxX, Node.MaxY, Node.MaxZ }, TNear);
+
+		// Push the hit children farthest first so the nearest is visited next and shrinks Closest early.
+		// Empty children are masked off explicitly: the slab test is not reliable on inverted bounds.
+		entry Sorted[4];
+		u32   SortedCount = 0;
+		ForRange(u32, Lane, 4)
+		{
+			if (!((Hit >> Lane) & 1) || Node.Child[Lane] == cEmptyChild) continue;
+
+			u32 Slot = SortedCount++;
+			while (Slot > 0 && Sorted[Slot - 1].TNear < TNear[Lane])
+			{
+				Sorted[Slot] = Sorted[Slot - 1];
+				Slot -= 1;
+			}
+			Sorted[Slot] = { Node.Child[Lane], TNear[Lane] };
+		}
+
+		ForRange(u32, i, SortedCount)
+		{
+			assert(Top < cTraversalStackSize);
+			Stack[Top++] = Sorted[i];
+		}
+	}
+
+	if (HitObject != cNoHit && HitT)
+	{
+		*HitT = Closest;
+	}
+	return HitObject;
+}
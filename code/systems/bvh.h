@@ -0,0 +1,142 @@
+#pragma once
+
+#include <types.h>
+#include <util/allocator.h>
+#include <math/math.h>
+#include <math/culling.h>
+
+// Runs Task(Data, i) for every i in [0, Count) and returns once all of them have finished. The tasks
+// are independent of each other and may run on any thread, in any order.
+using bvh_task_pfn         = void (*)(void* Data, u32 Index);
+using bvh_parallel_for_pfn = void (*)(void* Context, u32 Count, bvh_task_pfn Task, void* Data);
+
+// Exact intersection for RayCast. Returns the distance along the ray to the hit, or a value greater than
+// MaxT when Object is missed. Only called for objects whose bounds the ray enters before MaxT.
+using bvh_ray_intersect_pfn = f32 (*)(void* Context, u32 Object, f32x3 Origin, f32x3 Direction, f32 MaxT);
+
+//
+// bvh
+//
+// Bounding volume hierarchy over object AABBs, for culling, picking and ray queries that do not scan
+// every object.
+//
+// Build() makes a binary tree with binned SAH splits, then collapses it into nodes with 4 children each.
+// A node stores its children's bounds as SoA, so one SSE test covers the whole node. With a parallel-for
+// callback, the subtrees below the top levels of the binary tree are built as independent tasks.
+//
+// Refit() updates the bounds in place for objects that moved, keeping the topology. It is much cheaper
+// than a rebuild but the tree degrades as objects move far from where they were built, so rebuild
+// now and then (or when objects are added or removed).
+//
+// Objects are the indices into the bounds array given to Build() and Refit().
+//
+// Usage:
+//     bvh Bvh = bvh(Allocator, MaxObjects);
+//     Bvh.Build(Bounds, ObjectCount);
+//
+//     // Each frame, after the objects moved
+//     Bvh.Refit(Bounds);
+//     u32 VisibleCount = Bvh.CullFrustum(CameraFrustum, VisibleObjects);
+//
+//     f32 HitT;
+//     u32 Picked = Bvh.RayCast(CameraPosition, RayDirection, 100.0f, &HitT);
+//
+class bvh
+{
+public:
+	static constexpr u32 cNoHit       = U32_MAX;
+	static constexpr u32 cMaxLeafSize = 4;
+
+	bvh() = default;
+	bvh(const allocator& Allocator, u32 MaxObjects);
+	void Deinit();
+
+	// Replaces the tree with one over Bounds[0, Count). ParallelFor is optional; without it the build is serial.
+	void Build(const aabb* Bounds, u32 Count, bvh_parallel_for_pfn ParallelFor = nullptr, void* ParallelForContext = nullptr);
+	// Bounds must have the same Count as the last Build().
+	void Refit(const aabb* Bounds);
+
+	u32  Count()  const { return mCount;  }
+	aabb Bounds() const;
+
+	// Writes the objects whose bounds intersect the frustum and returns how many there are. VisibleObjects
+	// must have room for Count() objects. The order is the tree order, not the object order.
+	u32  CullFrustum(const frustum& Frustum, u32* VisibleObjects) const;
+	// Same as CullFrustum, for the objects whose bounds overlap Box.
+	u32  Overlap(const aabb& Box, u32* Objects) const;
+
+	// Closest object along Origin + T * Direction with T in [0, MaxT], or cNoHit. The first overload
+	// hits the object bounds, which is enough for picking. The second refines with Intersect.
+	u32  RayCast(f32x3 Origin, f32x3 Direction, f32 MaxT, f32* HitT) const;
+	u32  RayCast(f32x3 Origin, f32x3 Direction, f32 MaxT, bvh_ray_intersect_pfn Intersect, void* Context, f32* HitT) const;
+
+private:
+	// Child bounds as SoA. A child is another node, a leaf (cLeafFlag | (Count - 1) << cLeafCountShift | First)
+	// over mObjects[First, First + Count), or cEmptyChild, whose bounds are inverted so nothing overlaps it.
+	struct alignas(16) node
+	{
+		f32 MinX[4];
+		f32 MinY[4];
+		f32 MinZ[4];
+		f32 MaxX[4];
+		f32 MaxY[4];
+		f32 MaxZ[4];
+		u32 Child[4];
+	};
+
+	static constexpr u32 cLeafFlag       = 0x8000'0000;
+	static constexpr u32 cLeafCountShift = 28;
+	static constexpr u32 cLeafFirstMask  = (1u << cLeafCountShift) - 1;
+	static constexpr u32 cEmptyChild     = U32_MAX;
+	static_assert(cMaxLeafSize <= 8, "Leaf counts are stored in 3 bits");
+
+	static u32 MakeLeaf(u32 First, u32 Count) { return cLeafFlag | ((Count - 1) << cLeafCountShift) | First; }
+	static u32 LeafFirst(u32 Child)           { return Child & cLeafFirstMask;                              }
+	static u32 LeafCount(u32 Child)           { return ((Child >> cLeafCountShift) & 0x7) + 1;              }
+
+	// Objects are partitioned as these records rather than as indices, so the build reads memory in order.
+	struct build_ref
+	{
+		aabb  Bounds;
+		f32x3 Centroid;
+		u32   Object;
+	};
+
+	// Binary tree nodes of the build, collapsed into mNodes at the end.
+	struct build_node
+	{
+		aabb Bounds;
+		aabb CentroidBounds;
+		u32  First;
+		u32  Count;
+		u32  Left;  // 0 for leaves, otherwise the right child is Left + 1
+		u32  Depth;
+	};
+
+	friend struct bvh_build_context;
+
+	void Collapse();
+	void RefitLeaves(const aabb* Bounds);
+	u32  AppendSubtree(u32 Child, u32* Objects, u32 Count) const;
+
+	allocator   mAllocator  = {};
+	u32         mCapacity   = 0;
+	u32         mCount      = 0;
+	u32         mNodeCount  = 0;
+
+	node*       mNodes      = nullptr;  // 0 is the root, parents come before their children
+	u32*        mObjects    = nullptr;  // leaf order -> object
+
+	// Object bounds in leaf order, padded by 3 so a leaf always loads 4 lanes
+	f32*        mLeafMinX   = nullptr;
+	f32*        mLeafMinY   = nullptr;
+	f32*        mLeafMinZ   = nullptr;
+	f32*        mLeafMaxX   = nullptr;
+	f32*        mLeafMaxY   = nullptr;
+	f32*        mLeafMaxZ   = nullptr;
+
+	// Build scratch
+	build_node* mBuildNodes = nullptr;
+	build_ref*  mBuildRefs  = nullptr;
+	u32*        mStack      = nullptr;
+};
@@ -1,5 +1,10 @@
 #include "resource_system.h"
 
+#include <platform/platform.h>
+
+#include <string.h>
+#include <utility>
+
 fn_internal void
 NormalizePath(mstr8& Path)
 {
@@ -60,6 +65,97 @@ resource_system::Load(resource_type Type, istr8 ResourceName, resource* OutResou
 	return false;
 }
 
+u32 
+resource_system::LoadBatch(resource_type Type, const istr8* ResourceNames, resource** OutResources, u32 Count)
+{
+	assert(Type != resource_type::unknown);
+
+	if (Type >= resource_type::custom)
+	{ // TODO(enlynn): Handle custom loaders
+		return 0;
+	}
+
+	resource_loader_entry& Entry  = mLoaders[u32(Type)];
+	resource_loader&       Loader = Entry.mLoader;
+
+	u32 LoadedCount = 0;
+	if (!Loader.GetFilePath)
+	{
+		ForRange(u32, i, Count)
+		{
+			LoadedCount += Load(Type, ResourceNames[i], OutResources[i]) ? 1 : 0;
+		}
+		return LoadedCount;
+	}
+
+	allocator FileAllocator = allocator::Default(); // Loaders free the file data with the default allocator
+
+	mstr8*                 FilePaths    = FileAllocator.AllocArray<mstr8>(Count, allocation_strategy::default_init);
+	platform_read_request* Requests     = FileAllocator.AllocArray<platform_read_request>(Count, allocation_strategy::default_init);
+	u32                    RequestCount = 0;
+
+	// Size every file up front so all of the reads can be queued at once.
+	ForRange(u32, i, Count)
+	{
+		resource* Resource = OutResources[i];
+		FilePaths[i] = Loader.GetFilePath(&Loader, Entry.mAbsolutePath, ResourceNames[i], Resource);
+
+		u64 FileSize = 0;
+		if (!PlatformGetFileSize(FilePaths[i], &FileSize))
+		{
+			LogError("Unable to find resource file: %s", FilePaths[i].Ptr());
+			continue;
+		}
+
+		Resource->mBaseData     = FileAllocator.AllocChunk(FileSize);
+		Resource->mBaseDataSize = FileSize;
+
+		platform_read_request& Request = Requests[RequestCount++];
+		Request.AbsolutePath = FilePaths[i];
+		Request.Size         = FileSize;
+		Request.Destination  = Resource->mBaseData;
+		Request.UserData     = (void*)u64(i);
+	}
+
+	if (RequestCount > 0)
+	{
+		platform_async_reader Reader = {};
+		Reader.Init(FileAllocator);
+
+		// Parse the files that arrived while the rest are still being read.
+		u32                      SubmittedCount = 0;
+		platform_read_completion Completions[16];
+		while (SubmittedCount < RequestCount || Reader.InFlight() > 0)
+		{
+			SubmittedCount += Reader.Submit(Requests + SubmittedCount, RequestCount - SubmittedCount);
+
+			u32 CompletionCount = Reader.Wait(Completions, ArrayCount(Completions));
+			ForRange(u32, i, CompletionCount)
+			{
+				u32       Index    = u32(u64(Completions[i].UserData));
+				resource* Resource = OutResources[Index];
+
+				if (!Completions[i].Succeeded || Completions[i].BytesRead != Resource->mBaseDataSize)
+				{
+					LogError("Failed to read resource file: %s", FilePaths[Index].Ptr());
+					FileAllocator.Free(Resource->mBaseData);
+					Resource->mBaseData     = nullptr;
+					Resource->mBaseDataSize = 0;
+					continue;
+				}
+
+				LoadedCount += Resource->Parse(&Loader, ResourceNames[Index], Resource) ? 1 : 0;
+			}
+		}
+
+		Reader.Deinit();
+	}
+
+	FileAllocator.Free(Requests);
+	FileAllocator.FreeArray(FilePaths, Count, allocation_strategy::deconstruct);
+	return LoadedCount;
+}
+
 void 
 resource_system::Unload(resource_type Type, resource* InResource)
 {
@@ -74,4 +170,238 @@ resource_system::Unload(resource_type Type, resource* InResource)
 	{
 		// TODO(enlynn): Handle custom loaders
 	}
-}
\ No newline at end of file
+}
+
+//
+// resource_watcher
+//
+
+resource_watcher::resource_watcher(const allocator& Allocator, resource_system* ResourceSystem)
+{
+	mAllocator      = Allocator.Clone();
+	mResourceSystem = ResourceSystem;
+	mTracked        = mAllocator.AllocArray<tracked_resource>(cMaxTrackedResources, allocation_strategy::default_init);
+	mPending        = mAllocator.AllocArray<pending_change>(cMaxPendingChanges, allocation_strategy::default_init);
+
+	mIsWatching = mFileWatcher.Init(mAllocator, ResourceSystem->mBasePath);
+	if (!mIsWatching)
+	{
+		LogWarn("Resource hot reload is disabled, unable to watch: %s", ResourceSystem->mBasePath.Ptr());
+	}
+}
+
+void
+resource_watcher::Deinit()
+{
+	if (!mTracked) return;
+
+	mFileWatcher.Deinit();
+	mAllocator.FreeArray(mPending, cMaxPendingChanges, allocation_strategy::deconstruct);
+	mAllocator.FreeArray(mTracked, cMaxTrackedResources, allocation_strategy::deconstruct);
+
+	mTracked      = nullptr;
+	mTrackedCount = 0;
+	mPending      = nullptr;
+	mPendingCount = 0;
+	mIsWatching   = false;
+}
+
+bool
+resource_watcher::Track(resource_type Type, istr8 ResourceName, resource* Resource, resource_reload_pfn OnReload, void* UserData)
+{
+	assert(Type != resource_type::unknown);
+
+	if (Type >= resource_type::custom)
+	{ // TODO(enlynn): Handle custom loaders
+		return false;
+	}
+
+	if (mTrackedCount == cMaxTrackedResources)
+	{
+		LogError("Too many tracked resources, %s will not be hot reloaded", ResourceName.Ptr());
+		return false;
+	}
+
+	resource_system::resource_loader_entry& Entry  = mResourceSystem->mLoaders[u32(Type)];
+	resource_loader&                        Loader = Entry.mLoader;
+
+	tracked_resource& Tracked = mTracked[mTrackedCount];
+	Tracked.Type     = Type;
+	Tracked.Name     = mstr8(ResourceName);
+	Tracked.Resource = Resource;
+	Tracked.OnReload = OnReload;
+	Tracked.UserData = UserData;
+	Tracked.IsDirty  = false;
+
+	if (Loader.GetFilePath)
+	{
+		mstr8 FilePath = Loader.GetFilePath(&Loader, Entry.mAbsolutePath, ResourceName, Resource);
+
+		// Loader paths are built from the base path, see RegisterLoader
+		u64 BaseLength = mResourceSystem->mBasePath.Length();
+		assert(FilePath.Length() > BaseLength && memcmp(FilePath.Ptr(), mResourceSystem->mBasePath.Ptr(), BaseLength) == 0);
+
+		Tracked.Path        = mstr8(FilePath.Ptr() + BaseLength + 1, FilePath.Length() - BaseLength - 1);
+		Tracked.IsDirectory = false;
+	}
+	else
+	{ // Don't know which files the loader reads, any change in its directory reloads the resource
+		Tracked.Path        = Loader.mRelativePath;
+		Tracked.IsDirectory = true;
+	}
+
+	mTrackedCount += 1;
+	return true;
+}
+
+void
+resource_watcher::Untrack(resource* Resource)
+{
+	ForRange(u32, i, mTrackedCount)
+	{
+		if (mTracked[i].Resource != Resource) continue;
+
+		mTrackedCount -= 1;
+		if (i != mTrackedCount)
+		{
+			mTracked[i] = std::move(mTracked[mTrackedCount]);
+		}
+		mTracked[mTrackedCount] = {};
+		return;
+	}
+}
+
+void
+resource_watcher::OnFileChanged(void* UserData, istr8 RelativePath, file_change_type Type)
+{
+	resource_watcher* Self = (resource_watcher*)UserData;
+	u64               Now  = PlatformQueryNanoseconds();
+
+	if (Type == file_change_type::overflow)
+	{
+		Self->mReloadAll   = true;
+		Self->mReloadAllNs = Now;
+		return;
+	}
+
+	// The type does not matter: whatever happened last, the file is looked at once it settles.
+	ForRange(u32, i, Self->mPendingCount)
+	{
+		if (Self->mPending[i].Path == RelativePath)
+		{
+			Self->mPending[i].LastEventNs = Now;
+			return;
+		}
+	}
+
+	if (Self->mPendingCount == cMaxPendingChanges)
+	{ // A large copy or checkout, don't bother tracking every path
+		Self->mReloadAll   = true;
+		Self->mReloadAllNs = Now;
+		return;
+	}
+
+	pending_change& Change = Self->mPending[Self->mPendingCount++];
+	Change.Path        = mstr8(RelativePath);
+	Change.LastEventNs = Now;
+}
+
+void
+resource_watcher::MarkDirty(istr8 RelativePath)
+{
+	ForRange(u32, i, mTrackedCount)
+	{
+		tracked_resource& Tracked = mTracked[i];
+
+		bool IsMatch = false;
+		if (Tracked.IsDirectory)
+		{
+			u64 Length = Tracked.Path.Length();
+			IsMatch = RelativePath.Length() > Length
+				&& memcmp(RelativePath.Ptr(), Tracked.Path.Ptr(), Length) == 0
+				&& RelativePath[Length] == '/';
+		}
+		else
+		{
+			IsMatch = Tracked.Path == RelativePath;
+		}
+
+		Tracked.IsDirty |= IsMatch;
+	}
+}
+
+u32
+resource_watcher::Update()
+{
+	if (!mIsWatching) return 0;
+
+	mFileWatcher.Poll(OnFileChanged, this);
+
+	u64 Now = PlatformQueryNanoseconds();
+
+	if (mReloadAll && Now - mReloadAllNs >= cDebounceNanoseconds)
+	{
+		ForRange(u32, i, mTrackedCount)
+		{
+			mTracked[i].IsDirty = true;
+		}
+
+		mReloadAll    = false;
+		mPendingCount = 0;
+	}
+
+	for (u32 i = 0; i < mPendingCount;)
+	{
+		pending_change& Change = mPending[i];
+		if (Now - Change.LastEventNs < cDebounceNanoseconds)
+		{ // Still being written
+			i += 1;
+			continue;
+		}
+
+		MarkDirty(Change.Path);
+
+		mPendingCount -= 1;
+		if (i != mPendingCount)
+		{
+			Change = std::move(mPending[mPendingCount]);
+		}
+	}
+
+	u32 ReloadCount = 0;
+	ForRange(u32, i, mTrackedCount)
+	{
+		tracked_resource& Tracked = mTracked[i];
+		if (!Tracked.IsDirty) continue;
+		Tracked.IsDirty = false;
+
+		// Removed, or replaced by a rename that has not happened yet. Keep the old data, a later
+		// change picks the file up again.
+		if (!Tracked.IsDirectory)
+		{
+			mstr8 FilePath = mResourceSystem->mBasePath + "/" + Tracked.Path;
+
+			u64 FileSize = 0;
+			if (!PlatformGetFileSize(FilePath, &FileSize))
+				continue;
+		}
+
+		LogInfo("Reloading resource: %s", Tracked.Name.Ptr());
+
+		mResourceSystem->Unload(Tracked.Type, Tracked.Resource);
+		if (!mResourceSystem->Load(Tracked.Type, Tracked.Name, Tracked.Resource))
+		{
+			LogError("Failed to reload resource: %s", Tracked.Name.Ptr());
+			continue;
+		}
+
+		if (Tracked.OnReload)
+		{
+			Tracked.OnReload(Tracked.UserData, Tracked.Resource);
+		}
+
+		ReloadCount += 1;
+	}
+
+	return ReloadCount;
+}
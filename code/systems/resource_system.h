@@ -3,6 +3,7 @@
 #include <types.h>
 #include <util/str8.h>
 #include <util/allocator.h>
+#include <platform/platform.h>
 
 enum class resource_type : u8
 {
@@ -34,6 +35,11 @@ struct resource_loader
 
 	bool (*Load)(resource_loader* Self, const istr8 AbsolutePath, const istr8 ResourceName, resource* OutResource);
 	void (*Unload)(resource_loader* self, resource* resource);
+
+	// Optional. Loaders whose resources are one whole file can provide the file path instead, then
+	// LoadBatch reads the files asynchronously and calls resource::Parse on each as it arrives. The file
+	// data is allocated with allocator::Default() and owned by the loader, like in Load.
+	mstr8 (*GetFilePath)(resource_loader* Self, const istr8 AbsolutePath, const istr8 ResourceName, resource* Resource) = nullptr;
 };
 
 class resource_system
@@ -45,6 +51,9 @@ public:
 
 	// Loads a builtin resource type
 	bool Load(resource_type Type, istr8 ResourceName, resource* OutResource);
+	// Loads many resources of one builtin type, reading the files in parallel while the ones that arrived
+	// are parsed. Falls back to Load for loaders without GetFilePath. Returns how many loaded.
+	u32  LoadBatch(resource_type Type, const istr8* ResourceNames, resource** OutResources, u32 Count);
 	void Unload(resource_type Type, resource* InResource);
 
 	// Loads a custom resource type - TODO(enlynn)
@@ -52,6 +61,8 @@ public:
 	//void UnloadCustom(const istr8 ResourceName, resource* InResource);
 
 private:
+	friend class resource_watcher;
+
 	struct resource_loader_entry 
 	{
 		mstr8           mAbsolutePath = {};
@@ -62,11 +73,84 @@ private:
 	resource_loader_entry mLoaders[u32(resource_type::count) - 1] = {}; // Don't store custom loaders.
 };
 
-#if 0 // TODO:
+// Called after a tracked resource was reloaded, e.g. to rebuild the pipelines that use a shader.
+using resource_reload_pfn = void (*)(void* UserData, resource* Resource);
+
+//
+// resource_watcher
+//
+// Hot reloads resources when their files change on disk. The content directory of the resource system
+// is watched, and changed paths are mapped back to the tracked resources: the file of the resource for
+// loaders with GetFilePath, otherwise any file under the loader's directory. Only those resources are
+// reloaded, with the loader's Unload and then Load.
+//
+// Editors and compilers write a file in several steps (truncate, write, rename), and a build touches
+// many files at once, so changes are coalesced per path and a path is only handled once it has been
+// quiet for cDebounceNanoseconds.
+//
+// Usage:
+//     resource_watcher Watcher = resource_watcher(Allocator, &ResourceSystem);
+//     Watcher.Track(resource_type::builtin_shader, "TestTriangle", &VertexShader, RebuildPipelines, &Pass);
+//
+//     // Once a frame
+//     Watcher.Update();
+//
 class resource_watcher
 {
+public:
+	static constexpr u32 cMaxTrackedResources = 1024;
+	static constexpr u32 cMaxPendingChanges   = 256;
+	static constexpr u64 cDebounceNanoseconds = 100'000'000;
+
+	resource_watcher() = default;
+	// Watching is disabled (and logged) if the content directory can't be watched.
+	resource_watcher(const allocator& Allocator, resource_system* ResourceSystem);
+	void Deinit();
+
+	// Starts reloading Resource when its files change. The resource must have been loaded through the
+	// resource system and stay alive until it is untracked.
+	bool Track(resource_type Type, istr8 ResourceName, resource* Resource, resource_reload_pfn OnReload = nullptr, void* UserData = nullptr);
+	void Untrack(resource* Resource);
+
+	// Reloads the resources whose files settled since the last call. Returns how many were reloaded.
+	u32  Update();
+
+private:
+	struct tracked_resource
+	{
+		resource_type       Type        = resource_type::unknown;
+		mstr8               Name        = {};
+		mstr8               Path        = {};      // relative to the content directory
+		bool                IsDirectory = false;   // Path is the loader's directory, not the resource's file
+		resource*           Resource    = nullptr;
+		resource_reload_pfn OnReload    = nullptr;
+		void*               UserData    = nullptr;
+		bool                IsDirty     = false;
+	};
+
+	struct pending_change
+	{
+		mstr8 Path        = {};
+		u64   LastEventNs = 0;
+	};
+
+	static void OnFileChanged(void* UserData, istr8 RelativePath, file_change_type Type);
+	void        MarkDirty(istr8 RelativePath);
+
+	allocator             mAllocator      = {};
+	resource_system*      mResourceSystem = nullptr;
+	platform_file_watcher mFileWatcher    = {};
+	bool                  mIsWatching     = false;
+
+	tracked_resource*     mTracked        = nullptr;
+	u32                   mTrackedCount   = 0;
+
+	pending_change*       mPending        = nullptr;
+	u32                   mPendingCount   = 0;
+	// Set when changes were lost (OS overflow or too many pending paths), everything is reloaded
+	bool                  mReloadAll      = false;
+	u64                   mReloadAllNs    = 0;
 };
-#endif
 
 #if 0 // Usage code
 ResourceSystem->RegisterLoader(shader_resource::GetResourceLoader());
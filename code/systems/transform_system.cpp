@@ -0,0 +1,438 @@
+#include "transform_system.h"
+
+#include <string.h>
+
+transform_system::transform_system(const allocator& Allocator, u32 MaxTransforms, u32 BufferedFrames)
+	: mAllocator(Allocator)
+	, mCapacity(MaxTransforms)
+	, mBufferedFrames(BufferedFrames)
+{
+	assert(MaxTransforms > 0 && MaxTransforms < id_type_internal::cIndexMask);
+	assert(BufferedFrames > 0);
+
+	mPositionX   = mAllocator.AllocArray<f32>(mCapacity);
+	mPositionY   = mAllocator.AllocArray<f32>(mCapacity);
+	mPositionZ   = mAllocator.AllocArray<f32>(mCapacity);
+	mRotationX   = mAllocator.AllocArray<f32>(mCapacity);
+	mRotationY   = mAllocator.AllocArray<f32>(mCapacity);
+	mRotationZ   = mAllocator.AllocArray<f32>(mCapacity);
+	mRotationW   = mAllocator.AllocArray<f32>(mCapacity);
+	mScaleX      = mAllocator.AllocArray<f32>(mCapacity);
+	mScaleY      = mAllocator.AllocArray<f32>(mCapacity);
+	mScaleZ      = mAllocator.AllocArray<f32>(mCapacity);
+	mWorld       = mAllocator.AllocArray<f32x44>(mCapacity);
+	mParent      = mAllocator.AllocArray<u32>(mCapacity);
+	mFirstChild  = mAllocator.AllocArray<u32>(mCapacity);
+	mChildCount  = mAllocator.AllocArray<u32>(mCapacity);
+	mObjectIndex = mAllocator.AllocArray<u32>(mCapacity);
+	mSlotId      = mAllocator.AllocArray<u32>(mCapacity);
+	mLevelStart  = mAllocator.AllocArray<u32>(mCapacity + 1);
+	mIds         = mAllocator.AllocArray<id_type>(mCapacity);
+	mIdSlot      = mAllocator.AllocArray<u32>(mCapacity);
+	mFreeIds     = mAllocator.AllocArray<u32>(mCapacity);
+	mScratchA    = mAllocator.AllocArray<u32>(mCapacity);
+	mScratchB    = mAllocator.AllocArray<u32>(mCapacity);
+	mScratchF32  = mAllocator.AllocArray<f32>(mCapacity);
+
+	mDirty         = dbitset(mAllocator, mCapacity);
+	mRemoved       = dbitset(mAllocator, mCapacity);
+	mPendingUpload = mAllocator.AllocArray<dbitset>(mBufferedFrames);
+	ForRange(u32, i, mBufferedFrames)
+	{
+		mPendingUpload[i] = dbitset(mAllocator, mCapacity);
+	}
+
+	// Hand out low id indices first
+	ForRange(u32, i, mCapacity)
+	{
+		mIds[i]     = id_type(i);
+		mFreeIds[i] = mCapacity - 1 - i;
+	}
+	mFreeIdCount   = mCapacity;
+	mLevelStart[0] = 0;
+}
+
+void
+transform_system::Deinit()
+{
+	if (!mWorld) return;
+
+	mAllocator.FreeArray(mPositionX,   mCapacity);
+	mAllocator.FreeArray(mPositionY,   mCapacity);
+	mAllocator.FreeArray(mPositionZ,   mCapacity);
+	mAllocator.FreeArray(mRotationX,   mCapacity);
+	mAllocator.FreeArray(mRotationY,   mCapacity);
+	mAllocator.FreeArray(mRotationZ,   mCapacity);
+	mAllocator.FreeArray(mRotationW,   mCapacity);
+	mAllocator.FreeArray(mScaleX,      mCapacity);
+	mAllocator.FreeArray(mScaleY,      mCapacity);
+	mAllocator.FreeArray(mScaleZ,      mCapacity);
+	mAllocator.FreeArray(mWorld,       mCapacity);
+	mAllocator.FreeArray(mParent,      mCapacity);
+	mAllocator.FreeArray(mFirstChild,  mCapacity);
+	mAllocator.FreeArray(mChildCount,  mCapacity);
+	mAllocator.FreeArray(mObjectIndex, mCapacity);
+	mAllocator.FreeArray(mSlotId,      mCapacity);
+	mAllocator.FreeArray(mLevelStart,  mCapacity + 1);
+	mAllocator.FreeArray(mIds,         mCapacity);
+	mAllocator.FreeArray(mIdSlot,      mCapacity);
+	mAllocator.FreeArray(mFreeIds,     mCapacity);
+	mAllocator.FreeArray(mScratchA,    mCapacity);
+	mAllocator.FreeArray(mScratchB,    mCapacity);
+	mAllocator.FreeArray(mScratchF32,  mCapacity);
+
+	mDirty.Deinit();
+	mRemoved.Deinit();
+	ForRange(u32, i, mBufferedFrames)
+	{
+		mPendingUpload[i].Deinit();
+	}
+	mAllocator.FreeArray(mPendingUpload, mBufferedFrames);
+
+	*this = transform_system();
+}
+
+u32
+transform_system::SlotOf(transform_id Id) const
+{
+	assert(IsAlive(Id) && "Stale or destroyed transform_id");
+	return mIdSlot[GetIndex(Id)];
+}
+
+bool
+transform_system::IsAlive(transform_id Id) const
+{
+	if (!IsValid(Id)) return false;
+
+	index_type Index = GetIndex(Id);
+	return Index < mCapacity && mIds[Index] == id_type(Id) && !mRemoved.IsSet(mIdSlot[Index]);
+}
+
+transform_id
+transform_system::Create(transform_id Parent, u32 ObjectIndex)
+{
+	assert(mCount < mCapacity && mFreeIdCount > 0 && "transform_system is full");
+
+	u32 IdIndex = mFreeIds[--mFreeIdCount];
+	u32 Slot    = mCount++;
+
+	mPositionX[Slot] = 0.0f;
+	mPositionY[Slot] = 0.0f;
+	mPositionZ[Slot] = 0.0f;
+	mRotationX[Slot] = 0.0f;
+	mRotationY[Slot] = 0.0f;
+	mRotationZ[Slot] = 0.0f;
+	mRotationW[Slot] = 1.0f;
+	mScaleX[Slot]    = 1.0f;
+	mScaleY[Slot]    = 1.0f;
+	mScaleZ[Slot]    = 1.0f;
+	mWorld[Slot]     = f32x44();
+
+	mParent[Slot]      = IsValid(Parent) ? SlotOf(Parent) : cNoParent;
+	mChildCount[Slot]  = 0;
+	mFirstChild[Slot]  = 0;
+	mObjectIndex[Slot] = ObjectIndex;
+	mSlotId[Slot]      = IdIndex;
+	mIdSlot[IdIndex]   = Slot;
+
+	mRemoved.Unset(Slot);
+	mDirty.Set(Slot);
+	mNeedsRebuild = true;
+
+	return transform_id(mIds[IdIndex]);
+}
+
+void
+transform_system::Destroy(transform_id Id)
+{
+	// The descendants are dropped by the rebuild, which only walks down from live nodes.
+	mRemoved.Set(SlotOf(Id));
+	mNeedsRebuild = true;
+}
+
+void
+transform_system::SetParent(transform_id Id, transform_id Parent)
+{
+	u32 Slot       = SlotOf(Id);
+	u32 ParentSlot = IsValid(Parent) ? SlotOf(Parent) : cNoParent;
+
+	for (u32 Ancestor = ParentSlot; Ancestor != cNoParent; Ancestor = mParent[Ancestor])
+	{
+		assert(Ancestor != Slot && "SetParent would create a cycle");
+	}
+
+	mParent[Slot] = ParentSlot;
+	mDirty.Set(Slot);
+	mNeedsRebuild = true;
+}
+
+void
+transform_system::SetLocalPosition(transform_id Id, f32x3 Position)
+{
+	u32 Slot = SlotOf(Id);
+	mPositionX[Slot] = Position.X;
+	mPositionY[Slot] = Position.Y;
+	mPositionZ[Slot] = Position.Z;
+	mDirty.Set(Slot);
+}
+
+void
+transform_system::SetLocalRotation(transform_id Id, quaternion Rotation)
+{
+	u32 Slot = SlotOf(Id);
+	mRotationX[Slot] = Rotation.X;
+	mRotationY[Slot] = Rotation.Y;
+	mRotationZ[Slot] = Rotation.Z;
+	mRotationW[Slot] = Rotation.W;
+	mDirty.Set(Slot);
+}
+
+void
+transform_system::SetLocalScale(transform_id Id, f32x3 Scale)
+{
+	u32 Slot = SlotOf(Id);
+	mScaleX[Slot] = Scale.X;
+	mScaleY[Slot] = Scale.Y;
+	mScaleZ[Slot] = Scale.Z;
+	mDirty.Set(Slot);
+}
+
+void
+transform_system::SetLocal(transform_id Id, f32x3 Position, quaternion Rotation, f32x3 Scale)
+{
+	SetLocalPosition(Id, Position);
+	SetLocalRotation(Id, Rotation);
+	SetLocalScale(Id, Scale);
+}
+
+f32x3
+transform_system::GetLocalPosition(transform_id Id) const
+{
+	u32 Slot = SlotOf(Id);
+	return { mPositionX[Slot], mPositionY[Slot], mPositionZ[Slot] };
+}
+
+quaternion
+transform_system::GetLocalRotation(transform_id Id) const
+{
+	u32 Slot = SlotOf(Id);
+	return quaternion(mRotationX[Slot], mRotationY[Slot], mRotationZ[Slot], mRotationW[Slot]);
+}
+
+f32x3
+transform_system::GetLocalScale(transform_id Id) const
+{
+	u32 Slot = SlotOf(Id);
+	return { mScaleX[Slot], mScaleY[Slot], mScaleZ[Slot] };
+}
+
+const f32x44&
+transform_system::GetWorld(transform_id Id) const
+{
+	return mWorld[SlotOf(Id)];
+}
+
+// Reorders the live nodes breadth first, drops destroyed subtrees and marks everything dirty.
+void
+transform_system::Rebuild()
+{
+	u32* ChildList = mScratchA;
+	u32* Order     = mScratchB; // new slot -> old slot
+
+	// Bucket the children of each node, in slot order. mFirstChild/mChildCount are reused for the
+	// old slot numbering here and recomputed at the end.
+	ForRange(u32, Slot, mCount)
+	{
+		mChildCount[Slot] = 0;
+	}
+	ForRange(u32, Slot, mCount)
+	{
+		if (mParent[Slot] != cNoParent) mChildCount[mParent[Slot]] += 1;
+	}
+
+	u32 Offset = 0;
+	ForRange(u32, Slot, mCount)
+	{
+		Offset           += mChildCount[Slot];
+		mFirstChild[Slot] = Offset; // end of the bucket, the fill below walks it back to the start
+	}
+	for (u32 Slot = mCount; Slot-- > 0;)
+	{
+		if (mParent[Slot] != cNoParent) ChildList[--mFirstChild[mParent[Slot]]] = Slot;
+	}
+
+	// Breadth first walk from the live roots. Destroyed nodes are not visited, and neither are their children.
+	u32 NewCount = 0;
+	ForRange(u32, Slot, mCount)
+	{
+		if (mParent[Slot] == cNoParent && !mRemoved.IsSet(Slot)) Order[NewCount++] = Slot;
+	}
+
+	mLevelCount = 0;
+	u32 Head    = 0;
+	while (Head < NewCount)
+	{
+		mLevelStart[mLevelCount++] = Head;
+
+		u32 LevelEnd = NewCount;
+		for (; Head < LevelEnd; ++Head)
+		{
+			u32 Node = Order[Head];
+			ForRange(u32, i, mChildCount[Node])
+			{
+				u32 Child = ChildList[mFirstChild[Node] + i];
+				if (!mRemoved.IsSet(Child)) Order[NewCount++] = Child;
+			}
+		}
+	}
+	mLevelStart[mLevelCount] = NewCount;
+
+	// ChildList is free again, reuse it as old slot -> new slot. Release the ids of dropped nodes.
+	u32* NewSlot = ChildList;
+	ForRange(u32, Slot, mCount)
+	{
+		NewSlot[Slot] = cNoParent;
+	}
+	ForRange(u32, i, NewCount)
+	{
+		NewSlot[Order[i]] = i;
+	}
+	ForRange(u32, Slot, mCount)
+	{
+		if (NewSlot[Slot] != cNoParent) continue;
+
+		u32 IdIndex = mSlotId[Slot];
+		mIds[IdIndex] = SetGeneration(mIds[IdIndex], generation_type(GetGeneration(mIds[IdIndex]) + 1));
+		mFreeIds[mFreeIdCount++] = IdIndex;
+	}
+
+	// Permute the per-slot arrays. World matrices are not moved since everything is recomputed.
+	auto PermuteF32 = [&](f32* Values) {
+		ForRange(u32, i, NewCount) mScratchF32[i] = Values[Order[i]];
+		memcpy(Values, mScratchF32, NewCount * sizeof(f32));
+	};
+	PermuteF32(mPositionX);
+	PermuteF32(mPositionY);
+	PermuteF32(mPositionZ);
+	PermuteF32(mRotationX);
+	PermuteF32(mRotationY);
+	PermuteF32(mRotationZ);
+	PermuteF32(mRotationW);
+	PermuteF32(mScaleX);
+	PermuteF32(mScaleY);
+	PermuteF32(mScaleZ);
+
+	// mChildCount and mFirstChild are no longer needed as buckets, use them as temporaries.
+	u32* Temp = mChildCount;
+	ForRange(u32, i, NewCount) Temp[i] = (mParent[Order[i]] == cNoParent) ? cNoParent : NewSlot[mParent[Order[i]]];
+	memcpy(mParent, Temp, NewCount * sizeof(u32));
+
+	ForRange(u32, i, NewCount) Temp[i] = mObjectIndex[Order[i]];
+	memcpy(mObjectIndex, Temp, NewCount * sizeof(u32));
+
+	ForRange(u32, i, NewCount) Temp[i] = mSlotId[Order[i]];
+	memcpy(mSlotId, Temp, NewCount * sizeof(u32));
+
+	ForRange(u32, i, NewCount)
+	{
+		mIdSlot[mSlotId[i]] = i;
+		mChildCount[i]      = 0;
+	}
+
+	// Siblings are contiguous, so the first child seen for a parent starts its range.
+	ForRange(u32, i, NewCount)
+	{
+		u32 Parent = mParent[i];
+		if (Parent == cNoParent) continue;
+
+		if (mChildCount[Parent] == 0) mFirstChild[Parent] = i;
+		mChildCount[Parent] += 1;
+	}
+
+	mCount        = NewCount;
+	mNeedsRebuild = false;
+
+	mRemoved.ClearAll();
+	mDirty.ClearAll();
+	mDirty.SetRange(0, mCount);
+	ForRange(u32, i, mBufferedFrames)
+	{
+		mPendingUpload[i].ClearAll();
+	}
+}
+
+// Recomputes the world matrices of the dirty slots [Begin, End) in one level and marks their children dirty.
+void
+transform_system::UpdateRun(u32 Level, u32 Begin, u32 End)
+{
+	for (u32 Slot = Begin; Slot < End; ++Slot)
+	{
+		if (mChildCount[Slot] > 0) mDirty.SetRange(mFirstChild[Slot], mChildCount[Slot]);
+	}
+
+	trs_soa Local = {
+		mPositionX + Begin, mPositionY + Begin, mPositionZ + Begin,
+		mRotationX + Begin, mRotationY + Begin, mRotationZ + Begin, mRotationW + Begin,
+		mScaleX + Begin,    mScaleY + Begin,    mScaleZ + Begin,
+	};
+	ComposeTransformsSoA(Local, mWorld + Begin, sizeof(f32x44), End - Begin);
+
+	if (Level == 0) return; // roots, world == local
+
+	// Siblings share a parent, so each group is one parent matrix times many locals.
+	u32 Slot = Begin;
+	while (Slot < End)
+	{
+		u32 Parent     = mParent[Slot];
+		u32 GroupBegin = Slot;
+		while (Slot < End && mParent[Slot] == Parent) ++Slot;
+
+		F32x44MulBatchRH(mWorld[Parent], mWorld + GroupBegin, mWorld + GroupBegin, Slot - GroupBegin);
+	}
+}
+
+void
+transform_system::Update()
+{
+	if (mNeedsRebuild)
+	{
+		Rebuild();
+	}
+
+	ForRange(u32, Level, mLevelCount)
+	{
+		u32 LevelBegin = mLevelStart[Level];
+		u32 LevelEnd   = mLevelStart[Level + 1];
+
+		u64 RunBegin = mDirty.FindFirstSet(LevelBegin);
+		while (RunBegin < LevelEnd)
+		{
+			u64 RunEnd = mDirty.FindFirstUnset(RunBegin);
+			if (RunEnd > LevelEnd) RunEnd = LevelEnd;
+
+			UpdateRun(Level, u32(RunBegin), u32(RunEnd));
+			RunBegin = mDirty.FindFirstSet(RunEnd);
+		}
+	}
+
+	ForRange(u32, i, mBufferedFrames)
+	{
+		mPendingUpload[i] |= mDirty;
+	}
+	mDirty.ClearAll();
+}
+
+void
+transform_system::WriteWorldMatrices(void* Dst, u64 Stride, u64 FrameIndex)
+{
+	dbitset& Pending = mPendingUpload[FrameIndex % mBufferedFrames];
+
+	u8* Base = (u8*)Dst;
+	for (u64 Slot : Pending.SetBits())
+	{
+		if (mObjectIndex[Slot] == cNoObject) continue;
+		memcpy(Base + mObjectIndex[Slot] * Stride, &mWorld[Slot], sizeof(f32x44));
+	}
+
+	Pending.ClearAll();
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <types.h>
+#include <util/allocator.h>
+#include <util/bit.h>
+#include <util/id.h>
+#include <math/math.h>
+
+DEFINE_TYPE_ID(transform_id);
+
+//
+// transform_system
+//
+// Scene graph of local TRS transforms and their local-to-world matrices.
+//
+// Nodes are stored in breadth-first order: all roots, then all depth 1 nodes, and so on, with the
+// children of a node next to each other. Parents always come before their children, so one
+// front-to-back pass computes every world matrix. Each depth level is a contiguous range with no
+// dependencies inside it, which lets the batch kernels in math.h process it in runs.
+//
+// Setting a local transform marks the node dirty. Update() pushes dirty flags down to the children
+// and recomputes only the dirty world matrices. Clean subtrees are skipped 64 nodes at a time.
+//
+// Structural changes (Create, Destroy, SetParent) are cheap to record. The arrays are re-sorted by
+// the next Update(), and world matrices are only valid after that Update().
+//
+// Usage:
+//     transform_system Transforms = transform_system(Allocator, 1024, gpu_state::cMaxFrameCache);
+//     transform_id     Root       = Transforms.Create(transform_id(cInvalidId), 0);
+//     transform_id     Child      = Transforms.Create(Root, 1);
+//     Transforms.SetLocalPosition(Child, { 1, 0, 0 });
+//
+//     Transforms.Update();
+//     Transforms.WriteWorldMatrices(&MeshData[0].Transforms, sizeof(per_mesh_data), FrameIndex);
+//
+class transform_system
+{
+public:
+	static constexpr u32 cNoObject = U32_MAX;
+
+	transform_system() = default;
+	// BufferedFrames is the number of copies of the upload buffer that WriteWorldMatrices writes into.
+	transform_system(const allocator& Allocator, u32 MaxTransforms, u32 BufferedFrames = 1);
+	void Deinit();
+
+	// ObjectIndex is the element of the upload buffer this node's world matrix is written to, or
+	// cNoObject for nodes that only group other nodes.
+	transform_id Create(transform_id Parent, u32 ObjectIndex = cNoObject);
+	// Destroys the node and all of its descendants. Id is dead immediately, but the descendants are
+	// only found and released by the next Update(): until then they still report IsAlive and can be
+	// used (or moved out of the subtree with SetParent, which keeps them alive).
+	void         Destroy(transform_id Id);
+	// Pass an invalid id to make the node a root. Parent must not be a descendant of Id.
+	void         SetParent(transform_id Id, transform_id Parent);
+
+	bool         IsAlive(transform_id Id) const;
+	u32          Count() const { return mCount; }
+
+	void         SetLocalPosition(transform_id Id, f32x3 Position);
+	void         SetLocalRotation(transform_id Id, quaternion Rotation);
+	void         SetLocalScale(transform_id Id, f32x3 Scale);
+	void         SetLocal(transform_id Id, f32x3 Position, quaternion Rotation, f32x3 Scale);
+
+	f32x3        GetLocalPosition(transform_id Id) const;
+	quaternion   GetLocalRotation(transform_id Id) const;
+	f32x3        GetLocalScale(transform_id Id) const;
+	const f32x44& GetWorld(transform_id Id) const;
+
+	// Re-sorts after structural changes, then recomputes the world matrix of every dirty node.
+	void         Update();
+
+	// Copies the world matrices that changed since the last write to this frame's buffer copy into
+	// Dst + ObjectIndex * Stride. Dst is normally a field of a mapped (write-combined) upload buffer,
+	// so only whole matrices are written and nothing is read back.
+	void         WriteWorldMatrices(void* Dst, u64 Stride, u64 FrameIndex);
+
+private:
+	static constexpr u32 cNoParent = U32_MAX;
+
+	u32  SlotOf(transform_id Id) const;
+	void Rebuild();
+	void UpdateRun(u32 Level, u32 Begin, u32 End);
+
+	allocator mAllocator      = {};
+	u32       mCapacity       = 0;
+	u32       mCount          = 0;
+	u32       mBufferedFrames = 0;
+	bool      mNeedsRebuild   = false;
+
+	// Per slot, in breadth-first order. Local transforms are SoA for the batch compose kernel.
+	f32*      mPositionX      = nullptr;
+	f32*      mPositionY      = nullptr;
+	f32*      mPositionZ      = nullptr;
+	f32*      mRotationX      = nullptr;
+	f32*      mRotationY      = nullptr;
+	f32*      mRotationZ      = nullptr;
+	f32*      mRotationW      = nullptr;
+	f32*      mScaleX         = nullptr;
+	f32*      mScaleY         = nullptr;
+	f32*      mScaleZ         = nullptr;
+	f32x44*   mWorld          = nullptr;
+	u32*      mParent         = nullptr; // slot of the parent, or cNoParent
+	u32*      mFirstChild     = nullptr; // children are the slots [mFirstChild, mFirstChild + mChildCount)
+	u32*      mChildCount     = nullptr;
+	u32*      mObjectIndex    = nullptr;
+	u32*      mSlotId         = nullptr; // id index that owns each slot
+
+	// Level L is the slots [mLevelStart[L], mLevelStart[L + 1])
+	u32*      mLevelStart     = nullptr;
+	u32       mLevelCount     = 0;
+
+	// Id index -> slot. Ids are generational so stale handles are caught.
+	id_type*  mIds            = nullptr; // current id (with generation) of each id index
+	u32*      mIdSlot         = nullptr;
+	u32*      mFreeIds        = nullptr;
+	u32       mFreeIdCount    = 0;
+
+	dbitset   mDirty          = {};      // local changed, or a parent's world changed
+	dbitset   mRemoved        = {};      // destroyed, released by the next rebuild
+	dbitset*  mPendingUpload  = nullptr; // one per buffered frame, world changed since that copy was written
+
+	// Rebuild scratch
+	u32*      mScratchA       = nullptr;
+	u32*      mScratchB       = nullptr;
+	f32*      mScratchF32     = nullptr;
+};
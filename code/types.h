@@ -87,11 +87,12 @@ union u128
 #define _256MB _MB(256)
 #define _1GB   _GB(1)
 
-// A hack to determine if platform is little endian
-// TODO(enlynn): Do something that isn't so hacky.
-#define LITTLE_ENDIAN 0x41424344UL 
-#define ENDIAN_ORDER  ('ABCD') 
-#define IS_LITTLE_ENDIAN (ENDIAN_ORDER==LITTLE_ENDIAN)
+// GCC and Clang report the byte order, MSVC only targets little endian platforms.
+#if defined(__BYTE_ORDER__)
+# define IS_LITTLE_ENDIAN (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#else
+# define IS_LITTLE_ENDIAN 1
+#endif
 
 #define ForwardAlign(Base, Alignment) (((u64)(Base) + (u64)(Alignment) - 1) & ~((u64)(Alignment) - 1))
 // I doubt this is the most efficient way of doing things, but it is easy to understand and does not run the risk of an underflow
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <new> //placement new
+#include <utility> // std::forward
+#include <type_traits>
 
 #include <types.h>
 
@@ -127,9 +129,13 @@ public:
 
 	template<class T> void Free(T* Ptr, allocation_strategy Strategy = allocation_strategy::none)
 	{
-		if (Strategy == allocation_strategy::deconstruct)
+		// void* is common for untyped chunks (AllocChunk), it has no destructor to call.
+		if constexpr (!std::is_void_v<T>)
 		{
-			Ptr->~T();
+			if (Strategy == allocation_strategy::deconstruct)
+			{
+				Ptr->~T();
+			}
 		}
 
 		mInterface.Free(mInterface.Self, (void*)Ptr);
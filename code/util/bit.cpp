@@ -0,0 +1,394 @@
+#include "bit.h"
+#include "simd.h"
+
+//
+// Bit Arrays
+//
+
+// Applies Op to 256 bits (AVX2) or 128 bits (SSE2) per iteration, then finishes the tail one word at a time.
+#if SIMD_AVX2
+# define BIT_ARRAY_BINARY_OP(Dst, Src, WordCount, SimdOp, ScalarExpr)                    \
+    u64 i = 0;                                                                         \
+    for (; i + 4 <= WordCount; i += 4)                                                 \
+    {                                                                                  \
+        __m256i A = _mm256_loadu_si256((const __m256i*)(Dst + i));                     \
+        __m256i B = _mm256_loadu_si256((const __m256i*)(Src + i));                     \
+        _mm256_storeu_si256((__m256i*)(Dst + i), SimdOp##256(A, B));                   \
+    }                                                                                  \
+    for (; i < WordCount; ++i) { Dst[i] = ScalarExpr; }
+# define BitAnd256(A, B)    _mm256_and_si256(A, B)
+# define BitOr256(A, B)     _mm256_or_si256(A, B)
+# define BitXor256(A, B)    _mm256_xor_si256(A, B)
+# define BitAndNot256(A, B) _mm256_andnot_si256(B, A)
+#elif SIMD_SSE2
+# define BIT_ARRAY_BINARY_OP(Dst, Src, WordCount, SimdOp, ScalarExpr)                    \
+    u64 i = 0;                                                                         \
+    for (; i + 2 <= WordCount; i += 2)                                                 \
+    {                                                                                  \
+        __m128i A = _mm_loadu_si128((const __m128i*)(Dst + i));                        \
+        __m128i B = _mm_loadu_si128((const __m128i*)(Src + i));                        \
+        _mm_storeu_si128((__m128i*)(Dst + i), SimdOp##128(A, B));                      \
+    }                                                                                  \
+    for (; i < WordCount; ++i) { Dst[i] = ScalarExpr; }
+# define BitAnd128(A, B)    _mm_and_si128(A, B)
+# define BitOr128(A, B)     _mm_or_si128(A, B)
+# define BitXor128(A, B)    _mm_xor_si128(A, B)
+# define BitAndNot128(A, B) _mm_andnot_si128(B, A)
+#else
+# define BIT_ARRAY_BINARY_OP(Dst, Src, WordCount, SimdOp, ScalarExpr)                    \
+    ForRange(u64, i, WordCount) { Dst[i] = ScalarExpr; }
+#endif
+
+void
+BitArrayAnd(u64* Dst, const u64* Src, u64 WordCount)
+{
+    BIT_ARRAY_BINARY_OP(Dst, Src, WordCount, BitAnd, Dst[i] & Src[i]);
+}
+
+void
+BitArrayOr(u64* Dst, const u64* Src, u64 WordCount)
+{
+    BIT_ARRAY_BINARY_OP(Dst, Src, WordCount, BitOr, Dst[i] | Src[i]);
+}
+
+void
+BitArrayXor(u64* Dst, const u64* Src, u64 WordCount)
+{
+    BIT_ARRAY_BINARY_OP(Dst, Src, WordCount, BitXor, Dst[i] ^ Src[i]);
+}
+
+void
+BitArrayAndNot(u64* Dst, const u64* Src, u64 WordCount)
+{
+    BIT_ARRAY_BINARY_OP(Dst, Src, WordCount, BitAndNot, Dst[i] & ~Src[i]);
+}
+
+u64
+BitArrayCount(const u64* Words, u64 WordCount)
+{
+    // Four independent accumulators so the popcnt instructions are not serialized on one register.
+    u64 Counts[4] = {};
+    u64 i         = 0;
+    for (; i + 4 <= WordCount; i += 4)
+    {
+        Counts[0] += BitCountSet64(Words[i + 0]);
+        Counts[1] += BitCountSet64(Words[i + 1]);
+        Counts[2] += BitCountSet64(Words[i + 2]);
+        Counts[3] += BitCountSet64(Words[i + 3]);
+    }
+    for (; i < WordCount; ++i)
+    {
+        Counts[0] += BitCountSet64(Words[i]);
+    }
+    return Counts[0] + Counts[1] + Counts[2] + Counts[3];
+}
+
+// Finds the first word at or after WordIndex that is not equal to Skip (0 for set bit searches,
+// ~0 for unset bit searches). Returns WordCount if every word matches.
+fn_internal u64
+BitArraySkipWords(const u64* Words, u64 WordCount, u64 WordIndex, u64 Skip)
+{
+#if SIMD_SSE2
+    const __m128i SkipValue = _mm_set1_epi64x(s64(Skip));
+    for (; WordIndex + 2 <= WordCount; WordIndex += 2)
+    {
+        __m128i Block = _mm_loadu_si128((const __m128i*)(Words + WordIndex));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(Block, SkipValue)) != 0xFFFF) break;
+    }
+#endif
+
+    while (WordIndex < WordCount && Words[WordIndex] == Skip)
+    {
+        WordIndex += 1;
+    }
+    return WordIndex;
+}
+
+u64
+BitArrayFindFirstSet(const u64* Words, u64 BitCount, u64 StartBit)
+{
+    if (StartBit >= BitCount) return cBitNotFound;
+
+    const u64 WordCount = BitWordCount(BitCount);
+
+    u64 WordIndex = StartBit / 64;
+    u64 Word      = Words[WordIndex] & (~u64(0) << (StartBit % 64));
+    if (Word == 0)
+    {
+        WordIndex = BitArraySkipWords(Words, WordCount, WordIndex + 1, 0);
+        if (WordIndex == WordCount) return cBitNotFound;
+        Word = Words[WordIndex];
+    }
+
+    u64 Result = WordIndex * 64 + BitFindFirstSet64(Word);
+    return (Result < BitCount) ? Result : cBitNotFound;
+}
+
+u64
+BitArrayFindFirstUnset(const u64* Words, u64 BitCount, u64 StartBit)
+{
+    if (StartBit >= BitCount) return cBitNotFound;
+
+    const u64 WordCount = BitWordCount(BitCount);
+
+    u64 WordIndex = StartBit / 64;
+    u64 Word      = ~Words[WordIndex] & (~u64(0) << (StartBit % 64));
+    if (Word == 0)
+    {
+        WordIndex = BitArraySkipWords(Words, WordCount, WordIndex + 1, ~u64(0));
+        if (WordIndex == WordCount) return cBitNotFound;
+        Word = ~Words[WordIndex];
+    }
+
+    // The unused bits past BitCount in the last word are always clear, so cap the result.
+    u64 Result = WordIndex * 64 + BitFindFirstSet64(Word);
+    return (Result < BitCount) ? Result : cBitNotFound;
+}
+
+u64
+BitArrayFindZeroRun(const u64* Words, u64 BitCount, u64 RunLength, u64 StartBit)
+{
+    assert(RunLength > 0);
+
+    // Alternate between jumping to the next unset bit and the next set bit. Each jump is a
+    // word-level scan, so long runs of either kind are skipped 64 (or 128) bits at a time.
+    u64 RunStart = BitArrayFindFirstUnset(Words, BitCount, StartBit);
+    while (RunStart != cBitNotFound)
+    {
+        if (RunStart + RunLength > BitCount) return cBitNotFound;
+
+        u64 RunEnd = BitArrayFindFirstSet(Words, BitCount, RunStart);
+        if (RunEnd == cBitNotFound) RunEnd = BitCount;
+
+        if (RunEnd - RunStart >= RunLength) return RunStart;
+
+        RunStart = BitArrayFindFirstUnset(Words, BitCount, RunEnd);
+    }
+    return cBitNotFound;
+}
+
+//
+// dbitset
+//
+
+dbitset::dbitset(const allocator& Allocator, u64 BitCount)
+    : mAllocator(Allocator)
+    , mBitCount(BitCount)
+    , mWordCount(BitWordCount(BitCount))
+{
+    mWords = mAllocator.AllocArray<u64>(mWordCount, allocation_strategy::zero);
+}
+
+void
+dbitset::Deinit()
+{
+    if (mWords)
+    {
+        mAllocator.FreeArray(mWords, mWordCount);
+    }
+
+    mWords     = nullptr;
+    mBitCount  = 0;
+    mWordCount = 0;
+}
+
+// Sets (or clears) the bits [Begin, Begin + Count) with whole-word writes for the interior.
+fn_internal void
+BitArrayFillRange(u64* Words, u64 Begin, u64 Count, bool Value)
+{
+    if (Count == 0) return;
+
+    u64 End       = Begin + Count;
+    u64 FirstWord = Begin / 64;
+    u64 LastWord  = (End - 1) / 64;
+
+    u64 FirstMask = ~u64(0) << (Begin % 64);
+    u64 LastMask  = ~u64(0) >> (63 - ((End - 1) % 64));
+
+    if (FirstWord == LastWord)
+    {
+        u64 Mask = FirstMask & LastMask;
+        Words[FirstWord] = Value ? (Words[FirstWord] | Mask) : (Words[FirstWord] & ~Mask);
+        return;
+    }
+
+    Words[FirstWord] = Value ? (Words[FirstWord] | FirstMask) : (Words[FirstWord] & ~FirstMask);
+    for (u64 WordIndex = FirstWord + 1; WordIndex < LastWord; ++WordIndex)
+    {
+        Words[WordIndex] = Value ? ~u64(0) : 0;
+    }
+    Words[LastWord] = Value ? (Words[LastWord] | LastMask) : (Words[LastWord] & ~LastMask);
+}
+
+void
+dbitset::SetRange(u64 Begin, u64 Count)
+{
+    assert(Begin + Count <= mBitCount);
+    BitArrayFillRange(mWords, Begin, Count, true);
+}
+
+void
+dbitset::UnsetRange(u64 Begin, u64 Count)
+{
+    assert(Begin + Count <= mBitCount);
+    BitArrayFillRange(mWords, Begin, Count, false);
+}
+
+void
+dbitset::SetAll()
+{
+    // Keep the bits past mBitCount clear so Count() and the searches do not see them.
+    BitArrayFillRange(mWords, 0, mBitCount, true);
+}
+
+void
+dbitset::ClearAll()
+{
+    if (mWords)
+    {
+        mAllocator.ZeroMemoryBlock(mWords, mWordCount * sizeof(u64));
+    }
+}
+
+u64
+dbitset::Count() const
+{
+    return BitArrayCount(mWords, mWordCount);
+}
+
+bool
+dbitset::Any() const
+{
+    return BitArraySkipWords(mWords, mWordCount, 0, 0) != mWordCount;
+}
+
+//
+// hbitset
+//
+
+hbitset::hbitset(const allocator& Allocator, u64 BitCount)
+    : mAllocator(Allocator)
+    , mBitCount(BitCount)
+    , mWordCount(BitWordCount(BitCount))
+    , mSummaryCount(BitWordCount(BitWordCount(BitCount)))
+{
+    // Single allocation: [Words][NonEmpty summary][NotFull summary]
+    mWords    = mAllocator.AllocArray<u64>(mWordCount + 2 * mSummaryCount, allocation_strategy::zero);
+    mNonEmpty = mWords + mWordCount;
+    mNotFull  = mNonEmpty + mSummaryCount;
+
+    // Every word starts with free bits.
+    BitArrayFillRange(mNotFull, 0, mWordCount, true);
+}
+
+void
+hbitset::Deinit()
+{
+    if (mWords)
+    {
+        mAllocator.FreeArray(mWords, mWordCount + 2 * mSummaryCount);
+    }
+
+    mWords        = nullptr;
+    mNonEmpty     = nullptr;
+    mNotFull      = nullptr;
+    mBitCount     = 0;
+    mWordCount    = 0;
+    mSummaryCount = 0;
+}
+
+void
+hbitset::UpdateSummary(u64 WordIndex)
+{
+    u64 Word        = mWords[WordIndex];
+    u64 SummaryBit  = BitMaskU64(WordIndex % 64);
+    u64 SummaryWord = WordIndex / 64;
+
+    // The last word may be partially used, it is full once every valid bit is set.
+    u64 FullMask = ~u64(0);
+    if (WordIndex == mWordCount - 1 && (mBitCount % 64) != 0)
+    {
+        FullMask = BitMaskU64(mBitCount % 64) - 1;
+    }
+
+    if (Word != 0)        mNonEmpty[SummaryWord] |=  SummaryBit;
+    else                  mNonEmpty[SummaryWord] &= ~SummaryBit;
+
+    if (Word != FullMask) mNotFull[SummaryWord]  |=  SummaryBit;
+    else                  mNotFull[SummaryWord]  &= ~SummaryBit;
+}
+
+void
+hbitset::Set(u64 Index)
+{
+    assert(Index < mBitCount);
+    mWords[Index / 64] |= BitMaskU64(Index % 64);
+    UpdateSummary(Index / 64);
+}
+
+void
+hbitset::Unset(u64 Index)
+{
+    assert(Index < mBitCount);
+    mWords[Index / 64] &= ~BitMaskU64(Index % 64);
+    UpdateSummary(Index / 64);
+}
+
+void
+hbitset::ClearAll()
+{
+    if (!mWords) return;
+
+    mAllocator.ZeroMemoryBlock(mWords, (mWordCount + mSummaryCount) * sizeof(u64));
+    BitArrayFillRange(mNotFull, 0, mWordCount, true);
+}
+
+u64
+hbitset::Count() const
+{
+    return BitArrayCount(mWords, mWordCount);
+}
+
+bool
+hbitset::Any() const
+{
+    return BitArraySkipWords(mNonEmpty, mSummaryCount, 0, 0) != mSummaryCount;
+}
+
+u64
+hbitset::FindFirstSet(u64 Start) const
+{
+    if (Start >= mBitCount) return cBitNotFound;
+
+    // Check the remainder of the starting word, then let the summary find the next non-empty word.
+    u64 WordIndex = Start / 64;
+    u64 Word      = mWords[WordIndex] & (~u64(0) << (Start % 64));
+    if (Word != 0)
+    {
+        return WordIndex * 64 + BitFindFirstSet64(Word);
+    }
+
+    WordIndex = BitArrayFindFirstSet(mNonEmpty, mWordCount, WordIndex + 1);
+    if (WordIndex == cBitNotFound) return cBitNotFound;
+
+    return WordIndex * 64 + BitFindFirstSet64(mWords[WordIndex]);
+}
+
+u64
+hbitset::FindFirstUnset(u64 Start) const
+{
+    if (Start >= mBitCount) return cBitNotFound;
+
+    u64 WordIndex = Start / 64;
+    u64 Word      = ~mWords[WordIndex] & (~u64(0) << (Start % 64));
+    if (Word == 0)
+    {
+        WordIndex = BitArrayFindFirstSet(mNotFull, mWordCount, WordIndex + 1);
+        if (WordIndex == cBitNotFound) return cBitNotFound;
+
+        Word = ~mWords[WordIndex];
+    }
+
+    u64 Result = WordIndex * 64 + BitFindFirstSet64(Word);
+    return (Result < mBitCount) ? Result : cBitNotFound;
+}
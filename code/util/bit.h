@@ -1,6 +1,11 @@
 #pragma once
 
 #include <types.h>
+#include "allocator.h"
+
+#if defined(_MSC_VER)
+# include <intrin.h>
+#endif
 
 #define BitMaskU8(BitIndex)  ((u8) ((u8) 1 << (BitIndex)))
 #define BitMaskU16(BitIndex) ((u16)((u16)1 << (BitIndex)))
@@ -42,6 +47,148 @@ template<>           constexpr u16 IsBitSet(u16 Value, u16 BitIndex) { assert(Bi
 template<>           constexpr u32 IsBitSet(u32 Value, u32 BitIndex) { assert(BitIndex < 32); return ((Value >> BitIndex) & ((u32)1)) != 0; }
 template<>           constexpr u64 IsBitSet(u64 Value, u64 BitIndex) { assert(BitIndex < 64); return ((Value >> BitIndex) & ((u64)1)) != 0; }
 
+// Portable bit-scan and population count. The Find functions require a non-zero Value.
+fn_inline u32 BitCountSet32(u32 Value)
+{
+#if defined(_MSC_VER)
+    return __popcnt(Value);
+#else
+    return u32(__builtin_popcount(Value));
+#endif
+}
+
+fn_inline u32 BitCountSet64(u64 Value)
+{
+#if defined(_MSC_VER)
+    return u32(__popcnt64(Value));
+#else
+    return u32(__builtin_popcountll(Value));
+#endif
+}
+
+fn_inline u32 BitFindFirstSet32(u32 Value)
+{
+    assert(Value != 0);
+#if defined(_MSC_VER)
+    unsigned long Index;
+    _BitScanForward(&Index, Value);
+    return u32(Index);
+#else
+    return u32(__builtin_ctz(Value));
+#endif
+}
+
+fn_inline u32 BitFindFirstSet64(u64 Value)
+{
+    assert(Value != 0);
+#if defined(_MSC_VER)
+    unsigned long Index;
+    _BitScanForward64(&Index, Value);
+    return u32(Index);
+#else
+    return u32(__builtin_ctzll(Value));
+#endif
+}
+
+fn_inline u32 BitFindLastSet64(u64 Value)
+{
+    assert(Value != 0);
+#if defined(_MSC_VER)
+    unsigned long Index;
+    _BitScanReverse64(&Index, Value);
+    return u32(Index);
+#else
+    return u32(63 - __builtin_clzll(Value));
+#endif
+}
+
+// Clears the lowest set bit. Pairs with BitFindFirstSet to walk the set bits of a mask:
+//     while (Mask) { u32 Index = BitFindFirstSet64(Mask); ...; Mask = BitClearLowest(Mask); }
+template<typename T> constexpr T BitClearLowest(T Value) { return Value & (Value - 1); }
+
+// Calls Func(Index) for every set bit, lowest first.
+template<typename Fn>
+fn_inline void BitForEachSet64(u64 Mask, Fn&& Func)
+{
+    while (Mask)
+    {
+        Func(BitFindFirstSet64(Mask));
+        Mask = BitClearLowest(Mask);
+    }
+}
+
+//
+// Bit Arrays
+//
+// Operations over arrays of u64 words, shared by bitset, dbitset and hbitset. Bit i lives in
+// Words[i / 64] at bit (i % 64). The bulk logical ops are vectorized (SSE2, or AVX2 if enabled).
+//
+
+constexpr u64 cBitNotFound = U64_MAX;
+
+constexpr u64 BitWordCount(u64 BitCount) { return DivideCeil(BitCount, u64(64)); }
+
+void BitArrayAnd(u64* Dst, const u64* Src, u64 WordCount);     // Dst &= Src
+void BitArrayOr(u64* Dst, const u64* Src, u64 WordCount);      // Dst |= Src
+void BitArrayXor(u64* Dst, const u64* Src, u64 WordCount);     // Dst ^= Src
+void BitArrayAndNot(u64* Dst, const u64* Src, u64 WordCount);  // Dst &= ~Src
+u64  BitArrayCount(const u64* Words, u64 WordCount);
+
+// Searches return cBitNotFound when nothing matches in [StartBit, BitCount)
+u64  BitArrayFindFirstSet(const u64* Words, u64 BitCount, u64 StartBit);
+u64  BitArrayFindFirstUnset(const u64* Words, u64 BitCount, u64 StartBit);
+// First index of RunLength consecutive unset bits, useful for finding free slot ranges
+u64  BitArrayFindZeroRun(const u64* Words, u64 BitCount, u64 RunLength, u64 StartBit);
+
+// Forward iterator over the set bits of a bit array. Used with range-for:
+//     for (u64 Index : Bits.SetBits()) { ... }
+class set_bit_iterator
+{
+public:
+    set_bit_iterator(const u64* Words, u64 WordCount, u64 WordIndex)
+        : mWords(Words), mWordCount(WordCount), mWordIndex(WordIndex)
+    {
+        mCurrent = (mWordIndex < mWordCount) ? mWords[mWordIndex] : 0;
+        SkipEmptyWords();
+    }
+
+    u64 operator*() const { return mWordIndex * 64 + BitFindFirstSet64(mCurrent); }
+
+    set_bit_iterator& operator++()
+    {
+        mCurrent = BitClearLowest(mCurrent);
+        SkipEmptyWords();
+        return *this;
+    }
+
+    bool operator!=(const set_bit_iterator& Other) const { return mWordIndex != Other.mWordIndex || mCurrent != Other.mCurrent; }
+
+private:
+    void SkipEmptyWords()
+    {
+        while (mCurrent == 0 && mWordIndex < mWordCount)
+        {
+            mWordIndex += 1;
+            mCurrent    = (mWordIndex < mWordCount) ? mWords[mWordIndex] : 0;
+        }
+    }
+
+    const u64* mWords     = nullptr;
+    u64        mWordCount = 0;
+    u64        mWordIndex = 0;
+    u64        mCurrent   = 0;
+};
+
+struct set_bit_range
+{
+    const u64* mWords     = nullptr;
+    u64        mWordCount = 0;
+
+    set_bit_iterator begin() const { return set_bit_iterator(mWords, mWordCount, 0);          }
+    set_bit_iterator end()   const { return set_bit_iterator(mWords, mWordCount, mWordCount); }
+};
+
+// Fixed size bitset, indexed by an enum (or any integer type).
 template<typename T, u32 MaxEnumValue = 64>
 class bitset
 {
@@ -53,12 +200,12 @@ public:
 	{
 		u64 EnumValue = (u64)Enum;
 
-		u64 Index = EnumValue / sizeof(mBits[0]);
-		u64 Bit   = EnumValue % sizeof(mBits[0]);
+		u64 Index = EnumValue / 64;
+		u64 Bit   = EnumValue % 64;
 
 		assert(Index < ArrayCount(mBits));
 
-		mBits[Index] = BitSet(mBits[Index], Index);
+		mBits[Index] = BitSet(mBits[Index], Bit);
 
 		return *this;
 	}
@@ -67,28 +214,174 @@ public:
 	{
 		u64 EnumValue = (u64)Enum;
 
-		u64 Index = EnumValue / sizeof(mBits[0]);
-		u64 Bit   = EnumValue % sizeof(mBits[0]);
+		u64 Index = EnumValue / 64;
+		u64 Bit   = EnumValue % 64;
 
 		assert(Index < ArrayCount(mBits));
 
-		mBits[Index] = BitClear(mBits[Index], Index);
+		mBits[Index] = BitClear(mBits[Index], Bit);
 
 		return *this;
 	}
 
-	constexpr bool IsSet(T Enum)
+	constexpr bool IsSet(T Enum) const
 	{
 		u64 EnumValue = (u64)Enum;
 
-		u64 Index = EnumValue / sizeof(mBits[0]);
-		u64 Bit   = EnumValue % sizeof(mBits[0]);
+		u64 Index = EnumValue / 64;
+		u64 Bit   = EnumValue % 64;
 
 		assert(Index < ArrayCount(mBits));
 
-		return IsBitSet(mBits[Index], Index);
+		return IsBitSet(mBits[Index], Bit);
 	}
 
+	constexpr void Reset()                     { ForRange(u32, i, cWordCount) mBits[i] = 0; }
+
+	bool          Any()                  const { ForRange(u32, i, cWordCount) if (mBits[i]) return true; return false; }
+	u64           Count()                const { return BitArrayCount(mBits, cWordCount); }
+	set_bit_range SetBits()              const { return { mBits, cWordCount }; }
+
+	bitset& operator&=(const bitset& Other)    { BitArrayAnd(mBits, Other.mBits, cWordCount); return *this; }
+	bitset& operator|=(const bitset& Other)    { BitArrayOr(mBits,  Other.mBits, cWordCount); return *this; }
+	bitset& AndNot(const bitset& Other)        { BitArrayAndNot(mBits, Other.mBits, cWordCount); return *this; }
+
 private:
-	u64 mBits[DivideCeil(MaxEnumValue, 64u)] = {};
-};
\ No newline at end of file
+	static constexpr u32 cWordCount = DivideCeil(MaxEnumValue, 64u);
+	u64 mBits[cWordCount] = {};
+};
+
+//
+// dbitset
+//
+// Runtime sized bitset that owns its memory. Like darray, copies are shallow and
+// Deinit must be called to free the memory.
+//
+class dbitset
+{
+public:
+    dbitset() = default;
+    dbitset(const allocator& Allocator, u64 BitCount);
+    void Deinit();
+
+    u64  Length() const { return mBitCount; }
+
+    void Set(u64 Index)         { assert(Index < mBitCount); mWords[Index / 64] |=  BitMaskU64(Index % 64); }
+    void Unset(u64 Index)       { assert(Index < mBitCount); mWords[Index / 64] &= ~BitMaskU64(Index % 64); }
+    void Toggle(u64 Index)      { assert(Index < mBitCount); mWords[Index / 64] ^=  BitMaskU64(Index % 64); }
+    bool IsSet(u64 Index) const { assert(Index < mBitCount); return (mWords[Index / 64] >> (Index % 64)) & 1; }
+
+    void SetRange(u64 Begin, u64 Count);
+    void UnsetRange(u64 Begin, u64 Count);
+    void SetAll();
+    void ClearAll();
+
+    u64  Count() const;
+    bool Any()   const;
+
+    // Whole-set operations, both sets must be the same length.
+    dbitset& operator&=(const dbitset& Other) { assert(Other.mBitCount == mBitCount); BitArrayAnd(mWords, Other.mWords, mWordCount);    return *this; }
+    dbitset& operator|=(const dbitset& Other) { assert(Other.mBitCount == mBitCount); BitArrayOr(mWords, Other.mWords, mWordCount);     return *this; }
+    dbitset& operator^=(const dbitset& Other) { assert(Other.mBitCount == mBitCount); BitArrayXor(mWords, Other.mWords, mWordCount);    return *this; }
+    dbitset& AndNot(const dbitset& Other)     { assert(Other.mBitCount == mBitCount); BitArrayAndNot(mWords, Other.mWords, mWordCount); return *this; }
+
+    u64 FindFirstSet(u64 Start = 0)                   const { return BitArrayFindFirstSet(mWords, mBitCount, Start);              }
+    u64 FindFirstUnset(u64 Start = 0)                 const { return BitArrayFindFirstUnset(mWords, mBitCount, Start);            }
+    u64 FindZeroRun(u64 RunLength, u64 Start = 0)     const { return BitArrayFindZeroRun(mWords, mBitCount, RunLength, Start);    }
+
+    set_bit_range SetBits() const { return { mWords, mWordCount }; }
+
+    const u64* Words()     const { return mWords;     }
+    u64        WordCount() const { return mWordCount; }
+
+private:
+    allocator mAllocator = {};
+    u64*      mWords     = nullptr;
+    u64       mBitCount  = 0;
+    u64       mWordCount = 0;
+};
+
+//
+// hbitset
+//
+// Two level hierarchical bitset for sparse dirty tracking and free-slot searches over large ranges.
+// Alongside the bits, two summary levels are kept with one bit per 64-bit word:
+// - NonEmpty: the word has at least one bit set. Iteration and FindFirstSet skip 4096 clear bits per summary word.
+// - NotFull:  the word has at least one bit clear. FindFirstUnset skips 4096 set bits per summary word.
+//
+class hbitset
+{
+public:
+    hbitset() = default;
+    hbitset(const allocator& Allocator, u64 BitCount);
+    void Deinit();
+
+    u64  Length() const { return mBitCount; }
+
+    void Set(u64 Index);
+    void Unset(u64 Index);
+    bool IsSet(u64 Index) const { assert(Index < mBitCount); return (mWords[Index / 64] >> (Index % 64)) & 1; }
+    void ClearAll();
+
+    u64  Count() const;
+    bool Any()   const;
+
+    u64  FindFirstSet(u64 Start = 0)   const;
+    u64  FindFirstUnset(u64 Start = 0) const;
+
+    // Calls Func(Index) for every set bit, only touching words flagged in the summary.
+    template<typename Fn>
+    void ForEachSet(Fn&& Func) const
+    {
+        ForRange(u64, SummaryIndex, mSummaryCount)
+        {
+            u64 Summary = mNonEmpty[SummaryIndex];
+            while (Summary)
+            {
+                u64 WordIndex = SummaryIndex * 64 + BitFindFirstSet64(Summary);
+                u64 Word      = mWords[WordIndex];
+                while (Word)
+                {
+                    Func(WordIndex * 64 + BitFindFirstSet64(Word));
+                    Word = BitClearLowest(Word);
+                }
+                Summary = BitClearLowest(Summary);
+            }
+        }
+    }
+
+    // Same as ForEachSet, but clears the bits as they are visited (consume dirty bits).
+    template<typename Fn>
+    void ConsumeEachSet(Fn&& Func)
+    {
+        ForRange(u64, SummaryIndex, mSummaryCount)
+        {
+            u64 Summary = mNonEmpty[SummaryIndex];
+            while (Summary)
+            {
+                u64 WordIndex = SummaryIndex * 64 + BitFindFirstSet64(Summary);
+                u64 Word      = mWords[WordIndex];
+                while (Word)
+                {
+                    Func(WordIndex * 64 + BitFindFirstSet64(Word));
+                    Word = BitClearLowest(Word);
+                }
+                mWords[WordIndex] = 0;
+                mNotFull[WordIndex / 64] |= BitMaskU64(WordIndex % 64);
+                Summary = BitClearLowest(Summary);
+            }
+            mNonEmpty[SummaryIndex] = 0;
+        }
+    }
+
+private:
+    void UpdateSummary(u64 WordIndex);
+
+    allocator mAllocator    = {};
+    u64*      mWords        = nullptr;
+    u64*      mNonEmpty     = nullptr;
+    u64*      mNotFull      = nullptr;
+    u64       mBitCount     = 0;
+    u64       mWordCount    = 0;
+    u64       mSummaryCount = 0;
+};
@@ -33,10 +33,10 @@
 
 using id_type = u32;
 
-constexpr u64 cU64InvalidId  = 0xffff'ffff'ffff'ffffui64;
-constexpr u32 cU32InvalidId  = 0xffff'ffffui32;
-constexpr u16 cU16InvalidId  = 0xffffui16;
-constexpr u8  cU8InvalidId   = 0xffui8;
+constexpr u64 cU64InvalidId  = U64_MAX;
+constexpr u32 cU32InvalidId  = U32_MAX;
+constexpr u16 cU16InvalidId  = U16_MAX;
+constexpr u8  cU8InvalidId   = U8_MAX;
 
 constexpr id_type cIdMask     = static_cast<id_type>(-1);
 constexpr id_type cInvalidId  = cIdMask;
@@ -0,0 +1,417 @@
+#include "job_system.h"
+
+// Index of the calling thread in the job system it runs jobs for. U32_MAX for other threads.
+var_global thread_local u32 tThreadIndex = U32_MAX;
+
+// Failed steal rounds before an idle worker goes to sleep. Jobs are usually queued in bursts, so
+// spinning briefly avoids a sleep/wake round trip between the jobs of a frame.
+var_global constexpr u32 cIdleSpinCount = 64;
+
+//
+// Chase-Lev work-stealing deque
+//
+// "Correct and Efficient Work-Stealing for Weak Memory Models", Le et al. 2013. Fixed capacity, so the
+// buffer never has to grow. The owner pushes and pops at the bottom, thieves take from the top.
+//
+
+struct job_deque
+{
+    // Thieves write Top and the owner writes Bottom, keep them on separate cache lines. (Padding rather
+    // than alignas, the deques live in allocator memory.)
+    std::atomic<s64>   Top    = 0;
+    u8                 Pad[56];
+    std::atomic<s64>   Bottom = 0;
+    std::atomic<job*>* Buffer = nullptr;
+
+    static constexpr s64 cMask = job_system::cMaxJobsPerThread - 1;
+    static_assert((job_system::cMaxJobsPerThread & cMask) == 0, "Deque capacity must be a power of 2");
+
+    void Push(job* Job)
+    {
+        s64 B = Bottom.load(std::memory_order_relaxed);
+        [[maybe_unused]] s64 T = Top.load(std::memory_order_acquire);
+        assert(B - T < s64(job_system::cMaxJobsPerThread) && "Too many jobs queued on one thread");
+
+        // A release store rather than the paper's release fence: same code on x86/ARM64, and the
+        // thread sanitizer understands it.
+        Buffer[B & cMask].store(Job, std::memory_order_relaxed);
+        Bottom.store(B + 1, std::memory_order_release);
+    }
+
+    job* Pop()
+    {
+        s64 B = Bottom.load(std::memory_order_relaxed) - 1;
+        Bottom.store(B, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        s64 T = Top.load(std::memory_order_relaxed);
+
+        job* Result = nullptr;
+        if (T <= B)
+        {
+            Result = Buffer[B & cMask].load(std::memory_order_relaxed);
+            if (T == B)
+            { // Last job, race the thieves for it
+                if (!Top.compare_exchange_strong(T, T + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                {
+                    Result = nullptr;
+                }
+                Bottom.store(B + 1, std::memory_order_relaxed);
+            }
+        }
+        else
+        { // Empty
+            Bottom.store(B + 1, std::memory_order_relaxed);
+        }
+
+        return Result;
+    }
+
+    job* Steal()
+    {
+        s64 T = Top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        s64 B = Bottom.load(std::memory_order_acquire);
+
+        job* Result = nullptr;
+        if (T < B)
+        {
+            Result = Buffer[T & cMask].load(std::memory_order_relaxed);
+            if (!Top.compare_exchange_strong(T, T + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            { // Lost the race to another thief or the owner
+                Result = nullptr;
+            }
+        }
+
+        return Result;
+    }
+};
+
+struct job_system::thread_state
+{
+    job_deque   Deque    = {};
+    // Queued jobs are copied here, the deque holds pointers. Slots are reused round robin, which is safe
+    // as long as a thread never has more than cMaxJobsPerThread jobs in flight.
+    job*        Jobs     = nullptr;
+    u32         NextJob  = 0;
+    u32         Random   = 0; // xorshift state for picking steal victims
+
+    job_system* System   = nullptr;
+    u32         Index    = 0;
+};
+
+fn_internal u32
+XorShift32(u32* State)
+{
+    u32 X = *State;
+    X ^= X << 13;
+    X ^= X >> 17;
+    X ^= X << 5;
+    *State = X;
+    return X;
+}
+
+job_system::job_system(const allocator& Allocator, u32 WorkerCount)
+{
+    assert(tThreadIndex == U32_MAX && "Only one job system per thread");
+
+    if (WorkerCount == 0)
+    {
+        u32 HardwareThreads = PlatformGetLogicalProcessorCount();
+        WorkerCount = HardwareThreads > 1 ? HardwareThreads - 1 : 0;
+    }
+
+    mAllocator   = Allocator.Clone();
+    mStateCount  = WorkerCount + 1;
+    mThreadCount = 1;
+    mThreads     = mAllocator.AllocArray<thread_state>(mStateCount, allocation_strategy::default_init);
+
+    ForRange(u32, i, mStateCount)
+    {
+        thread_state& Thread = mThreads[i];
+        Thread.Deque.Buffer = mAllocator.AllocArray<std::atomic<job*>>(cMaxJobsPerThread, allocation_strategy::default_init);
+        Thread.Jobs         = mAllocator.AllocArray<job>(cMaxJobsPerThread, allocation_strategy::default_init);
+        Thread.Random       = 0x9E3779B9u * (i + 1);
+        Thread.System       = this;
+        Thread.Index        = i;
+    }
+
+    tThreadIndex = 0;
+    mRunning.store(true, std::memory_order_release);
+
+    // A worker that fails to start leaves an empty deque behind, the others find nothing to steal there.
+    // Its jobs are simply spread over fewer threads.
+    mWorkers = mAllocator.AllocArray<platform_thread>(WorkerCount, allocation_strategy::default_init);
+    ForRange(u32, i, WorkerCount)
+    {
+        mstr8 Name = mstr8::Format("Job Worker %u", i + 1);
+        if (!mWorkers[i].Start(WorkerEntry, &mThreads[i + 1], Name))
+        {
+            LogWarn("Started %u of %u job workers", i, WorkerCount);
+            break;
+        }
+        mThreadCount += 1;
+    }
+}
+
+void
+job_system::Deinit()
+{
+    if (!mThreads) return;
+    assert(tThreadIndex == 0);
+
+    mRunning.store(false, std::memory_order_release);
+    mWakeEpoch.fetch_add(1, std::memory_order_seq_cst);
+    PlatformWakeAll(&mWakeEpoch);
+
+    ForRange(u32, i, mThreadCount - 1)
+    {
+        mWorkers[i].Join();
+    }
+
+    ForRange(u32, i, mStateCount)
+    {
+        mAllocator.FreeArray(mThreads[i].Deque.Buffer, cMaxJobsPerThread, allocation_strategy::deconstruct);
+        mAllocator.Free(mThreads[i].Jobs);
+    }
+
+    mAllocator.FreeArray(mWorkers, mStateCount - 1, allocation_strategy::deconstruct);
+    mAllocator.FreeArray(mThreads, mStateCount, allocation_strategy::deconstruct);
+
+    mThreads     = nullptr;
+    mWorkers     = nullptr;
+    mStateCount  = 0;
+    mThreadCount = 0;
+    tThreadIndex = U32_MAX;
+}
+
+void
+job_system::Run(const job* Jobs, u32 Count, job_counter* Counter)
+{
+    u32 ThreadIndex = tThreadIndex;
+    assert(ThreadIndex < mThreadCount && "Jobs can only be queued from threads of the job system");
+
+    thread_state& Thread = mThreads[ThreadIndex];
+    ForRange(u32, i, Count)
+    {
+        job* Job = &Thread.Jobs[Thread.NextJob & (cMaxJobsPerThread - 1)];
+        Thread.NextJob += 1;
+
+        *Job = Jobs[i];
+        if (!Job->Counter)
+        {
+            Job->Counter = Counter;
+        }
+
+        // Counted before the push, a thief could finish the job right away
+        if (Job->Counter)
+        {
+            Job->Counter->mValue.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        Thread.Deque.Push(Job);
+    }
+
+    // A worker about to park either sees the new epoch, or is counted as sleeping by now and gets woken.
+    mWakeEpoch.fetch_add(1, std::memory_order_seq_cst);
+    if (mSleepingCount.load(std::memory_order_seq_cst) > 0)
+    {
+        PlatformWakeAll(&mWakeEpoch);
+    }
+}
+
+job*
+job_system::FindJob(u32 ThreadIndex)
+{
+    thread_state& Thread = mThreads[ThreadIndex];
+    if (job* Job = Thread.Deque.Pop())
+    {
+        return Job;
+    }
+
+    // Start at a random victim so the thieves spread out
+    u32 Start = XorShift32(&Thread.Random) % mStateCount;
+    ForRange(u32, i, mStateCount)
+    {
+        u32 Victim = (Start + i) % mStateCount;
+        if (Victim == ThreadIndex) continue;
+
+        if (job* Job = mThreads[Victim].Deque.Steal())
+        {
+            return Job;
+        }
+    }
+
+    return nullptr;
+}
+
+void
+job_system::Execute(job* Job)
+{
+    // The slot can be reused as soon as the job is running, so take what is needed from it first
+    job_pfn      Function = Job->Function;
+    void*        Data     = Job->Data;
+    job_counter* Counter  = Job->Counter;
+
+    Function(Data);
+
+    if (Counter)
+    {
+        Counter->mValue.fetch_sub(1, std::memory_order_release);
+    }
+}
+
+void
+job_system::Wait(job_counter* Counter)
+{
+    u32 ThreadIndex = tThreadIndex;
+    assert(ThreadIndex < mThreadCount && "Only threads of the job system can wait on jobs");
+
+    while (!Counter->IsDone())
+    {
+        if (job* Job = FindJob(ThreadIndex))
+        {
+            Execute(Job);
+        }
+        else
+        { // The remaining jobs are running on other threads
+            PlatformCpuRelax();
+        }
+    }
+}
+
+void
+job_system::WorkerEntry(void* Data)
+{
+    thread_state* Thread = (thread_state*)Data;
+    Thread->System->WorkerMain(Thread->Index);
+}
+
+void
+job_system::WorkerMain(u32 ThreadIndex)
+{
+    tThreadIndex = ThreadIndex;
+
+    u32 IdleRounds = 0;
+    while (true)
+    {
+        // Read the epoch before looking for work, so jobs queued after the search wake us up.
+        u32 Epoch = mWakeEpoch.load(std::memory_order_acquire);
+        if (!mRunning.load(std::memory_order_acquire))
+            break;
+
+        if (job* Job = FindJob(ThreadIndex))
+        {
+            Execute(Job);
+            IdleRounds = 0;
+        }
+        else if (IdleRounds < cIdleSpinCount)
+        {
+            PlatformCpuRelax();
+            IdleRounds += 1;
+        }
+        else
+        { // Parks only if no jobs were queued since Epoch was read
+            mSleepingCount.fetch_add(1, std::memory_order_seq_cst);
+            PlatformWaitOnAddress(&mWakeEpoch, Epoch);
+            mSleepingCount.fetch_sub(1, std::memory_order_relaxed);
+            IdleRounds = 0;
+        }
+    }
+
+    tThreadIndex = U32_MAX;
+}
+
+//
+// ParallelFor
+//
+
+struct parallel_for_range
+{
+    job_range_pfn Function;
+    void*         Data;
+    u32           Begin;
+    u32           End;
+};
+
+fn_internal void
+ParallelForRangeJob(void* Data)
+{
+    parallel_for_range* Range = (parallel_for_range*)Data;
+    Range->Function(Range->Data, Range->Begin, Range->End);
+}
+
+void
+job_system::ParallelFor(u32 Count, job_range_pfn Function, void* Data, u32 GrainSize)
+{
+    if (Count == 0) return;
+
+    // A few ranges per thread, so a thread that falls behind (or started late) doesn't hold up the rest
+    constexpr u32 cRangesPerThread = 4;
+
+    u32 MaxRanges = mThreadCount * cRangesPerThread;
+    MaxRanges = MaxRanges < cMaxParallelForJobs ? MaxRanges : cMaxParallelForJobs;
+
+    if (GrainSize == 0)
+    {
+        GrainSize = DivideCeil(Count, MaxRanges);
+    }
+
+    u32 MinGrainSize = DivideCeil(Count, cMaxParallelForJobs);
+    GrainSize = GrainSize > MinGrainSize ? GrainSize : MinGrainSize;
+
+    u32 RangeCount = DivideCeil(Count, GrainSize);
+    if (RangeCount == 1 || mThreadCount == 1)
+    {
+        Function(Data, 0, Count);
+        return;
+    }
+
+    // Lives on this stack frame, Wait() returns only once every range is done
+    parallel_for_range Ranges[cMaxParallelForJobs];
+    job                Jobs[cMaxParallelForJobs];
+    ForRange(u32, i, RangeCount)
+    {
+        u32 Begin = i * GrainSize;
+        u32 End   = Begin + GrainSize < Count ? Begin + GrainSize : Count;
+        Ranges[i] = { Function, Data, Begin, End };
+        Jobs[i]   = { ParallelForRangeJob, &Ranges[i], nullptr };
+    }
+
+    // The calling thread takes the first range itself rather than queueing it
+    job_counter Counter = {};
+    Run(Jobs + 1, RangeCount - 1, &Counter);
+    ParallelForRangeJob(&Ranges[0]);
+    Wait(&Counter);
+}
+
+struct parallel_for_index
+{
+    job_index_pfn Function;
+    void*         Data;
+};
+
+fn_internal void
+ParallelForIndexRange(void* Data, u32 Begin, u32 End)
+{
+    parallel_for_index* Index = (parallel_for_index*)Data;
+    for (u32 i = Begin; i < End; ++i)
+    {
+        Index->Function(Index->Data, i);
+    }
+}
+
+void
+job_system::ParallelFor(u32 Count, job_index_pfn Function, void* Data, u32 GrainSize)
+{
+    parallel_for_index Index = { Function, Data };
+    ParallelFor(Count, ParallelForIndexRange, &Index, GrainSize);
+}
+
+void
+job_system::ParallelForCallback(void* Context, u32 Count, job_index_pfn Task, void* Data)
+{
+    // The tasks handed over this way are already coarse (e.g. whole BVH subtrees) and uneven, so each
+    // one is its own job.
+    job_system* Self = (job_system*)Context;
+    Self->ParallelFor(Count, Task, Data, 1);
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <types.h>
+#include <util/allocator.h>
+#include <platform/platform.h>
+
+#include <atomic>
+
+using job_pfn       = void (*)(void* Data);
+using job_range_pfn = void (*)(void* Data, u32 Begin, u32 End);
+using job_index_pfn = void (*)(void* Data, u32 Index);
+
+// Number of jobs of a batch that have not finished yet. Jobs that depend on other jobs wait on the
+// counter of their dependencies, which builds job graphs without a separate graph structure. A counter
+// can be reused once it is back to zero.
+class job_counter
+{
+public:
+    u32  Value()  const { return mValue.load(std::memory_order_acquire); }
+    bool IsDone() const { return Value() == 0;                           }
+
+private:
+    friend class job_system;
+    std::atomic<u32> mValue = 0;
+};
+
+struct job
+{
+    job_pfn      Function = nullptr;
+    void*        Data     = nullptr;
+    job_counter* Counter  = nullptr; // optional, decremented once the job has finished
+};
+
+//
+// job_system
+//
+// Work-stealing job scheduler. Each thread (the workers, plus the thread that created the job system)
+// owns a Chase-Lev deque: it pushes and pops at the bottom without locks, while idle threads steal
+// from the top of the other deques. A thread keeps working through its own jobs in LIFO order, which
+// stays hot in cache, and idle threads take the oldest jobs, which tend to be the largest.
+//
+// Wait() does not block while there is work: the waiting thread runs queued jobs (its own first, then
+// stolen ones) until the counter reaches zero. Jobs can wait on other jobs the same way.
+//
+// Only the thread that created the job system and the job functions themselves may call Run, Wait and
+// ParallelFor. A thread can have at most cMaxJobsPerThread jobs queued or running at once.
+//
+// Usage:
+//     job_system Jobs = job_system(Allocator);
+//
+//     job_counter Counter = {};
+//     job         Decode  = { .Function = DecodeTexture, .Data = &Texture };
+//     Jobs.Run(&Decode, 1, &Counter);
+//     // ... other work ...
+//     Jobs.Wait(&Counter);
+//
+//     Jobs.ParallelFor(ObjectCount, CullObjects, &CullData);
+//     Bvh.Build(Bounds, ObjectCount, job_system::ParallelForCallback, &Jobs);
+//
+class job_system
+{
+public:
+    static constexpr u32 cMaxJobsPerThread   = 4096;
+    static constexpr u32 cMaxParallelForJobs = 256;
+
+    job_system() = default;
+    // WorkerCount is the number of threads created in addition to the calling thread. 0 uses one
+    // worker per hardware thread, minus the calling thread.
+    job_system(const allocator& Allocator, u32 WorkerCount = 0);
+    void Deinit();
+
+    // Total threads that run jobs, the calling thread included. Less than WorkerCount + 1 if some
+    // workers could not be started.
+    u32  ThreadCount() const { return mThreadCount; }
+
+    // Queues Count jobs. Each one is added to its own Counter, or to Counter if it has none.
+    void Run(const job* Jobs, u32 Count, job_counter* Counter = nullptr);
+    // Runs queued jobs until Counter reaches zero.
+    void Wait(job_counter* Counter);
+
+    // Calls Function over [0, Count) split into ranges of GrainSize, returning once every range is done.
+    // A GrainSize of 0 picks one that gives each thread a few ranges to balance the load.
+    void ParallelFor(u32 Count, job_range_pfn Function, void* Data, u32 GrainSize = 0);
+    void ParallelFor(u32 Count, job_index_pfn Function, void* Data, u32 GrainSize = 0);
+
+    // ParallelFor for callers that take a (Context, Count, Task, Data) callback, such as bvh::Build.
+    // Context is the job_system.
+    static void ParallelForCallback(void* Context, u32 Count, job_index_pfn Task, void* Data);
+
+private:
+    struct thread_state;
+
+    job* FindJob(u32 ThreadIndex);
+    void Execute(job* Job);
+    void WorkerMain(u32 ThreadIndex);
+    static void WorkerEntry(void* Data);
+
+    allocator         mAllocator      = {};
+    u32               mStateCount     = 0;       // WorkerCount + 1, whether or not every worker started
+    u32               mThreadCount    = 0;       // threads running jobs, the first mThreadCount of mThreads
+    thread_state*     mThreads        = nullptr; // [0] is the thread that created the job system
+    platform_thread*  mWorkers        = nullptr; // mStateCount - 1 workers, the first mThreadCount - 1 started
+
+    std::atomic<bool> mRunning        = false;
+    // Bumped whenever jobs are queued. Idle workers park on it.
+    std::atomic<u32>  mWakeEpoch      = 0;
+    // Workers parked (or about to park) on mWakeEpoch, queueing jobs only wakes them when there are some
+    std::atomic<u32>  mSleepingCount  = 0;
+};
@@ -0,0 +1,405 @@
+#include "serializer.h"
+#include "simd.h"
+
+#include <string.h>
+
+//
+// Varints
+//
+
+u32
+VarintEncodeU32(u8* Dst, u32 Value)
+{
+    u32 Bytes = 0;
+    while (Value >= 0x80)
+    {
+        Dst[Bytes++] = u8(Value | 0x80);
+        Value >>= 7;
+    }
+    Dst[Bytes++] = u8(Value);
+    return Bytes;
+}
+
+u32
+VarintEncodeU64(u8* Dst, u64 Value)
+{
+    u32 Bytes = 0;
+    while (Value >= 0x80)
+    {
+        Dst[Bytes++] = u8(Value | 0x80);
+        Value >>= 7;
+    }
+    Dst[Bytes++] = u8(Value);
+    return Bytes;
+}
+
+u32
+VarintDecodeU32(const u8* Src, u32* Value)
+{
+    // Fast path for the common single byte case.
+    if (Src[0] < 0x80)
+    {
+        *Value = Src[0];
+        return 1;
+    }
+
+    u32 Result = 0;
+    u32 Bytes  = 0;
+    u32 Shift  = 0;
+    u8  Byte   = 0;
+    do
+    {
+        assert(Bytes < cVarintMaxBytesU32 && "Malformed varint");
+        Byte     = Src[Bytes++];
+        Result  |= u32(Byte & 0x7F) << Shift;
+        Shift   += 7;
+    } while (Byte & 0x80);
+
+    *Value = Result;
+    return Bytes;
+}
+
+u32
+VarintDecodeU64(const u8* Src, u64* Value)
+{
+    if (Src[0] < 0x80)
+    {
+        *Value = Src[0];
+        return 1;
+    }
+
+    u64 Result = 0;
+    u32 Bytes  = 0;
+    u32 Shift  = 0;
+    u8  Byte   = 0;
+    do
+    {
+        assert(Bytes < cVarintMaxBytesU64 && "Malformed varint");
+        Byte     = Src[Bytes++];
+        Result  |= u64(Byte & 0x7F) << Shift;
+        Shift   += 7;
+    } while (Byte & 0x80);
+
+    *Value = Result;
+    return Bytes;
+}
+
+u64
+VarintEncodeArrayU32(u8* Dst, const u32* Values, u64 Count)
+{
+    u64 Offset = 0;
+    ForRange(u64, i, Count)
+    {
+        Offset += VarintEncodeU32(Dst + Offset, Values[i]);
+    }
+    return Offset;
+}
+
+u64
+VarintDecodeArrayU32(const u8* Src, u32* Values, u64 Count)
+{
+    u64 Offset = 0;
+    ForRange(u64, i, Count)
+    {
+        Offset += VarintDecodeU32(Src + Offset, &Values[i]);
+    }
+    return Offset;
+}
+
+//
+// Delta + ZigZag
+//
+
+void
+DeltaEncodeU32(const u32* In, u32* Out, u64 Count)
+{
+    u32 Previous = 0;
+    ForRange(u64, i, Count)
+    {
+        u32 Current = In[i]; // Read before writing so In and Out can alias
+        Out[i]      = ZigZagEncode32(s32(Current - Previous));
+        Previous    = Current;
+    }
+}
+
+void
+DeltaDecodeU32(const u32* In, u32* Out, u64 Count)
+{
+    u64 i       = 0;
+    u32 Running = 0;
+
+#if SIMD_SSE2
+    // Undo the ZigZag for 4 lanes, then an in-register prefix sum (log2(4) shift + add steps)
+    // with the carry from the previous block broadcast into every lane.
+    __m128i Carry = _mm_setzero_si128();
+    const __m128i One = _mm_set1_epi32(1);
+    for (; i + 4 <= Count; i += 4)
+    {
+        __m128i Encoded = _mm_loadu_si128((const __m128i*)(In + i));
+        __m128i Sign    = _mm_sub_epi32(_mm_setzero_si128(), _mm_and_si128(Encoded, One));
+        __m128i Delta   = _mm_xor_si128(_mm_srli_epi32(Encoded, 1), Sign);
+
+        Delta = _mm_add_epi32(Delta, _mm_slli_si128(Delta, 4));
+        Delta = _mm_add_epi32(Delta, _mm_slli_si128(Delta, 8));
+        Delta = _mm_add_epi32(Delta, Carry);
+
+        _mm_storeu_si128((__m128i*)(Out + i), Delta);
+        Carry = _mm_shuffle_epi32(Delta, _MM_SHUFFLE(3, 3, 3, 3));
+    }
+    Running = u32(_mm_cvtsi128_si32(Carry));
+#endif
+
+    for (; i < Count; ++i)
+    {
+        Running += u32(ZigZagDecode32(In[i]));
+        Out[i]   = Running;
+    }
+}
+
+void
+DeltaEncodeU16(const u16* In, u32* Out, u64 Count)
+{
+    u32 Previous = 0;
+    ForRange(u64, i, Count)
+    {
+        Out[i]   = ZigZagEncode32(s32(In[i]) - s32(Previous));
+        Previous = In[i];
+    }
+}
+
+void
+DeltaDecodeU16(const u32* In, u16* Out, u64 Count)
+{
+    s32 Running = 0;
+    ForRange(u64, i, Count)
+    {
+        Running += ZigZagDecode32(In[i]);
+        Out[i]   = u16(Running);
+    }
+}
+
+//
+// Bit-Packing
+//
+
+u32
+BitPackRequiredWidthU32(const u32* Values, u64 Count)
+{
+    u32 Combined = 0;
+    ForRange(u64, i, Count)
+    {
+        Combined |= Values[i];
+    }
+
+    u32 Width = 0;
+    while (Width < 32 && (Combined >> Width) != 0)
+    {
+        Width += 1;
+    }
+    return Width;
+}
+
+u64
+BitPackU32(u8* Dst, const u32* Values, u64 Count, u32 BitWidth)
+{
+    assert(BitWidth <= 32);
+    if (BitWidth == 0) return 0;
+
+    const u64 Mask = (u64(1) << BitWidth) - 1;
+
+    // Bits are accumulated little-endian into a 64-bit register and flushed a byte at a time.
+    u64 Accumulator = 0;
+    u32 Bits        = 0;
+    u64 Offset      = 0;
+    ForRange(u64, i, Count)
+    {
+        Accumulator |= (u64(Values[i]) & Mask) << Bits;
+        Bits        += BitWidth;
+        while (Bits >= 8)
+        {
+            Dst[Offset++]   = u8(Accumulator);
+            Accumulator   >>= 8;
+            Bits           -= 8;
+        }
+    }
+
+    if (Bits > 0)
+    {
+        Dst[Offset++] = u8(Accumulator);
+    }
+
+    assert(Offset == BitPackEncodedSize(Count, BitWidth));
+    return Offset;
+}
+
+u64
+BitUnpackU32(const u8* Src, u32* Values, u64 Count, u32 BitWidth)
+{
+    assert(BitWidth <= 32);
+
+    const u64 EncodedSize = BitPackEncodedSize(Count, BitWidth);
+    if (BitWidth == 0)
+    {
+        memset(Values, 0, Count * sizeof(u32));
+        return 0;
+    }
+
+    const u64 Mask = (u64(1) << BitWidth) - 1;
+
+    u64 i       = 0;
+    u64 BitBase = 0;
+
+    // A value starts at most 7 bits into a byte and spans at most 32 bits, so an unaligned 8 byte
+    // load always covers it. Use that while 8 bytes are available, then finish byte by byte.
+    for (; i < Count; ++i, BitBase += BitWidth)
+    {
+        u64 ByteOffset = BitBase >> 3;
+        if (ByteOffset + 8 > EncodedSize) break;
+
+        u64 Word = 0;
+        memcpy(&Word, Src + ByteOffset, sizeof(Word));
+        Values[i] = u32((Word >> (BitBase & 7)) & Mask);
+    }
+
+    for (; i < Count; ++i, BitBase += BitWidth)
+    {
+        u64 ByteOffset = BitBase >> 3;
+        u64 Word       = 0;
+        for (u64 Byte = 0; Byte < 8 && ByteOffset + Byte < EncodedSize; ++Byte)
+        {
+            Word |= u64(Src[ByteOffset + Byte]) << (8 * Byte);
+        }
+        Values[i] = u32((Word >> (BitBase & 7)) & Mask);
+    }
+
+    return EncodedSize;
+}
+
+//
+// Group Varint
+//
+// Layout per group of 4 values: [control byte][value bytes...]. The control byte holds
+// (ByteLength - 1) for each value, 2 bits per value starting at the low bits. Trailing groups
+// with less than 4 values are padded with zeros (1 byte each).
+//
+
+fn_internal u32
+GroupVarintByteLength(u32 Value)
+{
+    return (Value < (1u << 8)) ? 1 : (Value < (1u << 16)) ? 2 : (Value < (1u << 24)) ? 3 : 4;
+}
+
+struct group_varint_tables
+{
+    u8 Shuffle[256][16]; // pshufb masks that expand packed bytes into 4 u32 lanes
+    u8 Length[256];      // number of data bytes in the group
+};
+
+constexpr group_varint_tables
+BuildGroupVarintTables()
+{
+    group_varint_tables Tables = {};
+    for (u32 Control = 0; Control < 256; ++Control)
+    {
+        u32 Offset = 0;
+        for (u32 Lane = 0; Lane < 4; ++Lane)
+        {
+            u32 Length = ((Control >> (2 * Lane)) & 0x3) + 1;
+            for (u32 Byte = 0; Byte < 4; ++Byte)
+            {
+                Tables.Shuffle[Control][Lane * 4 + Byte] = (Byte < Length) ? u8(Offset + Byte) : u8(0x80);
+            }
+            Offset += Length;
+        }
+        Tables.Length[Control] = u8(Offset);
+    }
+    return Tables;
+}
+
+alignas(16) var_global constexpr group_varint_tables cGroupVarintTables = BuildGroupVarintTables();
+
+u64
+GroupVarintEncodeU32(u8* Dst, const u32* Values, u64 Count)
+{
+    u64 Offset = 0;
+    for (u64 i = 0; i < Count; i += 4)
+    {
+        u8* Control = Dst + Offset++;
+        *Control    = 0;
+
+        for (u32 Lane = 0; Lane < 4; ++Lane)
+        {
+            u32 Value  = (i + Lane < Count) ? Values[i + Lane] : 0;
+            u32 Length = GroupVarintByteLength(Value);
+
+            *Control |= u8((Length - 1) << (2 * Lane));
+            for (u32 Byte = 0; Byte < Length; ++Byte)
+            {
+                Dst[Offset++] = u8(Value >> (8 * Byte));
+            }
+        }
+    }
+    return Offset;
+}
+
+u64
+GroupVarintDecodeU32(const u8* Src, [[maybe_unused]] u64 SrcSize, u32* Values, u64 Count)
+{
+    u64 Offset = 0;
+    u64 i      = 0;
+
+#if SIMD_SSSE3
+    // A group is at most 17 bytes; the shuffle load reads 16 bytes after the control byte.
+    for (; i + 4 <= Count && Offset + 17 <= SrcSize; i += 4)
+    {
+        u8      Control = Src[Offset];
+        __m128i Data    = _mm_loadu_si128((const __m128i*)(Src + Offset + 1));
+        __m128i Mask    = _mm_load_si128((const __m128i*)cGroupVarintTables.Shuffle[Control]);
+        _mm_storeu_si128((__m128i*)(Values + i), _mm_shuffle_epi8(Data, Mask));
+        Offset += 1 + cGroupVarintTables.Length[Control];
+    }
+#endif
+
+    for (; i < Count; i += 4)
+    {
+        assert(Offset < SrcSize);
+        u8 Control = Src[Offset++];
+        for (u32 Lane = 0; Lane < 4; ++Lane)
+        {
+            u32 Length = ((Control >> (2 * Lane)) & 0x3) + 1;
+            u32 Value  = 0;
+            for (u32 Byte = 0; Byte < Length; ++Byte)
+            {
+                Value |= u32(Src[Offset++]) << (8 * Byte);
+            }
+
+            if (i + Lane < Count)
+            {
+                Values[i + Lane] = Value;
+            }
+        }
+    }
+
+    assert(Offset <= SrcSize);
+    return Offset;
+}
+
+//
+// file_reader / file_writer
+//
+
+void
+file_writer::Write(void* Data, u64 DataSize)
+{
+    assert(mOffsetPtr + DataSize <= mEndPtr && "file_writer is out of space");
+    memcpy(mOffsetPtr, Data, DataSize);
+    mOffsetPtr += DataSize;
+}
+
+void
+file_reader::Read(void* Data, u64 DataSize)
+{
+    assert(mOffsetPtr + DataSize <= mEndPtr && "file_reader read past the end of the buffer");
+    memcpy(Data, mOffsetPtr, DataSize);
+    mOffsetPtr += DataSize;
+}
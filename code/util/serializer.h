@@ -4,6 +4,10 @@
 #include "str8.h"
 #include "str16.h"
 
+#include <stddef.h>    // offsetof
+#include <type_traits>
+#include <utility>     // index_sequence
+
 using file_handle = void*;
 using file_info   = void*;
 
@@ -41,6 +45,9 @@ using file_info   = void*;
 // boo is a user custom type, so will need to implement Serialize too. If 
 // not implemented, then a compile error will occur.
 //
+// Writing these by hand gets tedious (and slow, one call per field), so most structs should
+// declare their field list with SERIAL_LAYOUT instead. See "Reflected Serialization" below.
+//
 
 struct file_reader
 {
@@ -113,4 +120,335 @@ template<u64>  constexpr u64  Deserialize(file_reader* Reader);
 template<f32>  constexpr f32  Deserialize(file_reader* Reader);
 template<f64>  constexpr f64  Deserialize(file_reader* Reader);
 
-template<bool> constexpr bool Deserialize(file_reader* Reader);
\ No newline at end of file
+template<bool> constexpr bool Deserialize(file_reader* Reader);
+
+//
+// Compact Numeric Encodings
+//
+// Most of the integer data written to disc is small or close to the previous value (index buffers,
+// id tables, animation keys), so writing every value at its full width wastes most of the bytes.
+// The following encoders work on raw byte buffers so they can be used before handing the result
+// to a file_writer (or after pulling a block out of a file_reader).
+//
+// Varint (LEB128): 7 bits of payload per byte, high bit set when more bytes follow.
+//      u32 VarintEncodeU32(u8* Dst, u32 Value);                 // returns bytes written (1-5)
+//      u32 VarintEncodeU64(u8* Dst, u64 Value);                 // returns bytes written (1-10)
+//      u32 VarintDecodeU32(const u8* Src, u32* Value);          // returns bytes read
+//      u32 VarintDecodeU64(const u8* Src, u64* Value);          // returns bytes read
+//
+// ZigZag: maps signed values to unsigned so small negative numbers stay small (0,-1,1,-2 -> 0,1,2,3).
+//
+// Delta: stores ZigZag(Value[i] - Value[i-1]). Monotonic or nearly sorted data (indices, ids, key
+// times) turns into small numbers that then varint/bit-pack well. Decoding is a SIMD prefix sum.
+//
+// Bit-Packing: stores every value with the same number of bits. Best for data with a known small
+// range (e.g. delta-encoded index buffers that fit in 6 bits).
+//
+// Group Varint: 4 values share one control byte holding each value's byte length (1-4). Decoding
+// does not branch per byte, and with SSSE3 a whole group is decoded with a single shuffle.
+//
+// A typical index buffer pipeline looks like:
+//
+//      DeltaEncodeU16(Indices, Scratch, IndexCount);
+//      u64 Bytes = GroupVarintEncodeU32(Dst, Scratch, IndexCount);
+//      ...
+//      GroupVarintDecodeU32(Src, Bytes, Scratch, IndexCount);
+//      DeltaDecodeU16(Scratch, Indices, IndexCount);
+//
+
+// Worst-case encoded sizes, use these to size destination buffers.
+constexpr u64 cVarintMaxBytesU32 = 5;
+constexpr u64 cVarintMaxBytesU64 = 10;
+
+constexpr u64 VarintMaxEncodedSizeU32(u64 Count)        { return Count * cVarintMaxBytesU32;                     }
+constexpr u64 GroupVarintMaxEncodedSizeU32(u64 Count)   { return DivideCeil(Count, u64(4)) * 17;                 }
+constexpr u64 BitPackEncodedSize(u64 Count, u32 BitWidth) { return DivideCeil(Count * u64(BitWidth), u64(8));   }
+
+constexpr u32 ZigZagEncode32(s32 Value) { return (u32(Value) << 1) ^ u32(Value >> 31); }
+constexpr u64 ZigZagEncode64(s64 Value) { return (u64(Value) << 1) ^ u64(Value >> 63); }
+constexpr s32 ZigZagDecode32(u32 Value) { return s32(Value >> 1) ^ -s32(Value & 1);    }
+constexpr s64 ZigZagDecode64(u64 Value) { return s64(Value >> 1) ^ -s64(Value & 1);    }
+
+// Scalar Varints
+u32 VarintEncodeU32(u8* Dst, u32 Value);
+u32 VarintEncodeU64(u8* Dst, u64 Value);
+u32 VarintDecodeU32(const u8* Src, u32* Value);
+u32 VarintDecodeU64(const u8* Src, u64* Value);
+
+// Varint Arrays. Encode returns the number of bytes written, Decode returns the number of bytes read.
+u64 VarintEncodeArrayU32(u8* Dst, const u32* Values, u64 Count);
+u64 VarintDecodeArrayU32(const u8* Src, u32* Values, u64 Count);
+
+// Delta + ZigZag. Out and In may alias for the u32 versions.
+void DeltaEncodeU32(const u32* In, u32* Out, u64 Count);
+void DeltaDecodeU32(const u32* In, u32* Out, u64 Count);
+void DeltaEncodeU16(const u16* In, u32* Out, u64 Count);
+void DeltaDecodeU16(const u32* In, u16* Out, u64 Count);
+
+// Bit-Packing. BitWidth must be in the range [0, 32]. A BitWidth of 0 writes nothing and decodes to zeros.
+u32 BitPackRequiredWidthU32(const u32* Values, u64 Count);
+u64 BitPackU32(u8* Dst, const u32* Values, u64 Count, u32 BitWidth);
+u64 BitUnpackU32(const u8* Src, u32* Values, u64 Count, u32 BitWidth);
+
+// Group Varint. SrcSize is the number of readable bytes at Src, the decoder uses it to decide
+// when it is safe to issue full 16 byte loads.
+u64 GroupVarintEncodeU32(u8* Dst, const u32* Values, u64 Count);
+u64 GroupVarintDecodeU32(const u8* Src, u64 SrcSize, u32* Values, u64 Count);
+
+
+//
+// Reflected Serialization
+//
+// Instead of hand-writing Serialize/Deserialize, a struct declares its field list once (at global scope):
+//
+// struct foo_header {
+//      u16 Version;
+//      u64 Size;         // padding after Version, so foo_header is not one run
+// };
+//
+// SERIAL_LAYOUT(foo_header,
+//      SERIAL_FIELD(foo_header, Version),
+//      SERIAL_FIELD(foo_header, Size));
+//
+// struct foo {
+//      foo_header Header;
+//      f32        Position[3];
+//      f32        Radius;
+//      u32        Flags;
+// };
+//
+// SERIAL_LAYOUT(foo,
+//      SERIAL_FIELD(foo, Header),
+//      SERIAL_FIELD(foo, Position),
+//      SERIAL_FIELD(foo, Radius),
+//      SERIAL_FIELD(foo, Flags));
+//
+// Everything else is derived at compile time from the field list:
+// - Serialize/Deserialize overloads for foo (and foo_header).
+// - SerialSchemaHash<foo>(), a hash of every field's name, type and offset. SerializeWithSchema
+//   writes it in front of the data and DeserializeWithSchema rejects mismatched data with a single
+//   compare instead of validating field by field.
+// - Runs of memcpy-able fields that sit next to each other in memory. Each run is written with a
+//   single Write call, so in the example above Header is written through its own overload (two
+//   runs, Version and Size) and Position, Radius and Flags become one 20 byte copy. A struct made
+//   of nothing but POD fields (without padding) is a single bulk copy. tests/serializer_tests.cpp
+//   checks this example.
+//
+// A field is memcpy-able ("serial POD") when it is an arithmetic or enum type, an array of serial POD,
+// a reflected struct that collapses into a single run, or a type opted in with SERIAL_POD(Type).
+// Anything else is written with its own Serialize/Deserialize overload, and a field of a type that has
+// neither a layout nor an overload (e.g. mstr8, or a math type without SERIAL_POD) fails to compile.
+//
+// NOTE: POD runs are written in host byte order, the same as the basic types.
+//
+
+constexpr u64 cSerialHashSeed  = 0xcbf29ce484222325;
+constexpr u64 cSerialHashPrime = 0x100000001b3;
+
+// FNV-1a, usable at compile time.
+constexpr u64 SerialHashString(const char* Str)
+{
+    u64 Hash = cSerialHashSeed;
+    for (; *Str; ++Str)
+    {
+        Hash = (Hash ^ u8(*Str)) * cSerialHashPrime;
+    }
+    return Hash;
+}
+
+constexpr u64 SerialHashCombine(u64 Seed, u64 Value)
+{
+    ForRange(u32, i, 8)
+    {
+        Seed = (Seed ^ ((Value >> (i * 8)) & 0xFF)) * cSerialHashPrime;
+    }
+    return Seed;
+}
+
+// Specialized by SERIAL_LAYOUT. Left undefined for types without a layout.
+template<typename T> struct serial_layout;
+
+// Specialize (or use SERIAL_POD) for types that can be memcpy'd as-is, e.g. math types.
+template<typename T> struct serial_pod_override : std::false_type {};
+
+template<typename T>
+concept serial_reflected = requires { typename serial_layout<T>::fields; };
+
+template<typename Owner, typename FieldType, u64 Offset, u64 NameHash>
+struct serial_field
+{
+    using type = FieldType;
+
+    static constexpr u64 cOffset   = Offset;
+    static constexpr u64 cSize     = sizeof(FieldType);
+    static constexpr u64 cNameHash = NameHash;
+
+    static constexpr       FieldType& Get(Owner& Value)       { return *(FieldType*)((u8*)&Value + Offset);             }
+    static constexpr const FieldType& Get(const Owner& Value) { return *(const FieldType*)((const u8*)&Value + Offset); }
+};
+
+template<typename... Fields>
+struct serial_field_list
+{
+    static constexpr u32 cCount = sizeof...(Fields);
+};
+
+#define SERIAL_FIELD(Type, Member) serial_field<Type, decltype(Type::Member), offsetof(Type, Member), SerialHashString(#Member)>
+#define SERIAL_LAYOUT(Type, ...)   template<> struct serial_layout<Type> { using fields = serial_field_list<__VA_ARGS__>; }
+#define SERIAL_POD(Type)           template<> struct serial_pod_override<Type> : std::true_type {}
+
+template<typename T> constexpr bool IsSerialPod();
+template<typename T> constexpr u64  SerialSchemaHash();
+
+namespace serial_internal
+{
+    template<typename T>
+    constexpr u64 TypeHash()
+    {
+        if constexpr (serial_reflected<T>)
+            return SerialSchemaHash<T>();
+        else if constexpr (std::is_array_v<T>)
+            return SerialHashCombine(TypeHash<std::remove_extent_t<T>>(), std::extent_v<T>);
+        else if constexpr (std::is_enum_v<T>)
+            return SerialHashCombine(TypeHash<std::underlying_type_t<T>>(), 'E');
+        else if constexpr (std::is_arithmetic_v<T>)
+            return SerialHashCombine(SerialHashCombine(sizeof(T), std::is_floating_point_v<T>), std::is_signed_v<T>);
+        else // Opaque type, the best that can be done without a layout is the size.
+            return SerialHashCombine(sizeof(T), 'O');
+    }
+
+    // Per-field tables for a field list, built at compile time.
+    template<typename List> struct field_table;
+
+    template<typename... Fields>
+    struct field_table<serial_field_list<Fields...>>
+    {
+        static constexpr u32  cCount          = sizeof...(Fields);
+        static constexpr u64  cOffsets[]      = { Fields::cOffset...                                  , 0 };
+        static constexpr u64  cSizes[]        = { Fields::cSize...                                    , 0 };
+        static constexpr bool cIsPod[]        = { IsSerialPod<typename Fields::type>()...             , false };
+
+        // A POD field starts a new run unless the previous field is POD and ends exactly where this one begins.
+        static constexpr bool StartsRun(u32 Index)
+        {
+            if (!cIsPod[Index]) return false;
+            if (Index == 0)     return true;
+            return !(cIsPod[Index - 1] && cOffsets[Index - 1] + cSizes[Index - 1] == cOffsets[Index]);
+        }
+
+        // Size in bytes of the run starting at Index.
+        static constexpr u64 RunSize(u32 Index)
+        {
+            u64 Size = cSizes[Index];
+            for (u32 i = Index + 1; i < cCount && cIsPod[i] && !StartsRun(i); ++i)
+            {
+                Size += cSizes[i];
+            }
+            return Size;
+        }
+
+        static constexpr u64 Hash()
+        {
+            u64 Hash = SerialHashCombine(cSerialHashSeed, cCount);
+            ((Hash = SerialHashCombine(SerialHashCombine(SerialHashCombine(Hash, Fields::cNameHash), Fields::cOffset), TypeHash<typename Fields::type>())), ...);
+            return Hash;
+        }
+    };
+
+    template<typename T> using table_for = field_table<typename serial_layout<T>::fields>;
+
+    template<typename T, typename Field, u32 Index>
+    void WriteField(file_writer* Writer, const T& Value)
+    {
+        using table = table_for<T>;
+        if constexpr (table::StartsRun(Index))
+            Writer->Write((void*)((const u8*)&Value + Field::cOffset), table::RunSize(Index));
+        else if constexpr (!table::cIsPod[Index])
+            Serialize(Writer, Field::Get(Value));
+        // else: covered by the run that started at an earlier field
+    }
+
+    template<typename T, typename Field, u32 Index>
+    void ReadField(file_reader* Reader, T& Value)
+    {
+        using table = table_for<T>;
+        if constexpr (table::StartsRun(Index))
+            Reader->Read((u8*)&Value + Field::cOffset, table::RunSize(Index));
+        else if constexpr (!table::cIsPod[Index])
+            Field::Get(Value) = Deserialize<typename Field::type>(Reader);
+    }
+
+    template<typename T, typename... Fields, u32... Indices>
+    void WriteFields(file_writer* Writer, const T& Value, serial_field_list<Fields...>, std::integer_sequence<u32, Indices...>)
+    {
+        (WriteField<T, Fields, Indices>(Writer, Value), ...);
+    }
+
+    template<typename T, typename... Fields, u32... Indices>
+    void ReadFields(file_reader* Reader, T& Value, serial_field_list<Fields...>, std::integer_sequence<u32, Indices...>)
+    {
+        (ReadField<T, Fields, Indices>(Reader, Value), ...);
+    }
+} // serial_internal
+
+template<typename T>
+constexpr u64 SerialSchemaHash()
+{
+    static_assert(serial_reflected<T>, "SerialSchemaHash requires a SERIAL_LAYOUT for the type");
+    return SerialHashCombine(serial_internal::table_for<T>::Hash(), sizeof(T));
+}
+
+template<typename T>
+constexpr bool IsSerialPod()
+{
+    if constexpr (std::is_array_v<T>)
+        return IsSerialPod<std::remove_extent_t<T>>();
+    else if constexpr (std::is_arithmetic_v<T> || std::is_enum_v<T> || serial_pod_override<T>::value)
+        return true;
+    else if constexpr (serial_reflected<T>)
+    { // Only when the whole struct is one run without padding.
+        using table = serial_internal::table_for<T>;
+        return table::cCount > 0 && table::StartsRun(0) && table::RunSize(0) == sizeof(T) && table::cOffsets[0] == 0;
+    }
+    else
+        return false;
+}
+
+// Writes the fields of a reflected struct. Prefer this over Serialize for large structs (no copy).
+template<serial_reflected T>
+void SerializeFields(file_writer* Writer, const T& Value)
+{
+    using fields = typename serial_layout<T>::fields;
+    serial_internal::WriteFields(Writer, Value, fields{}, std::make_integer_sequence<u32, fields::cCount>{});
+}
+
+template<serial_reflected T>
+void DeserializeFields(file_reader* Reader, T& Value)
+{
+    using fields = typename serial_layout<T>::fields;
+    serial_internal::ReadFields(Reader, Value, fields{}, std::make_integer_sequence<u32, fields::cCount>{});
+}
+
+// The generated overloads. These are more constrained than the deleted defaults above, so they win overload resolution.
+template<serial_reflected T> void Serialize(file_writer* Writer, T Value) { SerializeFields(Writer, Value);            }
+template<serial_reflected T> T    Deserialize(file_reader* Reader)        { T Result = {}; DeserializeFields(Reader, Result); return Result; }
+
+// Versioned variants: the schema hash is written first and checked on read. On mismatch, Value is left untouched.
+template<serial_reflected T>
+void SerializeWithSchema(file_writer* Writer, const T& Value)
+{
+    u64 Hash = SerialSchemaHash<T>();
+    Writer->Write(&Hash, sizeof(Hash));
+    SerializeFields(Writer, Value);
+}
+
+template<serial_reflected T>
+bool DeserializeWithSchema(file_reader* Reader, T& Value)
+{
+    u64 Hash = 0;
+    Reader->Read(&Hash, sizeof(Hash));
+    if (Hash != SerialSchemaHash<T>()) return false;
+
+    DeserializeFields(Reader, Value);
+    return true;
+}
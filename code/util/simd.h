@@ -0,0 +1,77 @@
+#pragma once
+
+//
+// Compile-time instruction set selection.
+//
+// Every SIMD_* define resolves to 0 or 1 (like PLATFORM_WIN32 in types.h) so code can write
+// "#if SIMD_SSE2" without caring which compiler is in use. GCC and Clang report the enabled
+// extensions through the usual __SSE4_1__/__AVX2__/... macros. MSVC only reports AVX-class
+// extensions (/arch:AVX, /arch:AVX2), so on x64 SSE4.1 and below are assumed - every GPU that
+// runs D3D12 is paired with a CPU that has them.
+//
+// Define SIMD_FORCE_SCALAR to compile the scalar fallbacks everywhere (useful for validating
+// the SIMD paths against the reference implementation).
+//
+
+#include <types.h>
+
+#if !defined(SIMD_FORCE_SCALAR) && (defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__))
+# define SIMD_X86 1
+#else
+# define SIMD_X86 0
+#endif
+
+#if SIMD_X86
+# define SIMD_SSE2 1
+
+# if defined(_MSC_VER) && !defined(__clang__)
+#  define SIMD_SSSE3 1
+#  define SIMD_SSE41 1
+# else
+#  if defined(__SSSE3__)
+#   define SIMD_SSSE3 1
+#  else
+#   define SIMD_SSSE3 0
+#  endif
+#  if defined(__SSE4_1__)
+#   define SIMD_SSE41 1
+#  else
+#   define SIMD_SSE41 0
+#  endif
+# endif
+
+# if defined(__AVX__)
+#  define SIMD_AVX 1
+# else
+#  define SIMD_AVX 0
+# endif
+
+# if defined(__AVX2__)
+#  define SIMD_AVX2 1
+# else
+#  define SIMD_AVX2 0
+# endif
+
+// MSVC enables FMA and F16C code generation together with /arch:AVX2.
+# if defined(__FMA__) || (defined(_MSC_VER) && defined(__AVX2__))
+#  define SIMD_FMA 1
+# else
+#  define SIMD_FMA 0
+# endif
+
+# if defined(__F16C__) || (defined(_MSC_VER) && defined(__AVX2__))
+#  define SIMD_F16C 1
+# else
+#  define SIMD_F16C 0
+# endif
+
+# include <immintrin.h>
+#else
+# define SIMD_SSE2  0
+# define SIMD_SSSE3 0
+# define SIMD_SSE41 0
+# define SIMD_AVX   0
+# define SIMD_AVX2  0
+# define SIMD_FMA   0
+# define SIMD_F16C  0
+#endif
@@ -196,17 +196,17 @@ c32 ToCodePoint(const c16 utf16[2], int* consumed)
     return STRING_REPLACEMENT_CHAR;
 }
 
-inline bool operator==(istr16 Lhs, istr16 Rhs)
+bool operator==(istr16 Lhs, istr16 Rhs)
 {
     return (Lhs.Length() == Rhs.Length() && memcmp((void*)Lhs.Ptr(), Rhs.Ptr(), Lhs.Length()) == 0);
 }
 
-inline bool operator==(istr16 Lhs, const c16* Rhs)
+bool operator==(istr16 Lhs, const c16* Rhs)
 {
     return (Lhs.Length() == Strlen16(Rhs) && memcmp((void*)Lhs.Ptr(), Rhs, Lhs.Length()) == 0);
 }
 
-inline bool operator==(const c16* Lhs, istr16 Rhs)
+bool operator==(const c16* Lhs, istr16 Rhs)
 {
     return (Strlen16(Lhs) == Rhs.Length() && memcmp((void*)Lhs, Rhs.Ptr(), Rhs.Length()) == 0);
 }
@@ -38,9 +38,9 @@ public:
     constexpr const c16* end()   const { return Ptr() + Length(); }
 
     // Comparison operators. Comparison with mstr16 is implemented inside of mstr16.
-    inline friend bool operator==(istr16 lhs, istr16 rhs);
-    inline friend bool operator==(istr16 lhs, const c16* rhs);
-    inline friend bool operator==(const c16* lhs, istr16 rhs);
+    friend bool operator==(istr16 lhs, istr16 rhs);
+    friend bool operator==(istr16 lhs, const c16* rhs);
+    friend bool operator==(const c16* lhs, istr16 rhs);
 
     inline friend bool operator!=(istr16 lhs, istr16 rhs)     { return !(lhs == rhs); }
     inline friend bool operator!=(const c16* lhs, istr16 rhs) { return !(lhs == rhs); }
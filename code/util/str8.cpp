@@ -166,12 +166,13 @@ mstr8 mstr8::Format(const char* StrFormat, ...)
 
     va_list Copy;
     va_copy(Copy, Args);
-    int Length = 1 + vsnprintf(nullptr, 0, StrFormat, Copy);
+    int Length = vsnprintf(nullptr, 0, StrFormat, Copy);
     va_end(Copy);
 
+    // SetLength reserves the null terminator, it is not part of the length.
     Result.SetLength(Length);
 
-    vsnprintf(Result.Ptr(), Length, StrFormat, Args);
+    vsnprintf(Result.Ptr(), Length + 1, StrFormat, Args);
 
     va_end(Args);
 
@@ -380,7 +381,8 @@ mstr8::ExpandIfNeeded(u64 RequiredCapacity)
     u64 OldCapacity = Capacity();
     u64 OldLength   = Length();
 
-    if (RequiredCapacity <= STACK_STR_SIZE || OldCapacity >= RequiredCapacity) return;
+    // Heap capacity counts the null terminator, the stack capacity does not (the length byte doubles as it).
+    if (RequiredCapacity <= STACK_STR_SIZE || (IsHeap() && OldCapacity > RequiredCapacity)) return;
 
     // We'll double in size, or if that isn't enough we will just allocate exactly the required number of bytes.
     u64 NewCapacity = (OldCapacity * 2 > RequiredCapacity) ? OldCapacity * 2 : RequiredCapacity;
@@ -438,7 +440,7 @@ mstr8::ShrinkToFit()
     }
 }
 
-constexpr u64 
+u64 
 mstr8::Length() const
 {
     u64 Result;
@@ -454,7 +456,7 @@ mstr8::Length() const
     return Result;
 }
 
-constexpr u64  
+u64  
 mstr8::Capacity() const
 {
     u64 Capacity = STACK_STR_SIZE;
@@ -466,7 +468,7 @@ mstr8::Capacity() const
     return Capacity;
 }
 
-constexpr bool 
+bool 
 mstr8::IsHeap() const
 {
     return IsBitSet(mFooter.Heap.Capacity, HEAP_STRING_BIT);
@@ -33,9 +33,9 @@ public:
     constexpr const char* end()   const { return Ptr() + Length(); }
 
     // Comparison operators. Comparison with mstr8 is implemented inside of mstr8.
-    inline friend bool operator==(istr8 lhs,       istr8 rhs);
-    inline friend bool operator==(istr8 lhs,       const char* rhs);
-    inline friend bool operator==(const char* lhs, istr8 rhs);
+    friend bool operator==(istr8 lhs,       istr8 rhs);
+    friend bool operator==(istr8 lhs,       const char* rhs);
+    friend bool operator==(const char* lhs, istr8 rhs);
 
     inline friend bool operator!=(istr8 lhs,       istr8 rhs)       { return !(lhs == rhs); }
     inline friend bool operator!=(const char* lhs, istr8 rhs)       { return !(lhs == rhs); }
@@ -67,36 +67,36 @@ public:
     static mstr8 Format(const char* StrFormat, ...);
 
     // Getters and setters for length and capacity and whatnot.
-    constexpr u64  Length() const;
-    constexpr u64  Capacity() const;
-    constexpr bool IsHeap() const;
+    u64            Length() const;
+    u64            Capacity() const;
+    bool           IsHeap() const;
     void           SetLength(u64 NewLen);
     void           ExpandIfNeeded(u64 RequiredCapacity);
     void           ShrinkToFit();
 
     // Accessors for the raw pointer, auto-cast, and array subscript operators.
-    constexpr const char* Ptr() const { return IsHeap() ? mData.Heap.Ptr : mData.Stack.Ptr; }
-    constexpr char*       Ptr()       { return IsHeap() ? mData.Heap.Ptr : mData.Stack.Ptr; }
+    const char* Ptr() const { return IsHeap() ? mData.Heap.Ptr : mData.Stack.Ptr; }
+    char*       Ptr()       { return IsHeap() ? mData.Heap.Ptr : mData.Stack.Ptr; }
 
     operator istr8       () const { return istr8(Ptr(), Length()); }
-    constexpr operator const char* () const { return Ptr();                  }
-    constexpr operator char*       ()       { return Ptr();                  }
+    operator const char* () const { return Ptr();                  }
+    operator char*       ()       { return Ptr();                  }
 
-    constexpr const char& operator[](u64 Index) const { return Ptr()[Index]; }
-    constexpr char&       operator[](u64 Index)       { return Ptr()[Index]; }
+    const char& operator[](u64 Index) const { return Ptr()[Index]; }
+    char&       operator[](u64 Index)       { return Ptr()[Index]; }
 
     // Legacy iterators
-    constexpr char*       begin()       { return Ptr();            }
-    constexpr char*       end()         { return Ptr() + Length(); }
-    constexpr const char* begin() const { return Ptr();            }
-    constexpr const char* end()   const { return Ptr() + Length(); }
+    char*       begin()       { return Ptr();            }
+    char*       end()         { return Ptr() + Length(); }
+    const char* begin() const { return Ptr();            }
+    const char* end()   const { return Ptr() + Length(); }
 
     // Comparison operators.
-    inline friend bool operator==(const mstr8& Lhs, const mstr8& Rhs);
-    inline friend bool operator==(const mstr8& Lhs, istr8 Rhs);
-    inline friend bool operator==(const mstr8& Lhs, const char* Rhs);
-    inline friend bool operator==(istr8 Lhs,        const mstr8& Rhs);
-    inline friend bool operator==(const char* Lhs,  const mstr8& Rhs);
+    friend bool operator==(const mstr8& Lhs, const mstr8& Rhs);
+    friend bool operator==(const mstr8& Lhs, istr8 Rhs);
+    friend bool operator==(const mstr8& Lhs, const char* Rhs);
+    friend bool operator==(istr8 Lhs,        const mstr8& Rhs);
+    friend bool operator==(const char* Lhs,  const mstr8& Rhs);
 
     inline friend bool operator!=(const mstr8& Lhs, const mstr8& Rhs) { return !(Lhs == Rhs); }
     inline friend bool operator!=(const mstr8& Lhs, istr8 Rhs)        { return !(Lhs == Rhs); }
@@ -0,0 +1,157 @@
+//
+// Bit Tests
+//
+// bitset indexing past the first word, and dbitset/hbitset checked against a plain bool array
+// after random edits.
+//
+#include <util/bit.h>
+
+#include "test_common.h"
+
+enum class test_flag : u32
+{
+    first  = 0,
+    word0  = 63,
+    word1  = 64,
+    middle = 70,
+    last   = 127,
+};
+
+fn_internal void
+TestBitset()
+{
+    // Set/Unset/IsSet used to index the word by the bit index divided by 8, which aliased bits
+    // across words and wrote past the array for large enum values.
+    bitset<test_flag, 128> Flags;
+    Flags.Set(test_flag::middle);
+    TestCheck(Flags.IsSet(test_flag::middle));
+    TestCheck(!Flags.IsSet(test_flag::first) && !Flags.IsSet(test_flag::word0) && !Flags.IsSet(test_flag::word1));
+    TestCheck(Flags.Count() == 1);
+
+    Flags.Set(test_flag::first).Set(test_flag::word0).Set(test_flag::word1).Set(test_flag::last);
+    TestCheck(Flags.Count() == 5);
+
+    u64 Expected[] = { 0, 63, 64, 70, 127 };
+    u64 Visited    = 0;
+    for (u64 Index : Flags.SetBits())
+    {
+        TestCheckIndex(Visited < ArrayCount(Expected) && Index == Expected[Visited], Visited);
+        Visited += 1;
+    }
+    TestCheck(Visited == ArrayCount(Expected));
+
+    Flags.Unset(test_flag::word1);
+    TestCheck(!Flags.IsSet(test_flag::word1) && Flags.IsSet(test_flag::word0) && Flags.IsSet(test_flag::middle));
+    TestCheck(Flags.Count() == 4);
+
+    Flags.Reset();
+    TestCheck(!Flags.Any() && Flags.Count() == 0);
+}
+
+fn_internal u64
+NaiveFind(const bool* Bits, u64 BitCount, u64 Start, bool Value)
+{
+    for (u64 i = Start; i < BitCount; ++i)
+    {
+        if (Bits[i] == Value) return i;
+    }
+    return cBitNotFound;
+}
+
+fn_internal u64
+NaiveCount(const bool* Bits, u64 BitCount)
+{
+    u64 Count = 0;
+    for (u64 i = 0; i < BitCount; ++i) Count += Bits[i];
+    return Count;
+}
+
+fn_internal void
+TestDbitset(const allocator& Allocator, test_random* Random)
+{
+    constexpr u64 cBitCount = 1000;
+    bool Naive[cBitCount] = {};
+    dbitset Bits(Allocator, cBitCount);
+
+    for (u32 Step = 0; Step < 4000; ++Step)
+    {
+        u64 Index = Random->Range(u32(cBitCount));
+        switch (Random->Range(4u))
+        {
+            case 0: Bits.Set(Index);    Naive[Index] = true;          break;
+            case 1: Bits.Unset(Index);  Naive[Index] = false;         break;
+            case 2: Bits.Toggle(Index); Naive[Index] = !Naive[Index]; break;
+            case 3:
+            {
+                u64 Count = Random->Range(u32(cBitCount - Index)) + 1;
+                bool Set  = Random->Range(2u) != 0;
+                if (Set) Bits.SetRange(Index, Count);
+                else     Bits.UnsetRange(Index, Count);
+                for (u64 i = Index; i < Index + Count; ++i) Naive[i] = Set;
+            } break;
+        }
+
+        u64 Start = Random->Range(u32(cBitCount));
+        TestCheckIndex(Bits.IsSet(Index) == Naive[Index], Step);
+        TestCheckIndex(Bits.Count() == NaiveCount(Naive, cBitCount), Step);
+        TestCheckIndex(Bits.FindFirstSet(Start) == NaiveFind(Naive, cBitCount, Start, true), Step);
+        TestCheckIndex(Bits.FindFirstUnset(Start) == NaiveFind(Naive, cBitCount, Start, false), Step);
+    }
+
+    Bits.Deinit();
+}
+
+fn_internal void
+TestHbitset(const allocator& Allocator, test_random* Random)
+{
+    // Not a multiple of 64 * 64, so the last summary word and the last word are partial
+    constexpr u64 cBitCount = 9000;
+    static bool Naive[cBitCount] = {};
+    hbitset Bits(Allocator, cBitCount);
+
+    TestCheck(!Bits.Any() && Bits.Count() == 0);
+    TestCheck(Bits.FindFirstSet() == cBitNotFound && Bits.FindFirstUnset() == 0);
+
+    for (u32 Step = 0; Step < 3000; ++Step)
+    {
+        // Clustered edits so some words fill up completely and the NotFull summary gets exercised
+        u64 Index = (Step < 1500) ? Random->Range(300u) + 4096 : Random->Range(u32(cBitCount));
+        if (Random->Range(4u) != 0) { Bits.Set(Index);   Naive[Index] = true;  }
+        else                        { Bits.Unset(Index); Naive[Index] = false; }
+
+        u64 Start = Random->Range(u32(cBitCount));
+        TestCheckIndex(Bits.IsSet(Index) == Naive[Index], Step);
+        TestCheckIndex(Bits.Count() == NaiveCount(Naive, cBitCount), Step);
+        TestCheckIndex(Bits.Any() == (NaiveCount(Naive, cBitCount) != 0), Step);
+        TestCheckIndex(Bits.FindFirstSet(Start) == NaiveFind(Naive, cBitCount, Start, true), Step);
+        TestCheckIndex(Bits.FindFirstUnset(Start) == NaiveFind(Naive, cBitCount, Start, false), Step);
+    }
+
+    // ForEachSet visits the set bits in order, ConsumeEachSet does the same and clears them
+    u64 Next = 0;
+    bool InOrder = true;
+    Bits.ForEachSet([&](u64 Index) {
+        InOrder = InOrder && Index == NaiveFind(Naive, cBitCount, Next, true);
+        Next    = Index + 1;
+    });
+    TestCheck(InOrder && NaiveFind(Naive, cBitCount, Next, true) == cBitNotFound);
+
+    u64 Consumed = 0;
+    Bits.ConsumeEachSet([&](u64 Index) { Consumed += Naive[Index]; });
+    TestCheck(Consumed == NaiveCount(Naive, cBitCount));
+    TestCheck(!Bits.Any() && Bits.Count() == 0 && Bits.FindFirstUnset() == 0);
+
+    Bits.Deinit();
+}
+
+int main()
+{
+    allocator  Allocator = allocator::Default();
+    test_random Random;
+
+    TestBitset();
+    TestDbitset(Allocator, &Random);
+    TestHbitset(Allocator, &Random);
+
+    return TestResult("bit");
+}
@@ -0,0 +1,281 @@
+//
+// BVH Tests
+//
+// Every query is compared against a brute force loop over the object bounds, on small random scenes,
+// after a serial build, a build through the parallel-for callback, and a refit after objects moved.
+//
+#include <systems/bvh.h>
+
+#include "test_common.h"
+
+#include <algorithm>
+
+constexpr u32 cMaxObjects = 3000;
+
+fn_internal aabb
+RandomBox(test_random* Random, f32 WorldSize)
+{
+	f32x3 Center = { Random->Range(-WorldSize, WorldSize), Random->Range(-WorldSize, WorldSize), Random->Range(-WorldSize, WorldSize) };
+	f32x3 Extent = { Random->Range(0.05f, 2.0f), Random->Range(0.05f, 2.0f), Random->Range(0.05f, 2.0f) };
+	return { Center - Extent, Center + Extent };
+}
+
+fn_internal bool
+BoxesOverlap(const aabb& Left, const aabb& Right)
+{
+	return Left.Min.X <= Right.Max.X && Left.Max.X >= Right.Min.X &&
+	       Left.Min.Y <= Right.Max.Y && Left.Max.Y >= Right.Min.Y &&
+	       Left.Min.Z <= Right.Max.Z && Left.Max.Z >= Right.Min.Z;
+}
+
+fn_internal bool
+BoxInFrustum(const frustum& Frustum, const aabb& Box, f32 Slack)
+{
+	f32x3 Center = (Box.Min + Box.Max) * 0.5f;
+	f32x3 Extent = (Box.Max - Box.Min) * 0.5f + f32x3{ Slack, Slack, Slack };
+	return FrustumTestAabb(Frustum, Center, Extent);
+}
+
+// Entry distance of the ray into Box within [0, MaxT], or -1 when it misses
+fn_internal f32
+RayBox(f32x3 Origin, f32x3 Direction, f32 MaxT, const aabb& Box)
+{
+	f32 Enter = 0.0f;
+	f32 Exit  = MaxT;
+	ForRange(u32, Axis, 3)
+	{
+		f32 O = Origin.Ptr[Axis];
+		f32 D = Direction.Ptr[Axis];
+		if (D == 0.0f)
+		{
+			if (O < Box.Min.Ptr[Axis] || O > Box.Max.Ptr[Axis]) return -1.0f;
+			continue;
+		}
+
+		f32 T0 = (Box.Min.Ptr[Axis] - O) / D;
+		f32 T1 = (Box.Max.Ptr[Axis] - O) / D;
+		Enter  = fmaxf(Enter, fminf(T0, T1));
+		Exit   = fminf(Exit,  fmaxf(T0, T1));
+	}
+	return (Enter <= Exit) ? Enter : -1.0f;
+}
+
+// Exact intersection for the refined ray cast: the sphere inscribed in the object's box
+fn_internal f32
+RaySphere(void* Context, u32 Object, f32x3 Origin, f32x3 Direction, f32 MaxT)
+{
+	const aabb& Box    = ((const aabb*)Context)[Object];
+	f32x3       Center = (Box.Min + Box.Max) * 0.5f;
+	f32x3       Half   = (Box.Max - Box.Min) * 0.5f;
+	f32         Radius = fminf(Half.X, fminf(Half.Y, Half.Z));
+
+	f32x3 ToCenter = Origin - Center;
+	f32   A        = Dot(Direction, Direction);
+	f32   B        = Dot(ToCenter, Direction);
+	f32   C        = Dot(ToCenter, ToCenter) - Radius * Radius;
+	f32   Disc     = B * B - A * C;
+	if (Disc < 0.0f) return MaxT + 1.0f;
+
+	f32 T = (-B - sqrtf(Disc)) / A;
+	if (T < 0.0f) T = (-B + sqrtf(Disc)) / A;
+	return (T >= 0.0f && T <= MaxT) ? T : MaxT + 1.0f;
+}
+
+fn_internal void
+SerialParallelFor(void*, u32 Count, bvh_task_pfn Task, void* Data)
+{
+	// Back to front, so the tasks do not run in the order they were created
+	for (u32 i = Count; i-- > 0;) Task(Data, i);
+}
+
+fn_internal void
+CheckBounds(const bvh& Bvh, const aabb* Bounds, u32 Count)
+{
+	aabb Expected = Bounds[0];
+	ForRange(u32, i, Count)
+	{
+		ForRange(u32, Axis, 3)
+		{
+			Expected.Min.Ptr[Axis] = fminf(Expected.Min.Ptr[Axis], Bounds[i].Min.Ptr[Axis]);
+			Expected.Max.Ptr[Axis] = fmaxf(Expected.Max.Ptr[Axis], Bounds[i].Max.Ptr[Axis]);
+		}
+	}
+
+	aabb Root = Bvh.Bounds();
+	TestCheck(Root.Min.X == Expected.Min.X && Root.Min.Y == Expected.Min.Y && Root.Min.Z == Expected.Min.Z);
+	TestCheck(Root.Max.X == Expected.Max.X && Root.Max.Y == Expected.Max.Y && Root.Max.Z == Expected.Max.Z);
+}
+
+fn_internal void
+CheckOverlap(const bvh& Bvh, const aabb* Bounds, u32 Count, test_random* Random)
+{
+	static u32 Found[cMaxObjects];
+	static u32 Expected[cMaxObjects];
+
+	ForRange(u32, Query, 50)
+	{
+		aabb Box = RandomBox(Random, 40.0f);
+		Box.Max  = Box.Max + f32x3{ 5, 5, 5 };
+
+		u32 FoundCount    = Bvh.Overlap(Box, Found);
+		u32 ExpectedCount = 0;
+		ForRange(u32, i, Count)
+		{
+			if (BoxesOverlap(Box, Bounds[i])) Expected[ExpectedCount++] = i;
+		}
+
+		std::sort(Found, Found + FoundCount);
+		TestCheckIndex(FoundCount == ExpectedCount && std::equal(Found, Found + FoundCount, Expected), Query);
+	}
+}
+
+fn_internal void
+CheckFrustum(const bvh& Bvh, const aabb* Bounds, u32 Count, test_random* Random)
+{
+	static u32  Found[cMaxObjects];
+	static bool IsFound[cMaxObjects];
+
+	ForRange(u32, Query, 30)
+	{
+		f32x3  Eye      = { Random->Range(-60.0f, 60.0f), Random->Range(-60.0f, 60.0f), Random->Range(-60.0f, 60.0f) };
+		f32x3  Target   = { Random->Range(-20.0f, 20.0f), Random->Range(-20.0f, 20.0f), Random->Range(-20.0f, 20.0f) };
+		f32x44 View     = LookAtMatrixRH(Eye, Target, { 0, 1, 0 });
+		f32x44 Proj     = PerspectiveMatrixRH(Random->Range(30.0f, 90.0f), 16.0f / 9.0f, 0.1f, Random->Range(20.0f, 120.0f));
+		frustum Frustum = FrustumFromMatrix(F32x44MulRH(Proj, View));
+
+		u32 FoundCount = Bvh.CullFrustum(Frustum, Found);
+		ForRange(u32, i, Count) IsFound[i] = false;
+
+		bool Unique = true;
+		ForRange(u32, i, FoundCount)
+		{
+			Unique = Unique && !IsFound[Found[i]];
+			IsFound[Found[i]] = true;
+		}
+		TestCheckIndex(Unique, Query);
+
+		// The tree evaluates the plane sums in a different order than FrustumTestAabb, so boxes that
+		// touch a plane may go either way. Everything clearly inside must be found, nothing clearly outside.
+		u32 Missing = 0;
+		u32 Extra   = 0;
+		ForRange(u32, i, Count)
+		{
+			if (!IsFound[i] && BoxInFrustum(Frustum, Bounds[i], -1e-3f)) Missing += 1;
+			if ( IsFound[i] && !BoxInFrustum(Frustum, Bounds[i], 1e-3f)) Extra   += 1;
+		}
+		TestCheckIndex(Missing == 0 && Extra == 0, Query);
+	}
+}
+
+fn_internal void
+CheckRayCast(const bvh& Bvh, const aabb* Bounds, u32 Count, test_random* Random)
+{
+	ForRange(u32, Query, 200)
+	{
+		f32x3 Origin    = { Random->Range(-60.0f, 60.0f), Random->Range(-60.0f, 60.0f), Random->Range(-60.0f, 60.0f) };
+		f32x3 Direction = { Random->Range(-1.0f, 1.0f), Random->Range(-1.0f, 1.0f), Random->Range(-1.0f, 1.0f) };
+		if (Query % 4 == 0) Direction.Ptr[Query % 3] = 0.0f;    // axis aligned in one or two axes
+		if (Query % 8 == 0) Direction.Ptr[(Query + 1) % 3] = 0.0f;
+		f32 MaxT = Random->Range(10.0f, 150.0f);
+
+		// Bounds only
+		f32 ClosestBox = MaxT + 1.0f;
+		f32 ClosestHit = MaxT + 1.0f;
+		ForRange(u32, i, Count)
+		{
+			f32 T = RayBox(Origin, Direction, MaxT, Bounds[i]);
+			if (T >= 0.0f && T < ClosestBox) ClosestBox = T;
+
+			if (T >= 0.0f)
+			{
+				f32 Hit = RaySphere((void*)Bounds, i, Origin, Direction, MaxT);
+				if (Hit <= MaxT && Hit < ClosestHit) ClosestHit = Hit;
+			}
+		}
+
+		f32 HitT   = -1.0f;
+		u32 Object = Bvh.RayCast(Origin, Direction, MaxT, &HitT);
+		if (ClosestBox > MaxT)
+		{
+			TestCheckIndex(Object == bvh::cNoHit, Query);
+		}
+		else if (TestCheckIndex(Object != bvh::cNoHit, Query))
+		{
+			TestCheckIndex(fabsf(HitT - ClosestBox) < 1e-3f, Query);
+			TestCheckIndex(fabsf(RayBox(Origin, Direction, MaxT, Bounds[Object]) - ClosestBox) < 1e-3f, Query);
+		}
+
+		// Refined with the exact intersection
+		HitT   = -1.0f;
+		Object = Bvh.RayCast(Origin, Direction, MaxT, RaySphere, (void*)Bounds, &HitT);
+		if (ClosestHit > MaxT)
+		{
+			TestCheckIndex(Object == bvh::cNoHit, Query);
+		}
+		else if (TestCheckIndex(Object != bvh::cNoHit, Query))
+		{
+			TestCheckIndex(fabsf(HitT - ClosestHit) < 1e-3f, Query);
+		}
+	}
+}
+
+fn_internal void
+CheckQueries(const bvh& Bvh, const aabb* Bounds, u32 Count, test_random* Random)
+{
+	TestCheck(Bvh.Count() == Count);
+	CheckBounds(Bvh, Bounds, Count);
+	CheckOverlap(Bvh, Bounds, Count, Random);
+	CheckFrustum(Bvh, Bounds, Count, Random);
+	CheckRayCast(Bvh, Bounds, Count, Random);
+}
+
+int main()
+{
+	allocator   Allocator = allocator::Default();
+	test_random Random;
+
+	static aabb Bounds[cMaxObjects];
+	ForRange(u32, i, cMaxObjects) Bounds[i] = RandomBox(&Random, 50.0f);
+
+	bvh Bvh(Allocator, cMaxObjects);
+
+	// Sizes around the leaf size and the 4-wide collapse, then a larger scene
+	const u32 SmallCounts[] = { 1, 3, 4, 5, 17, 64, 200 };
+	for (u32 Count : SmallCounts)
+	{
+		Bvh.Build(Bounds, Count);
+		CheckQueries(Bvh, Bounds, Count, &Random);
+	}
+
+	// Coincident boxes give every axis a zero centroid extent, so nothing can be split by SAH
+	static aabb Stacked[40];
+	ForRange(u32, i, 40) Stacked[i] = { { 0, 0, 0 }, { 1, 1, 1 } };
+	Bvh.Build(Stacked, 40);
+	CheckQueries(Bvh, Stacked, 40, &Random);
+
+	Bvh.Build(Bounds, cMaxObjects);
+	CheckQueries(Bvh, Bounds, cMaxObjects, &Random);
+
+	// Large enough that the subtrees below the top levels become parallel-for tasks
+	Bvh.Build(Bounds, cMaxObjects, SerialParallelFor, nullptr);
+	CheckQueries(Bvh, Bounds, cMaxObjects, &Random);
+
+	// Move everything a bit, and some objects far away, then refit instead of rebuilding
+	ForRange(u32, i, cMaxObjects)
+	{
+		f32x3 Offset = { Random.Range(-3.0f, 3.0f), Random.Range(-3.0f, 3.0f), Random.Range(-3.0f, 3.0f) };
+		if (i % 50 == 0) Offset = Offset * 20.0f;
+		Bounds[i].Min = Bounds[i].Min + Offset;
+		Bounds[i].Max = Bounds[i].Max + Offset;
+	}
+	Bvh.Refit(Bounds);
+	CheckQueries(Bvh, Bounds, cMaxObjects, &Random);
+
+	Bvh.Build(Bounds, 0);
+	u32 None[1];
+	TestCheck(Bvh.Count() == 0 && Bvh.Overlap(Bounds[0], None) == 0);
+	TestCheck(Bvh.RayCast({ 0, 0, 0 }, { 1, 0, 0 }, 100.0f, nullptr) == bvh::cNoHit);
+
+	Bvh.Deinit();
+	return TestResult("bvh");
+}
@@ -0,0 +1,236 @@
+//
+// Job System Tests
+//
+// Every job has to run exactly once, whichever thread pops or steals it. The machines running these may
+// have a single core, so the workers are always created explicitly to keep the steal paths busy.
+//
+#include <util/job_system.h>
+
+#include "test_common.h"
+
+constexpr u32 cWorkerCount = 3;
+constexpr u32 cBatchSize   = job_system::cMaxJobsPerThread - 64;
+
+var_global std::atomic<u32> gRuns[cBatchSize];
+
+fn_internal void
+CountRun(void* Data)
+{
+    gRuns[u32(u64(Data))].fetch_add(1, std::memory_order_relaxed);
+}
+
+fn_internal void
+TestDeque(job_system* Jobs)
+{
+    // Nearly full deques, so the owner pops and the thieves steal the same slots many times over
+    static job Batch[cBatchSize];
+    ForRange(u32, Round, 20)
+    {
+        ForRange(u32, i, cBatchSize)
+        {
+            gRuns[i].store(0, std::memory_order_relaxed);
+            Batch[i] = { CountRun, (void*)u64(i), nullptr };
+        }
+
+        job_counter Counter = {};
+        Jobs->Run(Batch, cBatchSize, &Counter);
+        TestCheckIndex(Counter.Value() <= cBatchSize, Round);
+        Jobs->Wait(&Counter);
+        TestCheckIndex(Counter.IsDone(), Round);
+
+        u32 Wrong = 0;
+        ForRange(u32, i, cBatchSize)
+        {
+            Wrong += gRuns[i].load(std::memory_order_relaxed) != 1;
+        }
+        TestCheckIndex(Wrong == 0, Round);
+    }
+}
+
+//
+// Wait from inside jobs
+//
+
+struct tree_job
+{
+    job_system*      Jobs;
+    u32              Depth;
+    std::atomic<u32> Leaves;
+};
+
+fn_internal void
+TreeJob(void* Data)
+{
+    tree_job* Node = (tree_job*)Data;
+    if (Node->Depth == 0)
+    {
+        Node->Leaves.store(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // Children live on this job's stack, so the Wait below must not return before they are all done
+    constexpr u32 cChildCount = 4;
+    tree_job Children[cChildCount];
+    job      ChildJobs[cChildCount];
+    ForRange(u32, i, cChildCount)
+    {
+        Children[i].Jobs  = Node->Jobs;
+        Children[i].Depth = Node->Depth - 1;
+        Children[i].Leaves.store(0, std::memory_order_relaxed);
+        ChildJobs[i] = { TreeJob, &Children[i], nullptr };
+    }
+
+    job_counter Counter = {};
+    Node->Jobs->Run(ChildJobs, cChildCount, &Counter);
+    Node->Jobs->Wait(&Counter);
+
+    u32 Leaves = 0;
+    ForRange(u32, i, cChildCount)
+    {
+        Leaves += Children[i].Leaves.load(std::memory_order_relaxed);
+    }
+    Node->Leaves.store(Leaves, std::memory_order_relaxed);
+}
+
+fn_internal void
+TestNestedWait(job_system* Jobs)
+{
+    ForRange(u32, Round, 10)
+    {
+        tree_job Root = {};
+        Root.Jobs  = Jobs;
+        Root.Depth = 5;
+
+        job         RootJob = { TreeJob, &Root, nullptr };
+        job_counter Counter = {};
+        Jobs->Run(&RootJob, 1, &Counter);
+        Jobs->Wait(&Counter);
+
+        TestCheckIndex(Root.Leaves.load(std::memory_order_relaxed) == 4 * 4 * 4 * 4 * 4, Round);
+    }
+
+    // A job's own counter wins over the one passed to Run
+    job_counter Own     = {};
+    job_counter Shared  = {};
+    gRuns[0].store(0, std::memory_order_relaxed);
+    gRuns[1].store(0, std::memory_order_relaxed);
+    job Pair[2] = { { CountRun, (void*)u64(0), &Own }, { CountRun, (void*)u64(1), nullptr } };
+    Jobs->Run(Pair, 2, &Shared);
+    Jobs->Wait(&Own);
+    Jobs->Wait(&Shared);
+    TestCheck(gRuns[0].load() == 1 && gRuns[1].load() == 1);
+
+    // Waiting on a counter that has nothing queued returns right away
+    job_counter Idle = {};
+    Jobs->Wait(&Idle);
+    TestCheck(Idle.IsDone());
+}
+
+//
+// ParallelFor
+//
+
+struct parallel_for_test
+{
+    std::atomic<u32>* Hits;
+    std::atomic<u32>  Calls;
+};
+
+fn_internal void
+HitRange(void* Data, u32 Begin, u32 End)
+{
+    parallel_for_test* Test = (parallel_for_test*)Data;
+    Test->Calls.fetch_add(1, std::memory_order_relaxed);
+    for (u32 i = Begin; i < End; ++i)
+    {
+        Test->Hits[i].fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+fn_internal void
+HitIndex(void* Data, u32 Index)
+{
+    parallel_for_test* Test = (parallel_for_test*)Data;
+    Test->Calls.fetch_add(1, std::memory_order_relaxed);
+    Test->Hits[Index].fetch_add(1, std::memory_order_relaxed);
+}
+
+fn_internal bool
+EachHitOnce(parallel_for_test* Test, u32 Count)
+{
+    u32 Wrong = 0;
+    ForRange(u32, i, Count)
+    {
+        Wrong += Test->Hits[i].load(std::memory_order_relaxed) != 1;
+        Test->Hits[i].store(0, std::memory_order_relaxed);
+    }
+    return Wrong == 0;
+}
+
+fn_internal void
+TestParallelFor(job_system* Jobs)
+{
+    constexpr u32 cMaxCount = 100'000;
+    static std::atomic<u32> Hits[cMaxCount];
+
+    parallel_for_test Test = {};
+    Test.Hits = Hits;
+
+    const u32 Counts[] = { 1, 2, 7, 255, 256, 257, 1000, 4099, cMaxCount };
+    const u32 Grains[] = { 0, 1, 3, 64, 5000 };
+    for (u32 Count : Counts)
+    {
+        for (u32 Grain : Grains)
+        {
+            Test.Calls.store(0, std::memory_order_relaxed);
+            Jobs->ParallelFor(Count, HitRange, &Test, Grain);
+            TestCheckIndex(EachHitOnce(&Test, Count), Count);
+
+            // Never more ranges than jobs, however small the grain
+            TestCheckIndex(Test.Calls.load() <= job_system::cMaxParallelForJobs, Count);
+            if (Grain > 0 && DivideCeil(Count, Grain) <= job_system::cMaxParallelForJobs)
+            {
+                TestCheckIndex(Test.Calls.load() == DivideCeil(Count, Grain), Count);
+            }
+        }
+
+        Test.Calls.store(0, std::memory_order_relaxed);
+        Jobs->ParallelFor(Count, HitIndex, &Test);
+        TestCheckIndex(EachHitOnce(&Test, Count) && Test.Calls.load() == Count, Count);
+    }
+
+    // Nothing to do
+    Test.Calls.store(0, std::memory_order_relaxed);
+    Jobs->ParallelFor(0, HitRange, &Test);
+    TestCheck(Test.Calls.load() == 0);
+
+    // The callback form runs every task as its own job
+    Test.Calls.store(0, std::memory_order_relaxed);
+    job_system::ParallelForCallback(Jobs, 300, HitIndex, &Test);
+    TestCheck(EachHitOnce(&Test, 300) && Test.Calls.load() == 300);
+}
+
+int main()
+{
+    allocator Allocator = allocator::Default();
+
+    {
+        job_system Jobs(Allocator, cWorkerCount);
+        TestCheck(Jobs.ThreadCount() == cWorkerCount + 1);
+        TestDeque(&Jobs);
+        TestNestedWait(&Jobs);
+        TestParallelFor(&Jobs);
+        Jobs.Deinit();
+        TestCheck(Jobs.ThreadCount() == 0);
+    }
+
+    // A single worker, so most jobs are run by the waiting thread and the worker steals the rest
+    {
+        job_system Jobs(Allocator, 1);
+        TestDeque(&Jobs);
+        TestParallelFor(&Jobs);
+        Jobs.Deinit();
+    }
+
+    return TestResult("job");
+}
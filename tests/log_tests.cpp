@@ -0,0 +1,189 @@
+//
+// Log Tests
+//
+// The deferred decoder is checked against snprintf with the same format and arguments, then messages go
+// through the queue from several threads and are read back from the in-memory history.
+//
+#include <platform/platform.h>
+#include <util/str8.h>
+
+#include "test_common.h"
+
+#include <string.h>
+
+// Encodes the arguments like a deferred call would, so the decoder sees exactly what the log thread gets
+template<typename... Args>
+fn_internal u64
+EncodeArgs(u8* Buffer, const Args&... Arguments)
+{
+	u8* Cursor = Buffer;
+	((Cursor = LogEncodeArg(Cursor, Arguments)), ...);
+	return u64(Cursor - Buffer);
+}
+
+template<typename... Args>
+fn_internal bool
+DecodesTo(const char* Expected, const char* Format, const Args&... Arguments)
+{
+	u8  Encoded[512] = {};
+	u64 EncodedSize  = EncodeArgs(Encoded, Arguments...);
+	TestCheck(EncodedSize == (u64(0) + ... + LogArgSize(Arguments)));
+
+	char Decoded[512];
+	u64  Length = PlatformLogSystemDecodeDeferred(Decoded, sizeof(Decoded), Format, Encoded, EncodedSize);
+	bool Match  = Length == strlen(Expected) && strcmp(Decoded, Expected) == 0;
+	if (!Match)
+	{
+		printf("\"%s\" decoded to \"%s\", expected \"%s\"\n", Format, Decoded, Expected);
+	}
+	return Match;
+}
+
+// Checks the decoder against printf for formats printf accepts with these arguments
+#define CheckLikePrintf(Format, ...)                                          \
+	do {                                                                      \
+		char Expected_[512];                                                  \
+		snprintf(Expected_, sizeof(Expected_), Format, ##__VA_ARGS__);        \
+		TestCheck(DecodesTo(Expected_, Format, ##__VA_ARGS__));               \
+	} while (0)
+
+fn_internal void
+TestDecode()
+{
+	CheckLikePrintf("plain text, 100%% literal");
+	CheckLikePrintf("[%d] [%u] [%x] [%c]", -42, 42u, 0xBEEFu, 'q');
+	CheckLikePrintf("[%zu] [%lld] [%llu] [%llx]", size_t(123456789012ull), -9000000000ll, 18000000000000000000ull, 0xDEADBEEFCAFEull);
+	CheckLikePrintf("[%hd] [%hhu] [%ld]", short(-7), (unsigned char)200, -123456l);
+	CheckLikePrintf("[%5d] [%-5d] [%05d] [%+d] [% d]", 42, 42, 42, 42, 42);
+	CheckLikePrintf("[%.3f] [%10.2e] [%g] [%-8.1f]", 3.14159, 12345.678, 0.0001, 2.5f);
+	CheckLikePrintf("[%s] [%-6s] [%6s] [%.2s] [%6.2s]", "abc", "abc", "abc", "abc", "abc");
+	CheckLikePrintf("[%s]", "");
+
+	// * width and precision come from the arguments
+	CheckLikePrintf("[%.*s]", 3, "abcdef");
+	CheckLikePrintf("[%*d]", 5, 42);
+	CheckLikePrintf("[%*d]", -5, 42);
+	CheckLikePrintf("[%-*s]", 6, "ab");
+	CheckLikePrintf("[%*.*f]", 9, 2, 3.14159);
+	CheckLikePrintf("[%*.*s]", 6, 2, "abcdef");
+	CheckLikePrintf("[%.*d]", 4, 7);
+	CheckLikePrintf("[%.*s]", -1, "negative precision is none");
+	CheckLikePrintf("[%*zu|%.*llu]", 8, size_t(99), 3, 5ull);
+
+	// Enums, bools and pointers
+	TestCheck(DecodesTo("[3] [1]", "[%d] [%d]", log_level::warn, true));
+	void* Pointer = (void*)uptr(0x1234);
+	CheckLikePrintf("[%p]", Pointer);
+
+	// The copy of a null string prints like glibc and the MSVC CRT do
+	const char* Null = nullptr;
+	TestCheck(DecodesTo("[(null)] [(null)] [(nu]", "[%s] [%-6s] [%.3s]", Null, Null, Null));
+
+	// More specs than arguments, the extra ones print nothing
+	TestCheck(DecodesTo("a=1 b= c=", "a=%d b=%d c=%s", 1));
+	TestCheck(DecodesTo("[]", "[%*d]", 5));
+	TestCheck(DecodesTo("[]", "[%.*s]"));
+	TestCheck(DecodesTo("x", "x%"));
+
+	// The length that did not fit is still returned, and the buffer is terminated
+	u8  Encoded[64];
+	u64 EncodedSize = EncodeArgs(Encoded, "abcdef", 12345);
+	char Small[5];
+	u64  Length = PlatformLogSystemDecodeDeferred(Small, sizeof(Small), "%s-%d", Encoded, EncodedSize);
+	TestCheck(Length == 12 && strcmp(Small, "abcd") == 0);
+}
+
+//
+// Queue
+//
+
+constexpr u32 cLogThreadCount      = 3;
+constexpr u32 cMessagesPerThread   = 500;
+constexpr int cHistoryCount        = 64;
+
+struct history_check
+{
+	u32  Lines;
+	u32  ThreadLines;
+	u32  LastMessage[cLogThreadCount];
+	bool InOrder;
+	bool SawDeferredFormat;
+};
+
+fn_internal void
+LogFromThread(void* Data)
+{
+	u32 Thread = u32(uptr(Data));
+	ForRange(u32, i, cMessagesPerThread)
+	{
+		// Alternate between deferred and formatted-on-call messages, they share the queue
+		if (i % 2) LogDeferred(log_level::info, "thread %u message %u of %s", Thread, i + 1, "queue");
+		else       LogInfo("thread %u message %u of %s", Thread, i + 1, "queue");
+	}
+}
+
+fn_internal void
+VisitLine(void* UserData, log_level, istr8 Line)
+{
+	history_check* Check = (history_check*)UserData;
+	Check->Lines += 1;
+
+	char Text[300];
+	u64  Length = Line.Length() < sizeof(Text) - 1 ? Line.Length() : sizeof(Text) - 1;
+	memcpy(Text, Line.Ptr(), Length);
+	Text[Length] = 0;
+
+	if (strstr(Text, "star [  abc]")) Check->SawDeferredFormat = true;
+
+	u32 Thread = 0;
+	u32 Message = 0;
+	const char* Body = strstr(Text, "thread ");
+	if (Body && sscanf(Body, "thread %u message %u", &Thread, &Message) == 2 && Thread < cLogThreadCount)
+	{ // Each thread's messages come out in the order they were logged
+		Check->ThreadLines += 1;
+		Check->InOrder = Check->InOrder && Message > Check->LastMessage[Thread];
+		Check->LastMessage[Thread] = Message;
+	}
+}
+
+fn_internal void
+TestQueue()
+{
+	PlatformLogSystemInit(cHistoryCount, log_backpressure::block);
+	log_flags_bitset Flags = {};
+	Flags.Set(log_flags::editor);
+	PlatformLogSystemSetFlags(Flags);
+	PlatformLogSystemMinLogLevel(log_level::trace);
+
+	platform_thread Threads[cLogThreadCount];
+	ForRange(u32, i, cLogThreadCount)
+	{
+		TestCheck(Threads[i].Start(LogFromThread, (void*)uptr(i), "Log Test"));
+	}
+	ForRange(u32, i, cLogThreadCount)
+	{
+		Threads[i].Join();
+	}
+
+	LogDeferred(log_level::info, "star [%*.*s]", 5, 3, "abcdef");
+	PlatformLogSystemFlush();
+
+	history_check Check = {};
+	Check.InOrder = true;
+	PlatformLogSystemVisitHistory(VisitLine, &Check);
+
+	TestCheck(Check.Lines == u32(cHistoryCount));
+	TestCheck(Check.ThreadLines == u32(cHistoryCount) - 1);
+	TestCheck(Check.InOrder);
+	TestCheck(Check.SawDeferredFormat);
+	TestCheck(PlatformLogSystemGetDroppedCount() == 0);
+
+	PlatformLogSystemDeinit();
+}
+
+int main()
+{
+	TestDecode();
+	TestQueue();
+	return TestResult("log");
+}
@@ -0,0 +1,149 @@
+//
+// Packed Format Tests
+//
+// Checks that the array conversions in math/packed.h give the same bits as the scalar functions,
+// including the special values the SIMD paths have to handle explicitly.
+//
+#include <math/packed.h>
+
+#include "test_common.h"
+
+#include <string.h>
+
+fn_internal bool
+SameBits(f32 Left, f32 Right)
+{
+    return memcmp(&Left, &Right, sizeof(f32)) == 0;
+}
+
+// Special values first, then a sweep of ordinary values. Counts are not multiples of the SIMD width
+// so the scalar remainder runs too.
+fn_internal u64
+MakeInputs(f32* Values, u64 Capacity)
+{
+    const u32 SpecialBits[] = {
+        0x7FC00000u, 0xFFC00000u, // quiet NaN, both signs
+        0x7F800001u, 0x7FBFFFFFu, // signaling NaN
+        0x7FFFE000u, 0xFFA5A5A5u, // NaN with payloads that survive a plain f16 truncation
+        0x00000000u, 0x80000000u, // +-0
+        0x7F800000u, 0xFF800000u, // +-Inf
+        0x00000001u, 0x807FFFFFu, // f32 denormals
+        0x33800000u, 0x387FC000u, // f16 denormal range
+        0x477FE000u, 0x477FF000u, // f16 max, and the first value that rounds to Inf
+        0x3F800000u, 0xBF800000u, // +-1
+    };
+
+    u64 Count = 0;
+    for (u32 Bits : SpecialBits)
+    {
+        memcpy(&Values[Count++], &Bits, sizeof(f32));
+    }
+
+    for (f32 Value = -2.0f; Count < Capacity && Value <= 2.0f; Value += 0.0137f)
+    {
+        Values[Count++] = Value;
+    }
+    return Count;
+}
+
+fn_internal void
+TestF16(const f32* Values, u64 Count)
+{
+    f16 Halves[512];
+    f32 Floats[512];
+    F32ToF16Array(Values, Halves, Count);
+    F16ToF32Array(Halves, Floats, Count);
+
+    for (u64 i = 0; i < Count; ++i)
+    {
+        f16 Half = F32ToF16(Values[i]);
+        TestCheckIndex(Halves[i].Bits == Half.Bits, i);
+        TestCheckIndex(SameBits(Floats[i], F16ToF32(Half)), i);
+    }
+}
+
+fn_internal void
+TestSnorm16(const f32* Values, u64 Count)
+{
+    snorm16 Packed[512];
+    f32     Unpacked[512];
+    PackSnorm16Array(Values, Packed, Count);
+    UnpackSnorm16Array(Packed, Unpacked, Count);
+
+    for (u64 i = 0; i < Count; ++i)
+    {
+        TestCheckIndex(Packed[i].Value == PackSnorm16(Values[i]).Value, i);
+        TestCheckIndex(SameBits(Unpacked[i], UnpackSnorm16(Packed[i])), i);
+    }
+}
+
+fn_internal void
+TestUnorm8(const f32* Values, u64 Count)
+{
+    unorm8 Packed[512];
+    f32    Unpacked[512];
+    PackUnorm8Array(Values, Packed, Count);
+    UnpackUnorm8Array(Packed, Unpacked, Count);
+
+    for (u64 i = 0; i < Count; ++i)
+    {
+        TestCheckIndex(Packed[i].Value == PackUnorm8(Values[i]).Value, i);
+        TestCheckIndex(SameBits(Unpacked[i], UnpackUnorm8(Packed[i])), i);
+    }
+
+    // Every byte value through the unpack path, in and out of the 16-wide loop
+    unorm8 Bytes[256 + 7];
+    f32    Floats[256 + 7];
+    for (u32 i = 0; i < ArrayCount(Bytes); ++i) Bytes[i].Value = u8(i);
+    UnpackUnorm8Array(Bytes, Floats, ArrayCount(Bytes));
+    for (u32 i = 0; i < ArrayCount(Bytes); ++i)
+    {
+        TestCheckIndex(SameBits(Floats[i], UnpackUnorm8(Bytes[i])), i);
+    }
+}
+
+fn_internal void
+TestOctNormal(const f32* Values, u64 Count)
+{
+    // Every component of every normal walks the special values, including all-zero and NaN normals.
+    f32x3 Normals[512];
+    for (u64 i = 0; i < Count; ++i)
+    {
+        Normals[i].X = Values[i];
+        Normals[i].Y = Values[(i * 7 + 3) % Count];
+        Normals[i].Z = Values[(i * 13 + 5) % Count];
+    }
+    Normals[0] = { 0.0f, 0.0f,  0.0f };
+    Normals[1] = { 0.0f, 0.0f, -0.0f };
+
+    oct_normal Encoded[512];
+    f32x3      Decoded[512];
+    OctNormalEncodeArray(Normals, Encoded, Count);
+    OctNormalDecodeArray(Encoded, Decoded, Count);
+
+    for (u64 i = 0; i < Count; ++i)
+    {
+        oct_normal Expected = OctNormalEncode(Normals[i]);
+        TestCheckIndex(Encoded[i].X.Value == Expected.X.Value && Encoded[i].Y.Value == Expected.Y.Value, i);
+
+        f32x3 Normal = OctNormalDecode(Encoded[i]);
+        TestCheckIndex(SameBits(Decoded[i].X, Normal.X) && SameBits(Decoded[i].Y, Normal.Y) && SameBits(Decoded[i].Z, Normal.Z), i);
+    }
+
+    // A zero length normal decodes to +Z, as in the scalar path (Norm uses the rsqrt estimate, so Z is only close to 1)
+    TestCheckIndex(Decoded[0].X == 0.0f && Decoded[0].Y == 0.0f && fabsf(Decoded[0].Z - 1.0f) < 1e-6f, 0);
+    TestCheckIndex(Decoded[1].X == 0.0f && Decoded[1].Y == 0.0f && fabsf(Decoded[1].Z - 1.0f) < 1e-6f, 1);
+}
+
+int main()
+{
+    f32 Values[512];
+    u64 Count = MakeInputs(Values, 301);
+
+    TestF16(Values, Count);
+    TestSnorm16(Values, Count);
+    TestUnorm8(Values, Count);
+    TestOctNormal(Values, Count);
+
+    return TestResult("packed");
+}
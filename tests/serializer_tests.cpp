@@ -0,0 +1,226 @@
+//
+// Serializer Tests
+//
+// The reflected serialization example from serializer.h, and group varint round trips checked
+// against a plain byte-by-byte decoder written from the format description in serializer.cpp. The test is built twice: against chibi-core, and with serializer.cpp
+// compiled for SSSE3 so the pshufb decoder runs too (see CMakeLists.txt).
+//
+#include <util/serializer.h>
+#include <util/simd.h>
+
+#include "test_common.h"
+
+#include <string.h>
+
+//
+// Reflected Serialization example
+//
+// The example from serializer.h, compiled here so the documentation can't drift from what the
+// templates actually do.
+//
+
+struct foo_header
+{
+    u16 Version;
+    u64 Size;
+};
+
+struct foo
+{
+    foo_header Header;
+    f32        Position[3];
+    f32        Radius;
+    u32        Flags;
+};
+
+SERIAL_LAYOUT(foo_header,
+    SERIAL_FIELD(foo_header, Version),
+    SERIAL_FIELD(foo_header, Size));
+
+SERIAL_LAYOUT(foo,
+    SERIAL_FIELD(foo, Header),
+    SERIAL_FIELD(foo, Position),
+    SERIAL_FIELD(foo, Radius),
+    SERIAL_FIELD(foo, Flags));
+
+using foo_table = serial_internal::table_for<foo>;
+
+static_assert(!IsSerialPod<foo_header>(),                     "Padding splits the header into two runs");
+static_assert(!foo_table::StartsRun(0),                       "Header goes through its own overload");
+static_assert(foo_table::StartsRun(1),                        "Position starts a run");
+static_assert(foo_table::RunSize(1) == 20,                    "Position, Radius and Flags are one 20 byte copy");
+static_assert(!foo_table::StartsRun(2) && !foo_table::StartsRun(3), "Radius and Flags join the Position run");
+
+fn_internal file_writer
+MemoryWriter(u8* Buffer, u64 Size)
+{
+    file_writer Writer = {};
+    Writer.mBasePtr    = Buffer;
+    Writer.mOffsetPtr  = Buffer;
+    Writer.mEndPtr     = Buffer + Size;
+    return Writer;
+}
+
+fn_internal file_reader
+MemoryReader(u8* Buffer, u64 Size)
+{
+    file_reader Reader = {};
+    Reader.mBasePtr    = Buffer;
+    Reader.mOffsetPtr  = Buffer;
+    Reader.mEndPtr     = Buffer + Size;
+    return Reader;
+}
+
+fn_internal bool
+FooEqual(const foo& Left, const foo& Right)
+{
+    return Left.Header.Version == Right.Header.Version && Left.Header.Size == Right.Header.Size &&
+           memcmp(Left.Position, Right.Position, sizeof(Left.Position)) == 0 &&
+           Left.Radius == Right.Radius && Left.Flags == Right.Flags;
+}
+
+fn_internal void
+TestReflectedExample()
+{
+    foo Example = {};
+    Example.Header.Version = 3;
+    Example.Header.Size    = 0x0123456789ABCDEFull;
+    Example.Position[0]    = 1.0f;
+    Example.Position[1]    = -2.5f;
+    Example.Position[2]    = 1e-3f;
+    Example.Radius         = 4.0f;
+    Example.Flags          = 0xA5A5A5A5u;
+
+    // Version and Size are written without the padding between them, then the 20 byte run
+    u8 Buffer[128];
+    file_writer Writer = MemoryWriter(Buffer, sizeof(Buffer));
+    Serialize(&Writer, Example);
+    u64 Written = u64(Writer.mOffsetPtr - Buffer);
+    TestCheck(Written == sizeof(u16) + sizeof(u64) + 20);
+
+    file_reader Reader = MemoryReader(Buffer, Written);
+    foo Read = Deserialize<foo>(&Reader);
+    TestCheck(Reader.mOffsetPtr == Reader.mEndPtr);
+    TestCheck(FooEqual(Read, Example));
+
+    // The schema variant prefixes the hash and rejects data written for a different layout
+    Writer = MemoryWriter(Buffer, sizeof(Buffer));
+    SerializeWithSchema(&Writer, Example);
+    Written = u64(Writer.mOffsetPtr - Buffer);
+    TestCheck(Written == sizeof(u64) + sizeof(u16) + sizeof(u64) + 20);
+
+    foo WithSchema = {};
+    Reader = MemoryReader(Buffer, Written);
+    TestCheck(DeserializeWithSchema(&Reader, WithSchema));
+    TestCheck(FooEqual(WithSchema, Example));
+
+    foo Untouched = {};
+    Buffer[0] ^= 1;
+    Reader = MemoryReader(Buffer, Written);
+    TestCheck(!DeserializeWithSchema(&Reader, Untouched));
+    TestCheck(Untouched.Header.Version == 0 && Untouched.Flags == 0);
+    TestCheck(SerialSchemaHash<foo>() != SerialSchemaHash<foo_header>());
+}
+
+// Reference decoder: [control byte][1-4 bytes per value], 2 bits of (length - 1) per value.
+fn_internal u64
+GroupVarintDecodeReference(const u8* Src, u32* Values, u64 Count)
+{
+    u64 Offset = 0;
+    for (u64 i = 0; i < Count; i += 4)
+    {
+        u8 Control = Src[Offset++];
+        for (u32 Lane = 0; Lane < 4; ++Lane)
+        {
+            u32 Length = ((Control >> (2 * Lane)) & 0x3) + 1;
+            u32 Value  = 0;
+            for (u32 Byte = 0; Byte < Length; ++Byte)
+            {
+                Value |= u32(Src[Offset++]) << (8 * Byte);
+            }
+            if (i + Lane < Count) Values[i + Lane] = Value;
+        }
+    }
+    return Offset;
+}
+
+// Values of 1 to 4 bytes, mixed so every control byte pattern shows up.
+fn_internal u32
+RandomVarintValue(test_random* Random)
+{
+    switch (Random->Range(5u))
+    {
+        case 0:  return 0;
+        case 1:  return Random->Next() & 0xFF;
+        case 2:  return Random->Next() & 0xFFFF;
+        case 3:  return Random->Next() & 0xFFFFFF;
+        default: return Random->Next() | 0x80000000u;
+    }
+}
+
+fn_internal void
+TestGroupVarintRoundTrip()
+{
+    test_random Random;
+
+    constexpr u64 cMaxCount = 67;
+    u32 Values[cMaxCount];
+    u32 Decoded[cMaxCount];
+    u32 Reference[cMaxCount];
+    u8  Encoded[GroupVarintMaxEncodedSizeU32(cMaxCount)];
+
+    for (u32 Iteration = 0; Iteration < 2000; ++Iteration)
+    {
+        u64 Count = Random.Range(u32(cMaxCount + 1));
+        for (u64 i = 0; i < Count; ++i)
+        {
+            Values[i] = RandomVarintValue(&Random);
+        }
+
+        u64 EncodedSize = GroupVarintEncodeU32(Encoded, Values, Count);
+        TestCheckIndex(EncodedSize <= GroupVarintMaxEncodedSizeU32(Count), Iteration);
+
+        // SrcSize is exactly the encoded size, so the SIMD loop has to hand the last groups to the scalar tail
+        memset(Decoded,   0xCD, sizeof(Decoded));
+        memset(Reference, 0xCD, sizeof(Reference));
+        u64 DecodedSize   = GroupVarintDecodeU32(Encoded, EncodedSize, Decoded, Count);
+        u64 ReferenceSize = GroupVarintDecodeReference(Encoded, Reference, Count);
+
+        TestCheckIndex(DecodedSize == EncodedSize && ReferenceSize == EncodedSize, Iteration);
+        TestCheckIndex(memcmp(Decoded, Values, Count * sizeof(u32)) == 0, Iteration);
+        TestCheckIndex(memcmp(Decoded, Reference, sizeof(Decoded)) == 0, Iteration);
+    }
+}
+
+fn_internal void
+TestGroupVarintEdges()
+{
+    // One group of 4-byte values is the 17 byte worst case
+    u32 Max[4] = { 0xFFFFFFFFu, 0x01000000u, 0xFFFFFFFFu, 0x80000000u };
+    u8  Encoded[GroupVarintMaxEncodedSizeU32(4)];
+    TestCheck(GroupVarintEncodeU32(Encoded, Max, 4) == 17);
+
+    u32 Decoded[4] = {};
+    TestCheck(GroupVarintDecodeU32(Encoded, 17, Decoded, 4) == 17);
+    TestCheck(memcmp(Decoded, Max, sizeof(Max)) == 0);
+
+    // A partial group is padded with 1 byte zeros, and only Count values are written
+    u32 One        = 300;
+    u32 Written[4] = { 7, 7, 7, 7 };
+    u64 Size       = GroupVarintEncodeU32(Encoded, &One, 1);
+    TestCheck(Size == 1 + 2 + 3);
+    TestCheck(GroupVarintDecodeU32(Encoded, Size, Written, 1) == Size);
+    TestCheck(Written[0] == 300 && Written[1] == 7 && Written[2] == 7 && Written[3] == 7);
+
+    TestCheck(GroupVarintEncodeU32(Encoded, nullptr, 0) == 0);
+    TestCheck(GroupVarintDecodeU32(Encoded, 0, nullptr, 0) == 0);
+}
+
+int main()
+{
+    TestReflectedExample();
+    TestGroupVarintRoundTrip();
+    TestGroupVarintEdges();
+
+    return TestResult(SIMD_SSSE3 ? "serializer (ssse3)" : "serializer");
+}
@@ -0,0 +1,61 @@
+//
+// Test Helpers
+//
+// Each test is a plain executable registered with ctest. A failed check prints its location and
+// the condition, and main returns TestResult() so ctest sees the failure.
+//
+#pragma once
+
+#include <types.h>
+
+#include <stdio.h>
+
+var_global u32 gTestFailures = 0;
+var_global u32 gTestChecks   = 0;
+
+fn_internal bool
+TestCheckImpl(bool Condition, const char* What, const char* File, int Line, u64 Index, bool HasIndex)
+{
+    gTestChecks += 1;
+    if (!Condition)
+    {
+        if (HasIndex) printf("%s(%d): FAILED: %s at %llu\n", File, Line, What, (unsigned long long)Index);
+        else          printf("%s(%d): FAILED: %s\n", File, Line, What);
+        gTestFailures += 1;
+    }
+    return Condition;
+}
+
+#define TestCheck(Condition)             TestCheckImpl((Condition), #Condition, __FILE__, __LINE__, 0, false)
+#define TestCheckIndex(Condition, Index) TestCheckImpl((Condition), #Condition, __FILE__, __LINE__, (Index), true)
+
+// Small deterministic generator so failures reproduce.
+struct test_random
+{
+    u64 State = 0x9E3779B97F4A7C15ull;
+
+    u32 Next()
+    {
+        State ^= State << 13;
+        State ^= State >> 7;
+        State ^= State << 17;
+        return u32(State >> 32);
+    }
+
+    u32 Range(u32 Count)           { return Next() % Count; }
+    f32 Unit()                     { return f32(Next() >> 8) * (1.0f / 16777216.0f); }
+    f32 Range(f32 Min, f32 Max)    { return Min + (Max - Min) * Unit(); }
+};
+
+fn_internal int
+TestResult(const char* Name)
+{
+    if (gTestFailures == 0)
+    {
+        printf("%s: all %u checks passed\n", Name, gTestChecks);
+        return 0;
+    }
+
+    printf("%s: %u of %u checks failed\n", Name, gTestFailures, gTestChecks);
+    return 1;
+}
@@ -0,0 +1,248 @@
+//
+// Transform System Tests
+//
+// Random hierarchies checked against a naive recursive compose of T * R * S, through reparenting,
+// subtree destruction and id reuse, plus the per-frame dirty write-out.
+//
+#include <systems/transform_system.h>
+
+#include "test_common.h"
+
+#include <string.h>
+
+constexpr u32 cMaxNodes = 256;
+
+// Mirror of the scene kept by the test, indexed by creation order.
+struct naive_node
+{
+	transform_id Id;
+	s32          Parent; // index into the naive array, or -1
+	bool         Alive;
+	f32x3        Position;
+	quaternion   Rotation;
+	f32x3        Scale;
+};
+
+struct naive_scene
+{
+	naive_node Nodes[cMaxNodes];
+	u32        Count;
+};
+
+fn_internal quaternion
+RandomRotation(test_random* Random)
+{
+	f32x3 Axis = { Random->Range(-1.0f, 1.0f), Random->Range(-1.0f, 1.0f), Random->Range(-1.0f, 1.0f) + 2.0f };
+	return QuaternionFromAxisAngle(Axis, Random->Range(-180.0f, 180.0f));
+}
+
+fn_internal void
+RandomLocal(transform_system* Transforms, naive_node* Node, test_random* Random)
+{
+	Node->Position = { Random->Range(-2.0f, 2.0f), Random->Range(-2.0f, 2.0f), Random->Range(-2.0f, 2.0f) };
+	Node->Rotation = RandomRotation(Random);
+	Node->Scale    = { Random->Range(0.5f, 1.5f), Random->Range(0.5f, 1.5f), Random->Range(0.5f, 1.5f) };
+	Transforms->SetLocal(Node->Id, Node->Position, Node->Rotation, Node->Scale);
+}
+
+fn_internal u32
+CreateNode(transform_system* Transforms, naive_scene* Scene, s32 Parent, test_random* Random)
+{
+	u32 Index = Scene->Count++;
+	naive_node* Node = &Scene->Nodes[Index];
+	Node->Parent = Parent;
+	Node->Alive  = true;
+	Node->Id     = Transforms->Create((Parent >= 0) ? Scene->Nodes[Parent].Id : transform_id(cInvalidId), Index);
+	RandomLocal(Transforms, Node, Random);
+	return Index;
+}
+
+fn_internal f32x44
+NaiveWorld(const naive_scene* Scene, u32 Index)
+{
+	const naive_node* Node = &Scene->Nodes[Index];
+	f32x44 Local = F32x44MulRH(TranslateMatrix(Node->Position),
+	               F32x44MulRH(QuaternionToRotationMatrix(Node->Rotation), ScaleMatrix(Node->Scale.X, Node->Scale.Y, Node->Scale.Z)));
+	return (Node->Parent >= 0) ? F32x44MulRH(NaiveWorld(Scene, u32(Node->Parent)), Local) : Local;
+}
+
+fn_internal bool
+NearlyEqual(const f32x44& Left, const f32x44& Right)
+{
+	ForRange(u32, Column, 4)
+	{
+		ForRange(u32, Row, 4)
+		{
+			f32 Difference = Left.Ptr[Column][Row] - Right.Ptr[Column][Row];
+			if (Difference > 1e-3f || Difference < -1e-3f) return false;
+		}
+	}
+	return true;
+}
+
+fn_internal bool
+IsDescendant(const naive_scene* Scene, u32 Index, u32 Ancestor)
+{
+	for (s32 Node = s32(Index); Node >= 0; Node = Scene->Nodes[Node].Parent)
+	{
+		if (u32(Node) == Ancestor) return true;
+	}
+	return false;
+}
+
+fn_internal void
+CheckScene(const transform_system* Transforms, const naive_scene* Scene)
+{
+	u32 AliveCount = 0;
+	ForRange(u32, i, Scene->Count)
+	{
+		const naive_node* Node = &Scene->Nodes[i];
+		TestCheckIndex(Transforms->IsAlive(Node->Id) == Node->Alive, i);
+		if (!Node->Alive || !Transforms->IsAlive(Node->Id)) continue;
+
+		AliveCount += 1;
+		TestCheckIndex(NearlyEqual(Transforms->GetWorld(Node->Id), NaiveWorld(Scene, i)), i);
+	}
+	TestCheck(Transforms->Count() == AliveCount);
+}
+
+fn_internal void
+TestHierarchy(const allocator& Allocator, test_random* Random)
+{
+	transform_system Transforms(Allocator, cMaxNodes);
+	static naive_scene Scene;
+	Scene = {};
+
+	// A few roots and random trees several levels deep, with wide sibling groups
+	ForRange(u32, i, 120)
+	{
+		s32 Parent = (i < 4) ? -1 : s32(Random->Range(i));
+		CreateNode(&Transforms, &Scene, Parent, Random);
+	}
+	Transforms.Update();
+	CheckScene(&Transforms, &Scene);
+
+	// Local edits only touch the edited subtrees
+	ForRange(u32, i, 20)
+	{
+		RandomLocal(&Transforms, &Scene.Nodes[Random->Range(Scene.Count)], Random);
+	}
+	Transforms.Update();
+	CheckScene(&Transforms, &Scene);
+
+	// Reparent, including moves to the root level and under a deeper node
+	ForRange(u32, i, 30)
+	{
+		u32 Node   = Random->Range(Scene.Count);
+		s32 Parent = (Random->Range(5u) == 0) ? -1 : s32(Random->Range(Scene.Count));
+		if (Parent >= 0 && IsDescendant(&Scene, u32(Parent), Node)) continue;
+
+		Scene.Nodes[Node].Parent = Parent;
+		Transforms.SetParent(Scene.Nodes[Node].Id, (Parent >= 0) ? Scene.Nodes[Parent].Id : transform_id(cInvalidId));
+		if (i % 10 == 9)
+		{
+			Transforms.Update();
+			CheckScene(&Transforms, &Scene);
+		}
+	}
+
+	// Destroy a subtree: the node dies at once, its descendants only when Update releases them
+	u32 Victim = 0;
+	ForRange(u32, i, Scene.Count)
+	{
+		u32 Descendants = 0;
+		ForRange(u32, j, Scene.Count) Descendants += (j != i && IsDescendant(&Scene, j, i));
+		if (Descendants >= 3) { Victim = i; break; }
+	}
+
+	Transforms.Destroy(Scene.Nodes[Victim].Id);
+	TestCheck(!Transforms.IsAlive(Scene.Nodes[Victim].Id));
+	ForRange(u32, j, Scene.Count)
+	{
+		if (j != Victim && IsDescendant(&Scene, j, Victim)) TestCheckIndex(Transforms.IsAlive(Scene.Nodes[j].Id), j);
+	}
+
+	ForRange(u32, j, Scene.Count)
+	{
+		if (IsDescendant(&Scene, j, Victim)) Scene.Nodes[j].Alive = false;
+	}
+	Transforms.Update();
+	CheckScene(&Transforms, &Scene);
+
+	// Released ids are reused with a new generation, the old handles stay dead
+	ForRange(u32, i, 40)
+	{
+		s32 Parent = s32(Random->Range(Scene.Count));
+		if (!Scene.Nodes[Parent].Alive) Parent = -1;
+		CreateNode(&Transforms, &Scene, Parent, Random);
+	}
+	Transforms.Update();
+	CheckScene(&Transforms, &Scene);
+
+	Transforms.Deinit();
+}
+
+fn_internal void
+TestWriteWorldMatrices(const allocator& Allocator)
+{
+	// Root -> Child -> Grandchild, and a separate Other root. Two buffered frames.
+	transform_system Transforms(Allocator, 16, 2);
+	transform_id Root       = Transforms.Create(transform_id(cInvalidId), 0);
+	transform_id Child      = Transforms.Create(Root, 1);
+	transform_id Grandchild = Transforms.Create(Child, 2);
+	transform_id Group      = Transforms.Create(Root); // no object, never written
+	transform_id Other      = Transforms.Create(transform_id(cInvalidId), 3);
+	(void)Group;
+
+	f32x44 Frames[2][4];
+	f32x44 Sentinel = ScaleMatrix(7.0f, 7.0f, 7.0f);
+	auto ResetFrame = [&](u32 Frame) { ForRange(u32, i, 4) Frames[Frame][i] = Sentinel; };
+	auto Written    = [&](u32 Frame, u32 Object) { return memcmp(&Frames[Frame][Object], &Sentinel, sizeof(f32x44)) != 0; };
+
+	// Everything is new, so both frames get every object
+	Transforms.SetLocalPosition(Other, { 5, 0, 0 });
+	Transforms.Update();
+	ResetFrame(0);
+	ResetFrame(1);
+	Transforms.WriteWorldMatrices(Frames[0], sizeof(f32x44), 0);
+	Transforms.WriteWorldMatrices(Frames[1], sizeof(f32x44), 1);
+	ForRange(u32, Object, 4)
+	{
+		TestCheckIndex(Written(0, Object) && Written(1, Object), Object);
+	}
+	TestCheck(memcmp(&Frames[0][3], &Transforms.GetWorld(Other), sizeof(f32x44)) == 0);
+
+	// Moving Child rewrites Child and Grandchild only, in each frame's copy
+	Transforms.SetLocalPosition(Child, { 0, 1, 0 });
+	Transforms.Update();
+	ResetFrame(0);
+	Transforms.WriteWorldMatrices(Frames[0], sizeof(f32x44), 0);
+	TestCheck(!Written(0, 0) && Written(0, 1) && Written(0, 2) && !Written(0, 3));
+	TestCheck(memcmp(&Frames[0][2], &Transforms.GetWorld(Grandchild), sizeof(f32x44)) == 0);
+
+	// Frame 1 has not been written since, so it accumulates that change and the next one
+	Transforms.SetLocalScale(Other, { 2, 2, 2 });
+	Transforms.Update();
+	ResetFrame(1);
+	Transforms.WriteWorldMatrices(Frames[1], sizeof(f32x44), 1);
+	TestCheck(!Written(1, 0) && Written(1, 1) && Written(1, 2) && Written(1, 3));
+
+	// Nothing changed: nothing written
+	Transforms.Update();
+	ResetFrame(1);
+	Transforms.WriteWorldMatrices(Frames[1], sizeof(f32x44), 1);
+	TestCheck(!Written(1, 0) && !Written(1, 1) && !Written(1, 2) && !Written(1, 3));
+
+	Transforms.Deinit();
+}
+
+int main()
+{
+	allocator   Allocator = allocator::Default();
+	test_random Random;
+
+	TestHierarchy(Allocator, &Random);
+	TestWriteWorldMatrices(Allocator);
+
+	return TestResult("transform");
+}